@@ -63,7 +63,7 @@ for base in "$@"; do
 done
 
 # Required variables
-required_vars="BMC0_RSYNC_PORT BMC1_RSYNC_PORT BMC0_STUNNEL_PORT BMC1_STUNNEL_PORT BMC0_IP BMC1_IP"
+required_vars="BMC0_RSYNC_PORT BMC1_RSYNC_PORT BMC0_STUNNEL_PORT BMC1_STUNNEL_PORT BMC0_TRANSFER_PORT BMC1_TRANSFER_PORT BMC0_TRANSFER_STUNNEL_PORT BMC1_TRANSFER_STUNNEL_PORT BMC0_IP BMC1_IP"
 
 # Validate required variables
 missing_vars=""
@@ -108,6 +108,10 @@ generate_conf() {
     eval STUNNEL_PORT=\$${bmc}_STUNNEL_PORT
     eval SIB_RSYNC_PORT=\$${sib}_RSYNC_PORT
     eval SIB_STUNNEL_PORT=\$${sib}_STUNNEL_PORT
+    eval TRANSFER_PORT=\$${bmc}_TRANSFER_PORT
+    eval TRANSFER_STUNNEL_PORT=\$${bmc}_TRANSFER_STUNNEL_PORT
+    eval SIB_TRANSFER_PORT=\$${sib}_TRANSFER_PORT
+    eval SIB_TRANSFER_STUNNEL_PORT=\$${sib}_TRANSFER_STUNNEL_PORT
     eval SIB_IP=\$${sib}_IP
 
     RSYNC_OUT="$RSYNC_OUT_DIR/${lbmc}_rsyncd.conf"
@@ -120,6 +124,10 @@ generate_conf() {
         -e "s|<SIBLING_BMC_RSYNC_PORT>|$SIB_RSYNC_PORT|g" \
         -e "s|<SIBLING_BMC_IP>|$SIB_IP|g" \
         -e "s|<SIBLING_BMC_STUNNEL_PORT>|$SIB_STUNNEL_PORT|g" \
+        -e "s|<LOCAL_BMC_TRANSFER_STUNNEL_PORT>|$TRANSFER_STUNNEL_PORT|g" \
+        -e "s|<LOCAL_BMC_TRANSFER_PORT>|$TRANSFER_PORT|g" \
+        -e "s|<SIBLING_BMC_TRANSFER_PORT>|$SIB_TRANSFER_PORT|g" \
+        -e "s|<SIBLING_BMC_TRANSFER_STUNNEL_PORT>|$SIB_TRANSFER_STUNNEL_PORT|g" \
         -e "s|<LOCAL_BMC_CERT>|${CERT_DIR}/${lbmc}.crt|g" \
         -e "s|<LOCAL_BMC_KEY>|${CERT_DIR}/${lbmc}.key|g" \
         -e "s|<CA_CERT>|${CERT_DIR}/ca.crt|g" \
@@ -2,6 +2,8 @@
 
 #include "async_command_exec.hpp"
 
+#include <signal.h>
+
 #include <phosphor-logging/lg2.hpp>
 
 namespace data_sync::async
@@ -88,15 +90,40 @@ bool AsyncCommandExecutor::setupPipeRedirection(const FD& readFd,
 }
 
 std::pair<pid_t, int> AsyncCommandExecutor::spawnCommand(const std::string& cmd,
-                                                         const auto& actions)
+                                                         const auto& actions,
+                                                         bool ownProcessGroup)
 {
     const char* argv[] = {"/bin/sh", "-c", cmd.c_str(), nullptr};
     pid_t pid = -1;
+
+    posix_spawnattr_t attrs;
+    bool useAttrs = false;
+    if (ownProcessGroup)
+    {
+        useAttrs = posix_spawnattr_init(&attrs) == 0;
+        if (useAttrs &&
+            (posix_spawnattr_setflags(&attrs, POSIX_SPAWN_SETPGROUP) != 0 ||
+             posix_spawnattr_setpgroup(&attrs, 0) != 0))
+        {
+            posix_spawnattr_destroy(&attrs);
+            useAttrs = false;
+        }
+        if (!useAttrs)
+        {
+            // The shell is still terminated, only its children may be left.
+            lg2::error("Failed to set the process group of the command");
+        }
+    }
+
     int spawnResult = posix_spawn(
-        &pid, "/bin/sh", actions, nullptr,
+        &pid, "/bin/sh", actions, useAttrs ? &attrs : nullptr,
         // [cppcoreguidelines-pro-type-const-cast,-warnings-as-errors]
         // NOLINTNEXTLINE
         const_cast<char* const*>(argv), nullptr);
+    if (useAttrs)
+    {
+        posix_spawnattr_destroy(&attrs);
+    }
 
     if (spawnResult != 0)
     {
@@ -108,7 +135,8 @@ std::pair<pid_t, int> AsyncCommandExecutor::spawnCommand(const std::string& cmd,
 
 sdbusplus::async::task<std::pair<int, std::string>>
     // NOLINTNEXTLINE
-    AsyncCommandExecutor::execCmd(const std::string& cmd)
+    AsyncCommandExecutor::execCmd(const std::string& cmd,
+                                  std::stop_token stopToken)
 {
     int pipefd[2];
     // Create pipe for the IPC
@@ -128,7 +156,8 @@ sdbusplus::async::task<std::pair<int, std::string>>
         co_return {-1, ""};
     }
 
-    auto [pid, spawnResult] = spawnCommand(cmd, actions);
+    auto [pid, spawnResult] = spawnCommand(cmd, actions,
+                                           stopToken.stop_possible());
 
     // Manually close the write end of the pipe in parent because only the child
     // need to write.
@@ -138,9 +167,22 @@ sdbusplus::async::task<std::pair<int, std::string>>
     // read.
     writeFd.reset();
 
-    // Wait until the child writes into the fd.
-    // NOLINTNEXTLINE
-    auto output = co_await waitForCmdCompletion(readFd());
+    std::string output;
+    {
+        // The shell doesn't forward the signal to the command, hence the
+        // whole process group is terminated. The callback is dropped before
+        // the child is reaped, so the pid can't be reused meanwhile.
+        std::stop_callback stopCmd(stopToken, [pid]() noexcept {
+            if (pid > 0 && kill(-pid, SIGTERM) != 0)
+            {
+                kill(pid, SIGTERM);
+            }
+        });
+
+        // Wait until the child writes into the fd.
+        // NOLINTNEXTLINE
+        output = co_await waitForCmdCompletion(readFd());
+    }
 
     // Manually close the read fd of the parent immediately instead of keeping
     // it open until RAII scope cleanup.
@@ -9,6 +9,8 @@
 
 #include <sdbusplus/async.hpp>
 
+#include <stop_token>
+
 namespace data_sync::async
 {
 
@@ -83,13 +85,16 @@ class AsyncCommandExecutor
      *        'posix_spawn'.
      *
      * @param[in] - cmd - The bash command to execute
+     * @param[in] - stopToken - The token to stop the command, the command
+     *                          and its children are terminated once a stop
+     *                          is requested
      *
      * @return sdbusplus::async::task<std::pair<int, std::string>>
      *              - int : Exit code of the spawned process (-1 on failure)
      *              - std::string : Combined stdout and stderr output
      */
     sdbusplus::async::task<std::pair<int, std::string>>
-        execCmd(const std::string& cmd);
+        execCmd(const std::string& cmd, std::stop_token stopToken = {});
 
   private:
     /**
@@ -125,13 +130,17 @@ class AsyncCommandExecutor
      *
      * @param[in]  cmd     Command string to execute.
      * @param[in]  actions  reference to the posix_spawn file actions object
+     * @param[in]  ownProcessGroup  Whether to start the child in a process
+     *                              group of its own, to signal it along
+     *                              with its children
      *
      * @return std::pair<pid_t, int>
      *         - first  : PID of the spawned child process (-1 for failure).
      *         - second : Result of posix_spawn().
      */
     std::pair<pid_t, int> spawnCommand(const std::string& cmd,
-                                       const auto& actions);
+                                       const auto& actions,
+                                       bool ownProcessGroup);
 
     /**
      * @brief API to wait asynchronously until child completes the command
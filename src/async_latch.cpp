@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "async_latch.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+namespace data_sync::async
+{
+
+Latch::Latch(sdbusplus::async::context& ctx, size_t count) :
+    _ctx(ctx), _count(count), _eventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (_eventFd() < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Failed to create the latch eventfd");
+    }
+}
+
+void Latch::countDown() noexcept
+{
+    if (_count == 0 || --_count > 0)
+    {
+        return;
+    }
+    uint64_t value{1};
+    [[maybe_unused]] auto bytes = write(_eventFd(), &value, sizeof(value));
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> Latch::wait()
+{
+    if (_count == 0)
+    {
+        co_return;
+    }
+
+    sdbusplus::async::fdio fdioInstance(_ctx, _eventFd());
+    while (_count > 0)
+    {
+        // NOLINTNEXTLINE
+        co_await fdioInstance.next();
+        uint64_t value{};
+        [[maybe_unused]] auto bytes = read(_eventFd(), &value, sizeof(value));
+    }
+    co_return;
+}
+
+} // namespace data_sync::async
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "utility.hpp"
+
+#include <sdbusplus/async.hpp>
+
+namespace data_sync::async
+{
+
+/**
+ * @class Latch
+ *
+ * @brief A single use countdown, awaited asynchronously until a set number
+ *        of the spawned tasks complete.
+ *
+ * The waiter is woken up through an eventfd as soon as the count reaches
+ * zero, so the completion is not polled.
+ */
+class Latch
+{
+  public:
+    Latch(const Latch&) = delete;
+    Latch& operator=(const Latch&) = delete;
+    Latch(Latch&&) = delete;
+    Latch& operator=(Latch&&) = delete;
+    ~Latch() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] ctx - The async context object
+     * @param[in] count - The number of the countdowns to await
+     *
+     * @throw std::system_error - If the eventfd could not be created
+     */
+    Latch(sdbusplus::async::context& ctx, size_t count);
+
+    /**
+     * @brief Count down once, waking up the waiter on reaching zero.
+     */
+    void countDown() noexcept;
+
+    /**
+     * @brief Wait until the count reaches zero.
+     *
+     * The wait is cancelled along with the context.
+     */
+    sdbusplus::async::task<> wait();
+
+    /**
+     * @brief Get the number of the countdowns still awaited.
+     */
+    size_t getCount() const
+    {
+        return _count;
+    }
+
+  private:
+    /**
+     * @brief The async context object
+     */
+    sdbusplus::async::context& _ctx;
+
+    /**
+     * @brief The number of the countdowns still awaited.
+     */
+    size_t _count;
+
+    /**
+     * @brief The eventfd signalled once the count reaches zero.
+     */
+    data_sync::utility::FD _eventFd;
+};
+
+} // namespace data_sync::async
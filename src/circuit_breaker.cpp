@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "circuit_breaker.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace data_sync::sync
+{
+
+std::string_view toString(BreakerState state)
+{
+    switch (state)
+    {
+        case BreakerState::Closed:
+            return "closed";
+        case BreakerState::Open:
+            return "open";
+        case BreakerState::HalfOpen:
+            return "half_open";
+    }
+    return "unknown";
+}
+
+CircuitBreaker::CircuitBreaker(size_t failureThreshold,
+                               std::chrono::milliseconds minBackoff,
+                               std::chrono::milliseconds maxBackoff,
+                               uint64_t seed) :
+    _failureThreshold(std::max<size_t>(failureThreshold, 1)),
+    _minBackoff(std::max(minBackoff, std::chrono::milliseconds(1))),
+    _maxBackoff(std::max(maxBackoff, _minBackoff)), _backoff(_minBackoff),
+    _random(seed)
+{}
+
+bool CircuitBreaker::allowRequest(Clock::time_point now)
+{
+    switch (_state)
+    {
+        case BreakerState::Closed:
+            return true;
+        case BreakerState::Open:
+            if (now < _retryTime)
+            {
+                return false;
+            }
+            _state = BreakerState::HalfOpen;
+            return true;
+        case BreakerState::HalfOpen:
+            return false;
+    }
+    return false;
+}
+
+bool CircuitBreaker::recordSuccess()
+{
+    _consecutiveFailures = 0;
+    _backoff = _minBackoff;
+    return std::exchange(_state, BreakerState::Closed) != BreakerState::Closed;
+}
+
+bool CircuitBreaker::recordFailure(Clock::time_point now)
+{
+    ++_consecutiveFailures;
+    if (_state == BreakerState::Open ||
+        (_state == BreakerState::Closed &&
+         _consecutiveFailures < _failureThreshold))
+    {
+        return false;
+    }
+    open(now);
+    return true;
+}
+
+CircuitBreaker::Clock::time_point
+    CircuitBreaker::getRetryTime(Clock::time_point now) const
+{
+    switch (_state)
+    {
+        case BreakerState::Closed:
+            return now;
+        case BreakerState::Open:
+            return _retryTime;
+        case BreakerState::HalfOpen:
+            return now + _minBackoff;
+    }
+    return now;
+}
+
+void CircuitBreaker::open(Clock::time_point now)
+{
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter(
+        _backoff.count() / 2, _backoff.count());
+    _retryTime = now + std::chrono::milliseconds(jitter(_random));
+    _backoff = std::min(_backoff * 2, _maxBackoff);
+    _state = BreakerState::Open;
+    ++_trips;
+}
+
+} // namespace data_sync::sync
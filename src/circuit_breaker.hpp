@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string_view>
+
+namespace data_sync::sync
+{
+
+/**
+ * @brief The states of a CircuitBreaker.
+ */
+enum class BreakerState
+{
+    Closed,
+    Open,
+    HalfOpen
+};
+
+/**
+ * @brief Get the name of the breaker state, as exported in the metrics.
+ *
+ * @param[in] state - The breaker state
+ *
+ * @returns std::string_view - The name of the state
+ */
+std::string_view toString(BreakerState state);
+
+/** @class CircuitBreaker
+ *
+ *  @brief Tracks whether the sibling BMC is reachable, to stop the requests
+ *         certain to fail while it is not.
+ *
+ *  The breaker opens after a set number of the consecutive failures, and
+ *  lets a single probe through once its backoff elapses. The backoff doubles
+ *  on each failed probe up to a maximum, and is randomized between its half
+ *  and its whole so the BMCs recovering together do not probe in lockstep.
+ *  A successful request closes the breaker and resets the backoff.
+ */
+class CircuitBreaker
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] failureThreshold - The consecutive failures opening the
+     *                               breaker, at least one
+     * @param[in] minBackoff - The backoff after the first opening
+     * @param[in] maxBackoff - The maximum backoff
+     * @param[in] seed - The seed of the jitter
+     */
+    CircuitBreaker(size_t failureThreshold, std::chrono::milliseconds minBackoff,
+                   std::chrono::milliseconds maxBackoff,
+                   uint64_t seed = std::random_device{}());
+
+    /**
+     * @brief Check whether a request may be sent.
+     *
+     * Once the backoff of an open breaker elapses, the breaker gets half
+     * open and the caller is the one probe let through.
+     *
+     * @param[in] now - The current time
+     *
+     * @returns true if the request may be sent
+     */
+    bool allowRequest(Clock::time_point now);
+
+    /**
+     * @brief Account a request which reached the sibling.
+     *
+     * @returns true if it closed the breaker
+     */
+    bool recordSuccess();
+
+    /**
+     * @brief Account a request which could not reach the sibling.
+     *
+     * The failures of the requests sent before the breaker opened do not
+     * extend its backoff.
+     *
+     * @param[in] now - The current time
+     *
+     * @returns true if it opened the breaker
+     */
+    bool recordFailure(Clock::time_point now);
+
+    /**
+     * @brief Get the time the next request may be attempted at.
+     *
+     * While a probe is in flight, it is the minimum backoff from now.
+     *
+     * @param[in] now - The current time
+     */
+    Clock::time_point getRetryTime(Clock::time_point now) const;
+
+    /**
+     * @brief Get the state of the breaker.
+     */
+    BreakerState getState() const
+    {
+        return _state;
+    }
+
+    /**
+     * @brief Get the number of the consecutive failures.
+     */
+    size_t getConsecutiveFailures() const
+    {
+        return _consecutiveFailures;
+    }
+
+    /**
+     * @brief Get the number of the times the breaker opened.
+     */
+    uint64_t getTrips() const
+    {
+        return _trips;
+    }
+
+  private:
+    /**
+     * @brief Open the breaker for the next backoff.
+     */
+    void open(Clock::time_point now);
+
+    /**
+     * @brief The consecutive failures opening the breaker.
+     */
+    size_t _failureThreshold;
+
+    /**
+     * @brief The backoff after the first opening.
+     */
+    std::chrono::milliseconds _minBackoff;
+
+    /**
+     * @brief The maximum backoff.
+     */
+    std::chrono::milliseconds _maxBackoff;
+
+    /**
+     * @brief The backoff of the next opening, before the jitter.
+     */
+    std::chrono::milliseconds _backoff;
+
+    /**
+     * @brief The state of the breaker.
+     */
+    BreakerState _state = BreakerState::Closed;
+
+    /**
+     * @brief The time an open breaker lets a probe through.
+     */
+    Clock::time_point _retryTime;
+
+    /**
+     * @brief The number of the consecutive failures.
+     */
+    size_t _consecutiveFailures = 0;
+
+    /**
+     * @brief The number of the times the breaker opened.
+     */
+    uint64_t _trips = 0;
+
+    /**
+     * @brief The source of the jitter.
+     */
+    std::mt19937_64 _random;
+};
+
+} // namespace data_sync::sync
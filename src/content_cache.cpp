@@ -0,0 +1,200 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "content_cache.hpp"
+
+#include <sys/stat.h>
+
+#include <bit>
+#include <cstring>
+#include <utility>
+
+namespace data_sync::sync
+{
+
+namespace
+{
+
+constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+template <typename T>
+T readLE(const char* data)
+{
+    T value{};
+    std::memcpy(&value, data, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+uint64_t round(uint64_t acc, uint64_t input)
+{
+    acc += input * prime2;
+    acc = std::rotl(acc, 31);
+    return acc * prime1;
+}
+
+uint64_t mergeRound(uint64_t acc, uint64_t value)
+{
+    acc ^= round(0, value);
+    return acc * prime1 + prime4;
+}
+
+/**
+ * @brief Get the directory form of a path, with a trailing '/', to
+ *        find the paths under it.
+ */
+std::string asDirectory(const fs::path& path)
+{
+    std::string dir{path.native()};
+    if (!dir.ends_with('/'))
+    {
+        dir.push_back('/');
+    }
+    return dir;
+}
+
+/**
+ * @brief Get the status change time of a path, zero if it is missing.
+ */
+int64_t getChangeTimeNs(const fs::path& path)
+{
+    struct stat status{};
+    if (lstat(path.c_str(), &status) != 0)
+    {
+        return 0;
+    }
+    return (static_cast<int64_t>(status.st_ctim.tv_sec) * 1'000'000'000) +
+           status.st_ctim.tv_nsec;
+}
+
+} // namespace
+
+uint64_t hashContent(std::string_view data, uint64_t seed)
+{
+    const char* pos = data.data();
+    const char* const end = pos + data.size();
+    uint64_t hash{};
+
+    if (data.size() >= 32)
+    {
+        // Four independent lanes, so the rounds of a stripe overlap.
+        uint64_t lane1 = seed + prime1 + prime2;
+        uint64_t lane2 = seed + prime2;
+        uint64_t lane3 = seed;
+        uint64_t lane4 = seed - prime1;
+        for (; end - pos >= 32; pos += 32)
+        {
+            lane1 = round(lane1, readLE<uint64_t>(pos));
+            lane2 = round(lane2, readLE<uint64_t>(pos + 8));
+            lane3 = round(lane3, readLE<uint64_t>(pos + 16));
+            lane4 = round(lane4, readLE<uint64_t>(pos + 24));
+        }
+        hash = std::rotl(lane1, 1) + std::rotl(lane2, 7) +
+               std::rotl(lane3, 12) + std::rotl(lane4, 18);
+        hash = mergeRound(hash, lane1);
+        hash = mergeRound(hash, lane2);
+        hash = mergeRound(hash, lane3);
+        hash = mergeRound(hash, lane4);
+    }
+    else
+    {
+        hash = seed + prime5;
+    }
+
+    hash += data.size();
+    for (; end - pos >= 8; pos += 8)
+    {
+        hash ^= round(0, readLE<uint64_t>(pos));
+        hash = std::rotl(hash, 27) * prime1 + prime4;
+    }
+    if (end - pos >= 4)
+    {
+        hash ^= readLE<uint32_t>(pos) * prime1;
+        hash = std::rotl(hash, 23) * prime2 + prime3;
+        pos += 4;
+    }
+    for (; pos < end; ++pos)
+    {
+        hash ^= static_cast<uint8_t>(*pos) * prime5;
+        hash = std::rotl(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+CacheCheck ContentCache::check(const fs::path& path)
+{
+    CacheCheck result;
+    // Taken before the read, so any change from then on gets noticed.
+    const auto changeTimeNs = getChangeTimeNs(path);
+    auto record = transfer::readFileRecord(path, path, _maxFileSize);
+    if (record && record->op == transfer::TransferOp::Put)
+    {
+        result.fingerprint =
+            ContentFingerprint{record->data.size(), record->mode, record->uid,
+                               record->gid, hashContent(record->data),
+                               changeTimeNs};
+        result.record = std::move(record);
+    }
+
+    if (result.fingerprint)
+    {
+        auto cached = _fingerprints.find(path.native());
+        if (cached != _fingerprints.end() &&
+            cached->second == *result.fingerprint)
+        {
+            ++_hits;
+            result.unchanged = true;
+            return result;
+        }
+        ++_misses;
+    }
+
+    // Stale until the path gets synced again.
+    erase(path);
+    return result;
+}
+
+void ContentCache::record(const fs::path& path,
+                          const ContentFingerprint& fingerprint)
+{
+    if (fingerprint.changeTimeNs == 0 ||
+        getChangeTimeNs(path) != fingerprint.changeTimeNs)
+    {
+        erase(path);
+        return;
+    }
+    _fingerprints.insert_or_assign(path.native(), fingerprint);
+}
+
+void ContentCache::erase(const fs::path& path)
+{
+    std::string file{path.native()};
+    while (file.size() > 1 && file.ends_with('/'))
+    {
+        file.pop_back();
+    }
+    _fingerprints.erase(file);
+
+    const std::string dir = asDirectory(path);
+    auto first = _fingerprints.lower_bound(dir);
+    auto last = first;
+    while (last != _fingerprints.end() && last->first.starts_with(dir))
+    {
+        ++last;
+    }
+    _fingerprints.erase(first, last);
+}
+
+} // namespace data_sync::sync
@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "native_transfer.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace data_sync::sync
+{
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Hash the contents of a file, using the XXH64 algorithm.
+ *
+ * @param[in] data - The data to hash
+ * @param[in] seed - The seed of the hash
+ *
+ * @returns uint64_t - The hash
+ */
+uint64_t hashContent(std::string_view data, uint64_t seed = 0);
+
+/**
+ * @brief The contents and the metadata of a file as last synced.
+ *
+ * The modification and the status change times are not compared, as they
+ * change on each rewrite even with the same contents.
+ */
+struct ContentFingerprint
+{
+    uint64_t size = 0;
+    uint32_t mode = 0;
+    uint32_t uid = 0;
+    uint32_t gid = 0;
+    uint64_t hash = 0;
+
+    /**
+     * @brief The status change time of the file before it got read, to find
+     *        out whether it changed until recorded.
+     */
+    int64_t changeTimeNs = 0;
+
+    bool operator==(const ContentFingerprint& other) const
+    {
+        return size == other.size && mode == other.mode && uid == other.uid &&
+               gid == other.gid && hash == other.hash;
+    }
+};
+
+/**
+ * @brief The result of looking up a path in the ContentCache.
+ */
+struct CacheCheck
+{
+    /**
+     * @brief Whether the path is unchanged since its last sync.
+     */
+    bool unchanged = false;
+
+    /**
+     * @brief The current fingerprint to record once the path is synced,
+     *        std::nullopt if the path is not cacheable.
+     */
+    std::optional<ContentFingerprint> fingerprint;
+
+    /**
+     * @brief The file read to fingerprint it, to be transferred without
+     *        reading it again.
+     */
+    std::optional<transfer::FileRecord> record;
+};
+
+/** @class ContentCache
+ *
+ *  @brief Keeps the fingerprint of the files as last synced, to skip the
+ *         syncs of the files rewritten with the same contents.
+ *
+ *  Only the regular files up to the maximum size are cacheable. A path
+ *  leaves the cache once it changes, and along with the paths under it
+ *  once it is synced as a directory, until its next successful sync.
+ */
+class ContentCache
+{
+  public:
+    /**
+     * @brief The default maximum size of a cacheable file.
+     *
+     * The files are read and hashed on the event loop, so only the small
+     * ones are worth it.
+     */
+    static constexpr size_t defaultMaxFileSize = 64 * 1024;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] maxFileSize - The maximum size of a cacheable file
+     */
+    explicit ContentCache(size_t maxFileSize = defaultMaxFileSize) :
+        _maxFileSize(maxFileSize)
+    {}
+
+    /**
+     * @brief Check whether a path is unchanged since its last sync.
+     *
+     * The cached fingerprint of a changed path, and of the paths under it,
+     * are dropped until the path is recorded again.
+     *
+     * @param[in] path - The path to be synced
+     *
+     * @returns CacheCheck - The result of the check
+     */
+    CacheCheck check(const fs::path& path);
+
+    /**
+     * @brief Record the fingerprint of a successfully synced path.
+     *
+     * The path is dropped instead if its status changed since it got
+     * fingerprinted, as the synced contents may then differ from the hashed
+     * ones.
+     *
+     * @param[in] path - The synced path
+     * @param[in] fingerprint - The fingerprint returned by check() before
+     *                          the sync
+     */
+    void record(const fs::path& path, const ContentFingerprint& fingerprint);
+
+    /**
+     * @brief Drop the cached fingerprint of a path and of the paths under it.
+     *
+     * @param[in] path - The path to drop
+     */
+    void erase(const fs::path& path);
+
+    /**
+     * @brief Drop all the cached fingerprints.
+     */
+    void clear()
+    {
+        _fingerprints.clear();
+    }
+
+    /**
+     * @brief Get the number of the syncs skipped as unchanged.
+     */
+    uint64_t getHits() const
+    {
+        return _hits;
+    }
+
+    /**
+     * @brief Get the number of the cacheable files found changed.
+     */
+    uint64_t getMisses() const
+    {
+        return _misses;
+    }
+
+    /**
+     * @brief Get the number of the cached fingerprints.
+     */
+    size_t size() const
+    {
+        return _fingerprints.size();
+    }
+
+  private:
+    /**
+     * @brief The maximum size of a cacheable file.
+     */
+    size_t _maxFileSize;
+
+    /**
+     * @brief The fingerprints of the synced files, by path.
+     *
+     * Keyed by the path string, so the paths under a directory are
+     * contiguous.
+     */
+    std::map<std::string, ContentFingerprint, std::less<>> _fingerprints;
+
+    /**
+     * @brief The number of the syncs skipped as unchanged.
+     */
+    uint64_t _hits = 0;
+
+    /**
+     * @brief The number of the cacheable files found changed.
+     */
+    uint64_t _misses = 0;
+};
+
+} // namespace data_sync::sync
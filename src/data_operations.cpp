@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "data_operations.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <unordered_map>
+
+namespace data_sync::watch
+{
+
+DataOperations coalesce(const DataOperations& dataOperations)
+{
+    if (dataOperations.size() < 2)
+    {
+        return dataOperations;
+    }
+
+    // The distinct paths in the order of their first operation, each with its
+    // latest operation. Each operation either adds a path or merges into one,
+    // adding at most the displaced source of a move, so the reserved storage
+    // keeps the paths referred by the lookup in place.
+    DataOperations distinctOps;
+    std::unordered_map<std::string_view, size_t> opIndexes;
+    distinctOps.reserve(dataOperations.size());
+    opIndexes.reserve(dataOperations.size());
+
+    auto addOperation = [&distinctOps,
+                         &opIndexes](const DataOperation& dataOp) {
+        auto opIt = opIndexes.find(dataOp.path.native());
+        if (opIt == opIndexes.end())
+        {
+            opIndexes.emplace(dataOp.path.native(), distinctOps.size());
+            distinctOps.emplace_back(dataOp);
+            return std::optional<DataOperation>{};
+        }
+
+        // A move stays a move, its source is synced along with the current
+        // state of the destination.
+        auto& distinctOp = distinctOps[opIt->second];
+        if (dataOp.op != DataOps::MOVE)
+        {
+            if (distinctOp.op != DataOps::MOVE)
+            {
+                distinctOp.op = dataOp.op;
+            }
+            return std::optional<DataOperation>{};
+        }
+
+        // Two moves to the same destination, the source of the earlier one
+        // is gone too.
+        std::optional<DataOperation> displacedOp;
+        if (distinctOp.op == DataOps::MOVE &&
+            distinctOp.movedFrom != dataOp.movedFrom)
+        {
+            displacedOp = DataOperation{distinctOp.movedFrom, DataOps::DELETE};
+        }
+        distinctOp.op = DataOps::MOVE;
+        distinctOp.movedFrom = dataOp.movedFrom;
+        return displacedOp;
+    };
+
+    for (const auto& dataOp : dataOperations)
+    {
+        if (auto displacedOp = addOperation(dataOp); displacedOp.has_value())
+        {
+            addOperation(displacedOp.value());
+        }
+    }
+
+    // The paths sharing a prefix are adjacent once sorted, and a directory
+    // precedes its children. So a single pass is enough to find the
+    // operations absorbed by a directory.
+    std::vector<size_t> sortedIndexes(distinctOps.size());
+    std::iota(sortedIndexes.begin(), sortedIndexes.end(), 0);
+    std::ranges::sort(sortedIndexes, {}, [&distinctOps](size_t index) {
+        return std::string_view(distinctOps[index].path.native());
+    });
+
+    std::vector<bool> absorbed(distinctOps.size(), false);
+    std::string_view rootDir;
+    for (auto index : sortedIndexes)
+    {
+        const auto& distinctOp = distinctOps[index];
+        std::string_view path = distinctOp.path.native();
+        if (!rootDir.empty() && path.starts_with(rootDir) &&
+            (distinctOp.op != DataOps::MOVE ||
+             distinctOp.movedFrom.native().starts_with(rootDir)))
+        {
+            absorbed[index] = true;
+        }
+        else if (path.ends_with('/'))
+        {
+            rootDir = path;
+        }
+    }
+
+    DataOperations coalescedOps;
+    coalescedOps.reserve(distinctOps.size());
+    for (auto index : std::views::iota(0UZ, distinctOps.size()))
+    {
+        if (!absorbed[index])
+        {
+            coalescedOps.emplace_back(std::move(distinctOps[index]));
+        }
+    }
+    return coalescedOps;
+}
+
+} // namespace data_sync::watch
@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "watcher.hpp"
+
+namespace data_sync::watch
+{
+
+/**
+ * @brief Coalesce the data operations of a batch of events, so each distinct
+ *        root is synced only once.
+ *
+ * - The operations of the same path are merged and the latest operation
+ *   wins, as the path is synced as per its current state anyway.
+ * - An operation on a directory (i.e. path with a trailing slash) absorbs
+ *   the operations on its children, as the directory is synced recursively.
+ *   So a subtree of deletes collapses into the delete of its root.
+ * - A move absorbs the other operations of its destination, and is absorbed
+ *   by a directory only if its source is in the directory too.
+ *
+ * The remaining operations are kept in the order they were first reported.
+ *
+ * @param[in] dataOperations - The data operations of a batch of events
+ *
+ * @returns DataOperations - The coalesced data operations
+ */
+DataOperations coalesce(const DataOperations& dataOperations);
+
+} // namespace data_sync::watch
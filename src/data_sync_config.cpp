@@ -6,6 +6,7 @@
 
 #include <phosphor-logging/lg2.hpp>
 
+#include <algorithm>
 #include <regex>
 
 namespace data_sync::config
@@ -82,10 +83,26 @@ DataSyncConfig::DataSyncConfig(const nlohmann::json& config,
             convertISODurationToSec(
                 config["DeferredSyncInterval"].get<std::string>())
                 .value_or(std::chrono::seconds(defDeferredSyncInterval));
+
+        // Bounded by default, so a path written continuously still syncs.
+        constexpr auto defMaxDeferredLatencyFactor = 10;
+        _maxDeferredLatencyInSec =
+            config.contains("MaxDeferredLatency")
+                ? convertISODurationToSec(
+                      config["MaxDeferredLatency"].get<std::string>())
+                      .value_or(*_deferredSyncIntervalInSec *
+                                defMaxDeferredLatencyFactor)
+                : *_deferredSyncIntervalInSec * defMaxDeferredLatencyFactor;
+        _maxDeferredLatencyInSec = std::max(*_maxDeferredLatencyInSec,
+                                            *_deferredSyncIntervalInSec);
+
+        _adaptiveDeferredInterval =
+            config.value("AdaptiveDeferredInterval", false);
     }
     else
     {
         _deferredSyncIntervalInSec = std::nullopt;
+        _maxDeferredLatencyInSec = std::nullopt;
     }
 
     if (config.contains("NotifySibling"))
@@ -127,6 +144,31 @@ DataSyncConfig::DataSyncConfig(const nlohmann::json& config,
     {
         _includeList = std::nullopt;
     }
+
+    if (config.contains("WatchPriority"))
+    {
+        _watchPriority = convertWatchPriorityToEnum(
+                             config["WatchPriority"].get<std::string>())
+                             .value_or(WatchPriority::Normal);
+    }
+
+    if (config.contains("WatchBackend"))
+    {
+        _watchBackend = convertWatchBackendToEnum(
+                            config["WatchBackend"].get<std::string>())
+                            .value_or(WatchBackend::Notify);
+    }
+
+    if (_watchBackend == WatchBackend::Poll)
+    {
+        constexpr auto defPollInterval = 15;
+        _pollIntervalInSec =
+            config.contains("PollInterval")
+                ? convertISODurationToSec(
+                      config["PollInterval"].get<std::string>())
+                      .value_or(std::chrono::seconds(defPollInterval))
+                : std::chrono::seconds(defPollInterval);
+    }
 }
 
 bool DataSyncConfig::operator==(const DataSyncConfig& dataSyncCfg) const
@@ -138,9 +180,77 @@ bool DataSyncConfig::operator==(const DataSyncConfig& dataSyncCfg) const
            _periodicityInSec == dataSyncCfg._periodicityInSec &&
            _deferredSyncIntervalInSec ==
                dataSyncCfg._deferredSyncIntervalInSec &&
+           _maxDeferredLatencyInSec == dataSyncCfg._maxDeferredLatencyInSec &&
+           _adaptiveDeferredInterval == dataSyncCfg._adaptiveDeferredInterval &&
            _retry == dataSyncCfg._retry &&
            _excludeList == dataSyncCfg._excludeList &&
-           _includeList == dataSyncCfg._includeList;
+           _includeList == dataSyncCfg._includeList &&
+           _watchPriority == dataSyncCfg._watchPriority &&
+           _watchBackend == dataSyncCfg._watchBackend &&
+           _pollIntervalInSec == dataSyncCfg._pollIntervalInSec;
+}
+
+void DataSyncConfig::recordDeferredSyncEvent(
+    std::chrono::steady_clock::time_point eventTime) const
+{
+    // Only the gaps within a burst are smoothed, a longer gap starts a new
+    // burst.
+    const auto gap = eventTime - _lastDeferredSyncEventTime;
+    if (_firstDeferredSyncEventTime.has_value() &&
+        gap < _deferredSyncIntervalInSec.value_or(std::chrono::seconds(0)))
+    {
+        _deferredEventGap = _deferredEventGap.count() == 0
+                                ? gap
+                                : (_deferredEventGap * 7 + gap) / 8;
+    }
+
+    _lastDeferredSyncEventTime = eventTime;
+    if (!_firstDeferredSyncEventTime.has_value())
+    {
+        _firstDeferredSyncEventTime = eventTime;
+    }
+}
+
+std::chrono::steady_clock::duration
+    DataSyncConfig::getDeferredQuietInterval() const
+{
+    const std::chrono::steady_clock::duration deferredSyncInterval =
+        _deferredSyncIntervalInSec.value_or(std::chrono::seconds(0));
+    if (!_adaptiveDeferredInterval || _deferredEventGap.count() == 0)
+    {
+        return deferredSyncInterval;
+    }
+
+    // A few gaps of the burst, so a slightly slower event still gets
+    // batched.
+    constexpr auto gapsPerQuietInterval = 3;
+    constexpr std::chrono::steady_clock::duration minQuietInterval =
+        std::chrono::milliseconds(100);
+    return std::clamp(_deferredEventGap * gapsPerQuietInterval,
+                      std::min(minQuietInterval, deferredSyncInterval),
+                      deferredSyncInterval);
+}
+
+std::chrono::steady_clock::time_point
+    DataSyncConfig::getDeferredSyncDeadline() const
+{
+    auto deadline = _lastDeferredSyncEventTime + getDeferredQuietInterval();
+    if (auto latencyDeadline = getDeferredLatencyDeadline())
+    {
+        deadline = std::min(deadline, *latencyDeadline);
+    }
+    return deadline;
+}
+
+std::optional<std::chrono::steady_clock::time_point>
+    DataSyncConfig::getDeferredLatencyDeadline() const
+{
+    if (!_maxDeferredLatencyInSec.has_value() ||
+        !_firstDeferredSyncEventTime.has_value())
+    {
+        return std::nullopt;
+    }
+    return *_firstDeferredSyncEventTime + *_maxDeferredLatencyInSec;
 }
 
 void DataSyncConfig::frameRsyncExcludeList(
@@ -204,6 +314,48 @@ std::optional<SyncType>
     }
 }
 
+std::optional<WatchPriority>
+    DataSyncConfig::convertWatchPriorityToEnum(const std::string& watchPriority)
+{
+    if (watchPriority == "Low")
+    {
+        return WatchPriority::Low;
+    }
+    else if (watchPriority == "Normal")
+    {
+        return WatchPriority::Normal;
+    }
+    else if (watchPriority == "High")
+    {
+        return WatchPriority::High;
+    }
+    else
+    {
+        lg2::error("Unsupported watch priority [{WATCH_PRIORITY}]",
+                   "WATCH_PRIORITY", watchPriority);
+        return std::nullopt;
+    }
+}
+
+std::optional<WatchBackend>
+    DataSyncConfig::convertWatchBackendToEnum(const std::string& watchBackend)
+{
+    if (watchBackend == "Notify")
+    {
+        return WatchBackend::Notify;
+    }
+    else if (watchBackend == "Poll")
+    {
+        return WatchBackend::Poll;
+    }
+    else
+    {
+        lg2::error("Unsupported watch backend [{WATCH_BACKEND}]",
+                   "WATCH_BACKEND", watchBackend);
+        return std::nullopt;
+    }
+}
+
 std::optional<std::chrono::seconds> DataSyncConfig::convertISODurationToSec(
     const std::string& timeIntervalInISO)
 {
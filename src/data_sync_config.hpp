@@ -36,6 +36,37 @@ enum class SyncType
     Periodic
 };
 
+/**
+ * @brief The enum contains the backends to find the data changes.
+ */
+enum class WatchBackend
+{
+    /**
+     * @brief The filesystem notifications (inotify or fanotify)
+     */
+    Notify,
+
+    /**
+     * @brief The periodic scan of the path, for the filesystems on which the
+     *        notifications are missing or unreliable
+     */
+    Poll
+};
+
+/**
+ * @brief The enum contains the priorities to keep the paths monitored
+ *        through inotify once the watches run short.
+ *
+ * The subtrees of the lower priority paths are moved to the periodic scan
+ * first.
+ */
+enum class WatchPriority
+{
+    Low,
+    Normal,
+    High
+};
+
 /**
  * @brief The structure contains all retry-related details
  *        specific to a file or directory to retry if failed to sync.
@@ -139,6 +170,45 @@ struct DataSyncConfig
      */
     bool operator==(const DataSyncConfig& dataSyncCfg) const;
 
+    /**
+     * @brief Record an event of a deferred sync, to track when the sync is
+     *        due.
+     *
+     * @param[in] eventTime - The time of the event
+     */
+    void recordDeferredSyncEvent(
+        std::chrono::steady_clock::time_point eventTime) const;
+
+    /**
+     * @brief Get the quiet interval to wait after the last event before a
+     *        deferred sync.
+     *
+     * The interval adapts to the gaps between the events of a burst if
+     * configured, bounded by the DeferredSyncInterval.
+     *
+     * @return The quiet interval
+     */
+    std::chrono::steady_clock::duration getDeferredQuietInterval() const;
+
+    /**
+     * @brief Get the time at which the deferred sync is due, once the events
+     *        quiet down or the first pending event reaches the maximum
+     *        latency, whichever is earlier.
+     *
+     * @return The time at which the deferred sync is due
+     */
+    std::chrono::steady_clock::time_point getDeferredSyncDeadline() const;
+
+    /**
+     * @brief Get the time at which the first pending event reaches the
+     *        maximum latency of the deferred sync.
+     *
+     * @return The time, std::nullopt if no event is pending or no maximum
+     *         latency is configured
+     */
+    std::optional<std::chrono::steady_clock::time_point>
+        getDeferredLatencyDeadline() const;
+
     /**
      * @brief Get sync direction in string format.
      *
@@ -216,6 +286,20 @@ struct DataSyncConfig
      */
     std::optional<std::chrono::seconds> _deferredSyncIntervalInSec;
 
+    /**
+     * @brief The maximum delay of a deferred sync since the first event not
+     *        synced yet, even if the events do not quiet down.
+     *
+     * @note Holds a value if the synchronization type is set to Deferred.
+     */
+    std::optional<std::chrono::seconds> _maxDeferredLatencyInSec;
+
+    /**
+     * @brief Whether the quiet interval of a deferred sync adapts to the
+     *        gaps between the events.
+     */
+    bool _adaptiveDeferredInterval{false};
+
     /**
      * @brief The details of sibling notification
      *
@@ -254,6 +338,24 @@ struct DataSyncConfig
      */
     std::optional<std::unordered_set<fs::path>> _includeList;
 
+    /**
+     * @brief The priority to keep the path monitored through inotify if the
+     *        watches run short.
+     */
+    WatchPriority _watchPriority{WatchPriority::Normal};
+
+    /**
+     * @brief The backend to find the changes of the path.
+     */
+    WatchBackend _watchBackend{WatchBackend::Notify};
+
+    /**
+     * @brief The interval (in seconds) to scan the path for the changes.
+     *
+     * @note Holds a value if the watch backend is set to Poll.
+     */
+    std::optional<std::chrono::seconds> _pollIntervalInSec;
+
     /**
      * @brief Tracks file or directory paths currently being processed for
      *        sync.
@@ -273,6 +375,18 @@ struct DataSyncConfig
      */
     mutable std::chrono::steady_clock::time_point _lastDeferredSyncEventTime;
 
+    /**
+     * @brief Timestamp of the first event not yet covered by a deferred sync.
+     */
+    mutable std::optional<std::chrono::steady_clock::time_point>
+        _firstDeferredSyncEventTime;
+
+    /**
+     * @brief The smoothed gap between the events of a burst, zero until
+     *        observed.
+     */
+    mutable std::chrono::steady_clock::duration _deferredEventGap{};
+
   private:
     /**
      * @brief A helper API to retrieve the corresponding enum type
@@ -296,6 +410,28 @@ struct DataSyncConfig
     static std::optional<SyncType>
         convertSyncTypeToEnum(const std::string& syncType);
 
+    /**
+     * @brief A helper API to retrieve the corresponding enum type
+     *        for a given watch priority string.
+     *
+     * @param[in] - watchPriority - the watch priority
+     *
+     * @returns The enum value on success; otherwise, nullopt.
+     */
+    static std::optional<WatchPriority>
+        convertWatchPriorityToEnum(const std::string& watchPriority);
+
+    /**
+     * @brief A helper API to retrieve the corresponding enum type
+     *        for a given watch backend string.
+     *
+     * @param[in] - watchBackend - the watch backend
+     *
+     * @returns The enum value on success; otherwise, nullopt.
+     */
+    static std::optional<WatchBackend>
+        convertWatchBackendToEnum(const std::string& watchBackend);
+
     /**
      * @brief A helper API to convert the time duration in ISO 8601 duration
      *        format into seconds
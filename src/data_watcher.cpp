@@ -4,9 +4,12 @@
 
 #include <phosphor-logging/lg2.hpp>
 
+#include <algorithm>
 #include <cstring>
 #include <ranges>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 
 namespace data_sync::watch::inotify
@@ -17,43 +20,52 @@ DataWatcher::DataWatcher(
     const uint32_t eventMasksToWatch, fs::path dataPathToWatch,
     std::optional<std::unordered_set<fs::path>> excludeList,
     std::optional<std::unordered_set<fs::path>> includeList) :
-    _inotifyFlags(inotifyFlags), _eventMasksToWatch(eventMasksToWatch),
+    _ownInotifyMux(std::make_unique<InotifyMux>(ctx, inotifyFlags)),
+    _inotifyMux(*_ownInotifyMux), _eventMasksToWatch(eventMasksToWatch),
     _dataPathToWatch(std::move(dataPathToWatch)),
     _excludeList(std::move(excludeList)), _includeList(std::move(includeList)),
-    _inotifyFileDescriptor(inotifyInit()),
-    _fdioInstance(
-        std::make_unique<sdbusplus::async::fdio>(ctx, _inotifyFileDescriptor()))
+    _pathTrie(_excludeList, _includeList),
+    _pollScanner([this](std::string_view path) {
+        return filterPolledPath(path);
+    })
 {
+    _inotifyMux.attach(*this);
     createWatchers(_dataPathToWatch);
 }
 
-DataWatcher::~DataWatcher()
+DataWatcher::DataWatcher(
+    InotifyMux& inotifyMux, DataChangeCallback callback,
+    const uint32_t eventMasksToWatch, fs::path dataPathToWatch,
+    std::optional<std::unordered_set<fs::path>> excludeList,
+    std::optional<std::unordered_set<fs::path>> includeList,
+    config::WatchPriority watchPriority) :
+    _inotifyMux(inotifyMux), _dataChangeCallback(std::move(callback)),
+    _eventMasksToWatch(eventMasksToWatch),
+    _dataPathToWatch(std::move(dataPathToWatch)),
+    _excludeList(std::move(excludeList)), _includeList(std::move(includeList)),
+    _pathTrie(_excludeList, _includeList), _watchPriority(watchPriority),
+    _pollScanner([this](std::string_view path) {
+        return filterPolledPath(path);
+    })
 {
-    if (_inotifyFileDescriptor() >= 0)
+    _inotifyMux.attach(*this);
+    try
     {
-        std::ranges::for_each(_watchDescriptors, [this](const auto& wd) {
-            if (wd.first >= 0)
-            {
-                inotify_rm_watch(_inotifyFileDescriptor(), wd.first);
-            }
-        });
+        createWatchers(_dataPathToWatch);
     }
+    catch (...)
+    {
+        // The destructor won't run, so don't leave a dangling watcher in the
+        // shared inotify instance.
+        _inotifyMux.detach(*this);
+        throw;
+    }
+    _inotifyMux.startDispatcher();
 }
 
-int DataWatcher::inotifyInit() const
+DataWatcher::~DataWatcher()
 {
-    auto fd = inotify_init1(_inotifyFlags);
-
-    if (-1 == fd)
-    {
-        lg2::error("inotify_init1 call failed with ErrNo : {ERRNO}, ErrMsg : "
-                   "{ERRMSG}",
-                   "ERRNO", errno, "ERRMSG", strerror(errno));
-
-        // TODO: Throw meaningful exception
-        throw std::runtime_error("inotify_init1 failed");
-    }
-    return fd;
+    _inotifyMux.detach(*this);
 }
 
 void DataWatcher::stop()
@@ -61,148 +73,221 @@ void DataWatcher::stop()
     lg2::debug("Stopping DataWatcher for [{PATH}], removing [{COUNT}] watches",
                "PATH", _dataPathToWatch, "COUNT", _watchDescriptors.size());
 
-    auto wds = _watchDescriptors | std::views::keys |
-               std::ranges::to<std::vector>();
-
-    std::ranges::for_each(wds, [this](int wd) { removeWatch(wd); });
+    std::ranges::for_each(_watchDescriptors.getWDs(),
+                          [this](int wd) { removeWatch(wd); });
 }
 
-std::string DataWatcher::eventName(uint32_t eventMask)
+fs::path DataWatcher::getExistingParentPath(const fs::path& dataPath)
 {
-    std::vector<std::string> events{};
-
-    if ((eventMask & IN_ACCESS) != 0)
-    {
-        events.emplace_back("IN_ACCESS");
-    }
-    if ((eventMask & IN_ATTRIB) != 0)
-    {
-        events.emplace_back("IN_ATTRIB");
-    }
-    if ((eventMask & IN_CLOSE_WRITE) != 0)
-    {
-        events.emplace_back("IN_CLOSE_WRITE");
-    }
-    if ((eventMask & IN_CLOSE_NOWRITE) != 0)
-    {
-        events.emplace_back("IN_CLOSE_NOWRITE");
-    }
-    if ((eventMask & IN_CREATE) != 0)
+    fs::path parentPath = dataPath.parent_path();
+    while ((!parentPath.empty()) && (!fs::exists(parentPath)))
     {
-        events.emplace_back("IN_CREATE");
+        parentPath = parentPath.parent_path();
     }
-    if ((eventMask & IN_DELETE) != 0)
+    return parentPath;
+}
+
+void DataWatcher::addToWatchList(const fs::path& pathToWatch,
+                                 uint32_t eventMasksToWatch,
+                                 std::optional<bool> isDir)
+{
+    // The subtrees moved to the periodic scan stay there.
+    if (_pollScanner.covers(pathToWatch.native()))
     {
-        events.emplace_back("IN_DELETE");
+        return;
     }
-    if ((eventMask & IN_DELETE_SELF) != 0)
+
+    auto wd = _inotifyMux.addWatch(*this, pathToWatch, eventMasksToWatch);
+    // Saved before the logging and the scan can overwrite it.
+    const int addErrno = errno;
+    if (-1 == wd && addErrno == ENOSPC && _dataChangeCallback)
     {
-        events.emplace_back("IN_DELETE_SELF");
+        // Scan the subtree periodically instead of losing its changes.
+        // Only the parents of a missing configured path are outside of it.
+        lg2::warning("No inotify watch left for {PATH}, scanning it "
+                     "periodically instead",
+                     "PATH", pathToWatch);
+        pollSubtree(isPathInTree(pathToWatch.native(), _dataPathToWatch.native())
+                        ? pathToWatch
+                        : _dataPathToWatch);
+        return;
     }
-    if ((eventMask & IN_MODIFY) != 0)
+    if (-1 == wd)
     {
-        events.emplace_back("IN_MODIFY");
+        lg2::error(
+            "inotify_add_watch call failed for {PATH} with ErrNo : {ERRNO}, "
+            "ErrMsg : {ERRMSG}",
+            "PATH", pathToWatch, "ERRNO", addErrno, "ERRMSG",
+            strerror(addErrno));
+        // TODO: create error log ? bcoz not watching the  path
+        throw std::runtime_error("Failed to add to watch list");
     }
-    if ((eventMask & IN_MOVE_SELF) != 0)
+    else
     {
-        events.emplace_back("IN_MOVE_SELF");
+        // Add trailing slash for directories to ensure rsync syncs directory
+        // contents rather than the directory itself
+        if (!isDir.has_value())
+        {
+            isDir = fs::is_directory(pathToWatch);
+        }
+        _watchDescriptors.emplace(wd, pathToWatch, isDir.value());
+        lg2::debug("Watch added. PATH : {PATH}, wd : {WD}", "PATH",
+                   _watchDescriptors.at(wd), "WD", wd);
     }
-    if ((eventMask & IN_MOVED_FROM) != 0)
+}
+
+void DataWatcher::pollSubtree(const fs::path& pathToPoll)
+{
+    removeSubtreeWatches(pathToPoll);
+    _pollScanner.addRoot(pathToPoll);
+    _inotifyMux.startPoller();
+}
+
+ScanFilter DataWatcher::filterPolledPath(std::string_view path) const
+{
+    // No current use case for data-sync to support hidden files
+    if (path.substr(path.rfind('/') + 1).starts_with('.'))
     {
-        events.emplace_back("IN_MOVED_FROM");
+        return ScanFilter::Skip;
     }
-    if ((eventMask & IN_MOVED_TO) != 0)
+    auto match = _pathTrie.match(path);
+    if (match.excluded)
     {
-        events.emplace_back("IN_MOVED_TO");
+        return ScanFilter::Skip;
     }
-    if ((eventMask & IN_OPEN) != 0)
+    if (_pathTrie.hasIncludes() && !match.included)
     {
-        events.emplace_back("IN_OPEN");
+        return match.parentOfInclude ? ScanFilter::Traverse : ScanFilter::Skip;
     }
-    if ((eventMask & IN_IGNORED) != 0)
+    return ScanFilter::Report;
+}
+
+size_t DataWatcher::demoteSubtree()
+{
+    auto watchesCount = _watchDescriptors.size();
+    if (watchesCount == 0)
     {
-        events.emplace_back("IN_IGNORED");
+        return 0;
     }
-    if ((eventMask & IN_ISDIR) != 0)
+
+    // Count the watches under each top level directory of the configured
+    // path, to release the most watches with a single subtree.
+    const auto rootPrefix = (_dataPathToWatch / "").native();
+    std::unordered_map<std::string, size_t> subtreeWatches;
+    for (const auto& [wd, path] : _watchDescriptors.getEntries())
     {
-        events.emplace_back("IN_ISDIR");
+        std::string_view relPath(path.native());
+        if (!relPath.starts_with(rootPrefix) ||
+            relPath.size() == rootPrefix.size())
+        {
+            continue;
+        }
+        relPath.remove_prefix(rootPrefix.size());
+        subtreeWatches[std::string(relPath.substr(0, relPath.find('/')))]++;
     }
-    if ((eventMask & IN_Q_OVERFLOW) != 0)
+
+    auto largest = std::ranges::max_element(
+        subtreeWatches, {}, [](const auto& subtree) { return subtree.second; });
+    fs::path pathToPoll = (largest != subtreeWatches.end())
+                              ? _dataPathToWatch / largest->first
+                              : _dataPathToWatch;
+
+    lg2::info("Moving {PATH} to the periodic scan to release the inotify "
+              "watches for the higher priority paths",
+              "PATH", pathToPoll);
+    if (!_pollScannerBeforeDemotion.has_value())
     {
-        events.emplace_back("IN_Q_OVERFLOW");
+        _pollScannerBeforeDemotion = _pollScanner;
     }
-    if ((eventMask & IN_UNMOUNT) != 0)
+    _demotedPaths.emplace_back(pathToPoll);
+    pollSubtree(pathToPoll);
+    if (pathToPoll == _dataPathToWatch)
     {
-        events.emplace_back("IN_UNMOUNT");
+        // Drop the watches of the missing path's parents too.
+        stop();
     }
-
-    auto result = std::ranges::fold_left_first(
-        events, [](const std::string& a, const std::string& b) {
-        return a + " | " + b;
-    });
-
-    return result.value_or("UNKNOWN");
+    return watchesCount - _watchDescriptors.size();
 }
 
-fs::path DataWatcher::getExistingParentPath(const fs::path& dataPath)
+void DataWatcher::keepDemotedSubtrees()
 {
-    fs::path parentPath = dataPath.parent_path();
-    while ((!parentPath.empty()) && (!fs::exists(parentPath)))
-    {
-        parentPath = parentPath.parent_path();
-    }
-    return parentPath;
+    _pollScannerBeforeDemotion.reset();
+    _demotedPaths.clear();
 }
 
-void DataWatcher::addToWatchList(const fs::path& pathToWatch,
-                                 uint32_t eventMasksToWatch)
+void DataWatcher::restoreDemotedSubtrees()
 {
-    auto wd = inotify_add_watch(_inotifyFileDescriptor(), pathToWatch.c_str(),
-                                eventMasksToWatch);
-    if (-1 == wd)
+    if (!_pollScannerBeforeDemotion.has_value())
     {
-        lg2::error(
-            "inotify_add_watch call failed for {PATH} with ErrNo : {ERRNO}, "
-            "ErrMsg : {ERRMSG}",
-            "PATH", pathToWatch, "ERRNO", errno, "ERRMSG", strerror(errno));
-        // TODO: create error log ? bcoz not watching the  path
-        throw std::runtime_error("Failed to add to watch list");
+        return;
     }
-    else
+    _pollScanner = std::move(_pollScannerBeforeDemotion.value());
+    _pollScannerBeforeDemotion.reset();
+
+    auto demotedPaths = std::exchange(_demotedPaths, {});
+    for (const auto& demotedPath : demotedPaths)
     {
-        // Add trailing slash for directories to ensure rsync syncs directory
-        // contents rather than the directory itself
-        _watchDescriptors.emplace(
-            wd,
-            (fs::is_directory(pathToWatch) ? pathToWatch / "" : pathToWatch));
-        lg2::debug("Watch added. PATH : {PATH}, wd : {WD}", "PATH",
-                   _watchDescriptors[wd], "WD", wd);
+        lg2::info("Watching {PATH} again as the inotify watches couldn't be "
+                  "reclaimed",
+                  "PATH", demotedPath);
+        try
+        {
+            createWatchers(demotedPath);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Failed to watch {PATH} again, Error : {ERROR}", "PATH",
+                       demotedPath, "ERROR", e);
+        }
     }
 }
 
-bool DataWatcher::isPathExcluded(const fs::path& path)
+void DataWatcher::pollSubtrees()
 {
-    auto matchesOrParentOfPath = [&path](const auto& excludePath) {
-        if (fs::is_directory(path))
+    _dataOperations = _pollScanner.scan();
+    if (!_dataOperations.empty())
+    {
+        lg2::debug("The periodic scan found [{COUNT}] modifications in {PATH}",
+                   "COUNT", _dataOperations.size(), "PATH", _dataPathToWatch);
+        if (_dataChangeCallback)
         {
-            // If path is directory append '/' and compare whether the given
-            // directory is in exclude list or is a child dir of the configured
-            // exclude path.
-            return (path / "").string().starts_with(excludePath.string());
+            _dataChangeCallback(_dataOperations);
         }
-        else
+    }
+    _dataOperations.clear();
+}
+
+bool DataWatcher::isSamePath(std::string_view lhs, std::string_view rhs)
+{
+    auto withoutTrailingSlash = [](std::string_view path) {
+        while ((path.size() > 1) && path.ends_with('/'))
         {
-            // If path is file, only exact match is valid
-            // Eg : If a file with name 'ID' is in exlcudeList, another file
-            // with name ID1 shouldn't get excluded.
-            return (path.string() == excludePath.string());
+            path.remove_suffix(1);
         }
+        return path;
     };
-    if (!_excludeList.has_value())
+    return withoutTrailingSlash(lhs) == withoutTrailingSlash(rhs);
+}
+
+bool DataWatcher::isPathInTree(std::string_view path, std::string_view root)
+{
+    while ((root.size() > 1) && root.ends_with('/'))
+    {
+        root.remove_suffix(1);
+    }
+    // Compare whole path components, Eg: /var/log2 is not in /var/log.
+    return path.starts_with(root) &&
+           (path.size() == root.size() || root.ends_with('/') ||
+            path[root.size()] == '/');
+}
+
+bool DataWatcher::isPathExcluded(const fs::path& path)
+{
+    if (!_pathTrie.hasExcludes())
     {
         return false;
     }
-    if (std::ranges::any_of(_excludeList.value(), matchesOrParentOfPath))
+    if (_pathTrie.match(path.native()).excluded)
     {
         lg2::debug("{PATH} is in exclude list. Hence skipping", "PATH", path);
         return true;
@@ -217,34 +302,13 @@ bool DataWatcher::isPathIncluded(const fs::path& path)
     // Case 2. If the given path(file/dir) is child of the path listed in
     // include list.
 
-    if (!_includeList.has_value())
+    if (!_pathTrie.hasIncludes())
     {
         return false;
     }
-
-    fs::path normalizedPath{};
-    fs::is_directory(path) ? normalizedPath = path / "" : normalizedPath = path;
-
-    if (_includeList.value().contains(normalizedPath))
-    {
-        lg2::debug("{PATH} present inside include list", "PATH",
-                   normalizedPath);
-        return true;
-    }
-
-    // check whether path is child of any includelist path.
-    auto isParentOfNormPath = [&normalizedPath](const auto& includePath) {
-        auto [parentItr, childItr] = std::ranges::mismatch(includePath,
-                                                           normalizedPath);
-        return (parentItr == includePath.end()) || (*parentItr == "");
-    };
-
-    if (auto itr = std::ranges::find_if(_includeList.value(),
-                                        isParentOfNormPath);
-        itr != _includeList.value().end())
+    if (_pathTrie.match(path.native()).included)
     {
-        lg2::debug("{PATH} is child of the include list path[{INCLUDE}]",
-                   "PATH", normalizedPath, "INCLUDE", *itr);
+        lg2::debug("{PATH} is included by the include list", "PATH", path);
         return true;
     }
     return false;
@@ -255,32 +319,13 @@ bool DataWatcher::isPathParentOfInclude(const fs::path& path)
     // If the paths configured in include list is not exists on the
     // filesystem, then it's parent path need to consider as include list and
     // need to monitor until the configured path creates.
-    fs::path normalizedPath{};
-    fs::is_directory(path) ? normalizedPath = path / "" : normalizedPath = path;
-
-    auto childOfPath = [&normalizedPath](const auto& includePath) {
-        // if paths are same return false, as std::mismatch will return the end
-        // iterator for both paths which will cause ambiguity.
-        std::error_code ec;
-        if (fs::equivalent(normalizedPath, includePath, ec))
-        {
-            return false;
-        }
-
-        auto [parentItr, childItr] = std::ranges::mismatch(normalizedPath,
-                                                           includePath);
-        return ((parentItr == normalizedPath.end()) || (*parentItr == ""));
-    };
-
-    if (!_includeList.has_value())
+    if (!_pathTrie.hasIncludes())
     {
         return false;
     }
-    if (auto itr = std::ranges::find_if(_includeList.value(), childOfPath);
-        itr != _includeList.value().end())
+    if (_pathTrie.match(path.native()).parentOfInclude)
     {
-        lg2::debug("{PATH} is parent of the include list path[{INCLUDE}]",
-                   "PATH", path, "INCLUDE", *itr);
+        lg2::debug("{PATH} is parent of the include list path", "PATH", path);
         return true;
     }
     return false;
@@ -288,7 +333,8 @@ bool DataWatcher::isPathParentOfInclude(const fs::path& path)
 
 void DataWatcher::addSubDirWatches(const fs::path& pathToWatch)
 {
-    if (!fs::is_directory(pathToWatch))
+    std::error_code ec;
+    if (!fs::is_directory(pathToWatch, ec))
     {
         lg2::warning("{PATH} is not a directory to add watches for "
                      "subdirectories",
@@ -296,27 +342,45 @@ void DataWatcher::addSubDirWatches(const fs::path& pathToWatch)
         return;
     }
 
-    auto addWatchIfDir = [this](const fs::path& entry) {
-        if (fs::is_directory(entry))
+    // The tree can change or be unreadable in parts while it is walked,
+    // which should not stop watching the rest of it.
+    fs::recursive_directory_iterator entry(
+        pathToWatch, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && entry != fs::recursive_directory_iterator();
+         entry.increment(ec))
+    {
+        // The entry type is cached from the directory listing.
+        std::error_code typeEc;
+        if (!entry->is_directory(typeEc))
         {
-            // If ExcldueList is configured, exclude those directories
-            // from monitoring and add watch for rest.
-            if (_excludeList.has_value() && isPathExcluded(entry))
-            {
-                return;
-            }
-            addToWatchList(entry, _eventMasksToWatch);
+            continue;
         }
-    };
-    std::ranges::for_each(fs::recursive_directory_iterator(pathToWatch),
-                          addWatchIfDir);
+
+        // If ExcldueList is configured, exclude those directories
+        // from monitoring and add watch for rest.
+        if (_excludeList.has_value() && isPathExcluded(entry->path()))
+        {
+            entry.disable_recursion_pending();
+            continue;
+        }
+        addToWatchList(entry->path(), _eventMasksToWatch, true);
+    }
+    if (ec)
+    {
+        lg2::warning("Failed to walk {PATH} to add watches for "
+                     "subdirectories, error: {ERROR}",
+                     "PATH", pathToWatch, "ERROR", ec.message());
+    }
 }
 
 void DataWatcher::createWatchers(const fs::path& pathToWatch)
 {
-    auto pathToWatchExist = fs::exists(pathToWatch);
-    if (pathToWatchExist)
+    // Query the status once and derive both the existence and the type.
+    std::error_code ec;
+    auto pathStatus = fs::status(pathToWatch, ec);
+    if (fs::exists(pathStatus))
     {
+        auto isDir = fs::is_directory(pathStatus);
         // If IncludeList is configured, then monitor only those and
         // exclude rest.
         if ((_includeList.has_value()) && (pathToWatch == _dataPathToWatch))
@@ -327,10 +391,14 @@ void DataWatcher::createWatchers(const fs::path& pathToWatch)
             // through whole directory tree.
             std::ranges::for_each(_includeList.value(),
                                   [this](const fs::path& includePath) {
-                if (fs::exists(includePath))
+                std::error_code ec;
+                auto includeStatus = fs::status(includePath, ec);
+                if (fs::exists(includeStatus))
                 {
-                    addToWatchList(includePath, _eventMasksToWatch);
-                    if (fs::is_directory(includePath))
+                    auto isIncludeDir = fs::is_directory(includeStatus);
+                    addToWatchList(includePath, _eventMasksToWatch,
+                                   isIncludeDir);
+                    if (isIncludeDir)
                     {
                         addSubDirWatches(includePath);
                     }
@@ -347,15 +415,15 @@ void DataWatcher::createWatchers(const fs::path& pathToWatch)
             return;
         }
         else if ((_includeList.has_value()) &&
-                 (pathToWatch.string().starts_with(_dataPathToWatch.string())))
+                 isPathInTree(pathToWatch.native(), _dataPathToWatch.native()))
         {
             // Add watches only for included paths if child paths created inside
             // configured paths.
             if (isPathIncluded(pathToWatch) ||
                 isPathParentOfInclude(pathToWatch))
             {
-                addToWatchList(pathToWatch, _eventMasksToWatch);
-                if (fs::is_directory(pathToWatch))
+                addToWatchList(pathToWatch, _eventMasksToWatch, isDir);
+                if (isDir)
                 {
                     addSubDirWatches(pathToWatch);
                 }
@@ -364,8 +432,8 @@ void DataWatcher::createWatchers(const fs::path& pathToWatch)
         }
 
         // In normal scenario, where no include list configured.
-        addToWatchList(pathToWatch, _eventMasksToWatch);
-        if (fs::is_directory(pathToWatch))
+        addToWatchList(pathToWatch, _eventMasksToWatch, isDir);
+        if (isDir)
         {
             addSubDirWatches(pathToWatch);
         }
@@ -387,82 +455,38 @@ void DataWatcher::createWatchers(const fs::path& pathToWatch)
 }
 
 // NOLINTNEXTLINE
-sdbusplus::async::task<DataOperations> DataWatcher::onDataChange()
+sdbusplus::async::task<std::span<const DataOperation>>
+    DataWatcher::onDataChange()
 {
-    // NOLINTNEXTLINE
-    co_await _fdioInstance->next();
+    // Before waiting for the events clear the data operations to remove the
+    // handled operation details.
+    _dataOperations.clear();
 
-    if (auto receivedEvents = readEvents(); receivedEvents.has_value())
-    {
-        processEvents(receivedEvents.value());
-    }
+    // NOLINTNEXTLINE
+    co_await _inotifyMux.waitForEvents();
 
-    co_return _dataOperations;
+    co_return std::span<const DataOperation>(_dataOperations);
 }
 
-std::optional<std::vector<EventInfo>> DataWatcher::readEvents()
+void DataWatcher::handleEvents(const std::vector<EventInfo>& receivedEvents)
 {
-    // Before reading the events clear the map of data operation to remove the
-    // handled operation details.
-    if (!_dataOperations.empty())
+    if (!receivedEvents.empty())
     {
-        _dataOperations.clear();
+        _eventStats.update(receivedEvents.size());
+        lg2::debug("Received [{COUNT}] inotify events in a wakeup for {PATH}",
+                   "COUNT", receivedEvents.size(), "PATH", _dataPathToWatch);
     }
 
-    // Maximum inotify events supported in the buffer
-    constexpr auto maxBytes = sizeof(struct inotify_event) + NAME_MAX + 1;
-    uint8_t buffer[maxBytes];
-    std::memset(buffer, '\0', maxBytes);
-
-    auto bytes = read(_inotifyFileDescriptor(), buffer, maxBytes);
-    if (0 > bytes)
-    {
-        // In non blocking mode, read returns immediately with EAGAIN /
-        // EWOULDBLOCK when no data is available, instead of waiting.
-        if (errno != EAGAIN && errno != EWOULDBLOCK)
-        {
-            lg2::error("Failed to read inotify event, error: {ERROR}", "ERROR",
-                       strerror(errno));
-        }
-        return std::nullopt;
-    }
+    processEvents(receivedEvents);
 
-    auto offset = 0;
-    std::vector<EventInfo> receivedEvents{};
-    while (offset < bytes)
+    if (_dataChangeCallback)
     {
-        // NOLINTNEXTLINE to avoid cppcoreguidelines-pro-type-reinterpret-cast
-        auto* receivedEvent = reinterpret_cast<inotify_event*>(&buffer[offset]);
-
-        // Using find() because,
-        // IN_IGNORED events can arrive for already removed watch descriptors
-        // Hence use of [] to access the map entries will cause stale entries.
-        auto wdIter = _watchDescriptors.find(receivedEvent->wd);
-        std::string pathStr = (wdIter != _watchDescriptors.end())
-                                  ? wdIter->second.string()
-                                  : "[removed path]";
-
-        lg2::debug("Received {EVENTS} from {PATH}, wd:{WD} and name : {NAME}",
-                   "EVENTS", eventName(receivedEvent->mask), "PATH", pathStr,
-                   "WD", receivedEvent->wd, "NAME", receivedEvent->name);
-
-        if (((receivedEvent->mask & _eventMasksToWatch) != 0) ||
-            ((receivedEvent->mask & _eventMasksIfNotExists) != 0))
-        {
-            receivedEvents.emplace_back(receivedEvent->wd, receivedEvent->name,
-                                        receivedEvent->mask,
-                                        receivedEvent->cookie);
-        }
-        else
+        if (!_dataOperations.empty())
         {
-            lg2::debug("Skipping the uninterested events[{EVENTS}] for the "
-                       "configured path : {PATH}",
-                       "EVENTS", eventName(receivedEvent->mask), "PATH",
-                       _dataPathToWatch);
+            _dataChangeCallback(_dataOperations);
         }
-        offset += offsetof(inotify_event, name) + receivedEvent->len;
+        _dataOperations.clear();
     }
-    return receivedEvents;
 }
 
 void DataWatcher::processEvents(
@@ -472,14 +496,33 @@ void DataWatcher::processEvents(
         std::optional<DataOperation> dataOperation = processEvent(event);
         if (dataOperation.has_value())
         {
-            _dataOperations.emplace_back(dataOperation.value());
+            _dataOperations.emplace_back(std::move(dataOperation.value()));
         }
     });
+
+    // The renames which didn't pair by now are moved out of the tree.
+    _renameCookies.expire();
+    if (_renameCookies.size() != 0)
+    {
+        // Expire them even if no other event is received.
+        _inotifyMux.startRenameExpiry();
+    }
+}
+
+void DataWatcher::expireRenames(std::chrono::steady_clock::time_point time)
+{
+    _renameCookies.expireBefore(time);
 }
 
 std::optional<DataOperation>
     DataWatcher::processEvent(const EventInfo& receivedEventInfo)
 {
+    // The overflow event is not for any watch (wd is -1).
+    if ((std::get<2>(receivedEventInfo) & IN_Q_OVERFLOW) != 0)
+    {
+        return processOverflow();
+    }
+
     // No current use case for data-sync to support hidden files
     // IN_MOVED_FROM signals for hidden files need to save in order to map
     // with the corresponding IN_MOVED_TO, hence not skipping here.
@@ -488,14 +531,27 @@ std::optional<DataOperation>
     {
         lg2::debug("Ignoring the {EVENTS}  as received for the hidden "
                    "file[{PATH}]",
-                   "EVENTS", eventName(std::get<2>(receivedEventInfo)), "PATH",
+                   "EVENTS", lg2::hex, std::get<2>(receivedEventInfo), "PATH",
                    std::get<BaseName>(receivedEventInfo));
         return std::nullopt;
     }
 
-    fs::path eventReceivedFor =
-        _watchDescriptors.at(std::get<WD>(receivedEventInfo)) /
-        std::get<BaseName>(receivedEventInfo);
+    // The watch could be dropped by the earlier events of the batch, Eg:
+    // moved to the periodic scan to make room for another watcher.
+    if (!_watchDescriptors.contains(std::get<WD>(receivedEventInfo)))
+    {
+        lg2::debug("Ignoring the {EVENTS} for the removed wd:{WD}", "EVENTS",
+                   lg2::hex, std::get<2>(receivedEventInfo), "WD",
+                   std::get<WD>(receivedEventInfo));
+        return std::nullopt;
+    }
+
+    // Build the path into the reusable buffer, the path is materialized
+    // only if the event results in a data operation.
+    _eventPathBuffer.clear();
+    _watchDescriptors.appendPath(std::get<WD>(receivedEventInfo),
+                                 _eventPathBuffer);
+    _eventPathBuffer.append(std::get<BaseName>(receivedEventInfo));
 
     // Skip the events received for the paths which are in excluded list and not
     // in include list.
@@ -505,19 +561,21 @@ std::optional<DataOperation>
     // path doesn't exists, monitoring parent will result is inotify events for
     // the paths which aren't in the tree of include list. No need to process
     // those events.
-    if ((_excludeList.has_value() && isPathExcluded(eventReceivedFor)) ||
-        (_includeList.has_value() &&
-         (!(isPathIncluded(eventReceivedFor)) &&
-          !(isPathParentOfInclude(eventReceivedFor)))))
+    // All the lists are checked at once with a single walk of the path.
+    if (auto match = _pathTrie.match(_eventPathBuffer);
+        match.excluded ||
+        (_pathTrie.hasIncludes() && !match.included && !match.parentOfInclude))
     {
         lg2::debug("Skipping the {EVENTS} for {PATH} as it is not in the"
                    " include or exclude list",
-                   "EVENTS", eventName(std::get<2>(receivedEventInfo)), "PATH",
-                   eventReceivedFor);
+                   "EVENTS", lg2::hex, std::get<2>(receivedEventInfo), "PATH",
+                   _eventPathBuffer);
         return std::nullopt;
     }
 
-    if ((std::get<2>(receivedEventInfo) & IN_CLOSE_WRITE) != 0)
+    // The IN_MODIFY is watched only for the files written without being
+    // closed (Eg: the logs appended by a daemon), and handled alike.
+    if ((std::get<2>(receivedEventInfo) & (IN_CLOSE_WRITE | IN_MODIFY)) != 0)
     {
         return processCloseWrite(receivedEventInfo);
     }
@@ -537,6 +595,10 @@ std::optional<DataOperation>
     {
         return processMovedTo(receivedEventInfo);
     }
+    else if ((std::get<2>(receivedEventInfo) & IN_MOVE_SELF) != 0)
+    {
+        return processMoveSelf(receivedEventInfo);
+    }
     else if ((std::get<2>(receivedEventInfo) & IN_DELETE_SELF) != 0)
     {
         return processDeleteSelf(receivedEventInfo);
@@ -548,7 +610,7 @@ std::optional<DataOperation>
     else
     {
         lg2::debug("Skipping the uninterested inotify event [{EVENTS}] ",
-                   "EVENTS", eventName(std::get<2>(receivedEventInfo)));
+                   "EVENTS", lg2::hex, std::get<2>(receivedEventInfo));
         return std::nullopt;
     }
     return std::nullopt;
@@ -557,47 +619,43 @@ std::optional<DataOperation>
 std::optional<DataOperation>
     DataWatcher::processCloseWrite(const EventInfo& receivedEventInfo)
 {
-    fs::path eventReceivedFor =
-        _watchDescriptors.at(std::get<WD>(receivedEventInfo));
+    // The most frequent event, hence use the event path already built by
+    // processEvent() and materialize it only for the data operation.
+    const auto& baseName = std::get<BaseName>(receivedEventInfo);
+    std::string_view eventReceivedFor(_eventPathBuffer);
+    eventReceivedFor.remove_suffix(baseName.size());
     lg2::debug("Processing an IN_CLOSE_WRITE for {PATH}", "PATH",
-               eventReceivedFor / std::get<BaseName>(receivedEventInfo));
+               _eventPathBuffer);
 
-    std::error_code ec;
-    if (eventReceivedFor.string().starts_with(_dataPathToWatch.string()))
+    if (isPathInTree(eventReceivedFor, _dataPathToWatch.native()))
     {
-        if (std::get<BaseName>(receivedEventInfo).empty())
+        if (baseName.empty())
         {
             // Case 1 : The configured file in the JSON was watching and is
             // modified.
-            return std::make_pair(eventReceivedFor, DataOps::COPY);
+            return DataOperation{fs::path(_eventPathBuffer), DataOps::COPY};
         }
-        else if (_includeList.has_value() &&
-                 isPathIncluded(eventReceivedFor /
-                                std::get<BaseName>(receivedEventInfo)))
+
+        fs::path absModifiedPath(_eventPathBuffer);
+        if (_includeList.has_value() && isPathIncluded(absModifiedPath))
         {
             // Case 2 : Non empty BaseName implies, not watching already.
             // Since the file is in includelist add watch for the same.
-            addToWatchList(eventReceivedFor /
-                               std::get<BaseName>(receivedEventInfo),
-                           _eventMasksToWatch);
+            addToWatchList(absModifiedPath, _eventMasksToWatch, false);
             removeIncludeParentWatches();
         }
 
         // Case 3 : A file got created or modified inside a watching subdir
-        return std::make_pair(eventReceivedFor /
-                                  std::get<BaseName>(receivedEventInfo),
-                              DataOps::COPY);
+        return DataOperation{std::move(absModifiedPath), DataOps::COPY};
     }
-    else if (fs::equivalent(eventReceivedFor /
-                                std::get<BaseName>(receivedEventInfo),
-                            _dataPathToWatch, ec))
+    else if (isSamePath(_eventPathBuffer, _dataPathToWatch.native()))
     {
         // The configured file in the monitored parent directory has been
         // created, hence monitor the configured file and remove the parent
         // watcher as it is no longer needed.
-        addToWatchList(_dataPathToWatch, _eventMasksToWatch);
+        addToWatchList(_dataPathToWatch, _eventMasksToWatch, false);
         removeWatch(std::get<WD>(receivedEventInfo));
-        return std::make_pair(_dataPathToWatch, DataOps::COPY);
+        return DataOperation{_dataPathToWatch, DataOps::COPY};
     }
 
     return std::nullopt;
@@ -610,15 +668,14 @@ std::optional<DataOperation>
     // all the file events are handled using IN_CLOSE_WRITE
     if ((std::get<2>(receivedEventInfo) & IN_ISDIR) != 0)
     {
-        std::error_code ec;
         fs::path absCreatedPath =
             _watchDescriptors.at(std::get<WD>(receivedEventInfo)) /
             std::get<BaseName>(receivedEventInfo) / "";
 
         lg2::debug("Processing an IN_CREATE for {PATH}", "PATH",
                    absCreatedPath);
-        if (absCreatedPath.string().starts_with(_dataPathToWatch.string()) &&
-            !fs::equivalent(_dataPathToWatch, absCreatedPath, ec))
+        if (isPathInTree(absCreatedPath.native(), _dataPathToWatch.native()) &&
+            !isSamePath(_dataPathToWatch.native(), absCreatedPath.native()))
         {
             // The created dir is a child directory inside the configured data
             // path add watch for the created child subdirectories.
@@ -632,12 +689,17 @@ std::optional<DataOperation>
                 removeIncludeParentWatches();
             }
         }
-        else if (_dataPathToWatch.string().starts_with(absCreatedPath.string()))
+        else if (isPathInTree(_dataPathToWatch.native(),
+                              absCreatedPath.native()))
         {
             // Was monitoring existing parent path of the configured data path
             // and a new file/directory got created inside it.
 
-            auto modifyWatchIfExpected = [this, &ec](const fs::path& entry) {
+            auto modifyWatchIfExpected =
+                [this](const fs::directory_entry& dirEntry) {
+                const fs::path& entry = dirEntry.path();
+                std::error_code ec;
+                auto isDir = dirEntry.is_directory(ec);
                 // Before modify watcher, check the created entry is part of
                 // exclude list or include list.
                 if ((_excludeList.has_value() && isPathExcluded(entry)) ||
@@ -646,20 +708,20 @@ std::optional<DataOperation>
                 {
                     return false;
                 }
-                if (_dataPathToWatch.string().starts_with(entry.string()))
+                if (isPathInTree(_dataPathToWatch.native(), entry.native()))
                 {
                     // Created DIR is in the tree of the configured path.
                     // Hence, Add watch for the created DIR and remove its
                     // parent watch until the JSON configured DIR creates.
-                    if (fs::equivalent(_dataPathToWatch, entry, ec))
+                    if (isSamePath(_dataPathToWatch.native(), entry.native()))
                     {
                         // Add configured event masks if created DIR is the
                         // configured path.
-                        addToWatchList(entry, _eventMasksToWatch);
+                        addToWatchList(entry, _eventMasksToWatch, isDir);
                     }
                     else
                     {
-                        addToWatchList(entry, _eventMasksIfNotExists);
+                        addToWatchList(entry, _eventMasksIfNotExists, isDir);
                     }
 
                     // "/a/b/c/d". Here "d" is directory and is the cfg path.
@@ -669,27 +731,24 @@ std::optional<DataOperation>
                     // Inotify event received for "a" only and "b" and "c"
                     // created in a single shot. So on recursive directory
                     // iteration, in order to remove the watch for the parents
-                    // 'a' and 'b', need to iterate through the map, as only WD
-                    // of 'a' is known from the inotify event.
-                    if (auto parent =
-                            std::ranges::find_if(_watchDescriptors,
-                                                 [&entry, &ec](const auto& wd) {
-                        return (
-                            fs::equivalent(wd.second, entry.parent_path(), ec));
-                    });
-                        parent != _watchDescriptors.end())
+                    // 'a' and 'b', need to look up the table, as only WD of 'a'
+                    // is known from the inotify event.
+                    if (auto parentWd =
+                            _watchDescriptors.find(entry.parent_path());
+                        parentWd.has_value())
                     {
-                        removeWatch(parent->first);
+                        removeWatch(parentWd.value());
                     }
                     return true;
                 }
-                else if (entry.string().starts_with(_dataPathToWatch.string()))
+                else if (isPathInTree(entry.native(),
+                                      _dataPathToWatch.native()))
                 {
                     // Created DIR is expected only, and is a child directory of
                     // the configured path.
                     // Hence add watch for created dirs and don't remove it's
                     // parent as created DIRs are childs of the configured DIR.
-                    addToWatchList(entry, _eventMasksToWatch);
+                    addToWatchList(entry, _eventMasksToWatch, isDir);
                     return true;
                 }
                 return false;
@@ -711,7 +770,7 @@ std::optional<DataOperation>
                 "PATH", absCreatedPath);
             return std::nullopt;
         }
-        return std::make_pair(absCreatedPath, DataOps::COPY);
+        return DataOperation{absCreatedPath, DataOps::COPY};
     }
     return std::nullopt;
 }
@@ -728,14 +787,15 @@ std::optional<DataOperation>
         std::get<BaseName>(receivedEventInfo);
     lg2::debug("Received an IN_MOVED_FROM for {PATH} with  cookie : {COOKIE}",
                "PATH", absMovedPath, "COOKIE", std::get<3>(receivedEventInfo));
-    if (absMovedPath.string().starts_with(_dataPathToWatch.string()))
+    // The hidden paths are not synced, their entry only serves to skip the
+    // rename of the rsync temporary files.
+    bool isHidden = std::get<BaseName>(receivedEventInfo).starts_with(".");
+    if (isPathInTree(absMovedPath.native(), _dataPathToWatch.native()))
     {
-        _movedFromDataOps.emplace(
-            std::get<3>(receivedEventInfo),
-            std::make_pair(absMovedPath, DataOps::DELETE));
+        _renameCookies.emplace(std::get<3>(receivedEventInfo), absMovedPath);
     }
 
-    if (std::get<BaseName>(receivedEventInfo).starts_with("."))
+    if (isHidden)
     {
         lg2::debug("Skipping the received IN_MOVED_FROM for the hidden path"
                    "[{PATH}] with cookie : {COOKIE}",
@@ -743,7 +803,7 @@ std::optional<DataOperation>
                    std::get<3>(receivedEventInfo));
         return std::nullopt;
     }
-    return std::make_pair(absMovedPath, DataOps::DELETE);
+    return DataOperation{absMovedPath, DataOps::DELETE};
 }
 
 std::optional<DataOperation>
@@ -755,35 +815,117 @@ std::optional<DataOperation>
         _watchDescriptors.at(std::get<WD>(receivedEventInfo)) /
         std::get<BaseName>(receivedEventInfo);
 
-    if (absCopiedPath.string().starts_with(_dataPathToWatch.string()))
+    if (isPathInTree(absCopiedPath.native(), _dataPathToWatch.native()))
     {
         auto cookie = std::get<3>(receivedEventInfo);
         lg2::debug("Received an IN_MOVED_TO for {PATH} with  cookie : {COOKIE}",
                    "PATH", absCopiedPath, "COOKIE", cookie);
 
-        if (_movedFromDataOps.contains(cookie))
+        auto movedFromPath = _renameCookies.take(cookie);
+        if ((std::get<2>(receivedEventInfo) & IN_ISDIR) != 0)
         {
-            if ((_movedFromDataOps[cookie].first.filename().string())
-                    .starts_with("."))
+            moveWatches(movedFromPath, absCopiedPath);
+        }
+
+        if (movedFromPath.has_value())
+        {
+            if (movedFromPath->filename().native().starts_with("."))
             {
                 lg2::debug("Ignoring the received IN_MOVED_TO for {PATH} with "
                            "cookie : {COOKIE} as update is done by RSYNC",
                            "PATH", absCopiedPath, "COOKIE", cookie);
                 return std::nullopt;
             }
-            else
+            lg2::debug("[{OLDPATH}] renamed/moved to [{NEWPATH}]", "OLDPATH",
+                       movedFromPath.value(), "NEWPATH", absCopiedPath);
+
+            // Report the rename as a single operation, in place of the
+            // DELETE reported for the IN_MOVED_FROM of the same batch.
+            auto deleteOps = _dataOperations | std::views::reverse;
+            if (auto deleteOp = std::ranges::find(
+                    deleteOps,
+                    DataOperation{movedFromPath.value(), DataOps::DELETE});
+                deleteOp != deleteOps.end())
             {
-                lg2::debug("[{OLDPATH}] renamed/moved to [{NEWPATH}]",
-                           "OLDPATH", _movedFromDataOps.at(cookie).first,
-                           "NEWPATH", absCopiedPath);
-                _movedFromDataOps.erase(cookie);
+                *deleteOp = DataOperation{std::move(absCopiedPath),
+                                          DataOps::MOVE,
+                                          std::move(movedFromPath.value())};
+                return std::nullopt;
             }
         }
-        return std::make_pair(absCopiedPath, DataOps::COPY);
+        return DataOperation{absCopiedPath, DataOps::COPY};
     }
     return std::nullopt;
 }
 
+void DataWatcher::moveWatches(const std::optional<fs::path>& movedFromPath,
+                              const fs::path& movedToPath)
+{
+    // The kernel keeps the watches of the renamed directory and its subtree,
+    // hence only their paths are moved.
+    if (movedFromPath.has_value() &&
+        _watchDescriptors.move(movedFromPath.value(), movedToPath))
+    {
+        _inotifyMux.movePath(movedFromPath.value(), movedToPath);
+        lg2::debug("Moved the watches of [{OLDPATH}] to [{NEWPATH}]",
+                   "OLDPATH", movedFromPath.value(), "NEWPATH", movedToPath);
+        return;
+    }
+
+    // Moved in from an unwatched path, or the destination is still watched
+    // (Eg: an empty directory replaced by the rename, until its
+    // IN_DELETE_SELF). So watch the directory tree afresh.
+    if (movedFromPath.has_value())
+    {
+        removeSubtreeWatches(movedFromPath.value());
+    }
+    createWatchers(movedToPath / "");
+    if (_includeList.has_value())
+    {
+        removeIncludeParentWatches();
+    }
+}
+
+std::optional<DataOperation>
+    DataWatcher::processMoveSelf(const EventInfo& receivedEventInfo)
+{
+    auto wd = std::get<WD>(receivedEventInfo);
+    fs::path movedPath = _watchDescriptors.at(wd);
+
+    // The configured path or its watched parent is moved, which is the same
+    // as deleted for the sync.
+    if (isPathInTree(_dataPathToWatch.native(), movedPath.native()))
+    {
+        lg2::debug("Processing IN_MOVE_SELF for {PATH}", "PATH", movedPath);
+        removeSubtreeWatches(movedPath, wd);
+        return processDeleteSelf(receivedEventInfo);
+    }
+
+    // The IN_MOVE_SELF is queued after the IN_MOVED_TO of the rename, so the
+    // watches are re-keyed already if moved inside the tree. Otherwise the
+    // subtree is moved out, and the DELETE is reported for its IN_MOVED_FROM.
+    if (_renameCookies.isPending(movedPath))
+    {
+        lg2::debug("{PATH} is moved out of {CFGPATH}, removing its watches",
+                   "PATH", movedPath, "CFGPATH", _dataPathToWatch);
+        removeSubtreeWatches(movedPath);
+    }
+    return std::nullopt;
+}
+
+void DataWatcher::removeSubtreeWatches(const fs::path& dirPath,
+                                       std::optional<WD> keepWd)
+{
+    const auto dirPrefix = (dirPath / "").native();
+    for (const auto& [wd, path] : _watchDescriptors.getEntries())
+    {
+        if (wd != keepWd && (path / "").native().starts_with(dirPrefix))
+        {
+            removeWatch(wd);
+        }
+    }
+}
+
 std::optional<DataOperation>
     DataWatcher::processDeleteSelf(const EventInfo& receivedEventInfo)
 {
@@ -795,9 +937,10 @@ std::optional<DataOperation>
     lg2::debug("Processing IN_DELETE_SELF for {PATH}", "PATH", deletedPath);
 
     // Check if the configured path is same as or a child of the deleted path.
-    bool isConfiguredPathOrParent = _dataPathToWatch.string().starts_with(
-        (fs::is_directory(deletedPath) ? deletedPath / "" : deletedPath)
-            .string());
+    // The deleted path can't be checked on the filesystem anymore, hence
+    // compare the paths lexically.
+    bool isConfiguredPathOrParent = isPathInTree(_dataPathToWatch.native(),
+                                                 deletedPath.native());
 
     if (isConfiguredPathOrParent)
     {
@@ -823,7 +966,7 @@ std::optional<DataOperation>
     // Remove the watch for the deleted path
     removeWatch(std::get<WD>(receivedEventInfo));
 
-    return std::make_pair(deletedPath, DataOps::DELETE);
+    return DataOperation{deletedPath, DataOps::DELETE};
 }
 
 std::optional<DataOperation>
@@ -840,20 +983,68 @@ std::optional<DataOperation>
     {
         // A file inside a monitoring directory got deleted.
         lg2::debug("Processing IN_DELETE for {PATH}", "PATH", deletedPath);
-        return std::make_pair(deletedPath, DataOps::DELETE);
+        return DataOperation{deletedPath, DataOps::DELETE};
     }
 
     return std::nullopt;
 }
 
+DataOperation DataWatcher::processOverflow()
+{
+    _eventStats.overflows++;
+    lg2::warning("Events of {PATH} are lost due to the inotify queue "
+                 "overflow, rescanning the watches and syncing the whole path",
+                 "PATH", _dataPathToWatch);
+
+    try
+    {
+        rescanWatches();
+    }
+    catch (const std::exception& e)
+    {
+        // The whole path is synced anyway, the watches get corrected upon
+        // the next events.
+        lg2::error("Failed to rescan the watches of {PATH}, Error : {ERROR}",
+                   "PATH", _dataPathToWatch, "ERROR", e);
+    }
+
+    return DataOperation{_dataPathToWatch, DataOps::COPY};
+}
+
+void DataWatcher::rescanWatches()
+{
+    std::error_code ec;
+    if (!fs::exists(_dataPathToWatch, ec))
+    {
+        // Still monitoring the existing parent, the creation of the
+        // configured path will be reported.
+        return;
+    }
+
+    createWatchers(_dataPathToWatch);
+
+    // The configured path exists now, hence drop the watches of its parents
+    // which were monitoring for its creation.
+    auto parentWds = _watchDescriptors.getEntries() |
+                     std::views::filter([this](const auto& wdPair) {
+        return isPathInTree(_dataPathToWatch.native(),
+                            wdPair.second.native()) &&
+               !isSamePath(wdPair.second.native(), _dataPathToWatch.native());
+    }) | std::views::keys |
+                     std::ranges::to<std::vector>();
+
+    std::ranges::for_each(parentWds, [this](WD wd) { removeWatch(wd); });
+
+    if (_includeList.has_value())
+    {
+        removeIncludeParentWatches();
+    }
+}
+
 void DataWatcher::removeIncludeParentWatches()
 {
     auto hasWatches = [this](const auto& incPath) {
-        return std::ranges::any_of(_watchDescriptors,
-                                   [&incPath](const auto& wdPair) {
-            std::error_code ec;
-            return fs::equivalent(wdPair.second, incPath, ec);
-        });
+        return _watchDescriptors.find(incPath).has_value();
     };
 
     // Check whether all configured include paths are being watched.
@@ -865,7 +1056,8 @@ void DataWatcher::removeIncludeParentWatches()
     {
         return;
     }
-    auto wdItToRemove = _watchDescriptors |
+    auto watchEntries = _watchDescriptors.getEntries();
+    auto wdItToRemove = watchEntries |
                         std::views::filter([this](const auto& pair) {
         return isPathParentOfInclude(pair.second);
     }) | std::views::transform([](const auto& pair) { return pair.first; });
@@ -880,7 +1072,7 @@ void DataWatcher::removeWatch(int wd)
 {
     fs::path pathToRemove = _watchDescriptors.at(wd);
 
-    inotify_rm_watch(_inotifyFileDescriptor(), wd);
+    _inotifyMux.removeWatch(*this, wd);
     _watchDescriptors.erase(wd);
 
     lg2::debug("Stopped monitoring {PATH}, WD : {WD}", "PATH", pathToRemove,
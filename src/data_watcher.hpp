@@ -2,15 +2,24 @@
 
 #pragma once
 
-#include "utility.hpp"
+#include "inotify_mux.hpp"
+#include "path_trie.hpp"
+#include "poll_scanner.hpp"
+#include "rename_cookie_table.hpp"
+#include "watch_table.hpp"
 
 #include <sys/inotify.h>
 
 #include <data_sync_config.hpp>
 #include <sdbusplus/async.hpp>
 
+#include <chrono>
 #include <filesystem>
-#include <map>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
 #include <unordered_set>
 #include <vector>
 
@@ -18,50 +27,19 @@ namespace data_sync::watch::inotify
 {
 
 namespace fs = std::filesystem;
-namespace utility = data_sync::utility;
 
-/**
- * @brief A tuple which has the info related to the occured inotify event
- *
- * int         - Watch descriptor corresponds to the event
- * std::string - name[] in inotify_event struct
- * uint32_t    - Mask describing event
- */
-using WD = int;
-using BaseName = std::string;
-using EventMask = uint32_t;
-using Cookie = uint32_t;
-using EventInfo = std::tuple<WD, BaseName, EventMask, Cookie>;
-
-/**
- * @brief enum which indicates the type of operations that can take against an
- * intersted inotify event on a configured data path
- */
-enum class DataOps
-{
-    COPY,
-    DELETE
-};
-
-/**
- * @brief Container holding data paths and their corresponding operations.
- *
- * Represents a list of data paths and the type of operation,that needs to be
- * performed on each path.
- *
- * Each entry is a pair of :
- * - fs::path : Absolute path of the file or directory
- * - DataOps  : Operation to perform on the given path
- */
-using DataOperation = std::pair<fs::path, DataOps>;
-using DataOperations = std::vector<DataOperation>;
+// The data operations are common for all the watcher backends.
+using watch::DataChangeCallback;
+using watch::DataOperation;
+using watch::DataOperations;
+using watch::DataOps;
 
 /** @class DataWatcher
  *
  *  @brief Adds inotify watch on directories/files configured for sync.
  *
  */
-class DataWatcher
+class DataWatcher : public Watcher
 {
   public:
     DataWatcher(const DataWatcher&) = delete;
@@ -73,7 +51,8 @@ class DataWatcher
      * @brief Constructor
      *
      * Create watcher for directories/files to monitor for the occurence
-     * of the interested events upon modifications.
+     * of the interested events upon modifications, using an inotify instance
+     * owned by the watcher.
      *
      *  @param[in] ctx - The async context object
      *  @param[in] inotifyFlags - inotify flags to watch
@@ -90,21 +69,62 @@ class DataWatcher
         uint32_t eventMasksToWatch, fs::path dataPathToWatch,
         std::optional<std::unordered_set<fs::path>> excludeList = std::nullopt,
         std::optional<std::unordered_set<fs::path>> includeList = std::nullopt);
+
+    /**
+     * @brief Constructor
+     *
+     * Create watcher for directories/files which shares the given inotify
+     * instance with the other watchers. The data operations of the received
+     * events are handed over through the callback.
+     *
+     *  @param[in] inotifyMux - The shared inotify instance
+     *  @param[in] callback - The callback to invoke upon data operations
+     *  @param[in] eventMasksToWatch - mask of interested events to watch
+     *  @param[in] dataPathToWatch - The absolute path to be monitored using
+     *                               inotify
+     *  @param[in] excludeList - The list of paths to be excluded from
+     *                           monitoring
+     *  @param[in] includeList - The list of paths should be included while
+     *                           monitoring
+     *  @param[in] watchPriority - The priority to keep the watches if the
+     *                             inotify watches run short
+     */
+    DataWatcher(
+        InotifyMux& inotifyMux, DataChangeCallback callback,
+        uint32_t eventMasksToWatch, fs::path dataPathToWatch,
+        std::optional<std::unordered_set<fs::path>> excludeList = std::nullopt,
+        std::optional<std::unordered_set<fs::path>> includeList = std::nullopt,
+        config::WatchPriority watchPriority = config::WatchPriority::Normal);
+
     /**
      * @brief Destructor
      * Remove the inotify watch and close fd's
      */
-    ~DataWatcher();
+    ~DataWatcher() override;
 
     /**
      * @brief API to monitor for the file/directory for inotify events
      *
-     * @returns bool - true - Inidcates that sync action is required on the
-     *                        received event
-     *                 false - Inidcates that no action is required on the
-     *                         received event
+     * @note Only for the watchers which own the inotify instance.
+     *
+     * @returns std::span<const DataOperation> - The operations to perform
+     *          for the events received on the wakeup, empty if no action is
+     *          required. Refers the operations held by the watcher without
+     *          copying, hence valid until the next call.
+     *
+     * @note The events are not copied, but each reported operation still
+     *       allocates its own fs::path.
      */
-    sdbusplus::async::task<DataOperations> onDataChange();
+    sdbusplus::async::task<std::span<const DataOperation>> onDataChange();
+
+    /**
+     * @brief API to process the batch of events which the inotify instance
+     *        dispatched to this watcher on a wakeup.
+     *
+     * @param[in] receivedEvents - The events received for the watches of this
+     *                             watcher
+     */
+    void handleEvents(const std::vector<EventInfo>& receivedEvents);
 
     /**
      * @brief Stop all active inotify watches.
@@ -113,28 +133,145 @@ class DataWatcher
      * IN_IGNORED which unblocks any pending co_await on onDataChange().
      * The inotify fd is closed by the destructor after the coroutine exits.
      */
-    void stop();
+    void stop() override;
 
     /**
-     * @brief Get the current watch descriptors map
+     * @brief Get the current watch descriptors table
      *
-     * This method provides read-only access to the internal map of watch
-     * descriptors and their associated file paths. Used by Manager to collect
-     * all currently watched paths for debugging purposes.
+     * This method provides read-only access to the internal table of watch
+     * descriptors and their associated file paths.
      *
-     * @returns const std::map<WD, fs::path>& - A reference to the map of watch
+     * @returns const WatchTable& - A reference to the table of watch
      *          descriptors and their associated file paths
      */
-    const std::map<WD, fs::path>& getWatchDescriptors() const
+    const WatchTable& getWatchDescriptors() const
     {
         return _watchDescriptors;
     }
 
+    /**
+     * @brief Get the path monitored by the watcher.
+     */
+    const fs::path& getDataPathToWatch() const
+    {
+        return _dataPathToWatch;
+    }
+
+    /**
+     * @brief Get the paths of the current watch descriptors.
+     *
+     * @returns std::vector<fs::path> - The watched paths
+     */
+    std::vector<fs::path> getWatchingPaths() const override
+    {
+        return _watchDescriptors.getEntries() | std::views::values |
+               std::ranges::to<std::vector>();
+    }
+
+    /**
+     * @brief Get the approximate memory used by the watch descriptors table.
+     *
+     * @returns size_t - The memory in bytes
+     */
+    size_t getMemoryUsage() const override
+    {
+        return _watchDescriptors.getMemoryUsage();
+    }
+
+    /**
+     * @brief Get the number of the renames awaiting their IN_MOVED_TO.
+     *
+     * @returns size_t - The number of the unmatched IN_MOVED_FROM
+     */
+    size_t getPendingRenamesCount() const override
+    {
+        return _renameCookies.size();
+    }
+
+    /**
+     * @brief Get the subtrees scanned periodically as the inotify watches
+     *        ran short.
+     *
+     * @returns std::vector<fs::path> - The polled paths
+     */
+    std::vector<fs::path> getPolledPaths() const override
+    {
+        return _pollScanner.getRoots();
+    }
+
+    /**
+     * @brief Get the priority to keep the watches of this watcher.
+     */
+    config::WatchPriority getWatchPriority() const
+    {
+        return _watchPriority;
+    }
+
+    /**
+     * @brief Move the subtree holding the most watches to the periodic scan,
+     *        to release the watches for a higher priority watcher.
+     *
+     * The whole configured path is moved once none of its subdirectories
+     * is watched anymore.
+     *
+     * @returns size_t - The number of the released watches
+     */
+    size_t demoteSubtree();
+
+    /**
+     * @brief Keep the subtrees demoted since the last call, as the reclaim
+     *        they were demoted for succeeded.
+     */
+    void keepDemotedSubtrees();
+
+    /**
+     * @brief Watch again the subtrees demoted since the last call, as the
+     *        reclaim they were demoted for failed.
+     */
+    void restoreDemotedSubtrees();
+
+    /**
+     * @brief Scan the polled subtrees and hand over the data operations of
+     *        the modifications through the callback.
+     */
+    void pollSubtrees();
+
+    /**
+     * @brief Drop the renames which didn't pair since the given time.
+     *
+     * @param[in] time - The time the renames still awaited are received from
+     */
+    void expireRenames(std::chrono::steady_clock::time_point time);
+
+    /**
+     * @brief Get the events per wakeup counters of this watcher.
+     *
+     * Only the events dispatched to this watcher are accounted, so the
+     * wakeups which didn't carry any of its events are not counted.
+     *
+     * @returns const EventStats& - The accumulated event counters
+     */
+    const EventStats& getEventStats() const override
+    {
+        return _eventStats;
+    }
+
   private:
     /**
-     * @brief inotify flags
+     * @brief The inotify instance owned by the watcher, if it isn't shared.
      */
-    int _inotifyFlags;
+    std::unique_ptr<InotifyMux> _ownInotifyMux;
+
+    /**
+     * @brief The inotify instance used to add the watches
+     */
+    InotifyMux& _inotifyMux;
+
+    /**
+     * @brief The callback to hand over the data operations, if the inotify
+     *        instance is shared.
+     */
+    DataChangeCallback _dataChangeCallback;
 
     /**
      * @brief The group of interested event Masks for which data to be watched
@@ -179,48 +316,58 @@ class DataWatcher
     std::optional<std::unordered_set<fs::path>> _includeList;
 
     /**
-     * @brief The map of unique watch descriptors associated with an configured
-     * file or directory.
+     * @brief The exclude and include lists compiled for the matching.
      */
-    std::map<WD, fs::path> _watchDescriptors;
+    PathTrie _pathTrie;
 
     /**
-     * @brief file descriptor referring to the inotify instance
+     * @brief The priority to keep the watches if the inotify watches run
+     *        short.
      */
-    utility::FD _inotifyFileDescriptor;
+    config::WatchPriority _watchPriority{config::WatchPriority::Normal};
 
     /**
-     * @brief fdio instance
+     * @brief The scanner of the subtrees which couldn't be watched.
      */
-    std::unique_ptr<sdbusplus::async::fdio> _fdioInstance;
+    PollScanner _pollScanner;
 
     /**
-     * @brief Map of DataOperation
+     * @brief The periodic scan before the pending demotions, restored if the
+     *        reclaim they are made for fails.
      */
-    DataOperations _dataOperations;
+    std::optional<PollScanner> _pollScannerBeforeDemotion;
 
     /**
-     * @brief Map of Cookie and DataOperation to save the inotify event info.
-     *
-     * Eg : The IN_MOVED_FROM info during the rename or move operations can be
-     * saved for map to the corresponding IN_MOVED_TO signals.
+     * @brief The subtrees demoted for the pending reclaim.
      */
-    std::map<Cookie, DataOperation> _movedFromDataOps;
+    std::vector<fs::path> _demotedPaths;
 
     /**
-     * @brief initialize an inotify instance and returns file descriptor
+     * @brief The table of unique watch descriptors associated with an
+     * configured file or directory.
      */
-    int inotifyInit() const;
+    WatchTable _watchDescriptors;
 
     /**
-     * @brief API to convert the inotify event masks to event macros in string
-     *        format.
-     *
-     * @param[in] - eventMask - The mask describing event
-     *
-     * @returns - The event name in string format.
+     * @brief Reusable buffer to build the path of the received events.
+     */
+    std::string _eventPathBuffer;
+
+    /**
+     * @brief Map of DataOperation
      */
-    static std::string eventName(uint32_t eventMask);
+    DataOperations _dataOperations;
+
+    /**
+     * @brief The events per wakeup counters
+     */
+    EventStats _eventStats;
+
+    /**
+     * @brief The IN_MOVED_FROM info of the rename or move operations, saved
+     *        to map the corresponding IN_MOVED_TO events.
+     */
+    RenameCookieTable _renameCookies;
 
     /**
      * @brief API to get the existing parent path of a given path.
@@ -238,9 +385,55 @@ class DataWatcher
      * @param[in] pathToWatch - The path of file/directory to be monitored
      * @param[in] eventMasksToWatch - The set of events for which the path to be
      *                                monitored
+     * @param[in] isDir - Whether the path is a directory, if already known
+     *                    from the event or the directory entry. The path is
+     *                    checked on the filesystem only if not given.
+     */
+    void addToWatchList(const fs::path& pathToWatch, uint32_t eventMasksToWatch,
+                        std::optional<bool> isDir = std::nullopt);
+
+    /**
+     * @brief API to move the given subtree to the periodic scan, replacing
+     *        its watches.
+     *
+     * @param[in] pathToPoll - The absolute path of the subtree
+     */
+    void pollSubtree(const fs::path& pathToPoll);
+
+    /**
+     * @brief API to filter the entries found by the periodic scan using the
+     *        exclude and include lists.
+     *
+     * @param[in] path - The absolute path of the entry
+     *
+     * @returns ScanFilter - How the entry should be scanned
+     */
+    ScanFilter filterPolledPath(std::string_view path) const;
+
+    /**
+     * @brief API to compare two absolute paths lexically, ignoring the
+     *        trailing slash of the directories.
+     *
+     * Used instead of fs::equivalent() to avoid the stat calls while
+     * processing the events.
+     *
+     * @param[in] lhs - The absolute path to compare
+     * @param[in] rhs - The absolute path to compare with
+     *
+     * @returns True if both the paths refer to the same entry.
+     */
+    static bool isSamePath(std::string_view lhs, std::string_view rhs);
+
+    /**
+     * @brief API to check lexically whether an absolute path is the given
+     *        root or inside its tree, comparing whole path components.
+     *
+     * @param[in] path - The absolute path to check
+     * @param[in] root - The absolute path of the root of the tree
+     *
+     * @returns True if the path is the root or under it.
      */
-    void addToWatchList(const fs::path& pathToWatch,
-                        uint32_t eventMasksToWatch);
+    static bool isPathInTree(std::string_view path, std::string_view root);
 
     /**
      * @brief API to check whether the given path is part of exclude list.
@@ -278,10 +471,13 @@ class DataWatcher
     bool isPathParentOfInclude(const fs::path& path);
 
     /**
-     * @brief API to create watchers for the sub directories if the given path
-     * is a directory.
+     * @brief API to create watchers for the sub directories of the given
+     * directory.
      *
-     * @param[in] pathToWatch - The absolute path of directory.
+     * The type of the entries is taken from the directory listing, hence no
+     * stat call is made per entry.
+     *
+     * @param[in] pathToWatch - The absolute path of an existing directory.
      */
     void addSubDirWatches(const fs::path& pathToWatch);
 
@@ -292,14 +488,6 @@ class DataWatcher
      */
     void createWatchers(const std::filesystem::path& pathToWatch);
 
-    /**
-     * @brief API to read the triggered events from inotify structure
-     *
-     * returns : The vector of events read from the buffer
-     *         : std::nullopt , in case of any errors while reading from buffer
-     */
-    std::optional<std::vector<EventInfo>> readEvents();
-
     /**
      * @brief API to trigger processing of the received inotify events.
      *
@@ -322,7 +510,11 @@ class DataWatcher
     std::optional<DataOperation> processEvent(const EventInfo& receivedEvent);
 
     /**
-     * @brief API to handle the received IN_CLOSE_WRITE inotify events
+     * @brief API to handle the received IN_CLOSE_WRITE and IN_MODIFY inotify
+     *        events
+     *
+     * @note Uses the path of the event built in _eventPathBuffer by
+     *       processEvent().
      *
      * @param[in] receivedEventInfo : eventInfo type which has the information
      *                                of received  inotify event.
@@ -360,6 +552,9 @@ class DataWatcher
     /**
      * @brief API to handle the received IN_MOVED_TO inotify events
      *
+     * A rename inside the tree is reported as a single DataOps::MOVE, and
+     * the watches of a renamed directory are moved along.
+     *
      * @param[in] receivedEventInfo : eventInfo type which has the information
      *                                of received  inotify event.
      *
@@ -369,6 +564,46 @@ class DataWatcher
     std::optional<DataOperation>
         processMovedTo(const EventInfo& receivedEventInfo);
 
+    /**
+     * @brief API to move the watches of a renamed directory and its subtree
+     *        to the new path.
+     *
+     * The paths are re-keyed at once without adding the watches again. If
+     * the source isn't watched, Eg: moved in from outside the tree, the
+     * moved directory is watched afresh.
+     *
+     * @param[in] movedFromPath - The path moved from, if known from the
+     *                            IN_MOVED_FROM of the rename
+     * @param[in] movedToPath - The path moved to
+     */
+    void moveWatches(const std::optional<fs::path>& movedFromPath,
+                     const fs::path& movedToPath);
+
+    /**
+     * @brief API to handle the received IN_MOVE_SELF inotify events
+     *
+     * A directory renamed inside the tree is handled upon its IN_MOVED_TO,
+     * hence only the moves out of the tree are handled, by removing the
+     * watches of the moved subtree.
+     *
+     * @param[in] receivedEventInfo : eventInfo type which has the information
+     *                                of received  inotify event.
+     *
+     * @returns DataOperation : If the received event need to handle in rsync
+     *          std::nullopt  : If the received event doesn't need to handle.
+     */
+    std::optional<DataOperation>
+        processMoveSelf(const EventInfo& receivedEventInfo);
+
+    /**
+     * @brief API to remove the watches of a directory and its subtree.
+     *
+     * @param[in] dirPath - The absolute path of the directory
+     * @param[in] keepWd - The watch descriptor to keep, if any
+     */
+    void removeSubtreeWatches(const fs::path& dirPath,
+                              std::optional<WD> keepWd = std::nullopt);
+
     /**
      * @brief API to handle the received IN_DELETE inotify events
      *
@@ -381,6 +616,27 @@ class DataWatcher
     std::optional<DataOperation>
         processDelete(const EventInfo& receivedEventInfo);
 
+    /**
+     * @brief API to recover from the IN_Q_OVERFLOW of the inotify instance.
+     *
+     * The lost events are unknown, hence the watches are rescanned to
+     * monitor the directories created meanwhile and the whole configured
+     * path is reported to sync.
+     *
+     * @returns DataOperation : To sync the configured path.
+     */
+    DataOperation processOverflow();
+
+    /**
+     * @brief API to add the watches for the directories which got created
+     *        without the corresponding event being processed (Eg: lost due
+     *        to IN_Q_OVERFLOW).
+     *
+     * The watches of the existing directories are not affected as adding a
+     * watch again returns the same watch descriptor.
+     */
+    void rescanWatches();
+
     /**
      * @brief API to handle the received IN_DELETE_SELF inotify events
      *
@@ -0,0 +1,403 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dirty_journal.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <ranges>
+
+namespace data_sync::persist
+{
+
+fs::path DirtyJournalFile =
+    "/var/lib/phosphor-data-sync/persistence/dirty_paths.journal";
+
+namespace
+{
+
+constexpr char dirtyRecord = 'D';
+constexpr char cleanRecord = 'C';
+constexpr char timeRecord = 'T';
+
+/**
+ * @brief The clean records kept before the journal gets rewritten with the
+ *        outstanding paths only.
+ */
+constexpr size_t maxCleanRecords = 1024;
+
+int64_t toNs(const struct timespec& time)
+{
+    return (static_cast<int64_t>(time.tv_sec) * 1'000'000'000) + time.tv_nsec;
+}
+
+int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string makeHeader(std::string_view role, uint64_t configHash)
+{
+    return "DSJ2:" + std::string(role) + ':' + std::to_string(configHash) +
+           '\0';
+}
+
+std::string makeRecord(char marker, const std::string& path)
+{
+    std::string record(1, marker);
+    record.append(path);
+    record.push_back('\0');
+    return record;
+}
+
+/**
+ * @brief Get the directory form of a path, with a trailing '/', to find the
+ *        paths under it.
+ */
+std::string asDirectory(const fs::path& path)
+{
+    std::string dir{path.native()};
+    if (!dir.ends_with('/'))
+    {
+        dir.push_back('/');
+    }
+    return dir;
+}
+
+} // namespace
+
+DirtyJournal::DirtyJournal(fs::path journalFile) :
+    _journalFile(std::move(journalFile)), _journalFd(-1)
+{}
+
+std::optional<DirtyState> DirtyJournal::open(std::string_view role,
+                                             uint64_t configHash)
+{
+    _header = makeHeader(role, configHash);
+    _dirtyPaths.clear();
+
+    std::error_code ec;
+    if (!fs::exists(_journalFile, ec))
+    {
+        lg2::info("No dirty path journal found at {FILE}", "FILE",
+                  _journalFile);
+        return std::nullopt;
+    }
+
+    std::ifstream journal(_journalFile, std::ios::binary);
+    std::string content{std::istreambuf_iterator<char>(journal),
+                        std::istreambuf_iterator<char>()};
+
+    // A record cut by a crash while appending makes the journal corrupt, as
+    // the change it was tracking is unknown.
+    bool corrupt = journal.bad() || !content.starts_with(_header) ||
+                   (content.size() > _header.size() && !content.ends_with('\0'));
+    std::string_view records{content};
+    records.remove_prefix(corrupt ? records.size() : _header.size());
+    int64_t lastUpdateNs{0};
+    while (!records.empty())
+    {
+        auto end = records.find('\0');
+        auto marker = records.front();
+        std::string path{records.substr(1, end - 1)};
+        records.remove_prefix(end + 1);
+        if (marker == timeRecord)
+        {
+            auto [ptr, errc] = std::from_chars(
+                path.data(), path.data() + path.size(), lastUpdateNs);
+            corrupt = errc != std::errc() || ptr != path.data() + path.size();
+            if (corrupt)
+            {
+                break;
+            }
+            continue;
+        }
+        if (path.empty() || path.front() != '/' ||
+            (marker != dirtyRecord && marker != cleanRecord))
+        {
+            corrupt = true;
+            break;
+        }
+        if (marker == dirtyRecord)
+        {
+            _dirtyPaths.insert_or_assign(std::move(path), 0);
+        }
+        else
+        {
+            _dirtyPaths.erase(path);
+        }
+    }
+
+    // The change times are compared against the last flush, which is not
+    // possible if the clock went back. Each journal starts with a flush.
+    if (corrupt || lastUpdateNs == 0 || lastUpdateNs > nowNs())
+    {
+        lg2::error("Discarding the dirty path journal {FILE}, Corrupt : "
+                   "{CORRUPT}",
+                   "FILE", _journalFile, "CORRUPT", corrupt);
+        discard();
+        return std::nullopt;
+    }
+
+    _lastUpdateNs = lastUpdateNs;
+    if (!rewrite())
+    {
+        discard();
+        return std::nullopt;
+    }
+
+    DirtyState state;
+    state.lastUpdateNs = lastUpdateNs;
+    for (const auto& path : _dirtyPaths | std::views::keys)
+    {
+        state.paths.emplace_back(path);
+    }
+    return state;
+}
+
+void DirtyJournal::create(std::string_view role, uint64_t configHash)
+{
+    _header = makeHeader(role, configHash);
+    _dirtyPaths.clear();
+    _lastUpdateNs = nowNs();
+    if (!rewrite())
+    {
+        discard();
+    }
+}
+
+void DirtyJournal::discard()
+{
+    _journalFd.reset();
+    _dirtyPaths.clear();
+    _cleanRecords = 0;
+    _flushPending = false;
+    std::error_code ec;
+    fs::remove(_journalFile, ec);
+}
+
+void DirtyJournal::markDirty(const std::vector<fs::path>& paths)
+{
+    ++_sequence;
+    if (!isActive())
+    {
+        return;
+    }
+
+    // The paths already journaled only get their sequence updated.
+    std::string records;
+    for (const auto& path : paths)
+    {
+        auto [dirtyPath, inserted] = _dirtyPaths.insert_or_assign(path.native(),
+                                                                  _sequence);
+        if (inserted)
+        {
+            records.append(makeRecord(dirtyRecord, dirtyPath->first));
+        }
+    }
+    if (!records.empty())
+    {
+        append(records);
+        _flushPending = true;
+    }
+}
+
+void DirtyJournal::flush()
+{
+    if (!isActive() || !_flushPending)
+    {
+        return;
+    }
+
+    // The changes made from now on may not be journaled by this flush.
+    const auto flushNs = nowNs();
+    if (fdatasync(_journalFd()) != 0)
+    {
+        lg2::error("Failed to flush the dirty path journal {FILE}, errno : "
+                   "{ERRNO}",
+                   "FILE", _journalFile, "ERRNO", errno);
+        discard();
+        return;
+    }
+    _flushPending = false;
+    _lastUpdateNs = flushNs;
+
+    // Lost in a crash, the previous time is used, which only finds more
+    // changed paths.
+    append(makeRecord(timeRecord, std::to_string(flushNs)));
+}
+
+void DirtyJournal::markClean(const fs::path& path, uint64_t syncedSequence)
+{
+    std::string file{path.native()};
+    while (file.size() > 1 && file.ends_with('/'))
+    {
+        file.pop_back();
+    }
+    const std::string dir = asDirectory(path);
+
+    std::string records;
+    auto clean = [this, syncedSequence, &records](auto dirtyPath) {
+        if (dirtyPath->second > syncedSequence)
+        {
+            // Changed again while syncing.
+            return std::next(dirtyPath);
+        }
+        records.append(makeRecord(cleanRecord, dirtyPath->first));
+        return _dirtyPaths.erase(dirtyPath);
+    };
+
+    if (auto dirtyPath = _dirtyPaths.find(file); dirtyPath != _dirtyPaths.end())
+    {
+        clean(dirtyPath);
+    }
+    for (auto dirtyPath = _dirtyPaths.lower_bound(dir);
+         dirtyPath != _dirtyPaths.end() && dirtyPath->first.starts_with(dir);)
+    {
+        dirtyPath = clean(dirtyPath);
+    }
+
+    if (records.empty() || !isActive())
+    {
+        return;
+    }
+
+    // A lost clean record only costs a redundant sync after a crash, so it
+    // is not flushed.
+    _cleanRecords += std::ranges::count(records, '\0');
+    if (_cleanRecords > maxCleanRecords &&
+        _cleanRecords > 4 * _dirtyPaths.size())
+    {
+        if (!rewrite())
+        {
+            discard();
+        }
+        return;
+    }
+    append(records);
+}
+
+bool DirtyJournal::rewrite()
+{
+    std::string content{_header};
+    content.append(makeRecord(timeRecord, std::to_string(_lastUpdateNs)));
+    for (const auto& path : _dirtyPaths | std::views::keys)
+    {
+        content.append(makeRecord(dirtyRecord, path));
+    }
+
+    std::error_code ec;
+    fs::create_directories(_journalFile.parent_path(), ec);
+    auto tmpFile = _journalFile;
+    tmpFile += ".tmp";
+    utility::FD tmpFd(::open(tmpFile.c_str(),
+                             O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600));
+    bool written{tmpFd() >= 0};
+    std::string_view pending{content};
+    while (written && !pending.empty())
+    {
+        auto bytes = write(tmpFd(), pending.data(), pending.size());
+        if (bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        written = bytes > 0;
+        if (written)
+        {
+            pending.remove_prefix(static_cast<size_t>(bytes));
+        }
+    }
+    if (!written || fdatasync(tmpFd()) != 0 ||
+        rename(tmpFile.c_str(), _journalFile.c_str()) != 0)
+    {
+        lg2::error("Failed to write the dirty path journal {FILE}, errno : "
+                   "{ERRNO}",
+                   "FILE", _journalFile, "ERRNO", errno);
+        fs::remove(tmpFile, ec);
+        return false;
+    }
+
+    _journalFd = utility::FD(
+        ::open(_journalFile.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC));
+    _cleanRecords = 0;
+    _flushPending = false;
+    return isActive();
+}
+
+void DirtyJournal::append(std::string_view records)
+{
+    while (!records.empty())
+    {
+        auto bytes = write(_journalFd(), records.data(), records.size());
+        if (bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            break;
+        }
+        records.remove_prefix(static_cast<size_t>(bytes));
+    }
+    if (!records.empty())
+    {
+        lg2::error("Failed to append to the dirty path journal {FILE}, "
+                   "errno : {ERRNO}",
+                   "FILE", _journalFile, "ERRNO", errno);
+        discard();
+    }
+}
+
+std::vector<fs::path> findChangedPaths(const fs::path& root, int64_t sinceNs)
+{
+    std::vector<fs::path> changedPaths;
+    auto isChanged = [sinceNs](const fs::path& path, bool& isDir) {
+        struct stat pathStat{};
+        if (lstat(path.c_str(), &pathStat) != 0)
+        {
+            return false;
+        }
+        isDir = S_ISDIR(pathStat.st_mode);
+        return toNs(pathStat.st_ctim) >= sinceNs;
+    };
+
+    bool isDir{false};
+    if (isChanged(root, isDir))
+    {
+        changedPaths.emplace_back(isDir ? fs::path(asDirectory(root)) : root);
+        return changedPaths;
+    }
+    if (!isDir)
+    {
+        return changedPaths;
+    }
+
+    std::error_code ec;
+    for (auto entry = fs::recursive_directory_iterator(
+             root, fs::directory_options::skip_permission_denied, ec);
+         !ec && entry != fs::recursive_directory_iterator();
+         entry.increment(ec))
+    {
+        if (isChanged(entry->path(), isDir))
+        {
+            // The whole directory is synced, including the deleted entries.
+            changedPaths.emplace_back(isDir ? fs::path(asDirectory(
+                                                  entry->path()))
+                                            : entry->path());
+            entry.disable_recursion_pending();
+        }
+    }
+    return changedPaths;
+}
+
+} // namespace data_sync::persist
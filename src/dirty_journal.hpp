@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "utility.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace data_sync::persist
+{
+
+namespace fs = std::filesystem;
+
+extern fs::path DirtyJournalFile;
+
+/**
+ * @brief The state left by the previous run in the DirtyJournal.
+ */
+struct DirtyState
+{
+    /**
+     * @brief The paths changed but not synced yet.
+     */
+    std::vector<fs::path> paths;
+
+    /**
+     * @brief The start of the last flush of the journal in nanoseconds since
+     *        the epoch, the paths changed after it may not be tracked.
+     */
+    int64_t lastUpdateNs = 0;
+};
+
+/** @class DirtyJournal
+ *
+ *  @brief An append-only journal of the changed paths not synced yet, to
+ *         resume the syncs after a restart instead of a full sync.
+ *
+ *  A path is journaled once its change is accepted and until a sync started
+ *  after its last change succeeds. The journal is valid only while all the
+ *  changes got tracked, so it is created once a full sync succeeds and is
+ *  discarded whenever the sync stops or the configuration changes, hence a
+ *  missing journal means a full sync is needed.
+ *
+ *  Each record is the 'D'(dirty) or the 'C'(clean) marker followed by the
+ *  path and a NUL, after a header naming the BMC role and the hash of the
+ *  configuration. The dirty records are flushed to the storage in a batch
+ *  before a sync starts, and each flush is followed by a 'T'(time) record
+ *  with the time it started, after which the changes are looked up by their
+ *  change time.
+ */
+class DirtyJournal
+{
+  public:
+    DirtyJournal(const DirtyJournal&) = delete;
+    DirtyJournal& operator=(const DirtyJournal&) = delete;
+    DirtyJournal(DirtyJournal&&) = delete;
+    DirtyJournal& operator=(DirtyJournal&&) = delete;
+    ~DirtyJournal() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] journalFile - The path of the journal
+     */
+    explicit DirtyJournal(fs::path journalFile);
+
+    /**
+     * @brief Replay the journal left by the previous run and keep journaling
+     *        on top of the outstanding paths.
+     *
+     * @param[in] role - The current BMC role, the journal of another role is
+     *                   not valid
+     * @param[in] configHash - The hash of the current configuration, the
+     *                         journal of another configuration is not valid
+     *
+     * @returns The outstanding state, std::nullopt if the journal is missing,
+     *          corrupt, of another role or configuration or could not be
+     *          reopened, then it is discarded.
+     */
+    std::optional<DirtyState> open(std::string_view role, uint64_t configHash);
+
+    /**
+     * @brief Start a new journal, once all the data is synced.
+     *
+     * @param[in] role - The current BMC role
+     * @param[in] configHash - The hash of the current configuration
+     */
+    void create(std::string_view role, uint64_t configHash);
+
+    /**
+     * @brief Stop journaling and remove the journal, so the next run does a
+     *        full sync.
+     */
+    void discard();
+
+    /**
+     * @brief Journal the changed paths, flushed to the storage by the next
+     *        flush().
+     *
+     * @param[in] paths - The changed paths
+     */
+    void markDirty(const std::vector<fs::path>& paths);
+
+    /**
+     * @brief Flush the dirty records to the storage, to be called before a
+     *        sync sends the changed data.
+     *
+     * The journal is discarded if the records could not be flushed.
+     */
+    void flush();
+
+    /**
+     * @brief Drop a synced path and the paths under it, unless they changed
+     *        after the sync started.
+     *
+     * @param[in] path - The synced path
+     * @param[in] syncedSequence - The sequence() when the sync started
+     */
+    void markClean(const fs::path& path, uint64_t syncedSequence);
+
+    /**
+     * @brief Get the sequence of the last change, to be taken before a sync
+     *        starts reading the data.
+     */
+    uint64_t sequence() const
+    {
+        return _sequence;
+    }
+
+    /**
+     * @brief Whether the changes are being journaled.
+     */
+    bool isActive() const
+    {
+        return _journalFd() >= 0;
+    }
+
+    /**
+     * @brief Get the number of the outstanding paths.
+     */
+    size_t size() const
+    {
+        return _dirtyPaths.size();
+    }
+
+  private:
+    /**
+     * @brief Write the outstanding paths into a new journal, which replaces
+     *        the current one.
+     *
+     * @returns bool - true if the journal got replaced
+     */
+    bool rewrite();
+
+    /**
+     * @brief Append the records, without flushing them.
+     *
+     * The journal is discarded if the records could not be written.
+     *
+     * @param[in] records - The records to append
+     */
+    void append(std::string_view records);
+
+    /**
+     * @brief The path of the journal
+     */
+    fs::path _journalFile;
+
+    /**
+     * @brief The header of the journal, naming the BMC role
+     */
+    std::string _header;
+
+    /**
+     * @brief The journal opened to append, closed if not active
+     */
+    utility::FD _journalFd;
+
+    /**
+     * @brief The outstanding paths, with the sequence of their last change
+     */
+    std::map<std::string, uint64_t, std::less<>> _dirtyPaths;
+
+    /**
+     * @brief The sequence of the last change
+     */
+    uint64_t _sequence = 0;
+
+    /**
+     * @brief The number of the clean records since the last rewrite
+     */
+    size_t _cleanRecords = 0;
+
+    /**
+     * @brief Whether dirty records were appended since the last flush
+     */
+    bool _flushPending = false;
+
+    /**
+     * @brief The time of the last flush in nanoseconds since the epoch,
+     *        kept by a rewrite
+     */
+    int64_t _lastUpdateNs = 0;
+};
+
+/**
+ * @brief Find the paths changed after a time, by their change time.
+ *
+ * A changed directory is reported with a trailing '/' instead of the paths
+ * under it, as its entries may have been deleted.
+ *
+ * @param[in] root - The path to look into
+ * @param[in] sinceNs - The time in nanoseconds since the epoch
+ *
+ * @returns std::vector<fs::path> - The changed paths
+ */
+std::vector<fs::path> findChangedPaths(const fs::path& root, int64_t sinceNs);
+
+} // namespace data_sync::persist
@@ -0,0 +1,484 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "fanotify_watcher.hpp"
+
+#include <fcntl.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstring>
+#include <string>
+
+namespace data_sync::watch::fanotify
+{
+
+namespace
+{
+
+/**
+ * @brief Initialize the fanotify instance which reports the events with the
+ *        directory file handle and the entry name.
+ */
+int fanotifyInit()
+{
+    auto fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK |
+                                FAN_REPORT_DFID_NAME,
+                            O_RDONLY | O_LARGEFILE);
+    if (-1 == fd)
+    {
+        lg2::error("fanotify_init call failed with ErrNo : {ERRNO}, ErrMsg : "
+                   "{ERRMSG}",
+                   "ERRNO", errno, "ERRMSG", strerror(errno));
+        throw std::runtime_error("fanotify_init failed");
+    }
+    return fd;
+}
+
+/**
+ * @brief Pack the filesystem id (fsid_t of statfs or __kernel_fsid_t of the
+ *        event, both are two ints) to use as the map key.
+ */
+template <typename FsId>
+uint64_t fsidKey(const FsId& fsid)
+{
+    static_assert(sizeof(FsId) == sizeof(uint64_t));
+    uint64_t key{0};
+    std::memcpy(&key, &fsid, sizeof(key));
+    return key;
+}
+
+} // namespace
+
+FanotifyMux::FanotifyMux(sdbusplus::async::context& ctx) :
+    _ctx(ctx), _fanotifyFileDescriptor(fanotifyInit()),
+    _fdioInstance(std::make_unique<sdbusplus::async::fdio>(
+        ctx, _fanotifyFileDescriptor())),
+    _eventBuffer(fanotifyReadBufferSize)
+{}
+
+void FanotifyMux::attach(FanotifyWatcher& watcher)
+{
+    if (!std::ranges::contains(_watchers, &watcher))
+    {
+        _watchers.emplace_back(&watcher);
+    }
+}
+
+void FanotifyMux::detach(FanotifyWatcher& watcher)
+{
+    std::erase(_watchers, &watcher);
+}
+
+void FanotifyMux::markFilesystem(const fs::path& path)
+{
+    // The fd is needed on the same filesystem to open the reported file
+    // handles, and the handles of the directories are reported hence use
+    // the directory itself if the path is a file.
+    fs::path dirPath = fs::is_directory(path) ? path : path.parent_path();
+
+    utility::FD mountFd{
+        open(dirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+    if (mountFd() < 0)
+    {
+        throw std::runtime_error("Failed to open " + dirPath.string() +
+                                 ", error: " + strerror(errno));
+    }
+
+    struct statfs fsStat{};
+    if (fstatfs(mountFd(), &fsStat) < 0)
+    {
+        throw std::runtime_error("Failed to statfs " + dirPath.string() +
+                                 ", error: " + strerror(errno));
+    }
+
+    auto fsid = fsidKey(fsStat.f_fsid);
+    if (_mountFds.contains(fsid))
+    {
+        return;
+    }
+
+    if (fanotify_mark(_fanotifyFileDescriptor(),
+                      FAN_MARK_ADD | FAN_MARK_FILESYSTEM, fanotifyEventMasks,
+                      AT_FDCWD, dirPath.c_str()) < 0)
+    {
+        lg2::error("fanotify_mark call failed for {PATH} with ErrNo : "
+                   "{ERRNO}, ErrMsg : {ERRMSG}",
+                   "PATH", dirPath, "ERRNO", errno, "ERRMSG", strerror(errno));
+        throw std::runtime_error("Failed to mark the filesystem");
+    }
+
+    lg2::debug("Marked the filesystem of {PATH} for fanotify events", "PATH",
+               dirPath);
+    _mountFds.emplace(fsid, std::move(mountFd));
+}
+
+void FanotifyMux::startDispatcher()
+{
+    if (_dispatcherRunning)
+    {
+        return;
+    }
+    _dispatcherRunning = true;
+    _ctx.spawn(dispatchEvents());
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> FanotifyMux::dispatchEvents()
+{
+    while (!_ctx.stop_requested() && !_watchers.empty())
+    {
+        // NOLINTNEXTLINE
+        co_await _fdioInstance->next();
+
+        readEvents();
+    }
+    _dispatcherRunning = false;
+    co_return;
+}
+
+std::optional<fs::path>
+    FanotifyMux::resolvePath(const fanotify_event_metadata& metadata)
+{
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* begin = reinterpret_cast<const uint8_t*>(&metadata);
+    const auto* info = begin + metadata.metadata_len;
+    const auto* end = begin + metadata.event_len;
+
+    while (info + sizeof(fanotify_event_info_header) <= end)
+    {
+        const auto* header =
+            reinterpret_cast<const fanotify_event_info_header*>(info);
+        if (header->len == 0)
+        {
+            break;
+        }
+
+        if (header->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME ||
+            header->info_type == FAN_EVENT_INFO_TYPE_DFID)
+        {
+            const auto* fid =
+                reinterpret_cast<const fanotify_event_info_fid*>(info);
+            auto* handle = const_cast<file_handle*>(
+                reinterpret_cast<const file_handle*>(fid->handle));
+
+            // The entry name follows the file handle.
+            const char* name = "";
+            if (header->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME)
+            {
+                name = reinterpret_cast<const char*>(handle->f_handle +
+                                                     handle->handle_bytes);
+            }
+            // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+            // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+            std::string handleKey(reinterpret_cast<const char*>(&fid->fsid),
+                                  sizeof(fid->fsid));
+            handleKey.append(reinterpret_cast<const char*>(handle),
+                             sizeof(file_handle) + handle->handle_bytes);
+            // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+            if (auto cached = _dirPaths.find(handleKey);
+                cached != _dirPaths.end())
+            {
+                return cached->second / name;
+            }
+
+            auto mountFd = _mountFds.find(fsidKey(fid->fsid));
+            if (mountFd == _mountFds.end())
+            {
+                return std::nullopt;
+            }
+
+            utility::FD dirFd{
+                open_by_handle_at(mountFd->second(), handle, O_PATH)};
+            if (dirFd() < 0)
+            {
+                // Eg : ESTALE as the directory is already removed.
+                lg2::debug("Failed to open the reported directory handle, "
+                           "error: {ERROR}",
+                           "ERROR", strerror(errno));
+                return std::nullopt;
+            }
+
+            std::array<char, PATH_MAX> dirPath{};
+            auto procPath = "/proc/self/fd/" + std::to_string(dirFd());
+            auto len = readlink(procPath.c_str(), dirPath.data(),
+                                dirPath.size() - 1);
+            if (len < 0)
+            {
+                return std::nullopt;
+            }
+
+            if (_dirPaths.size() >= dirPathCacheSize)
+            {
+                _dirPaths.clear();
+            }
+            auto& resolved =
+                _dirPaths
+                    .emplace(std::move(handleKey),
+                             fs::path(std::string(dirPath.data(), len)))
+                    .first->second;
+            return resolved / name;
+        }
+        info += header->len;
+    }
+    return std::nullopt;
+}
+
+void FanotifyMux::invalidateDirPaths(const fs::path& dirPath)
+{
+    const auto dirPrefix = (dirPath / "").native();
+    std::erase_if(_dirPaths, [&dirPrefix](const auto& entry) {
+        return (entry.second / "").native().starts_with(dirPrefix);
+    });
+}
+
+void FanotifyMux::readEvents()
+{
+    std::vector<EventInfo> receivedEvents{};
+    while (true)
+    {
+        auto bytes = read(_fanotifyFileDescriptor(), _eventBuffer.data(),
+                          _eventBuffer.size());
+        if (0 > bytes)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                lg2::error("Failed to read fanotify event, error: {ERROR}",
+                           "ERROR", strerror(errno));
+            }
+            break;
+        }
+
+        // NOLINTNEXTLINE to avoid cppcoreguidelines-pro-type-reinterpret-cast
+        auto* metadata = reinterpret_cast<fanotify_event_metadata*>(
+            _eventBuffer.data());
+        for (; FAN_EVENT_OK(metadata, bytes);
+             metadata = FAN_EVENT_NEXT(metadata, bytes))
+        {
+            if (metadata->vers != FANOTIFY_METADATA_VERSION)
+            {
+                lg2::error("Mismatch of the fanotify metadata version");
+                continue;
+            }
+            if ((metadata->mask & FAN_Q_OVERFLOW) != 0)
+            {
+                // Not specific to a path, let all the watchers recover.
+                lg2::error("The fanotify event queue overflowed, events are "
+                           "lost");
+                _eventStats.overflows++;
+                _dirPaths.clear();
+                receivedEvents.emplace_back(metadata->mask, fs::path{});
+                continue;
+            }
+
+            if (auto path = resolvePath(*metadata); path.has_value())
+            {
+                // The handle of a directory stays the same across renames,
+                // hence the cached path of it and of its sub directories
+                // gets stale.
+                if ((metadata->mask & FAN_ONDIR) != 0 &&
+                    (metadata->mask & (FAN_DELETE | FAN_MOVED_FROM)) != 0)
+                {
+                    invalidateDirPaths(path.value());
+                }
+                receivedEvents.emplace_back(metadata->mask,
+                                            std::move(path.value()));
+            }
+        }
+    }
+
+    _eventStats.update(receivedEvents.size());
+    lg2::debug("Read [{COUNT}] fanotify events in a wakeup", "COUNT",
+               receivedEvents.size());
+
+    // Copy as a watcher could get detached while processing the events.
+    auto watchers = _watchers;
+    for (auto* watcher : watchers)
+    {
+        if (std::ranges::contains(_watchers, watcher))
+        {
+            watcher->handleEvents(receivedEvents);
+        }
+    }
+}
+
+FanotifyWatcher::FanotifyWatcher(
+    FanotifyMux& fanotifyMux, DataChangeCallback callback,
+    const fs::path& dataPathToWatch, bool isPathDir,
+    std::optional<std::unordered_set<fs::path>> excludeList,
+    std::optional<std::unordered_set<fs::path>> includeList) :
+    _fanotifyMux(fanotifyMux), _dataChangeCallback(std::move(callback)),
+    _dataPathToWatch(isPathDir ? dataPathToWatch / "" : dataPathToWatch),
+    _pathTrie(excludeList, includeList)
+{
+    // Mark the nearest existing path, the whole filesystem is monitored
+    // anyway hence the configured path gets reported once it is created.
+    fs::path existingPath = _dataPathToWatch;
+    while (!existingPath.empty() && !fs::exists(existingPath))
+    {
+        existingPath = existingPath.parent_path();
+    }
+    if (existingPath.empty())
+    {
+        throw std::runtime_error("No existing path found to monitor");
+    }
+
+    _fanotifyMux.markFilesystem(existingPath);
+    _fanotifyMux.attach(*this);
+    _fanotifyMux.startDispatcher();
+}
+
+FanotifyWatcher::~FanotifyWatcher()
+{
+    _fanotifyMux.detach(*this);
+}
+
+void FanotifyWatcher::stop()
+{
+    lg2::debug("Stopping FanotifyWatcher for [{PATH}]", "PATH",
+               _dataPathToWatch);
+    _stopped = true;
+    _fanotifyMux.detach(*this);
+}
+
+std::vector<fs::path> FanotifyWatcher::getWatchingPaths() const
+{
+    if (_stopped)
+    {
+        return {};
+    }
+    return {_dataPathToWatch};
+}
+
+bool FanotifyWatcher::isPathInScope(const fs::path& path) const
+{
+    // Directories end with a trailing slash, hence check for the children.
+    // Files need the exact match.
+    if (_dataPathToWatch.filename().empty()
+            ? !path.native().starts_with(_dataPathToWatch.native())
+            : path != _dataPathToWatch)
+    {
+        return false;
+    }
+
+    auto match = _pathTrie.match(path.native());
+    if (match.excluded)
+    {
+        lg2::debug("{PATH} is in exclude list. Hence skipping", "PATH", path);
+        return false;
+    }
+    return !_pathTrie.hasIncludes() || match.included;
+}
+
+std::optional<DataOperation>
+    FanotifyWatcher::processEvent(const EventInfo& receivedEvent)
+{
+    const auto& [mask, eventPath] = receivedEvent;
+    if ((mask & FAN_Q_OVERFLOW) != 0)
+    {
+        // The lost events are unknown, hence sync the whole configured path.
+        _eventStats.overflows++;
+        lg2::warning("Events of {PATH} are lost, syncing the whole path",
+                     "PATH", _dataPathToWatch);
+        return DataOperation{_dataPathToWatch, DataOps::COPY};
+    }
+
+    bool isHidden = eventPath.filename().string().starts_with(".");
+
+    // Directories are synced with a trailing slash to sync the contents.
+    fs::path path = (mask & FAN_ONDIR) != 0 ? eventPath / "" : eventPath;
+
+    if ((mask & FAN_MOVED_FROM) != 0 && isHidden)
+    {
+        // Saved to skip the following rename of the rsync temporary file.
+        _hiddenMovedFromDir = eventPath.parent_path();
+        return std::nullopt;
+    }
+
+    if (isHidden || !isPathInScope(path))
+    {
+        return std::nullopt;
+    }
+
+    if ((mask & (FAN_MOVED_FROM | FAN_DELETE)) != 0)
+    {
+        // The events of the same entry get merged in the queue, so a
+        // removal can come along with the write or the creation which
+        // preceded or followed it. The removal wins unless the entry got
+        // created again.
+        std::error_code ec;
+        if (!fs::exists(fs::symlink_status(eventPath, ec)))
+        {
+            // No watch per sub directory, hence the deleted directories are
+            // reported here as well.
+            return DataOperation{path, DataOps::DELETE};
+        }
+        if ((mask & (FAN_CLOSE_WRITE | FAN_CREATE | FAN_MOVED_TO)) == 0)
+        {
+            return std::nullopt;
+        }
+    }
+
+    if ((mask & FAN_CLOSE_WRITE) != 0)
+    {
+        return DataOperation{path, DataOps::COPY};
+    }
+    else if ((mask & (FAN_CREATE | FAN_ONDIR)) == (FAN_CREATE | FAN_ONDIR))
+    {
+        // Files are handled upon FAN_CLOSE_WRITE.
+        return DataOperation{path, DataOps::COPY};
+    }
+    else if ((mask & FAN_MOVED_TO) != 0)
+    {
+        if (_hiddenMovedFromDir.has_value() &&
+            _hiddenMovedFromDir.value() == eventPath.parent_path())
+        {
+            lg2::debug("Ignoring the FAN_MOVED_TO for {PATH} as update is "
+                       "done by RSYNC",
+                       "PATH", path);
+            _hiddenMovedFromDir.reset();
+            return std::nullopt;
+        }
+        return DataOperation{path, DataOps::COPY};
+    }
+    return std::nullopt;
+}
+
+void FanotifyWatcher::handleEvents(const std::vector<EventInfo>& receivedEvents)
+{
+    if (_stopped)
+    {
+        return;
+    }
+
+    DataOperations dataOperations;
+    size_t eventsCount = 0;
+    for (const auto& event : receivedEvents)
+    {
+        auto dataOperation = processEvent(event);
+        // Only the rename of the hidden file can follow its FAN_MOVED_FROM
+        if ((std::get<EventMask>(event) & FAN_MOVED_FROM) == 0)
+        {
+            _hiddenMovedFromDir.reset();
+        }
+        if (dataOperation.has_value())
+        {
+            dataOperations.emplace_back(std::move(dataOperation.value()));
+            ++eventsCount;
+        }
+    }
+
+    if (eventsCount == 0)
+    {
+        return;
+    }
+    _eventStats.update(eventsCount);
+    _dataChangeCallback(dataOperations);
+}
+
+} // namespace data_sync::watch::fanotify
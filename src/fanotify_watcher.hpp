@@ -0,0 +1,385 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "path_trie.hpp"
+#include "utility.hpp"
+#include "watcher.hpp"
+
+#include <sys/fanotify.h>
+
+#include <sdbusplus/async.hpp>
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace data_sync::watch::fanotify
+{
+
+namespace fs = std::filesystem;
+namespace utility = data_sync::utility;
+
+/**
+ * @brief A tuple which has the info related to the occured fanotify event
+ *
+ * uint64_t - Mask describing event
+ * fs::path - The absolute path of the object, resolved from the reported
+ *            directory file handle and the entry name
+ */
+using EventMask = uint64_t;
+using EventInfo = std::tuple<EventMask, fs::path>;
+
+/**
+ * @brief The set of events monitored on the marked filesystems.
+ */
+constexpr EventMask fanotifyEventMasks = FAN_CLOSE_WRITE | FAN_CREATE |
+                                         FAN_DELETE | FAN_MOVED_FROM |
+                                         FAN_MOVED_TO | FAN_ONDIR;
+
+/**
+ * @brief Size of the reusable buffer used to drain the fanotify queue.
+ */
+constexpr size_t fanotifyReadBufferSize = 64 * 1024;
+
+/**
+ * @brief Maximum number of the resolved directory handles kept in the cache.
+ */
+constexpr size_t dirPathCacheSize = 1024;
+
+class FanotifyWatcher;
+
+/** @class FanotifyMux
+ *
+ *  @brief Monitors whole filesystems using one fanotify instance and hands
+ *         over the events to the attached FanotifyWatchers.
+ *
+ *  The filesystem of each configured path is marked only once using
+ *  FAN_MARK_FILESYSTEM, so the number of marks doesn't depend on the depth
+ *  of the directory trees. The events are reported with the file handle of
+ *  the parent directory and the entry name (FAN_REPORT_DFID_NAME), which is
+ *  resolved to an absolute path.
+ *
+ *  @note Requires CAP_SYS_ADMIN and a kernel supporting FAN_REPORT_DFID_NAME,
+ *        the constructor throws if the capability is missing.
+ */
+class FanotifyMux
+{
+  public:
+    FanotifyMux(const FanotifyMux&) = delete;
+    FanotifyMux& operator=(const FanotifyMux&) = delete;
+    FanotifyMux(FanotifyMux&&) = delete;
+    FanotifyMux& operator=(FanotifyMux&&) = delete;
+    ~FanotifyMux() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * Create the fanotify instance and register it with the event loop.
+     *
+     * @param[in] ctx - The async context object
+     *
+     * @throws std::runtime_error if fanotify is not supported or permitted.
+     */
+    explicit FanotifyMux(sdbusplus::async::context& ctx);
+
+    /**
+     * @brief Register a watcher to receive the events.
+     *
+     * @param[in] watcher - The watcher to register
+     */
+    void attach(FanotifyWatcher& watcher);
+
+    /**
+     * @brief Unregister a watcher.
+     *
+     * @param[in] watcher - The watcher to unregister
+     */
+    void detach(FanotifyWatcher& watcher);
+
+    /**
+     * @brief Mark the filesystem which holds the given path, if it is not
+     *        marked already.
+     *
+     * @param[in] path - The existing path on the filesystem to monitor
+     *
+     * @throws std::runtime_error if the filesystem cannot be marked (Eg: the
+     *         filesystem doesn't support file handles).
+     */
+    void markFilesystem(const fs::path& path);
+
+    /**
+     * @brief Spawn the coroutine which drains the fanotify instance and
+     *        dispatches the events, if it is not already running.
+     */
+    void startDispatcher();
+
+    /**
+     * @brief Get the events per wakeup counters of the fanotify instance.
+     */
+    const EventStats& getEventStats() const
+    {
+        return _eventStats;
+    }
+
+    /**
+     * @brief Get the number of the marked filesystems.
+     */
+    size_t getMarksCount() const
+    {
+        return _mountFds.size();
+    }
+
+  private:
+    /**
+     * @brief The coroutine which keeps dispatching the events as long as
+     *        any watcher is attached.
+     */
+    sdbusplus::async::task<> dispatchEvents();
+
+    /**
+     * @brief Drain the fanotify queue and hand over the events to the
+     *        attached watchers.
+     */
+    void readEvents();
+
+    /**
+     * @brief Resolve the path of the object reported by an event.
+     *
+     * @param[in] metadata - The metadata of the received event
+     *
+     * @returns The absolute path of the object, std::nullopt if it cannot
+     *          be resolved (Eg: the parent directory is already removed).
+     */
+    std::optional<fs::path>
+        resolvePath(const fanotify_event_metadata& metadata);
+
+    /**
+     * @brief Forget the cached paths of a removed or renamed directory and
+     *        of its sub directories.
+     *
+     * @param[in] dirPath - The path the directory had
+     */
+    void invalidateDirPaths(const fs::path& dirPath);
+
+    /**
+     * @brief The async context object
+     */
+    sdbusplus::async::context& _ctx;
+
+    /**
+     * @brief file descriptor referring to the fanotify instance
+     */
+    utility::FD _fanotifyFileDescriptor;
+
+    /**
+     * @brief fdio instance
+     */
+    std::unique_ptr<sdbusplus::async::fdio> _fdioInstance;
+
+    /**
+     * @brief Reusable buffer to read the queued fanotify events in bulk.
+     */
+    std::vector<uint8_t> _eventBuffer;
+
+    /**
+     * @brief The fsid → fd map of the marked filesystems, the fd is used to
+     *        open the reported file handles.
+     */
+    std::map<uint64_t, utility::FD> _mountFds;
+
+    /**
+     * @brief The paths of the reported directory handles, keyed by the fsid
+     *        and the file handle, to avoid opening and resolving the same
+     *        directory upon each event.
+     */
+    std::unordered_map<std::string, fs::path> _dirPaths;
+
+    /**
+     * @brief The attached watchers
+     */
+    std::vector<FanotifyWatcher*> _watchers;
+
+    /**
+     * @brief Whether the dispatcher coroutine is running
+     */
+    bool _dispatcherRunning = false;
+
+    /**
+     * @brief The events per wakeup counters
+     */
+    EventStats _eventStats;
+};
+
+/** @class FanotifyWatcher
+ *
+ *  @brief Reports the data operations of a configured path from the events
+ *         of the whole filesystem received through FanotifyMux.
+ *
+ *  Since the whole filesystem is monitored, no per directory watch is
+ *  needed and the configured path is reported as soon as it gets created.
+ */
+class FanotifyWatcher : public Watcher
+{
+  public:
+    /**
+     * @brief Constructor
+     *
+     *  @param[in] fanotifyMux - The shared fanotify instance
+     *  @param[in] callback - The callback to invoke upon data operations
+     *  @param[in] dataPathToWatch - The absolute path to be monitored
+     *  @param[in] isPathDir - Whether the configured path is a directory
+     *  @param[in] excludeList - The list of paths to be excluded from
+     *                           monitoring
+     *  @param[in] includeList - The list of paths should be included while
+     *                           monitoring
+     *
+     * @throws std::runtime_error if the filesystem cannot be marked.
+     */
+    FanotifyWatcher(
+        FanotifyMux& fanotifyMux, DataChangeCallback callback,
+        const fs::path& dataPathToWatch, bool isPathDir,
+        std::optional<std::unordered_set<fs::path>> excludeList = std::nullopt,
+        std::optional<std::unordered_set<fs::path>> includeList = std::nullopt);
+
+    /**
+     * @brief Destructor
+     * Unregister from the fanotify instance.
+     */
+    ~FanotifyWatcher() override;
+
+    /**
+     * @brief Stop reporting the data operations.
+     */
+    void stop() override;
+
+    /**
+     * @brief Get the monitored path.
+     *
+     * @returns std::vector<fs::path> - The configured path, empty once
+     *                                  stopped
+     */
+    std::vector<fs::path> getWatchingPaths() const override;
+
+    /**
+     * @brief Get the events per wakeup counters of this watcher.
+     *
+     * @returns const EventStats& - The accumulated event counters
+     */
+    const EventStats& getEventStats() const override
+    {
+        return _eventStats;
+    }
+
+    /**
+     * @brief Get the approximate memory used to track the monitored path.
+     *
+     * No per directory state is kept, only the configured path.
+     *
+     * @returns size_t - The memory in bytes
+     */
+    size_t getMemoryUsage() const override
+    {
+        return sizeof(*this) + _dataPathToWatch.native().capacity();
+    }
+
+    /**
+     * @brief Get the number of the renames awaiting their FAN_MOVED_TO.
+     *
+     * Only the last hidden FAN_MOVED_FROM is kept, as both the events of a
+     * rename are queued together.
+     *
+     * @returns size_t - The number of the pending renames
+     */
+    size_t getPendingRenamesCount() const override
+    {
+        return _hiddenMovedFromDir.has_value() ? 1 : 0;
+    }
+
+    /**
+     * @brief Get the polled paths, none as a fanotify mark never runs short.
+     *
+     * @returns std::vector<fs::path> - Always empty
+     */
+    std::vector<fs::path> getPolledPaths() const override
+    {
+        return {};
+    }
+
+    /**
+     * @brief API to process the batch of events which the fanotify instance
+     *        read on a wakeup.
+     *
+     * @param[in] receivedEvents - The events received on the filesystem
+     */
+    void handleEvents(const std::vector<EventInfo>& receivedEvents);
+
+  private:
+    /**
+     * @brief API to check whether the given path is under the configured
+     *        path and not filtered out by the exclude/include list.
+     *
+     * @param[in] path - The normalized absolute path of the data
+     *
+     * @returns True if the data operations of the path need to be reported.
+     */
+    bool isPathInScope(const fs::path& path) const;
+
+    /**
+     * @brief API to determine the operation to perform for an event.
+     *
+     * @param[in] receivedEvent - The received fanotify event
+     *
+     * @returns DataOperation : If the received event need to handle in rsync
+     *          std::nullopt  : If the received event doesn't need to handle.
+     */
+    std::optional<DataOperation> processEvent(const EventInfo& receivedEvent);
+
+    /**
+     * @brief The shared fanotify instance
+     */
+    FanotifyMux& _fanotifyMux;
+
+    /**
+     * @brief The callback to hand over the data operations
+     */
+    DataChangeCallback _dataChangeCallback;
+
+    /**
+     * @brief The file or directory path to be monitored, directories end
+     *        with a trailing slash.
+     */
+    const fs::path _dataPathToWatch;
+
+    /**
+     * @brief The exclude and include lists compiled for the matching.
+     */
+    PathTrie _pathTrie;
+
+    /**
+     * @brief The directory of the last hidden FAN_MOVED_FROM, used to skip
+     *        the rename of the rsync temporary files.
+     *
+     * fanotify doesn't report the rename cookie, but both the events of a
+     * rename are queued together.
+     */
+    std::optional<fs::path> _hiddenMovedFromDir;
+
+    /**
+     * @brief Whether the watcher is stopped
+     */
+    bool _stopped = false;
+
+    /**
+     * @brief The events per wakeup counters
+     */
+    EventStats _eventStats;
+};
+
+} // namespace data_sync::watch::fanotify
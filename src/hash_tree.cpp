@@ -0,0 +1,416 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hash_tree.hpp"
+
+#include "content_cache.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace data_sync::sync
+{
+
+namespace
+{
+
+template <typename T>
+void put(std::string& data, T value)
+{
+    if constexpr (std::endian::native == std::endian::little && sizeof(T) > 1)
+    {
+        value = std::byteswap(value);
+    }
+    data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T get(std::string_view data, size_t& offset)
+{
+    if (data.size() - offset < sizeof(T))
+    {
+        throw std::runtime_error("Truncated hash tree level");
+    }
+    T value{};
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    if constexpr (std::endian::native == std::endian::little && sizeof(T) > 1)
+    {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+/**
+ * @brief Strip the trailing '/' of a path, except of the root directory.
+ */
+std::string withoutTrailingSlash(std::string path)
+{
+    while (path.size() > 1 && path.ends_with('/'))
+    {
+        path.pop_back();
+    }
+    return path;
+}
+
+/**
+ * @brief The metadata hashed along with each path.
+ */
+void putAttributes(std::string& data, const struct stat& pathStat)
+{
+    put(data, static_cast<uint32_t>(pathStat.st_mode & 07777));
+    put(data, static_cast<uint32_t>(pathStat.st_uid));
+    put(data, static_cast<uint32_t>(pathStat.st_gid));
+}
+
+} // namespace
+
+std::string encodeLevel(const TreeLevel& level)
+{
+    std::string data;
+    put(data, static_cast<uint8_t>(level.isDir));
+    put(data, level.hash);
+    put(data, static_cast<uint32_t>(level.children.size()));
+    for (const auto& child : level.children)
+    {
+        put(data, static_cast<uint8_t>(child.isDir));
+        put(data, child.hash);
+        put(data, static_cast<uint32_t>(child.name.size()));
+        data.append(child.name);
+    }
+    return data;
+}
+
+TreeLevel decodeLevel(std::string_view data)
+{
+    size_t offset = 0;
+    TreeLevel level;
+    level.isDir = get<uint8_t>(data, offset) != 0;
+    level.hash = get<uint64_t>(data, offset);
+    auto count = get<uint32_t>(data, offset);
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        TreeEntry child;
+        child.isDir = get<uint8_t>(data, offset) != 0;
+        child.hash = get<uint64_t>(data, offset);
+        auto nameSize = get<uint32_t>(data, offset);
+        if (data.size() - offset < nameSize)
+        {
+            throw std::runtime_error("Truncated hash tree level");
+        }
+        child.name = data.substr(offset, nameSize);
+        offset += nameSize;
+        level.children.emplace_back(std::move(child));
+    }
+    if (offset != data.size())
+    {
+        throw std::runtime_error("Trailing data in hash tree level");
+    }
+    return level;
+}
+
+HashTree::HashTree(fs::path root, const std::vector<fs::path>& excludes) :
+    _root(withoutTrailingSlash(root.lexically_normal().native()))
+{
+    for (const auto& exclude : excludes)
+    {
+        _excludes.emplace(withoutTrailingSlash(exclude.lexically_normal()));
+    }
+}
+
+std::optional<std::string> HashTree::normalize(const fs::path& path) const
+{
+    auto normalized = withoutTrailingSlash(path.lexically_normal().native());
+    if (normalized == _root.native() ||
+        (normalized.starts_with(_root.native()) &&
+         (_root.native() == "/" || normalized[_root.native().size()] == '/')))
+    {
+        return normalized;
+    }
+    return std::nullopt;
+}
+
+std::optional<TreeLevel> HashTree::level(const fs::path& path)
+{
+    auto normalized = normalize(path);
+    if (!normalized)
+    {
+        return std::nullopt;
+    }
+    const auto* node = getNode(*normalized);
+    if (node == nullptr)
+    {
+        return std::nullopt;
+    }
+    return TreeLevel{node->isDir, node->hash, node->children};
+}
+
+const HashTree::Node* HashTree::getNode(const std::string& path)
+{
+    if (auto cached = _nodes.find(path); cached != _nodes.end())
+    {
+        return &cached->second;
+    }
+    if (_excludes.contains(path))
+    {
+        return nullptr;
+    }
+
+    struct stat pathStat{};
+    if (lstat(path.c_str(), &pathStat) != 0 ||
+        (!S_ISREG(pathStat.st_mode) && !S_ISDIR(pathStat.st_mode)))
+    {
+        return nullptr;
+    }
+
+    Node node;
+    node.isDir = S_ISDIR(pathStat.st_mode);
+    std::string hashed;
+    if (!node.isDir)
+    {
+        put(hashed, 'f');
+        put(hashed, static_cast<uint64_t>(pathStat.st_size));
+        put(hashed, static_cast<int64_t>(pathStat.st_mtim.tv_sec));
+        put(hashed, static_cast<int64_t>(pathStat.st_mtim.tv_nsec));
+        putAttributes(hashed, pathStat);
+        node.hash = hashContent(hashed);
+        return &_nodes.insert_or_assign(path, std::move(node)).first->second;
+    }
+
+    // The modification time of a directory changes along with its entries,
+    // which are hashed instead.
+    put(hashed, 'd');
+    putAttributes(hashed, pathStat);
+
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (auto entry = fs::directory_iterator(path, ec);
+         !ec && entry != fs::directory_iterator(); entry.increment(ec))
+    {
+        names.emplace_back(entry->path().filename());
+    }
+    std::ranges::sort(names);
+
+    const std::string dir = path == "/" ? path : path + '/';
+    for (auto& name : names)
+    {
+        const auto* child = getNode(dir + name);
+        if (child == nullptr)
+        {
+            continue;
+        }
+        put(hashed, static_cast<uint32_t>(name.size()));
+        hashed.append(name);
+        put(hashed, static_cast<uint8_t>(child->isDir));
+        put(hashed, child->hash);
+        node.children.emplace_back(
+            TreeEntry{std::move(name), child->isDir, child->hash});
+    }
+    node.hash = hashContent(hashed);
+    return &_nodes.insert_or_assign(path, std::move(node)).first->second;
+}
+
+HashTree::HashWalk HashTree::startWalk(const fs::path& path) const
+{
+    HashWalk walk;
+    if (auto normalized = normalize(path))
+    {
+        walk.pending.emplace_back(std::move(*normalized), false);
+    }
+    return walk;
+}
+
+bool HashTree::hashStep(HashWalk& walk, size_t maxEntries)
+{
+    size_t entries{0};
+    while (!walk.pending.empty() && entries < maxEntries)
+    {
+        auto& [path, queued] = walk.pending.back();
+        if (_nodes.contains(path) || _excludes.contains(path))
+        {
+            walk.pending.pop_back();
+            continue;
+        }
+        if (queued)
+        {
+            // The subdirectories are cached by now, so only the files of
+            // the directory get read.
+            const std::string dir = std::move(path);
+            walk.pending.pop_back();
+            getNode(dir);
+            continue;
+        }
+
+        // The types come along with the entries, without reading each.
+        queued = true;
+        const std::string dir = path == "/" ? path : path + '/';
+        std::vector<std::string> subDirs;
+        std::error_code ec;
+        for (auto entry = fs::directory_iterator(path, ec);
+             !ec && entry != fs::directory_iterator(); entry.increment(ec))
+        {
+            ++entries;
+            std::error_code typeEc;
+            if (entry->symlink_status(typeEc).type() == fs::file_type::directory)
+            {
+                subDirs.emplace_back(dir + entry->path().filename().native());
+            }
+        }
+        for (auto& subDir : subDirs)
+        {
+            walk.pending.emplace_back(std::move(subDir), false);
+        }
+    }
+    return walk.pending.empty();
+}
+
+void HashTree::invalidate(const fs::path& path)
+{
+    auto normalized = normalize(path);
+    if (!normalized)
+    {
+        return;
+    }
+
+    const std::string dir = *normalized == "/" ? *normalized
+                                               : *normalized + '/';
+    auto first = _nodes.lower_bound(dir);
+    auto last = first;
+    while (last != _nodes.end() && last->first.starts_with(dir))
+    {
+        ++last;
+    }
+    _nodes.erase(first, last);
+
+    for (fs::path parent{*normalized};; parent = parent.parent_path())
+    {
+        _nodes.erase(parent.native());
+        if (parent.native() == _root.native() || !parent.has_relative_path())
+        {
+            break;
+        }
+    }
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<std::vector<fs::path>>
+    findDifferingPaths(HashTree& localTree, transfer::TransferClient& client,
+                       const fs::path& remoteRoot)
+{
+    const auto& root = localTree.root();
+    auto toRemotePath = [&root, &remoteRoot](const fs::path& path) {
+        return path == root ? remoteRoot
+                            : remoteRoot / path.lexically_relative(root);
+    };
+    auto asDiffering = [](const fs::path& path, bool isDir) {
+        return isDir ? path / "" : path;
+    };
+
+    std::vector<fs::path> differingPaths;
+    std::vector<fs::path> pendingPaths{root};
+    while (!pendingPaths.empty())
+    {
+        std::vector<fs::path> remotePaths;
+        for (const auto& path : pendingPaths)
+        {
+            remotePaths.emplace_back(toRemotePath(path));
+        }
+        // NOLINTNEXTLINE
+        auto answers = co_await client.query(remotePaths);
+        if (answers.size() != pendingPaths.size())
+        {
+            throw std::runtime_error("Missing hash tree levels");
+        }
+
+        std::vector<fs::path> nextPaths;
+        for (size_t index = 0; index < pendingPaths.size(); ++index)
+        {
+            const auto& path = pendingPaths[index];
+            auto local = localTree.level(path);
+            std::optional<TreeLevel> remote;
+            if (answers[index])
+            {
+                remote = decodeLevel(*answers[index]);
+            }
+
+            if (!local && !remote)
+            {
+                continue;
+            }
+            if (local && remote && local->isDir == remote->isDir &&
+                local->hash == remote->hash)
+            {
+                continue;
+            }
+            // A missing path is deleted on the sibling by rsync.
+            if (!local || !remote || local->isDir != remote->isDir ||
+                !local->isDir)
+            {
+                differingPaths.emplace_back(
+                    asDiffering(path, local && local->isDir));
+                continue;
+            }
+
+            // The entries of both are sorted by name.
+            bool syncWhole{false};
+            std::vector<fs::path> differingChildren;
+            std::vector<fs::path> nextChildren;
+            auto remoteChild = remote->children.cbegin();
+            for (const auto& localChild : local->children)
+            {
+                while (remoteChild != remote->children.cend() &&
+                       remoteChild->name < localChild.name)
+                {
+                    // Only on the sibling, to be deleted.
+                    syncWhole = true;
+                    ++remoteChild;
+                }
+                const auto childPath = path / localChild.name;
+                if (remoteChild == remote->children.cend() ||
+                    remoteChild->name != localChild.name)
+                {
+                    differingChildren.emplace_back(
+                        asDiffering(childPath, localChild.isDir));
+                    continue;
+                }
+                if (remoteChild->isDir != localChild.isDir)
+                {
+                    syncWhole = true;
+                }
+                else if (remoteChild->hash != localChild.hash &&
+                         localChild.isDir)
+                {
+                    nextChildren.emplace_back(childPath);
+                }
+                else if (remoteChild->hash != localChild.hash)
+                {
+                    differingChildren.emplace_back(childPath);
+                }
+                ++remoteChild;
+            }
+            syncWhole = syncWhole || remoteChild != remote->children.cend();
+
+            // Only the attributes of the directory itself differ.
+            if (differingChildren.empty() && nextChildren.empty())
+            {
+                syncWhole = true;
+            }
+            if (syncWhole)
+            {
+                differingPaths.emplace_back(asDiffering(path, true));
+                continue;
+            }
+            std::ranges::move(differingChildren,
+                              std::back_inserter(differingPaths));
+            std::ranges::move(nextChildren, std::back_inserter(nextPaths));
+        }
+        pendingPaths = std::move(nextPaths);
+    }
+    co_return differingPaths;
+}
+
+} // namespace data_sync::sync
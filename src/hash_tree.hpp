@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "native_transfer.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace data_sync::sync
+{
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief An entry of a directory in the HashTree.
+ */
+struct TreeEntry
+{
+    std::string name;
+    bool isDir = false;
+    uint64_t hash = 0;
+
+    bool operator==(const TreeEntry&) const = default;
+};
+
+/**
+ * @brief A path of the HashTree along with its entries, the unit exchanged
+ *        with the sibling BMC.
+ */
+struct TreeLevel
+{
+    bool isDir = false;
+    uint64_t hash = 0;
+
+    /**
+     * @brief The entries of a directory, sorted by name.
+     */
+    std::vector<TreeEntry> children;
+
+    bool operator==(const TreeLevel&) const = default;
+};
+
+/**
+ * @brief Serialize a level to exchange it with the sibling BMC.
+ *
+ * @param[in] level - The level to serialize
+ *
+ * @returns std::string - The serialized level
+ */
+std::string encodeLevel(const TreeLevel& level);
+
+/**
+ * @brief Deserialize a level received from the sibling BMC.
+ *
+ * @param[in] data - The serialized level
+ *
+ * @returns TreeLevel - The level
+ *
+ * @throw std::runtime_error - If the data is malformed
+ */
+TreeLevel decodeLevel(std::string_view data);
+
+/** @class HashTree
+ *
+ *  @brief A hash tree of a configured path, to find the paths differing from
+ *         the sibling BMC without walking both the trees entirely.
+ *
+ *  Only the regular files and the directories are part of it, the same as
+ *  what rsync syncs. The hash of a file covers the metadata compared by the
+ *  quick check of rsync (size and modification time, in nanoseconds)
+ *  instead of its contents, and the hash of a directory covers its entries.
+ *  Both cover the permissions and the owner too, as rsync syncs them.
+ *
+ *  The hashes are computed on demand and cached until the paths are
+ *  invalidated, so a tree invalidated on each change event is compared
+ *  without rereading the unchanged paths. A big tree can be hashed in steps
+ *  beforehand, so its first comparison does not block for long.
+ */
+class HashTree
+{
+  public:
+    /**
+     * @brief The default number of the directory entries listed per step.
+     */
+    static constexpr size_t defaultStepEntries = 256;
+
+    /**
+     * @brief The directories left to hash in steps.
+     */
+    struct HashWalk
+    {
+        /**
+         * @brief The directories, along with whether their subdirectories
+         *        got queued, the next to hash last.
+         */
+        std::vector<std::pair<std::string, bool>> pending;
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] root - The path hashed by the tree
+     * @param[in] excludes - The paths left out of the tree
+     */
+    explicit HashTree(fs::path root, const std::vector<fs::path>& excludes = {});
+
+    /**
+     * @brief Get the path hashed by the tree.
+     */
+    const fs::path& root() const
+    {
+        return _root;
+    }
+
+    /**
+     * @brief Get the level of a path under the root.
+     *
+     * @param[in] path - The path
+     *
+     * @returns The level, std::nullopt if the path is missing, excluded, not
+     *          under the root or neither a regular file nor a directory.
+     */
+    std::optional<TreeLevel> level(const fs::path& path);
+
+    /**
+     * @brief Start hashing a path and the paths under it in steps.
+     *
+     * @param[in] path - The path
+     *
+     * @returns HashWalk - The walk, done right away if the path is not
+     *                     under the root
+     */
+    HashWalk startWalk(const fs::path& path) const;
+
+    /**
+     * @brief Hash the directories of a walk, the deepest first, until about
+     *        the given number of the entries got listed.
+     *
+     * The hashes invalidated between the steps are computed again once
+     * asked.
+     *
+     * @param[in,out] walk - The walk
+     * @param[in] maxEntries - The number of the entries to list
+     *
+     * @returns bool - true once the walk is done
+     */
+    bool hashStep(HashWalk& walk, size_t maxEntries = defaultStepEntries);
+
+    /**
+     * @brief Drop the hashes of a changed path, of the paths under it and of
+     *        its parent directories.
+     *
+     * @param[in] path - The changed path
+     */
+    void invalidate(const fs::path& path);
+
+    /**
+     * @brief Drop all the hashes.
+     */
+    void clear()
+    {
+        _nodes.clear();
+    }
+
+    /**
+     * @brief Get the number of the hashed paths.
+     */
+    size_t size() const
+    {
+        return _nodes.size();
+    }
+
+  private:
+    /**
+     * @brief The cached hash of a path.
+     */
+    struct Node
+    {
+        bool isDir = false;
+        uint64_t hash = 0;
+        std::vector<TreeEntry> children;
+    };
+
+    /**
+     * @brief Get the node of a path, hashing it and the paths under it if
+     *        not cached.
+     *
+     * @param[in] path - The normalized path, without a trailing '/'
+     *
+     * @returns The node, nullptr if the path is not part of the tree.
+     */
+    const Node* getNode(const std::string& path);
+
+    /**
+     * @brief Normalize a path under the root.
+     *
+     * @param[in] path - The path
+     *
+     * @returns The normalized path without a trailing '/', std::nullopt if
+     *          the path is not under the root.
+     */
+    std::optional<std::string> normalize(const fs::path& path) const;
+
+    /**
+     * @brief The path hashed by the tree
+     */
+    fs::path _root;
+
+    /**
+     * @brief The paths left out of the tree
+     */
+    std::set<std::string, std::less<>> _excludes;
+
+    /**
+     * @brief The cached nodes, by path.
+     *
+     * Keyed by the path string, so the paths under a directory are
+     * contiguous.
+     */
+    std::map<std::string, Node, std::less<>> _nodes;
+};
+
+/**
+ * @brief Find the paths differing from the sibling BMC, by exchanging the
+ *        levels of the trees from the root down to the differing paths.
+ *
+ * The levels of each depth are queried at once. A directory whose entries
+ * got added on the sibling only or changed their type is reported as a
+ * whole, with a trailing '/', to let rsync delete or replace the entries.
+ *
+ * @param[in] localTree - The tree of this BMC
+ * @param[in] client - The client to query the sibling BMC
+ * @param[in] remoteRoot - The path of the root on the sibling BMC
+ *
+ * @returns std::vector<fs::path> - The differing paths of this BMC
+ *
+ * @throw std::exception - If the sibling BMC could not be queried
+ */
+sdbusplus::async::task<std::vector<fs::path>>
+    findDifferingPaths(HashTree& localTree, transfer::TransferClient& client,
+                       const fs::path& remoteRoot);
+
+} // namespace data_sync::sync
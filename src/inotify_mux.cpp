@@ -0,0 +1,602 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "inotify_mux.hpp"
+
+#include "data_watcher.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <experimental/scope>
+#include <fstream>
+#include <iterator>
+#include <ranges>
+
+namespace data_sync::watch::inotify
+{
+
+std::string eventName(uint32_t eventMask)
+{
+    std::vector<std::string> events{};
+
+    if ((eventMask & IN_ACCESS) != 0)
+    {
+        events.emplace_back("IN_ACCESS");
+    }
+    if ((eventMask & IN_ATTRIB) != 0)
+    {
+        events.emplace_back("IN_ATTRIB");
+    }
+    if ((eventMask & IN_CLOSE_WRITE) != 0)
+    {
+        events.emplace_back("IN_CLOSE_WRITE");
+    }
+    if ((eventMask & IN_CLOSE_NOWRITE) != 0)
+    {
+        events.emplace_back("IN_CLOSE_NOWRITE");
+    }
+    if ((eventMask & IN_CREATE) != 0)
+    {
+        events.emplace_back("IN_CREATE");
+    }
+    if ((eventMask & IN_DELETE) != 0)
+    {
+        events.emplace_back("IN_DELETE");
+    }
+    if ((eventMask & IN_DELETE_SELF) != 0)
+    {
+        events.emplace_back("IN_DELETE_SELF");
+    }
+    if ((eventMask & IN_MODIFY) != 0)
+    {
+        events.emplace_back("IN_MODIFY");
+    }
+    if ((eventMask & IN_MOVE_SELF) != 0)
+    {
+        events.emplace_back("IN_MOVE_SELF");
+    }
+    if ((eventMask & IN_MOVED_FROM) != 0)
+    {
+        events.emplace_back("IN_MOVED_FROM");
+    }
+    if ((eventMask & IN_MOVED_TO) != 0)
+    {
+        events.emplace_back("IN_MOVED_TO");
+    }
+    if ((eventMask & IN_OPEN) != 0)
+    {
+        events.emplace_back("IN_OPEN");
+    }
+    if ((eventMask & IN_IGNORED) != 0)
+    {
+        events.emplace_back("IN_IGNORED");
+    }
+    if ((eventMask & IN_ISDIR) != 0)
+    {
+        events.emplace_back("IN_ISDIR");
+    }
+    if ((eventMask & IN_Q_OVERFLOW) != 0)
+    {
+        events.emplace_back("IN_Q_OVERFLOW");
+    }
+    if ((eventMask & IN_UNMOUNT) != 0)
+    {
+        events.emplace_back("IN_UNMOUNT");
+    }
+
+    auto result = std::ranges::fold_left_first(
+        events, [](const std::string& a, const std::string& b) {
+        return a + " | " + b;
+    });
+
+    return result.value_or("UNKNOWN");
+}
+
+InotifyMux::InotifyMux(sdbusplus::async::context& ctx, int inotifyFlags,
+                       std::optional<size_t> watchBudget) :
+    _ctx(ctx), _inotifyFlags(inotifyFlags),
+    _inotifyFileDescriptor(inotifyInit(inotifyFlags)),
+    _fdioInstance(
+        std::make_unique<sdbusplus::async::fdio>(ctx, _inotifyFileDescriptor())),
+    _eventBuffer(inotifyReadBufferSize),
+    _watchBudget(watchBudget.value_or(defaultWatchBudget()))
+{}
+
+size_t InotifyMux::defaultWatchBudget()
+{
+    size_t maxUserWatches = inotifyDefaultMaxUserWatches;
+    std::ifstream limitFile("/proc/sys/fs/inotify/max_user_watches");
+    if (!(limitFile >> maxUserWatches))
+    {
+        lg2::warning("Failed to read the inotify watches limit, assuming "
+                     "[{LIMIT}]",
+                     "LIMIT", inotifyDefaultMaxUserWatches);
+        maxUserWatches = inotifyDefaultMaxUserWatches;
+    }
+    return std::max<size_t>(maxUserWatches * inotifyWatchBudgetPercent / 100,
+                            1);
+}
+
+int InotifyMux::inotifyInit(int inotifyFlags)
+{
+    auto fd = inotify_init1(inotifyFlags);
+
+    if (-1 == fd)
+    {
+        lg2::error("inotify_init1 call failed with ErrNo : {ERRNO}, ErrMsg : "
+                   "{ERRMSG}",
+                   "ERRNO", errno, "ERRMSG", strerror(errno));
+
+        // TODO: Throw meaningful exception
+        throw std::runtime_error("inotify_init1 failed");
+    }
+    return fd;
+}
+
+void InotifyMux::attach(DataWatcher& watcher)
+{
+    if (!std::ranges::contains(_watchers, &watcher))
+    {
+        _watchers.emplace_back(&watcher);
+    }
+}
+
+void InotifyMux::detach(DataWatcher& watcher)
+{
+    auto isSubscribed = [&watcher](const auto& entry) {
+        return std::ranges::any_of(
+            entry.second.subscribers,
+            [&watcher](const auto& sub) { return sub.watcher == &watcher; });
+    };
+    auto wds = _dispatchTable | std::views::filter(isSubscribed) |
+               std::views::keys | std::ranges::to<std::vector>();
+
+    std::ranges::for_each(wds,
+                          [this, &watcher](WD wd) { removeWatch(watcher, wd); });
+
+    std::erase(_watchers, &watcher);
+}
+
+void InotifyMux::startDispatcher()
+{
+    if (_dispatcherRunning)
+    {
+        return;
+    }
+    _dispatcherRunning = true;
+    _ctx.spawn(dispatchEvents());
+}
+
+void InotifyMux::startPoller()
+{
+    if (_pollerRunning)
+    {
+        return;
+    }
+    _pollerRunning = true;
+    _ctx.spawn(pollWatchers());
+}
+
+void InotifyMux::startRenameExpiry()
+{
+    if (_renameExpiryRunning)
+    {
+        return;
+    }
+    _renameExpiryRunning = true;
+    _ctx.spawn(expireRenames());
+}
+
+WD InotifyMux::addWatch(DataWatcher& watcher, const fs::path& pathToWatch,
+                        uint32_t eventMasksToWatch)
+{
+    // IN_MASK_ADD keeps the events already requested by the other watchers
+    // if the path is watched already.
+    auto wd = inotify_add_watch(_inotifyFileDescriptor(), pathToWatch.c_str(),
+                                eventMasksToWatch | IN_MASK_ADD);
+    // The reclaim makes syscalls and logs, which overwrite errno.
+    int addErrno = errno;
+    if (-1 == wd && addErrno == ENOSPC && !_reclaiming &&
+        reclaimWatches(watcher, _dispatchTable.size()))
+    {
+        // The kernel limit is shared with the other inotify users, retry
+        // once some watches are released.
+        wd = inotify_add_watch(_inotifyFileDescriptor(), pathToWatch.c_str(),
+                               eventMasksToWatch | IN_MASK_ADD);
+        addErrno = errno;
+    }
+    if (-1 == wd)
+    {
+        errno = addErrno;
+        return wd;
+    }
+
+    if (!_dispatchTable.contains(wd) && _dispatchTable.size() >= _watchBudget &&
+        (_reclaiming || !reclaimWatches(watcher, _watchBudget)))
+    {
+        lg2::warning("The inotify watch budget [{BUDGET}] is exhausted, "
+                     "failed to watch {PATH}",
+                     "BUDGET", _watchBudget, "PATH", pathToWatch);
+        inotify_rm_watch(_inotifyFileDescriptor(), wd);
+        errno = ENOSPC;
+        return -1;
+    }
+
+    auto [entryIt, inserted] = _dispatchTable.try_emplace(
+        wd, WatchEntry{pathToWatch, eventMasksToWatch, {}});
+    auto& entry = entryIt->second;
+
+    if (auto sub = std::ranges::find(entry.subscribers, &watcher,
+                                     &Subscriber::watcher);
+        sub != entry.subscribers.end())
+    {
+        sub->eventMasks = eventMasksToWatch;
+    }
+    else
+    {
+        entry.subscribers.emplace_back(&watcher, eventMasksToWatch);
+    }
+
+    if (!inserted)
+    {
+        lg2::debug("Sharing the watch of {PATH}, wd : {WD} with [{COUNT}] "
+                   "watchers",
+                   "PATH", entry.path, "WD", wd, "COUNT",
+                   entry.subscribers.size());
+        entry.kernelMasks |= eventMasksToWatch;
+        rearmWatch(entry);
+    }
+    return wd;
+}
+
+void InotifyMux::removeWatch(DataWatcher& watcher, WD wd)
+{
+    // The entry could be already dropped upon IN_IGNORED.
+    auto entryIt = _dispatchTable.find(wd);
+    if (entryIt == _dispatchTable.end())
+    {
+        return;
+    }
+
+    auto& subscribers = entryIt->second.subscribers;
+    std::erase_if(subscribers,
+                  [&watcher](const auto& sub) { return sub.watcher == &watcher; });
+
+    if (subscribers.empty())
+    {
+        inotify_rm_watch(_inotifyFileDescriptor(), wd);
+        _dispatchTable.erase(entryIt);
+    }
+    else
+    {
+        rearmWatch(entryIt->second);
+    }
+}
+
+void InotifyMux::movePath(const fs::path& from, const fs::path& to)
+{
+    const auto fromDir = (from / "").native();
+    const auto toDir = (to / "").native();
+    std::string_view fromPath(fromDir);
+    fromPath.remove_suffix(1);
+
+    for (auto& entry : _dispatchTable | std::views::values)
+    {
+        const auto& path = entry.path.native();
+        if (path == fromPath)
+        {
+            entry.path = toDir.substr(0, toDir.size() - 1);
+        }
+        else if (path.starts_with(fromDir))
+        {
+            entry.path = toDir + path.substr(fromDir.size());
+        }
+    }
+}
+
+bool InotifyMux::reclaimWatches(const DataWatcher& requester,
+                                size_t maxWatches)
+{
+    auto requesterPriority = requester.getWatchPriority();
+    auto candidates = _watchers | std::views::filter([&](DataWatcher* watcher) {
+        return watcher->getWatchPriority() < requesterPriority;
+    }) | std::ranges::to<std::vector>();
+
+    // Demote the lowest priority first, and the watchers holding the most
+    // watches among the same priority to release them in fewer scans.
+    std::ranges::sort(candidates, [](DataWatcher* lhs, DataWatcher* rhs) {
+        return std::make_pair(lhs->getWatchPriority(),
+                              rhs->getWatchDescriptors().size()) <
+               std::make_pair(rhs->getWatchPriority(),
+                              lhs->getWatchDescriptors().size());
+    });
+
+    // The watches restored upon a failure must not reclaim in turn.
+    _reclaiming = true;
+    using std::experimental::scope_exit;
+    auto endReclaim = scope_exit([this]() noexcept { _reclaiming = false; });
+
+    bool reclaimed = false;
+    for (auto* watcher : candidates)
+    {
+        while (_dispatchTable.size() >= maxWatches &&
+               watcher->demoteSubtree() > 0)
+        {}
+        if (_dispatchTable.size() < maxWatches)
+        {
+            lg2::info("Reclaimed the inotify watches, now holding [{COUNT}] "
+                      "watches",
+                      "COUNT", _dispatchTable.size());
+            reclaimed = true;
+            break;
+        }
+    }
+
+    // The demotions are of no use if not enough watches are released.
+    if (!reclaimed && !candidates.empty())
+    {
+        lg2::warning("Failed to reclaim the inotify watches, watching the "
+                     "demoted subtrees again");
+    }
+    for (auto* watcher : candidates)
+    {
+        if (reclaimed)
+        {
+            watcher->keepDemotedSubtrees();
+        }
+        else
+        {
+            watcher->restoreDemotedSubtrees();
+        }
+    }
+    return reclaimed;
+}
+
+void InotifyMux::rearmWatch(WatchEntry& entry) const
+{
+    auto masks = std::ranges::fold_left(
+        entry.subscribers, 0U,
+        [](uint32_t masks, const auto& sub) { return masks | sub.eventMasks; });
+
+    if (masks == entry.kernelMasks)
+    {
+        return;
+    }
+
+    // Without IN_MASK_ADD the kernel replaces the existing mask, so the
+    // events which are no longer interested by any watcher are dropped.
+    if (inotify_add_watch(_inotifyFileDescriptor(), entry.path.c_str(),
+                          masks) == -1)
+    {
+        lg2::error("Failed to update the watch mask of {PATH}, ErrNo : "
+                   "{ERRNO}, ErrMsg : {ERRMSG}",
+                   "PATH", entry.path, "ERRNO", errno, "ERRMSG",
+                   strerror(errno));
+        return;
+    }
+    entry.kernelMasks = masks;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> InotifyMux::dispatchEvents()
+{
+    while (!_ctx.stop_requested() && !_watchers.empty())
+    {
+        // NOLINTNEXTLINE
+        co_await waitForEvents();
+    }
+    _dispatcherRunning = false;
+    co_return;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> InotifyMux::pollWatchers()
+{
+    auto isPolling = [](const DataWatcher* watcher) {
+        return !watcher->getPolledPaths().empty();
+    };
+    while (!_ctx.stop_requested() && std::ranges::any_of(_watchers, isPolling))
+    {
+        // NOLINTNEXTLINE
+        co_await sdbusplus::async::sleep_for(_ctx, pollScanInterval);
+
+        // The watchers can be detached while reporting the modifications.
+        auto watchers = _watchers;
+        for (auto* watcher : watchers)
+        {
+            if (std::ranges::contains(_watchers, watcher))
+            {
+                watcher->pollSubtrees();
+            }
+        }
+    }
+    _pollerRunning = false;
+    co_return;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> InotifyMux::expireRenames()
+{
+    auto awaitsRenames = [](const DataWatcher* watcher) {
+        return watcher->getPendingRenamesCount() != 0;
+    };
+    while (!_ctx.stop_requested() &&
+           std::ranges::any_of(_watchers, awaitsRenames))
+    {
+        // NOLINTNEXTLINE
+        co_await sdbusplus::async::sleep_for(_ctx, renameCookieTimeout);
+
+        auto expireBefore = std::chrono::steady_clock::now() -
+                            renameCookieTimeout;
+        for (auto* watcher : _watchers)
+        {
+            watcher->expireRenames(expireBefore);
+        }
+    }
+    _renameExpiryRunning = false;
+    co_return;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> InotifyMux::waitForEvents()
+{
+    // NOLINTNEXTLINE
+    co_await _fdioInstance->next();
+
+    readEvents();
+    co_return;
+}
+
+void InotifyMux::readEvents()
+{
+    // Keep the batches in the order the watchers got attached, so the
+    // delivery order doesn't depend on the pointer values. The batches are
+    // reused across the wakeups to keep their capacity.
+    _batches.resize(_watchers.size());
+    for (size_t index = 0; index < _watchers.size(); ++index)
+    {
+        _batches[index].first = _watchers[index];
+        _batches[index].second.clear();
+    }
+
+    auto dispatch = [this](const inotify_event& event) {
+        // The name field is present only when the event is for a child of
+        // the watched directory. It is referred in place from the read
+        // buffer, hence valid only until the batches are handled.
+        std::string_view name = (event.len > 0) ? event.name : "";
+
+        if ((event.mask & IN_Q_OVERFLOW) != 0)
+        {
+            // The overflow is not specific to a watch (wd is -1), any of the
+            // watchers could have lost events, hence let all of them recover.
+            lg2::error("The inotify event queue overflowed, events are lost. "
+                       "Notifying [{WATCHERS}] watchers",
+                       "WATCHERS", _batches.size());
+            _eventStats.overflows++;
+            std::ranges::for_each(_batches, [&event](auto& batch) {
+                batch.second.emplace_back(event.wd, "", event.mask,
+                                          event.cookie);
+            });
+            return;
+        }
+
+        // Using find() because,
+        // IN_IGNORED events can arrive for already removed watch descriptors
+        auto entryIt = _dispatchTable.find(event.wd);
+        if (entryIt == _dispatchTable.end())
+        {
+            lg2::debug("Received {EVENTS} for the removed wd:{WD}", "EVENTS",
+                       lg2::hex, event.mask, "WD", event.wd);
+            return;
+        }
+
+        // Logging the raw mask, as decoding it per event allocates.
+        lg2::debug("Received {EVENTS} for wd:{WD} and name : {NAME}", "EVENTS",
+                   lg2::hex, event.mask, "WD", event.wd, "NAME", name);
+
+        for (const auto& sub : entryIt->second.subscribers)
+        {
+            if ((event.mask & sub.eventMasks) == 0)
+            {
+                continue;
+            }
+            if (auto batch = std::ranges::find(_batches, sub.watcher,
+                                               &Batch::first);
+                batch != _batches.end())
+            {
+                batch->second.emplace_back(event.wd, name, event.mask,
+                                           event.cookie);
+            }
+        }
+
+        if ((event.mask & IN_IGNORED) != 0)
+        {
+            // The kernel already dropped the watch (path deleted/unmounted)
+            _dispatchTable.erase(entryIt);
+        }
+    };
+
+    // Drain the queue into the buffer without overwriting the previous
+    // reads, so all the events of the wakeup stay in place.
+    size_t filled = 0;
+    while (filled < inotifyMaxDrainSize)
+    {
+        if (_eventBuffer.size() - filled < inotifyReadBufferSize)
+        {
+            // The buffer keeps the grown size for the next wakeups.
+            _eventBuffer.resize(filled + inotifyReadBufferSize);
+        }
+
+        auto bytes = read(_inotifyFileDescriptor(), &_eventBuffer[filled],
+                          _eventBuffer.size() - filled);
+        if (0 > bytes)
+        {
+            // In non blocking mode, read returns immediately with EAGAIN /
+            // EWOULDBLOCK once the queue is drained, instead of waiting.
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                lg2::error("Failed to read inotify event, error: {ERROR}",
+                           "ERROR", strerror(errno));
+            }
+            break;
+        }
+        filled += static_cast<size_t>(bytes);
+
+        // A blocking inotify instance would wait for the next event instead
+        // of returning EAGAIN, hence read only once.
+        if ((_inotifyFlags & IN_NONBLOCK) == 0)
+        {
+            break;
+        }
+    }
+
+    size_t eventsCount = 0;
+    size_t offset = 0;
+    while (offset < filled)
+    {
+        // NOLINTNEXTLINE to avoid cppcoreguidelines-pro-type-reinterpret-cast
+        const auto* event =
+            reinterpret_cast<const inotify_event*>(&_eventBuffer[offset]);
+        dispatch(*event);
+        offset += offsetof(inotify_event, name) + event->len;
+        ++eventsCount;
+    }
+
+    _eventStats.update(eventsCount);
+    lg2::debug("Read [{COUNT}] inotify events in a wakeup for [{WATCHERS}] "
+               "watchers",
+               "COUNT", eventsCount, "WATCHERS", _watchers.size());
+
+    for (auto& [watcher, events] : _batches)
+    {
+        // A watcher could be detached by the processing of the previous
+        // batches.
+        if (!std::ranges::contains(_watchers, watcher))
+        {
+            continue;
+        }
+
+        // A failing watcher is dropped alone, the others sharing the
+        // instance keep being monitored.
+        try
+        {
+            watcher->handleEvents(events);
+        }
+        catch (const std::exception& e)
+        {
+            if (!_failureCallback)
+            {
+                throw;
+            }
+            const fs::path path = watcher->getDataPathToWatch();
+            lg2::error("Failed to handle the inotify events of {PATH}, "
+                       "dropping its watcher. Exception : {ERROR}",
+                       "PATH", path, "ERROR", e);
+            detach(*watcher);
+            _failureCallback(path, e);
+        }
+    }
+}
+
+} // namespace data_sync::watch::inotify
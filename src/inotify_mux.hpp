@@ -0,0 +1,431 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "utility.hpp"
+#include "watcher.hpp"
+
+#include <sys/inotify.h>
+
+#include <sdbusplus/async.hpp>
+
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace data_sync::watch::inotify
+{
+
+namespace fs = std::filesystem;
+namespace utility = data_sync::utility;
+
+/**
+ * @brief A tuple which has the info related to the occured inotify event
+ *
+ * int              - Watch descriptor corresponds to the event
+ * std::string_view - name[] in inotify_event struct, referred in place from
+ *                    the read buffer hence valid only while the batch of
+ *                    events is handled
+ * uint32_t         - Mask describing event
+ */
+using WD = int;
+using BaseName = std::string_view;
+using EventMask = uint32_t;
+using Cookie = uint32_t;
+using EventInfo = std::tuple<WD, BaseName, EventMask, Cookie>;
+
+/**
+ * @brief Size of the reusable buffer used to drain the inotify queue.
+ *
+ * Large enough to hold a few dozen events with maximum length names, so a
+ * burst of changes is normally drained with a single read().
+ */
+constexpr size_t inotifyReadBufferSize = 64 *
+                                         (sizeof(inotify_event) + NAME_MAX + 1);
+
+/**
+ * @brief Maximum size of the events read on a wakeup.
+ *
+ * The events of a wakeup are kept in the read buffer until they are handled,
+ * so the buffer grows while the queue is drained. Beyond this size, the rest
+ * of the queue is left to the next wakeup.
+ */
+constexpr size_t inotifyMaxDrainSize = 16 * inotifyReadBufferSize;
+
+/**
+ * @brief The percentage of the kernel limit of the inotify watches which
+ *        can be used.
+ *
+ * The limit is per user, hence the rest is left to the other inotify users
+ * of the same user.
+ */
+constexpr size_t inotifyWatchBudgetPercent = 75;
+
+/**
+ * @brief The kernel limit of the inotify watches, if it can't be read.
+ */
+constexpr size_t inotifyDefaultMaxUserWatches = 8192;
+
+/**
+ * @brief API to convert the inotify event masks to event macros in string
+ *        format.
+ *
+ * @param[in] - eventMask - The mask describing event
+ *
+ * @returns - The event name in string format.
+ */
+std::string eventName(uint32_t eventMask);
+
+class DataWatcher;
+
+/**
+ * @brief The callback to report the watcher dropped by the inotify instance
+ *        as its events could not be handled.
+ */
+using WatcherFailureCallback =
+    std::function<void(const fs::path&, const std::exception&)>;
+
+/** @class InotifyMux
+ *
+ *  @brief Multiplexes the watches of several DataWatchers over one inotify
+ *         instance.
+ *
+ *  The inotify fd is registered once with the event loop and drained by a
+ *  single coroutine, so the number of fds, epoll registrations and wakeups
+ *  doesn't grow with the number of configured paths. The received events
+ *  are fanned out to the interested DataWatchers using the wd → watcher
+ *  dispatch table.
+ *
+ *  The watches are limited to a budget derived from the kernel limit. Once
+ *  it is exhausted, the subtrees of the lower priority watchers are moved to
+ *  the periodic scan to make room, instead of failing to add the watch.
+ */
+class InotifyMux
+{
+  public:
+    InotifyMux(const InotifyMux&) = delete;
+    InotifyMux& operator=(const InotifyMux&) = delete;
+    InotifyMux(InotifyMux&&) = delete;
+    InotifyMux& operator=(InotifyMux&&) = delete;
+    ~InotifyMux() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * Create the inotify instance and register it with the event loop.
+     *
+     *  @param[in] ctx - The async context object
+     *  @param[in] inotifyFlags - inotify flags used to create the instance
+     *  @param[in] watchBudget - The maximum number of watches to hold, derived
+     *                           from the kernel limit if not given
+     */
+    explicit InotifyMux(sdbusplus::async::context& ctx,
+                        int inotifyFlags = IN_NONBLOCK | IN_CLOEXEC,
+                        std::optional<size_t> watchBudget = std::nullopt);
+
+    /**
+     * @brief Register a watcher to receive the events of its watches.
+     *
+     * @param[in] watcher - The watcher to register
+     */
+    void attach(DataWatcher& watcher);
+
+    /**
+     * @brief Unregister a watcher and drop all of its watches.
+     *
+     * @param[in] watcher - The watcher to unregister
+     */
+    void detach(DataWatcher& watcher);
+
+    /**
+     * @brief Set the callback to report the watchers dropped as their events
+     *        could not be handled.
+     *
+     * Without it, the failure is thrown to the waiter of the events.
+     *
+     * @param[in] callback - The callback, given the watched path
+     */
+    void setFailureCallback(WatcherFailureCallback callback)
+    {
+        _failureCallback = std::move(callback);
+    }
+
+    /**
+     * @brief Spawn the coroutine which drains the inotify instance and
+     *        dispatches the events, if it is not already running.
+     *
+     * The coroutine exits once no watcher is attached anymore.
+     */
+    void startDispatcher();
+
+    /**
+     * @brief Add a watch for the given watcher.
+     *
+     * If the path is already watched by another watcher, the kernel watch is
+     * shared and its mask becomes the union of the requested masks.
+     *
+     * @param[in] watcher - The watcher which requests the watch
+     * @param[in] pathToWatch - The path of file/directory to be monitored
+     * @param[in] eventMasksToWatch - The set of events for which the path to
+     *                                be monitored
+     *
+     * If the watch budget or the kernel limit is exhausted, the watches of
+     * the lower priority watchers are reclaimed to make room.
+     *
+     * @returns WD - The watch descriptor, -1 on failure with errno set.
+     *               errno is ENOSPC if no watch could be reclaimed.
+     */
+    WD addWatch(DataWatcher& watcher, const fs::path& pathToWatch,
+                uint32_t eventMasksToWatch);
+
+    /**
+     * @brief Remove the watch of the given watcher.
+     *
+     * The kernel watch is removed only when no other watcher uses it.
+     *
+     * @param[in] watcher - The watcher which owns the watch
+     * @param[in] wd - The watch descriptor to remove
+     */
+    void removeWatch(DataWatcher& watcher, WD wd);
+
+    /**
+     * @brief Move the paths of the watches of a renamed directory and its
+     *        subtree, used while re-arming the watches.
+     *
+     * The kernel keeps the watches across a rename, hence no watch is added.
+     *
+     * @param[in] from - The absolute path of the directory moved from
+     * @param[in] to - The absolute path of the directory moved to
+     */
+    void movePath(const fs::path& from, const fs::path& to);
+
+    /**
+     * @brief Spawn the coroutine which periodically scans the subtrees polled
+     *        by the watchers, if it is not already running.
+     *
+     * The coroutine exits once no attached watcher polls any path.
+     */
+    void startPoller();
+
+    /**
+     * @brief Spawn the coroutine which expires the renames which didn't pair
+     *        in time, if it is not already running.
+     *
+     * The coroutine exits once no attached watcher awaits any rename.
+     */
+    void startRenameExpiry();
+
+    /**
+     * @brief Wait for the inotify instance to become readable, then drain it
+     *        and dispatch the events to the watchers.
+     */
+    sdbusplus::async::task<> waitForEvents();
+
+    /**
+     * @brief Get the events per wakeup counters of the inotify instance.
+     */
+    const EventStats& getEventStats() const
+    {
+        return _eventStats;
+    }
+
+    /**
+     * @brief Get the number of kernel watches held by the inotify instance.
+     */
+    size_t getWatchesCount() const
+    {
+        return _dispatchTable.size();
+    }
+
+    /**
+     * @brief Get the maximum number of kernel watches to hold.
+     */
+    size_t getWatchBudget() const
+    {
+        return _watchBudget;
+    }
+
+  private:
+    /**
+     * @brief A watcher interested in a watch descriptor and its events.
+     */
+    struct Subscriber
+    {
+        DataWatcher* watcher;
+        uint32_t eventMasks;
+    };
+
+    /**
+     * @brief The dispatch table entry of a watch descriptor.
+     */
+    struct WatchEntry
+    {
+        /**
+         * @brief The path used to add the watch
+         */
+        fs::path path;
+
+        /**
+         * @brief The mask currently set on the kernel watch
+         */
+        uint32_t kernelMasks;
+
+        /**
+         * @brief The watchers to which the events are dispatched
+         */
+        std::vector<Subscriber> subscribers;
+    };
+
+    /**
+     * @brief initialize an inotify instance and returns file descriptor
+     *
+     * @param[in] inotifyFlags - inotify flags used to create the instance
+     */
+    static int inotifyInit(int inotifyFlags);
+
+    /**
+     * @brief Get the default watch budget from the kernel limit.
+     */
+    static size_t defaultWatchBudget();
+
+    /**
+     * @brief Move the subtrees of the watchers having a lower priority than
+     *        the requester to the periodic scan, until the number of the
+     *        watches is below the given count.
+     *
+     * The watchers with the lowest priority and then the most watches are
+     * demoted first.
+     *
+     * @param[in] requester - The watcher which needs the watch
+     * @param[in] maxWatches - The number of the watches to stay below
+     *
+     * @returns True if enough watches are reclaimed.
+     */
+    bool reclaimWatches(const DataWatcher& requester, size_t maxWatches);
+
+    /**
+     * @brief The coroutine which keeps dispatching the events as long as
+     *        any watcher is attached.
+     */
+    sdbusplus::async::task<> dispatchEvents();
+
+    /**
+     * @brief The coroutine which keeps scanning the polled subtrees as long
+     *        as any watcher polls.
+     */
+    sdbusplus::async::task<> pollWatchers();
+
+    /**
+     * @brief The coroutine which keeps expiring the unmatched renames as
+     *        long as any watcher awaits one.
+     */
+    sdbusplus::async::task<> expireRenames();
+
+    /**
+     * @brief Drain the inotify queue and hand over the events to the
+     *        interested watchers, one batch per watcher.
+     */
+    void readEvents();
+
+    /**
+     * @brief Update the kernel watch mask to the union of the subscriber's
+     *        masks.
+     *
+     * @param[in] entry - The dispatch table entry of the watch
+     */
+    void rearmWatch(WatchEntry& entry) const;
+
+    /**
+     * @brief The async context object
+     */
+    sdbusplus::async::context& _ctx;
+
+    /**
+     * @brief inotify flags
+     */
+    int _inotifyFlags;
+
+    /**
+     * @brief file descriptor referring to the inotify instance
+     */
+    utility::FD _inotifyFileDescriptor;
+
+    /**
+     * @brief fdio instance
+     */
+    std::unique_ptr<sdbusplus::async::fdio> _fdioInstance;
+
+    /**
+     * @brief Reusable buffer to read the queued inotify events in bulk.
+     *
+     * All the events of a wakeup are kept in place, as the batches refer
+     * the event names from the buffer.
+     */
+    std::vector<uint8_t> _eventBuffer;
+
+    /**
+     * @brief The events of a wakeup for a watcher
+     */
+    using Batch = std::pair<DataWatcher*, std::vector<EventInfo>>;
+
+    /**
+     * @brief The batches of the attached watchers, reused across the
+     *        wakeups to avoid allocations.
+     */
+    std::vector<Batch> _batches;
+
+    /**
+     * @brief The wd → watchers dispatch table
+     */
+    std::unordered_map<WD, WatchEntry> _dispatchTable;
+
+    /**
+     * @brief The attached watchers
+     */
+    std::vector<DataWatcher*> _watchers;
+
+    /**
+     * @brief Whether the dispatcher coroutine is running
+     */
+    bool _dispatcherRunning = false;
+
+    /**
+     * @brief Whether the poller coroutine is running
+     */
+    bool _pollerRunning = false;
+
+    /**
+     * @brief Whether the rename expiry coroutine is running
+     */
+    bool _renameExpiryRunning = false;
+
+    /**
+     * @brief Whether the watches are being reclaimed
+     */
+    bool _reclaiming = false;
+
+    /**
+     * @brief The maximum number of kernel watches to hold
+     */
+    size_t _watchBudget;
+
+    /**
+     * @brief The events per wakeup counters
+     */
+    EventStats _eventStats;
+
+    /**
+     * @brief The callback to report the dropped watchers.
+     */
+    WatcherFailureCallback _failureCallback;
+};
+
+} // namespace data_sync::watch::inotify
@@ -5,7 +5,10 @@
 #include "manager.hpp"
 
 #include "async_command_exec.hpp"
+#include "async_latch.hpp"
+#include "data_operations.hpp"
 #include "data_watcher.hpp"
+#include "fanotify_watcher.hpp"
 #include "notify_sibling.hpp"
 #include "utility.hpp"
 
@@ -16,6 +19,8 @@
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/async/context.hpp>
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <csignal>
 #include <cstring>
@@ -24,8 +29,11 @@
 #include <fstream>
 #include <iomanip>
 #include <iterator>
+#include <ranges>
 #include <sstream>
 #include <string>
+#include <system_error>
+#include <utility>
 
 namespace data_sync
 {
@@ -34,8 +42,28 @@ Manager::Manager(sdbusplus::async::context& ctx,
                  std::unique_ptr<ext_data::ExternalDataIFaces>&& extDataIfaces,
                  const fs::path& dataSyncCfgDir) :
     _ctx(ctx), _extDataIfaces(std::move(extDataIfaces)),
-    _dataSyncCfgDir(dataSyncCfgDir), _syncBMCDataIface(ctx, *this)
+    _dataSyncCfgDir(dataSyncCfgDir), _syncBMCDataIface(ctx, *this),
+    _inotifyMux(ctx), _pollMux(ctx),
+    _syncScheduler(ctx, MAX_CONCURRENT_SYNCS),
+    _timers(ctx, std::chrono::milliseconds(TIMER_TICK_MS), TIMER_SLACK_PERCENT),
+    _dirtyJournal(persist::DirtyJournalFile)
 {
+#ifdef FANOTIFY_BACKEND
+    try
+    {
+        _fanotifyMux = std::make_unique<watch::fanotify::FanotifyMux>(ctx);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::warning("fanotify backend is not available, falling back to "
+                     "inotify. Error : {ERROR}",
+                     "ERROR", e);
+    }
+#endif
+    _inotifyMux.setFailureCallback(
+        [this](const fs::path& path, const std::exception& e) {
+        _ctx.spawn(handleWatcherFailure(path, e.what()));
+    });
 // Skip SIGUSR1 registration in unit tests to avoid waiting
 // indefinitely for a signal and time out issues.
 #ifndef UNIT_TEST
@@ -68,12 +96,28 @@ sdbusplus::async::task<> Manager::init()
      * role changes, ensuring data is synchronized according to the new role.
      */
     _ctx.spawn(_extDataIfaces->watchRedundancyMgrProps());
+
+    startNativeTransfer();
 #endif
 
     if (!_extDataIfaces->bmcRedundancy() || _syncBMCDataIface.disable_sync())
     {
         lg2::warning(
             "Either Redundancy or Sync is disabled, No sync operations will be performed.");
+        // The changes made meanwhile are not tracked.
+        _dirtyJournal.discard();
+        co_return;
+    }
+
+    // Resume the syncs left by the previous run, the full sync is needed only
+    // if those are unknown.
+    if (auto dirtyState = _dirtyJournal.open(_extDataIfaces->bmcRoleInStr(),
+                                             getConfigHash()))
+    {
+        lg2::info("Resuming [{COUNT}] dirty paths instead of a full sync",
+                  "COUNT", dirtyState->paths.size());
+        co_await startSyncEvents();
+        replayDirtyPaths(*dirtyState);
         co_return;
     }
 
@@ -158,18 +202,43 @@ sdbusplus::async::task<> Manager::processPendingNotifications()
                   "DIR", notifyServiceDir);
     }
 
-    for (const auto& path : fs::directory_iterator(NOTIFY_SERVICES_DIR))
+    std::error_code ec;
+    for (const auto& entry :
+         fs::directory_iterator(NOTIFY_SERVICES_DIR, ec))
     {
-        _notifyReqs.emplace_back(std::make_unique<notify::NotifyService>(
-            _ctx, *_extDataIfaces, path, [this](notify::NotifyService* ptr) {
-            std::erase_if(_notifyReqs,
-                          [ptr](const auto& p) { return p.get() == ptr; });
-        }));
+        if (!entry.is_directory(ec))
+        {
+            processNotifyRequest(entry.path());
+        }
+    }
+    if (ec)
+    {
+        lg2::error("Failed to list the pending notify requests of {DIR}, "
+                   "error: {ERROR}",
+                   "DIR", NOTIFY_SERVICES_DIR, "ERROR", ec.message());
     }
 
     co_return;
 }
 
+void Manager::processNotifyRequest(const fs::path& notifyFilePath)
+{
+    // A rescan lists the requests already being processed as well.
+    if (std::ranges::any_of(_notifyReqs, [&notifyFilePath](const auto& req) {
+            return req->getNotifyFilePath() == notifyFilePath;
+        }))
+    {
+        return;
+    }
+
+    _notifyReqs.emplace_back(std::make_unique<notify::NotifyService>(
+        _ctx, *_extDataIfaces, notifyFilePath,
+        [this](notify::NotifyService* ptr) {
+        std::erase_if(_notifyReqs,
+                      [ptr](const auto& p) { return p.get() == ptr; });
+    }));
+}
+
 // NOLINTNEXTLINE
 sdbusplus::async::task<> Manager::monitorServiceNotifications()
 {
@@ -188,26 +257,21 @@ sdbusplus::async::task<> Manager::monitorServiceNotifications()
         // Start watching the NOTIFY_SERVICE_DIR
         // Monitoring for IN_MOVED_TO only as rsync creates a temporary file in
         // the destination and then rename to original file.
-        watch::inotify::DataWatcher notifyWatcher(
-            _ctx, IN_NONBLOCK | IN_CLOEXEC, IN_MOVED_TO, NOTIFY_SERVICES_DIR);
-        while (!_ctx.stop_requested())
-        {
-            if (auto dataOperations = co_await notifyWatcher.onDataChange();
-                !dataOperations.empty())
+        _notifyWatcher = std::make_unique<watch::inotify::DataWatcher>(
+            _inotifyMux,
+            [this](const watch::DataOperations& dataOperations) {
+            for (const auto& dataOp : dataOperations)
             {
-                for (const auto& [path, Op] : dataOperations)
+                // The whole directory is reported upon an inotify queue
+                // overflow, hence rescan it for the lost requests.
+                if ((dataOp.path / "") == (fs::path(NOTIFY_SERVICES_DIR) / ""))
                 {
-                    _notifyReqs.emplace_back(
-                        std::make_unique<notify::NotifyService>(
-                            _ctx, *_extDataIfaces, path,
-                            [this](notify::NotifyService* ptr) {
-                        std::erase_if(_notifyReqs, [ptr](const auto& p) {
-                            return p.get() == ptr;
-                        });
-                    }));
+                    _ctx.spawn(processPendingNotifications());
+                    continue;
                 }
+                processNotifyRequest(dataOp.path);
             }
-        }
+        }, IN_MOVED_TO, NOTIFY_SERVICES_DIR);
     }
     catch (std::exception& e)
     {
@@ -229,6 +293,46 @@ sdbusplus::async::task<> Manager::monitorServiceNotifications()
     co_return;
 }
 
+sdbusplus::async::task<>
+    // NOLINTNEXTLINE
+    Manager::handleWatcherFailure(fs::path path, std::string error)
+{
+    if (_notifyWatcher && _notifyWatcher->getDataPathToWatch() == path)
+    {
+        _notifyWatcher.reset();
+        ext_data::AdditionalData additionalDetails = {
+            {"DS_Notify_DIR", path.string()},
+            {"DS_Notify_Msg",
+             "Exception: Failed to handle the events of the notify services "
+             "directory: " +
+                 error}};
+        co_await _extDataIfaces->createErrorLog(
+            "xyz.openbmc_project.RBMC_DataSync.Error.NotifyFailure",
+            ext_data::ErrorLevel::Informational, additionalDetails);
+        co_return;
+    }
+
+    if (auto watcher = _activeWatchers.find(path);
+        watcher != _activeWatchers.end())
+    {
+        watcher->second->stop();
+        _activeWatchers.erase(watcher);
+    }
+    _hashTrees.erase(path);
+    setSyncEventsHealth(SyncEventsHealth::Critical);
+
+    ext_data::AdditionalData additionalDetails = {
+        {"DS_Events_Path", path.string()},
+        {"DS_Events_Msg",
+         "Exception: Failed to handle the inotify events of the configured "
+         "path: " +
+             error}};
+    co_await _extDataIfaces->createErrorLog(
+        "xyz.openbmc_project.RBMC_DataSync.Error.SyncEventsFailure",
+        ext_data::ErrorLevel::Warning, additionalDetails);
+    co_return;
+}
+
 bool Manager::isSyncEligible(const config::DataSyncConfig& dataSyncCfg)
 {
     using enum config::SyncDirection;
@@ -317,6 +421,121 @@ void Manager::stopSyncEvents()
     {
         watcher->stop();
     }
+    _activeWatchers.clear();
+    _hashTrees.clear();
+    _parkedSyncs.clear();
+    _rerunSyncOps.clear();
+    _fullSyncParked = false;
+
+    // The changes are not tracked until the next full sync.
+    _dirtyJournal.discard();
+}
+
+uint64_t Manager::getConfigHash() const
+{
+    // The timings do not change the synced data, so are not part of it.
+    std::vector<std::string> configs;
+    for (const auto& dataSyncCfg : _dataSyncConfiguration)
+    {
+        std::string config{dataSyncCfg._path.native()};
+        config.push_back('\0');
+        config.append(dataSyncCfg._destPath.value_or(fs::path()).native());
+        config.push_back('\0');
+        config.append(dataSyncCfg.getSyncDirectionInStr());
+        if (dataSyncCfg._excludeList.has_value())
+        {
+            config.push_back('\0');
+            config.append(dataSyncCfg._excludeList->second);
+        }
+        if (dataSyncCfg._includeList.has_value())
+        {
+            std::vector<std::string> includes;
+            for (const auto& path : *dataSyncCfg._includeList)
+            {
+                includes.emplace_back(path.native());
+            }
+            std::ranges::sort(includes);
+            for (const auto& include : includes)
+            {
+                config.push_back('\0');
+                config.append(include);
+            }
+        }
+        configs.emplace_back(std::move(config));
+    }
+    std::ranges::sort(configs);
+
+    uint64_t hash{0};
+    for (const auto& config : configs)
+    {
+        hash = sync::hashContent(config, hash);
+    }
+    return hash;
+}
+
+void Manager::replayDirtyPaths(const persist::DirtyState& dirtyState)
+{
+    const auto journalSequence = _dirtyJournal.sequence();
+    for (const auto& dataSyncCfg : _dataSyncConfiguration)
+    {
+        const auto cfgDir = (dataSyncCfg._path / "").native();
+        auto isUnderCfg = [&dataSyncCfg, &cfgDir](const fs::path& path) {
+            return path == dataSyncCfg._path ||
+                   (path / "").native().starts_with(cfgDir);
+        };
+
+        watch::DataOperations dataOperations;
+        for (const auto& path : dirtyState.paths)
+        {
+            if (isUnderCfg(path))
+            {
+                dataOperations.emplace_back(
+                    watch::DataOperation{path, watch::DataOps::COPY});
+            }
+        }
+        for (auto& path : persist::findChangedPaths(dataSyncCfg._path,
+                                                    dirtyState.lastUpdateNs))
+        {
+            dataOperations.emplace_back(
+                watch::DataOperation{std::move(path), watch::DataOps::COPY});
+        }
+        if (dataOperations.empty() || !isSyncEligible(dataSyncCfg))
+        {
+            continue;
+        }
+
+        lg2::debug("Replaying [{COUNT}] dirty paths of {PATH}", "COUNT",
+                   dataOperations.size(), "PATH", dataSyncCfg._path);
+        using enum config::SyncType;
+        if (dataSyncCfg._syncType == Immediate)
+        {
+            batchSync(dataSyncCfg, dataOperations);
+        }
+        else if (dataSyncCfg._syncType == Deferred)
+        {
+            deferSync(dataSyncCfg, dataOperations);
+        }
+        else if (_activeWatchers.contains(dataSyncCfg._path))
+        {
+            // Synced on the next period along with the later changes.
+            collectChangedPaths(_collectedSyncOps[dataSyncCfg._path],
+                                dataSyncCfg, dataOperations);
+        }
+        else
+        {
+            _dirtyJournal.markDirty({dataSyncCfg._path});
+            // NOLINTNEXTLINE
+            _ctx.spawn(syncData(dataSyncCfg, sync::SyncPriority::Periodic) |
+                       stdexec::then(
+                           []([[maybe_unused]] SyncResult result) {}));
+        }
+    }
+
+    // The paths of the configs removed or not synced by this BMC are dropped.
+    for (const auto& path : dirtyState.paths)
+    {
+        _dirtyJournal.markClean(path, journalSequence);
+    }
 }
 
 bool Manager::isRetryEligible(uint8_t errCode) noexcept
@@ -339,6 +558,196 @@ bool Manager::isRetryEligible(uint8_t errCode) noexcept
     }
 }
 
+bool Manager::isSiblingUnreachable(int errCode) noexcept
+{
+    switch (errCode)
+    {
+        case 5:  // Error starting client-server protocol
+        case 10: // Error in socket I/O
+        case 12: // Error in rsync protocol data stream
+        case 30: // Timeout in data send/receive
+        case 35: // Timeout waiting for daemon connection
+            return true;
+        default:
+            return false;
+    }
+}
+
+sync::CircuitBreaker& Manager::getSiblingBreaker()
+{
+#ifdef UNIT_TEST
+    const std::string endpoint{"local"};
+#else
+    const std::string endpoint{std::format(
+        "localhost:{}/{}",
+        (_extDataIfaces->bmcPosition() == 0 ? BMC1_RSYNC_PORT
+                                            : BMC0_RSYNC_PORT),
+        RSYNCD_MODULE_NAME)};
+#endif
+    return _siblingBreakers
+        .try_emplace(endpoint, SIBLING_FAILURE_THRESHOLD,
+                     std::chrono::seconds(SIBLING_MIN_BACKOFF),
+                     std::chrono::seconds(SIBLING_MAX_BACKOFF))
+        .first->second;
+}
+
+void Manager::recordSiblingResult(int errCode)
+{
+    recordSiblingReachability(!isSiblingUnreachable(errCode), errCode);
+}
+
+void Manager::recordSiblingReachability(bool reachable, int errCode)
+{
+    auto& breaker = getSiblingBreaker();
+    if (reachable)
+    {
+        if (breaker.recordSuccess())
+        {
+            _siblingOutageLogged = false;
+            lg2::info("Sibling BMC is reachable again, draining the parked "
+                      "syncs of [{COUNT}] paths",
+                      "COUNT", _parkedSyncs.size());
+            // The full sync parked by the outage covers its parked paths.
+            const bool resumeFullSync = std::exchange(_fullSyncParked, false);
+            drainParkedSyncs(resumeFullSync);
+            if (resumeFullSync)
+            {
+                resumeParkedFullSync();
+            }
+        }
+        return;
+    }
+
+    const bool wasClosed = breaker.getState() == sync::BreakerState::Closed;
+    if (breaker.recordFailure(std::chrono::steady_clock::now()) && wasClosed)
+    {
+        lg2::error("Sibling BMC is unreachable after [{COUNT}] failures, "
+                   "parking the syncs. ErrCode: {ERRCODE}",
+                   "COUNT", breaker.getConsecutiveFailures(), "ERRCODE",
+                   errCode);
+    }
+}
+
+void Manager::parkSync(const config::DataSyncConfig& dataSyncCfg,
+                       const watch::DataOperations& dataOperations,
+                       sync::SyncPriority priority)
+{
+    auto [parkedIt, added] = _parkedSyncs.try_emplace(dataSyncCfg._path);
+    auto& parked = parkedIt->second;
+    parked.priority = added ? priority : std::min(parked.priority, priority);
+    collectChangedPaths(parked.dataOperations, dataSyncCfg, dataOperations);
+    lg2::debug("Parked the sync of [{COUNT}] paths of [{PATH}] while the "
+               "sibling BMC is unreachable",
+               "COUNT", dataOperations.size(), "PATH", dataSyncCfg._path);
+
+    if (!_siblingProbeScheduled)
+    {
+        _siblingProbeScheduled = true;
+        _ctx.spawn(probeSibling());
+    }
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> Manager::probeSibling()
+{
+    using std::experimental::scope_exit;
+    auto cleanup = scope_exit(
+        [this]() noexcept { _siblingProbeScheduled = false; });
+
+    // A single error log per outage, instead of one per config.
+    if (!std::exchange(_siblingOutageLogged, true))
+    {
+        ext_data::AdditionalData additionalDetails = {
+            {"BMC_Role", _extDataIfaces->bmcRoleInStr()},
+            {"DS_Sync_Msg",
+             "Sibling BMC is unreachable, the syncs are parked until it is "
+             "reachable again"}};
+        co_await _extDataIfaces->createErrorLog(
+            "xyz.openbmc_project.RBMC_DataSync.Error.SyncFailure",
+            ext_data::ErrorLevel::Informational, additionalDetails);
+    }
+
+    while (!_ctx.stop_requested() && !_syncBMCDataIface.disable_sync())
+    {
+        auto& breaker = getSiblingBreaker();
+        if (breaker.getState() == sync::BreakerState::Closed)
+        {
+            // Closed by another sync, which drained the parked syncs.
+            break;
+        }
+
+        // NOLINTNEXTLINE
+        co_await _timers.sleepUntil(
+            breaker.getRetryTime(std::chrono::steady_clock::now()),
+            std::chrono::steady_clock::duration(0));
+        if (breaker.getState() != sync::BreakerState::Open)
+        {
+            continue;
+        }
+        if (_parkedSyncs.empty())
+        {
+            // The next sync probes the sibling.
+            break;
+        }
+
+        // The probe is a parked sync, which gets parked again if it fails.
+        auto parked = _parkedSyncs.extract(_parkedSyncs.begin());
+        auto dataSyncCfg = std::ranges::find(_dataSyncConfiguration,
+                                             parked.key(),
+                                             &config::DataSyncConfig::_path);
+        if (dataSyncCfg == _dataSyncConfiguration.end())
+        {
+            continue;
+        }
+        lg2::debug("Probing the sibling BMC with the parked sync of [{PATH}]",
+                   "PATH", parked.key());
+        // NOLINTNEXTLINE
+        co_await syncCollectedData(
+            *dataSyncCfg, watch::coalesce(parked.mapped().dataOperations),
+            parked.mapped().priority);
+    }
+    co_return;
+}
+
+void Manager::drainParkedSyncs(bool skipFullSync)
+{
+    // Spawned at once, so the SyncScheduler orders the whole backlog by
+    // priority.
+    for (auto& [path, parked] : std::exchange(_parkedSyncs, {}))
+    {
+        auto dataSyncCfg = std::ranges::find(_dataSyncConfiguration, path,
+                                             &config::DataSyncConfig::_path);
+        if (dataSyncCfg == _dataSyncConfiguration.end() ||
+            !isSyncEligible(*dataSyncCfg) ||
+            (skipFullSync && parked.priority == sync::SyncPriority::FullSync))
+        {
+            continue;
+        }
+        // NOLINTNEXTLINE
+        _ctx.spawn(syncCollectedData(*dataSyncCfg,
+                                     watch::coalesce(parked.dataOperations),
+                                     parked.priority));
+    }
+}
+
+void Manager::resumeParkedFullSync()
+{
+    if (_syncBMCDataIface.disable_sync())
+    {
+        return;
+    }
+    if (getSiblingBreaker().getState() != sync::BreakerState::Closed)
+    {
+        // Resumed once the sibling BMC is reachable again.
+        _fullSyncParked = true;
+        return;
+    }
+    lg2::info("Resuming the full sync parked while the sibling BMC was "
+              "unreachable");
+    // NOLINTNEXTLINE
+    _ctx.spawn(startFullSync());
+}
+
 // Disabled because this function conditionally accesses class members when
 // unit tests are not enabled.
 // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
@@ -489,13 +898,25 @@ sdbusplus::async::task<void>
     co_return;
 }
 
-sdbusplus::async::task<bool>
+sdbusplus::async::task<SyncResult>
     // NOLINTNEXTLINE
-    Manager::retrySync(const config::DataSyncConfig& cfg, fs::path srcPath,
-                       size_t retryCount)
+    Manager::retrySync(const config::DataSyncConfig& cfg,
+                       sync::SyncPriority priority, fs::path srcPath,
+                       size_t retryCount, fs::path movedFromPath)
 {
     const fs::path currentSrcPath = srcPath.empty() ? cfg._path : srcPath;
 
+    // The retries of all the configs would fail alike while the sibling BMC
+    // is unreachable, those are synced once it is reachable again.
+    if (getSiblingBreaker().getState() != sync::BreakerState::Closed)
+    {
+        parkSync(cfg,
+                 {watch::DataOperation{currentSrcPath, watch::DataOps::COPY,
+                                       std::move(movedFromPath)}},
+                 priority);
+        co_return SyncResult::Parked;
+    }
+
     if (cfg._retry.has_value() && retryCount++ < cfg._retry->_maxRetryAttempts)
     {
         lg2::debug(
@@ -505,44 +926,49 @@ sdbusplus::async::task<bool>
             cfg._retry->_maxRetryAttempts, "SRC_PATH", currentSrcPath,
             "RETRY_INTERVAL", cfg._retry->_retryIntervalInSec.count());
 
-        co_await sleep_for(_ctx, std::chrono::seconds(
-                                     cfg._retry->_retryIntervalInSec.count()));
+        // NOLINTNEXTLINE
+        co_await _timers.sleepFor(cfg._retry->_retryIntervalInSec);
 
         // NOLINTNEXTLINE
-        co_return co_await syncData(cfg, std::move(srcPath), retryCount);
+        co_return co_await syncData(cfg, priority, std::move(srcPath),
+                                    retryCount, std::move(movedFromPath));
     }
-    co_return false;
+    co_return SyncResult::Failed;
 }
 
-sdbusplus::async::task<bool>
+sdbusplus::async::task<SyncResult>
     // NOLINTNEXTLINE
     Manager::syncData(const config::DataSyncConfig& dataSyncCfg,
-                      fs::path srcPath, size_t retryCount)
+                      sync::SyncPriority priority, fs::path srcPath,
+                      size_t retryCount, fs::path movedFromPath)
 {
     // Don't sync if the sync is disabled
     if (_syncBMCDataIface.disable_sync())
     {
-        co_return false;
+        co_return SyncResult::Failed;
     }
 
     using std::experimental::scope_exit;
     const fs::path currentSrcPath = srcPath.empty() ? dataSyncCfg._path
                                                     : srcPath;
 
-    auto cleanup = scope_exit([&dataSyncCfg, &currentSrcPath]() noexcept {
+    auto cleanup = scope_exit([this, &dataSyncCfg,
+                               &currentSrcPath]() noexcept {
         // remove this path from the in-progress set once the first(main)
         // attempt completes
-        dataSyncCfg._syncInProgressPaths.erase(currentSrcPath);
+        releaseSyncPath(dataSyncCfg, currentSrcPath);
     });
 
     if (retryCount == 0)
     {
         if (dataSyncCfg._syncInProgressPaths.contains(currentSrcPath))
         {
-            lg2::debug("Skipping sync for [{SRC}]: already in progress", "SRC",
-                       currentSrcPath);
+            lg2::debug("Deferring sync for [{SRC}]: already in progress",
+                       "SRC", currentSrcPath);
+            _rerunSyncOps[dataSyncCfg._path].emplace_back(watch::DataOperation{
+                currentSrcPath, watch::DataOps::COPY, movedFromPath});
             cleanup.release(); // nothing inserted, skip cleanup
-            co_return true;
+            co_return SyncResult::Synced;
         }
         dataSyncCfg._syncInProgressPaths.emplace(currentSrcPath);
     }
@@ -552,19 +978,92 @@ sdbusplus::async::task<bool>
         cleanup.release();
     }
 
+    // The changes made until now are covered by this sync.
+    const auto journalSequence = _dirtyJournal.sequence();
+    auto markSynced = [this, &currentSrcPath, &movedFromPath,
+                       journalSequence]() {
+        _dirtyJournal.markClean(currentSrcPath, journalSequence);
+        if (!movedFromPath.empty())
+        {
+            _dirtyJournal.markClean(movedFromPath, journalSequence);
+        }
+    };
+
+    sync::CacheCheck cacheCheck;
+    if (srcPath.empty())
+    {
+        // The whole path is synced, the paths under it may change on the
+        // sibling.
+        _contentCache.erase(dataSyncCfg._path);
+    }
+    else
+    {
+        cacheCheck = checkSyncedContent(srcPath, movedFromPath);
+        if (cacheCheck.unchanged)
+        {
+            lg2::debug("Skipping sync for [{SRC}]: unchanged since its last "
+                       "sync",
+                       "SRC", srcPath);
+            markSynced();
+            co_return SyncResult::Synced;
+        }
+    }
+
+    // A renamed path is synced along with its source in a single run, the
+    // missing source gets deleted on the sibling. Each path is quoted, as
+    // the command is run through the shell.
     std::string syncCmd{};
-    getRsyncCmd(RsyncMode::Sync, dataSyncCfg, srcPath.string(), syncCmd);
+    std::string syncPaths{};
+    if (!srcPath.empty())
+    {
+        if (!movedFromPath.empty())
+        {
+            syncPaths = utility::rsync::quotePath(movedFromPath) + " ";
+        }
+        syncPaths.append(utility::rsync::quotePath(srcPath));
+    }
+    getRsyncCmd(RsyncMode::Sync, dataSyncCfg, syncPaths, syncCmd);
 
     if (syncCmd.empty())
     {
-        co_return true;
+        markSynced();
+        co_return SyncResult::Synced;
     }
 
     lg2::debug("Rsync command: {CMD}", "CMD", syncCmd);
 
+    // NOLINTNEXTLINE
+    auto syncSlot = co_await _syncScheduler.acquire(priority);
+    const auto stopToken = getStopToken(priority);
+    if (stopToken.stop_requested())
+    {
+        lg2::info("Sync of [{PATH}] skipped as the full sync is stopped",
+                  "PATH", currentSrcPath);
+        co_return SyncResult::Failed;
+    }
+    if (!getSiblingBreaker().allowRequest(std::chrono::steady_clock::now()))
+    {
+        parkSync(dataSyncCfg,
+                 {watch::DataOperation{currentSrcPath, watch::DataOps::COPY,
+                                       std::move(movedFromPath)}},
+                 priority);
+        co_return SyncResult::Parked;
+    }
+    // The dirty paths are flushed once per sync run, before it sends them.
+    _dirtyJournal.flush();
     data_sync::async::AsyncCommandExecutor executor(_ctx);
     // NOLINTNEXTLINE
-    auto result = co_await executor.execCmd(syncCmd);
+    auto result = co_await executor.execCmd(syncCmd, stopToken);
+    // Released before notifying the sibling or retrying, which wait for a
+    // slot again.
+    syncSlot.release();
+    if (stopToken.stop_requested())
+    {
+        lg2::info("Sync of [{PATH}] stopped as the full sync is stopped",
+                  "PATH", currentSrcPath);
+        co_return SyncResult::Failed;
+    }
+    recordSiblingResult(result.first);
     lg2::debug(
         "Rsync cmd output for [{PATH}] : return code : {RET} : output : {OUTPUT}",
         "PATH", currentSrcPath, "RET", result.first, "OUTPUT", result.second);
@@ -583,6 +1082,12 @@ sdbusplus::async::task<bool>
     {
         case 0: // Success
         {
+            markSynced();
+            if (cacheCheck.fingerprint)
+            {
+                _contentCache.record(srcPath, *cacheCheck.fingerprint);
+            }
+
             // Notify only if configured, we know the concrete path,
             // and bytes > 0
             if (dataSyncCfg._notifySibling &&
@@ -597,17 +1102,18 @@ sdbusplus::async::task<bool>
                 co_await triggerSiblingNotification(dataSyncCfg,
                                                     currentSrcPath.string());
             }
-            co_return true;
+            co_return SyncResult::Synced;
         }
 
         case 24: // Vanished source: treat as success
         {
             // TODO: Revisit notification handling for vanished files if partial
             // data got synced
+            markSynced();
             lg2::debug(
                 "Rsync exited with vanished file error for [{SRC}], treating as success",
                 "SRC", currentSrcPath);
-            co_return true;
+            co_return SyncResult::Synced;
         }
 
         default:
@@ -632,7 +1138,7 @@ sdbusplus::async::task<bool>
                 co_await _extDataIfaces->createErrorLog(
                     "xyz.openbmc_project.RBMC_DataSync.Error.SyncFailure",
                     ext_data::ErrorLevel::Warning, additionalDetails);
-                co_return false;
+                co_return SyncResult::Failed;
             }
 
             lg2::debug(
@@ -640,10 +1146,12 @@ sdbusplus::async::task<bool>
                 "SRC", currentSrcPath, "ERRCODE", result.first, "ERRMSG",
                 result.second);
 
-            auto retrySuccess = co_await retrySync(
-                dataSyncCfg, srcPath.empty() ? fs::path{} : currentSrcPath,
-                retryCount);
-            if (dataSyncCfg._retry.has_value() && !retrySuccess &&
+            auto retryResult = co_await retrySync(
+                dataSyncCfg, priority,
+                srcPath.empty() ? fs::path{} : currentSrcPath, retryCount,
+                movedFromPath);
+            if (dataSyncCfg._retry.has_value() &&
+                retryResult == SyncResult::Failed &&
                 retryCount >= dataSyncCfg._retry->_maxRetryAttempts)
             {
                 lg2::error(
@@ -668,48 +1176,963 @@ sdbusplus::async::task<bool>
                     "xyz.openbmc_project.RBMC_DataSync.Error.SyncFailure",
                     ext_data::ErrorLevel::Warning, additionalDetails);
             }
-            co_return retrySuccess;
+            co_return retryResult;
         }
     }
 }
 
-sdbusplus::async::task<>
-    Manager::syncNotifyRequest(const config::DataSyncConfig& cfg,
-                               const fs::path& modifiedPath,
-                               const fs::path& notifyPath)
+void Manager::batchSync(const config::DataSyncConfig& dataSyncCfg,
+                        const watch::DataOperations& dataOperations)
 {
-    std::string notifyCmd{};
-    getRsyncCmd(RsyncMode::Notify, cfg, notifyPath.string(), notifyCmd);
-    lg2::debug("Sync sibling notify request cmd : {CMD}", "CMD", notifyCmd);
+    // Journaled before the sync starts, to resume it after a restart.
+    std::vector<fs::path> dirtyPaths;
+    for (const auto& dataOp : dataOperations)
+    {
+        dirtyPaths.emplace_back(dataOp.path);
+        if (!dataOp.movedFrom.empty())
+        {
+            dirtyPaths.emplace_back(dataOp.movedFrom);
+        }
+    }
+    _dirtyJournal.markDirty(dirtyPaths);
 
-    std::pair<int, std::string> result{-1, ""};
-    // retryAttempts = 0 indicates initial attempt, if fails retry happens
-    uint8_t retryAttempts = 0;
-    while (cfg._retry.has_value() &&
-           retryAttempts++ <= cfg._retry->_maxRetryAttempts)
+    auto [pendingIt, idle] = _pendingSyncOps.try_emplace(dataSyncCfg._path);
+    pendingIt->second.insert(pendingIt->second.end(), dataOperations.begin(),
+                             dataOperations.end());
+    if (idle)
     {
-        data_sync::async::AsyncCommandExecutor executor(_ctx);
-        result = co_await executor.execCmd(notifyCmd);
+        _ctx.spawn(syncPendingData(dataSyncCfg));
+    }
+}
 
-        switch (result.first)
+sdbusplus::async::task<>
+    // NOLINTNEXTLINE
+    Manager::syncPendingData(const config::DataSyncConfig& dataSyncCfg)
+{
+    while (!_ctx.stop_requested() && !_syncBMCDataIface.disable_sync())
+    {
+        auto& pendingOps = _pendingSyncOps[dataSyncCfg._path];
+        if (pendingOps.empty())
         {
-            case 0: // Success
-            {
-                lg2::debug(
-                    "Successfully send notify request[{NOTIFYPATH}] to the sibling BMC "
-                    "for the path[{PATH}]",
-                    "NOTIFYPATH", notifyPath, "PATH", modifiedPath);
-                co_return;
-            }
+            break;
+        }
 
-            case 24: // Vanished source
-            {
-                lg2::error(
-                    "Notify Request[{NOTIFYPATH}] to sibling BMC exited with vanished "
-                    "file error for the path [{PATH}], treating as permanent error.",
-                    "NOTIFYPATH", notifyPath, "PATH", modifiedPath);
-                co_return;
-            }
+        // Sync each distinct root only once, a batch usually has several
+        // events for the same path or for the children of a directory.
+        auto dataOperations = std::exchange(pendingOps, {});
+        auto coalescedOps = watch::coalesce(dataOperations);
+        lg2::debug("Coalesced [{COUNT}] data operations of {PATH} into "
+                   "[{COALESCED}] syncs",
+                   "COUNT", dataOperations.size(), "PATH", dataSyncCfg._path,
+                   "COALESCED", coalescedOps.size());
+
+        // The configured path itself is reported when the events are lost
+        // (Eg: on an event queue overflow), sync it like a full sync to
+        // honour the include list, which covers the other paths too.
+        if (std::ranges::any_of(coalescedOps,
+                                [&dataSyncCfg](const auto& dataOp) {
+            return (dataOp.path / "") == (dataSyncCfg._path / "");
+        }))
+        {
+            // NOLINTNEXTLINE
+            co_await syncData(dataSyncCfg, sync::SyncPriority::Immediate);
+            continue;
+        }
+
+        // NOLINTNEXTLINE
+        co_await syncBatchedData(dataSyncCfg, std::move(coalescedOps),
+                                 sync::SyncPriority::Immediate);
+    }
+
+    _pendingSyncOps.erase(dataSyncCfg._path);
+    co_return;
+}
+
+sdbusplus::async::task<>
+    // NOLINTNEXTLINE
+    Manager::syncBatchedData(const config::DataSyncConfig& dataSyncCfg,
+                             watch::DataOperations dataOperations,
+                             sync::SyncPriority priority)
+{
+    // The paths still being synced (Eg: retrying) are synced again once
+    // released, the same as in the sync of a single path.
+    std::erase_if(dataOperations, [this, &dataSyncCfg](auto& dataOp) {
+        if (dataSyncCfg._syncInProgressPaths.contains(dataOp.path))
+        {
+            lg2::debug("Deferring sync for [{SRC}]: already in progress",
+                       "SRC", dataOp.path);
+            _rerunSyncOps[dataSyncCfg._path].emplace_back(std::move(dataOp));
+            return true;
+        }
+        return false;
+    });
+    if (dataOperations.empty())
+    {
+        co_return;
+    }
+
+    // The changes made until now are covered by this sync.
+    const auto journalSequence = _dirtyJournal.sequence();
+    auto markSynced = [this, journalSequence](const auto& dataOp) {
+        _dirtyJournal.markClean(dataOp.path, journalSequence);
+        if (!dataOp.movedFrom.empty())
+        {
+            _dirtyJournal.markClean(dataOp.movedFrom, journalSequence);
+        }
+    };
+
+    // The files rewritten with the same contents are skipped.
+    std::map<fs::path, sync::ContentFingerprint> fingerprints;
+    std::map<fs::path, transfer::FileRecord> readRecords;
+    std::erase_if(dataOperations, [this, &fingerprints, &readRecords,
+                                   &markSynced](const auto& dataOp) {
+        auto cacheCheck = checkSyncedContent(dataOp.path, dataOp.movedFrom);
+        if (cacheCheck.unchanged)
+        {
+            lg2::debug("Skipping sync for [{SRC}]: unchanged since its last "
+                       "sync",
+                       "SRC", dataOp.path);
+            markSynced(dataOp);
+            return true;
+        }
+        if (cacheCheck.fingerprint)
+        {
+            fingerprints.emplace(dataOp.path, *cacheCheck.fingerprint);
+        }
+        if (cacheCheck.record)
+        {
+            readRecords.emplace(dataOp.path, std::move(*cacheCheck.record));
+        }
+        return false;
+    });
+    if (dataOperations.empty())
+    {
+        co_return;
+    }
+
+    if (_transferClient)
+    {
+        // Copied, as the operations are compared against the ones returned.
+        const auto nativeOps = dataOperations;
+        // NOLINTNEXTLINE
+        auto rsyncOps = co_await transferNatively(
+            dataSyncCfg, nativeOps, priority, std::move(readRecords));
+        if (!rsyncOps)
+        {
+            // Parked until the sibling is reachable again.
+            co_return;
+        }
+        dataOperations = std::move(*rsyncOps);
+
+        // The operations not returned got transferred.
+        for (const auto& dataOp : nativeOps)
+        {
+            if (!std::ranges::contains(dataOperations, dataOp))
+            {
+                markSynced(dataOp);
+            }
+        }
+        std::erase_if(fingerprints, [this, &dataOperations](const auto& entry) {
+            if (std::ranges::contains(dataOperations, entry.first,
+                                      &watch::DataOperation::path))
+            {
+                return false;
+            }
+            _contentCache.record(entry.first, entry.second);
+            return true;
+        });
+        if (dataOperations.empty())
+        {
+            co_return;
+        }
+    }
+
+    std::vector<fs::path> srcPaths;
+    for (const auto& dataOp : dataOperations)
+    {
+        dataSyncCfg._syncInProgressPaths.emplace(dataOp.path);
+        // A renamed path is synced along with its source, the missing source
+        // gets deleted on the sibling.
+        if (!dataOp.movedFrom.empty())
+        {
+            srcPaths.emplace_back(dataOp.movedFrom);
+        }
+        srcPaths.emplace_back(dataOp.path);
+    }
+
+    using std::experimental::scope_exit;
+    // The paths handed over to the retries or to the single path syncs are
+    // released by those.
+    bool handedOver{false};
+    auto cleanup = scope_exit([this, &dataSyncCfg, &dataOperations,
+                               &handedOver]() noexcept {
+        if (!handedOver)
+        {
+            std::ranges::for_each(dataOperations,
+                                  [this, &dataSyncCfg](const auto& dataOp) {
+                releaseSyncPath(dataSyncCfg, dataOp.path);
+            });
+        }
+    });
+
+    fs::path listPath;
+    try
+    {
+        listPath = utility::rsync::writeFilesFromList(srcPaths);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to batch the sync of [{COUNT}] paths of {PATH}, "
+                   "syncing each path. Exception : {ERROR}",
+                   "COUNT", dataOperations.size(), "PATH", dataSyncCfg._path,
+                   "ERROR", e);
+    }
+    if (listPath.empty())
+    {
+        for (auto& dataOp : dataOperations)
+        {
+            dataSyncCfg._syncInProgressPaths.erase(dataOp.path);
+            // NOLINTNEXTLINE
+            _ctx.spawn(syncData(dataSyncCfg, priority, dataOp.path, 0,
+                                dataOp.movedFrom) |
+                       stdexec::then(
+                           []([[maybe_unused]] SyncResult result) {}));
+        }
+        handedOver = true;
+        co_return;
+    }
+    auto removeList = scope_exit([&listPath]() noexcept {
+        std::error_code ec;
+        fs::remove(listPath, ec);
+    });
+
+    // The listed paths are relative to the root, and each listed directory
+    // is synced recursively.
+    std::string syncCmd{};
+    getRsyncCmd(RsyncMode::Sync, dataSyncCfg,
+                std::string(utility::rsync::transferredPathsOpt) +
+                    " --from0 --files-from=" + listPath.string() + " /",
+                syncCmd);
+
+    lg2::debug("Rsync command: {CMD}", "CMD", syncCmd);
+
+    // NOLINTNEXTLINE
+    auto syncSlot = co_await _syncScheduler.acquire(priority);
+    const auto stopToken = getStopToken(priority);
+    if (stopToken.stop_requested())
+    {
+        co_return;
+    }
+    if (!getSiblingBreaker().allowRequest(std::chrono::steady_clock::now()))
+    {
+        parkSync(dataSyncCfg, dataOperations, priority);
+        co_return;
+    }
+    _dirtyJournal.flush();
+    data_sync::async::AsyncCommandExecutor executor(_ctx);
+    // NOLINTNEXTLINE
+    auto result = co_await executor.execCmd(syncCmd, stopToken);
+    syncSlot.release();
+    if (stopToken.stop_requested())
+    {
+        co_return;
+    }
+    recordSiblingResult(result.first);
+    lg2::debug("Rsync cmd output for [{COUNT}] paths of [{PATH}] : return "
+               "code : {RET} : output : {OUTPUT}",
+               "COUNT", dataOperations.size(), "PATH", dataSyncCfg._path,
+               "RET", result.first, "OUTPUT", result.second);
+
+    switch (result.first)
+    {
+        case 0: // Success
+        {
+            std::ranges::for_each(dataOperations, markSynced);
+            for (const auto& [path, fingerprint] : fingerprints)
+            {
+                _contentCache.record(path, fingerprint);
+            }
+
+            // Notify only if configured, and for the paths whose data got
+            // transferred.
+            if (!dataSyncCfg._notifySibling ||
+                utility::rsync::getTransferredDataBytes(result.second) == 0)
+            {
+                co_return;
+            }
+            auto transferredPaths =
+                utility::rsync::getTransferredPaths(result.second);
+            for (const auto& dataOp : dataOperations)
+            {
+                const auto& path = dataOp.path.native();
+                if (std::ranges::any_of(
+                        transferredPaths, [&path](const fs::path& transferred) {
+                    return transferred.native() == path ||
+                           (path.ends_with('/') &&
+                            transferred.native().starts_with(path));
+                }))
+                {
+                    // NOLINTNEXTLINE
+                    co_await triggerSiblingNotification(dataSyncCfg,
+                                                        dataOp.path.string());
+                }
+            }
+            co_return;
+        }
+
+        case 24: // Vanished source: treat as success
+        {
+            std::ranges::for_each(dataOperations, markSynced);
+            lg2::debug("Rsync exited with vanished file error for [{COUNT}] "
+                       "paths of [{PATH}], treating as success",
+                       "COUNT", dataOperations.size(), "PATH",
+                       dataSyncCfg._path);
+            co_return;
+        }
+
+        default:
+        {
+            if (!isRetryEligible(result.first))
+            {
+                lg2::error(
+                    "Error syncing [{COUNT}] paths of [{PATH}], ErrCode: "
+                    "{ERRCODE}, ErrMsg: {ERRMSG} SyncCmd : [{SYNC_CMD}]",
+                    "COUNT", dataOperations.size(), "PATH", dataSyncCfg._path,
+                    "ERRCODE", result.first, "ERRMSG", result.second,
+                    "SYNC_CMD", syncCmd);
+                // Mark sync event health as critical when a non-retryable
+                // (permanent) sync error occurs.
+                setSyncEventsHealth(SyncEventsHealth::Critical);
+
+                ext_data::AdditionalData additionalDetails = {
+                    {"BMC_Role", _extDataIfaces->bmcRoleInStr()},
+                    {"DS_Sync_Path", dataSyncCfg._path.string()},
+                    {"DS_Sync_ErrCode", std::to_string(result.first)},
+                    {"DS_Sync_ErrMsg", result.second},
+                    {"DS_Sync_Msg",
+                     "Permanent rsync failure occurred for the batched paths"}};
+                additionalDetails["DS_Sync_Type"] =
+                    dataSyncCfg.getSyncTypeInStr();
+                additionalDetails["DS_Sync_Direction"] =
+                    dataSyncCfg.getSyncDirectionInStr();
+
+                co_await _extDataIfaces->createErrorLog(
+                    "xyz.openbmc_project.RBMC_DataSync.Error.SyncFailure",
+                    ext_data::ErrorLevel::Warning, additionalDetails);
+                co_return;
+            }
+
+            // The exit code covers the whole batch, so each path is retried
+            // on its own to find and track the failing ones.
+            lg2::debug("Retrying rsync for each of [{COUNT}] paths of [{PATH}] "
+                       "after ErrCode: {ERRCODE}, ErrMsg: {ERRMSG}",
+                       "COUNT", dataOperations.size(), "PATH",
+                       dataSyncCfg._path, "ERRCODE", result.first, "ERRMSG",
+                       result.second);
+            handedOver = true;
+            for (auto& dataOp : dataOperations)
+            {
+                _ctx.spawn(retryBatchedPath(dataSyncCfg, priority,
+                                            std::move(dataOp.path),
+                                            std::move(dataOp.movedFrom)));
+            }
+            co_return;
+        }
+    }
+}
+
+sync::CacheCheck Manager::checkSyncedContent(const fs::path& srcPath,
+                                             const fs::path& movedFromPath)
+{
+    if (!movedFromPath.empty())
+    {
+        _contentCache.erase(movedFromPath);
+        _contentCache.erase(srcPath);
+    }
+    return _contentCache.check(srcPath);
+}
+
+sdbusplus::async::task<std::optional<watch::DataOperations>>
+    // NOLINTNEXTLINE
+    Manager::transferNatively(
+        const config::DataSyncConfig& dataSyncCfg,
+        watch::DataOperations dataOperations, sync::SyncPriority priority,
+        std::map<fs::path, transfer::FileRecord> readRecords)
+{
+    const fs::path destRoot = dataSyncCfg._destPath.value_or(fs::path("/"));
+    auto readRecord = [&destRoot, &readRecords](const fs::path& srcPath)
+        -> std::optional<transfer::FileRecord> {
+        auto destPath = destRoot / srcPath.relative_path();
+        auto readNode = readRecords.extract(srcPath);
+        if (readNode.empty())
+        {
+            return transfer::readFileRecord(srcPath, destPath,
+                                            NATIVE_TRANSFER_MAX_SIZE);
+        }
+        if (readNode.mapped().data.size() > NATIVE_TRANSFER_MAX_SIZE)
+        {
+            return std::nullopt;
+        }
+        readNode.mapped().destPath = std::move(destPath);
+        return std::move(readNode.mapped());
+    };
+
+    // The records of each operation, the delete of the renamed source first.
+    watch::DataOperations rsyncOps;
+    watch::DataOperations nativeOps;
+    std::vector<transfer::FileRecord> records;
+    std::vector<size_t> recordCounts;
+    for (auto& dataOp : dataOperations)
+    {
+        // The directories are synced recursively by rsync.
+        if (dataOp.path.native().ends_with('/') ||
+            dataOp.movedFrom.native().ends_with('/'))
+        {
+            rsyncOps.emplace_back(std::move(dataOp));
+            continue;
+        }
+
+        std::optional<transfer::FileRecord> movedFromRecord;
+        if (!dataOp.movedFrom.empty())
+        {
+            movedFromRecord = readRecord(dataOp.movedFrom);
+        }
+        auto record = readRecord(dataOp.path);
+        if (!record || (!dataOp.movedFrom.empty() && !movedFromRecord))
+        {
+            rsyncOps.emplace_back(std::move(dataOp));
+            continue;
+        }
+
+        size_t count{1};
+        if (movedFromRecord)
+        {
+            movedFromRecord->updateOnly =
+                dataSyncCfg._syncDirection ==
+                config::SyncDirection::Bidirectional;
+            records.emplace_back(std::move(*movedFromRecord));
+            ++count;
+        }
+        record->updateOnly = dataSyncCfg._syncDirection ==
+                             config::SyncDirection::Bidirectional;
+        records.emplace_back(std::move(*record));
+        recordCounts.emplace_back(count);
+        nativeOps.emplace_back(std::move(dataOp));
+    }
+    if (records.empty())
+    {
+        co_return rsyncOps;
+    }
+
+    // NOLINTNEXTLINE
+    auto syncSlot = co_await _syncScheduler.acquire(priority);
+    if (!getSiblingBreaker().allowRequest(std::chrono::steady_clock::now()))
+    {
+        // The operations left to rsync would get parked alike.
+        std::ranges::move(nativeOps, std::back_inserter(rsyncOps));
+        parkSync(dataSyncCfg, rsyncOps, priority);
+        co_return std::nullopt;
+    }
+
+    std::vector<int> results;
+    try
+    {
+        _dirtyJournal.flush();
+        // NOLINTNEXTLINE
+        results = co_await _transferClient->send(records);
+        recordSiblingReachability(true, 0);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::warning("Native transfer of [{COUNT}] paths of [{PATH}] failed, "
+                     "syncing them by rsync. Error : {ERROR}",
+                     "COUNT", nativeOps.size(), "PATH", dataSyncCfg._path,
+                     "ERROR", e);
+        // Counted the same as an rsync run which could not reach the
+        // sibling.
+        const auto* systemError = dynamic_cast<const std::system_error*>(&e);
+        recordSiblingReachability(false,
+                                  systemError ? systemError->code().value()
+                                              : EPROTO);
+    }
+    syncSlot.release();
+    if (results.size() != records.size())
+    {
+        std::ranges::move(nativeOps, std::back_inserter(rsyncOps));
+        co_return rsyncOps;
+    }
+
+    // An operation is done only if all its records got applied, the failed
+    // ones are retried and reported by rsync.
+    size_t transferred{0};
+    auto result = results.cbegin();
+    auto record = records.cbegin();
+    for (size_t index = 0; index < nativeOps.size(); ++index)
+    {
+        const auto count = static_cast<std::ptrdiff_t>(recordCounts[index]);
+        bool applied = std::all_of(result, result + count,
+                                   [](int error) { return error == 0; });
+        bool deleted = (record + count - 1)->op == transfer::TransferOp::Delete;
+        result += count;
+        record += count;
+
+        if (!applied)
+        {
+            lg2::debug("Native transfer of [{SRC}] failed, syncing it by rsync",
+                       "SRC", nativeOps[index].path);
+            rsyncOps.emplace_back(std::move(nativeOps[index]));
+            continue;
+        }
+        ++transferred;
+        if (dataSyncCfg._notifySibling && !deleted)
+        {
+            // NOLINTNEXTLINE
+            co_await triggerSiblingNotification(
+                dataSyncCfg, nativeOps[index].path.string());
+        }
+    }
+    lg2::debug("Transferred [{COUNT}] paths of [{PATH}] natively", "COUNT",
+               transferred, "PATH", dataSyncCfg._path);
+    co_return rsyncOps;
+}
+
+void Manager::startNativeTransfer()
+{
+    if constexpr (NATIVE_TRANSFER_MAX_SIZE == 0)
+    {
+        return;
+    }
+
+    const bool isBMC0 = _extDataIfaces->bmcPosition() == 0;
+    try
+    {
+        _transferServer = std::make_unique<transfer::TransferServer>(
+            _ctx, isBMC0 ? BMC0_TRANSFER_PORT : BMC1_TRANSFER_PORT,
+            [this](const fs::path& destPath) {
+            return isTransferAllowed(destPath);
+        }, NATIVE_TRANSFER_MAX_SIZE, [this](const fs::path& destPath) {
+            return describeTreeLevel(destPath);
+        });
+    }
+    catch (const std::exception& e)
+    {
+        // The sibling falls back to rsync once its transfers fail.
+        lg2::error("Failed to start receiving the native transfers. Error : "
+                   "{ERROR}",
+                   "ERROR", e);
+    }
+
+    // The connections are opened on the first transfer.
+    _transferClient = std::make_unique<transfer::TransferClient>(
+        _ctx, isBMC0 ? BMC1_TRANSFER_PORT : BMC0_TRANSFER_PORT);
+}
+
+bool Manager::isTransferAllowed(const fs::path& destPath) const
+{
+    auto isInTree = [](const fs::path& path, const fs::path& root) {
+        auto relative = path.lexically_relative(root.lexically_normal());
+        return !relative.empty() && *relative.begin() != "..";
+    };
+
+    // Only the paths the sibling would sync by rsync with the same config
+    // may be modified.
+    using enum config::SyncDirection;
+    using enum ext_data::BMCRole;
+    const auto bmcRole = _extDataIfaces->bmcRole();
+    return std::ranges::any_of(_dataSyncConfiguration, [&destPath, &isInTree,
+                                                        bmcRole](
+                                                           const auto& cfg) {
+        if (!((cfg._syncDirection == Bidirectional) ||
+              (cfg._syncDirection == Active2Passive && bmcRole == Passive) ||
+              (cfg._syncDirection == Passive2Active && bmcRole == Active)))
+        {
+            return false;
+        }
+
+        const auto destRoot = (cfg._destPath.value_or(fs::path("/")) /
+                               cfg._path.relative_path())
+                                  .lexically_normal();
+        if (!isInTree(destPath, destRoot))
+        {
+            return false;
+        }
+
+        // The lists hold the source paths.
+        const auto srcPath =
+            (cfg._path / destPath.lexically_relative(destRoot))
+                .lexically_normal();
+        if (cfg._excludeList.has_value() &&
+            std::ranges::any_of(cfg._excludeList->first,
+                                [&srcPath, &isInTree](const auto& excluded) {
+            return isInTree(srcPath, excluded);
+        }))
+        {
+            return false;
+        }
+        return !cfg._includeList.has_value() ||
+               std::ranges::any_of(*cfg._includeList,
+                                   [&srcPath, &isInTree](const auto& included) {
+            return isInTree(srcPath, included);
+        });
+    });
+}
+
+sdbusplus::async::task<SyncResult>
+    // NOLINTNEXTLINE
+    Manager::fullSyncData(const config::DataSyncConfig& dataSyncCfg)
+{
+    // The include list is honoured by the sync of the whole path only.
+    if (!_transferClient || dataSyncCfg._includeList.has_value() ||
+        _syncBMCDataIface.disable_sync())
+    {
+        // NOLINTNEXTLINE
+        co_return co_await syncData(dataSyncCfg, sync::SyncPriority::FullSync);
+    }
+
+    const fs::path remoteRoot = (dataSyncCfg._destPath.value_or(fs::path("/")) /
+                                 dataSyncCfg._path.relative_path())
+                                    .lexically_normal();
+    std::optional<std::vector<fs::path>> differingPaths;
+    try
+    {
+        // NOLINTNEXTLINE
+        co_await hashTreeInSteps(dataSyncCfg, dataSyncCfg._path,
+                                 dataSyncCfg._path, true);
+        // NOLINTNEXTLINE
+        differingPaths = co_await sync::findDifferingPaths(
+            getHashTree(dataSyncCfg, dataSyncCfg._path, false),
+            *_transferClient, remoteRoot);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::warning("Failed to compare the hash trees of [{PATH}] with the "
+                     "sibling, syncing the whole path. Error : {ERROR}",
+                     "PATH", dataSyncCfg._path, "ERROR", e);
+    }
+    if (!differingPaths)
+    {
+        // NOLINTNEXTLINE
+        co_return co_await syncData(dataSyncCfg, sync::SyncPriority::FullSync);
+    }
+    if (differingPaths->empty())
+    {
+        lg2::info("Full sync skipped for [{PATH}] as it is in sync with the "
+                  "sibling",
+                  "PATH", dataSyncCfg._path);
+        co_return SyncResult::Synced;
+    }
+
+    // The root itself differs when its entries got replaced on the sibling.
+    if (std::ranges::any_of(*differingPaths,
+                            [&dataSyncCfg](const fs::path& path) {
+        return (path / "") == (dataSyncCfg._path / "");
+    }))
+    {
+        // NOLINTNEXTLINE
+        co_return co_await syncData(dataSyncCfg, sync::SyncPriority::FullSync);
+    }
+
+    fs::path listPath;
+    try
+    {
+        listPath = utility::rsync::writeFilesFromList(*differingPaths);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to list the [{COUNT}] differing paths of {PATH}, "
+                   "syncing the whole path. Exception : {ERROR}",
+                   "COUNT", differingPaths->size(), "PATH", dataSyncCfg._path,
+                   "ERROR", e);
+    }
+    if (listPath.empty())
+    {
+        // NOLINTNEXTLINE
+        co_return co_await syncData(dataSyncCfg, sync::SyncPriority::FullSync);
+    }
+    using std::experimental::scope_exit;
+    auto removeList = scope_exit([&listPath]() noexcept {
+        std::error_code ec;
+        fs::remove(listPath, ec);
+    });
+
+    std::string syncCmd{};
+    getRsyncCmd(RsyncMode::Sync, dataSyncCfg,
+                " --from0 --files-from=" + listPath.string() + " /", syncCmd);
+    lg2::debug("Rsync command: {CMD}", "CMD", syncCmd);
+
+    // NOLINTNEXTLINE
+    auto syncSlot = co_await _syncScheduler.acquire(
+        sync::SyncPriority::FullSync);
+    const auto stopToken = getStopToken(sync::SyncPriority::FullSync);
+    if (stopToken.stop_requested())
+    {
+        co_return SyncResult::Failed;
+    }
+    if (!getSiblingBreaker().allowRequest(std::chrono::steady_clock::now()))
+    {
+        parkSync(dataSyncCfg,
+                 {watch::DataOperation{dataSyncCfg._path, watch::DataOps::COPY}},
+                 sync::SyncPriority::FullSync);
+        co_return SyncResult::Parked;
+    }
+
+    // The changes made until now are covered by this sync.
+    const auto journalSequence = _dirtyJournal.sequence();
+    _dirtyJournal.flush();
+    data_sync::async::AsyncCommandExecutor executor(_ctx);
+    // NOLINTNEXTLINE
+    auto result = co_await executor.execCmd(syncCmd, stopToken);
+    syncSlot.release();
+    if (stopToken.stop_requested())
+    {
+        lg2::info("Full sync of [{PATH}] stopped as the sync is disabled",
+                  "PATH", dataSyncCfg._path);
+        co_return SyncResult::Failed;
+    }
+    recordSiblingResult(result.first);
+    lg2::debug("Rsync cmd output for [{COUNT}] differing paths of [{PATH}] : "
+               "return code : {RET} : output : {OUTPUT}",
+               "COUNT", differingPaths->size(), "PATH", dataSyncCfg._path,
+               "RET", result.first, "OUTPUT", result.second);
+
+    // The whole path is synced on failure, to retry and report it.
+    if (result.first != 0 && result.first != 24)
+    {
+        // NOLINTNEXTLINE
+        co_return co_await syncData(dataSyncCfg, sync::SyncPriority::FullSync);
+    }
+
+    for (const auto& path : *differingPaths)
+    {
+        _dirtyJournal.markClean(path, journalSequence);
+    }
+    lg2::info("Full sync of [{PATH}] synced [{COUNT}] differing paths",
+              "PATH", dataSyncCfg._path, "COUNT", differingPaths->size());
+    if (result.first == 0 && dataSyncCfg._notifySibling &&
+        utility::rsync::getTransferredDataBytes(result.second) != 0)
+    {
+        // NOLINTNEXTLINE
+        co_await triggerSiblingNotification(dataSyncCfg,
+                                            dataSyncCfg._path.string());
+    }
+    co_return SyncResult::Synced;
+}
+
+sync::HashTree&
+    Manager::getHashTree(const config::DataSyncConfig& dataSyncCfg,
+                         const fs::path& root, bool rebuild)
+{
+    if (root == dataSyncCfg._path)
+    {
+        if (auto tracked = _hashTrees.find(root); tracked != _hashTrees.end())
+        {
+            // The watchers do not report every change of the metadata, such
+            // as a chmod or a chown, so a full sync rebuilds the tree too.
+            if (rebuild)
+            {
+                tracked->second.clear();
+            }
+            return tracked->second;
+        }
+    }
+
+    // The excluded paths of the destination are under the same relative
+    // paths.
+    std::vector<fs::path> excludes;
+    if (dataSyncCfg._excludeList.has_value())
+    {
+        for (const auto& exclude : dataSyncCfg._excludeList->first)
+        {
+            excludes.emplace_back(root /
+                                  exclude.lexically_relative(dataSyncCfg._path));
+        }
+    }
+    auto& hashTree =
+        _untrackedHashTrees.try_emplace(root, root, excludes).first->second;
+    if (rebuild)
+    {
+        hashTree.clear();
+    }
+    return hashTree;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> Manager::hashTreeInSteps(
+    const config::DataSyncConfig& dataSyncCfg, fs::path root, fs::path path,
+    bool rebuild)
+{
+    auto walk = getHashTree(dataSyncCfg, root, rebuild).startWalk(path);
+    while (!getHashTree(dataSyncCfg, root, false).hashStep(walk))
+    {
+        // NOLINTNEXTLINE
+        co_await sdbusplus::async::sleep_for(_ctx,
+                                             std::chrono::milliseconds(0));
+    }
+    co_return;
+}
+
+sdbusplus::async::task<std::optional<std::string>>
+    // NOLINTNEXTLINE
+    Manager::describeTreeLevel(fs::path destPath)
+{
+    for (const auto& dataSyncCfg : _dataSyncConfiguration)
+    {
+        const auto destRoot = (dataSyncCfg._destPath.value_or(fs::path("/")) /
+                               dataSyncCfg._path.relative_path())
+                                  .lexically_normal();
+        auto relative = destPath.lexically_relative(destRoot);
+        if (relative.empty() || *relative.begin() == "..")
+        {
+            continue;
+        }
+
+        // The comparison starts from the root, so the tree is rebuilt once
+        // per comparison, in steps to keep serving the events meanwhile.
+        // NOLINTNEXTLINE
+        co_await hashTreeInSteps(dataSyncCfg, destRoot, destPath,
+                                 destPath == destRoot);
+        auto level = getHashTree(dataSyncCfg, destRoot, false).level(destPath);
+        if (!level)
+        {
+            co_return std::nullopt;
+        }
+        co_return sync::encodeLevel(*level);
+    }
+    co_return std::nullopt;
+}
+
+sdbusplus::async::task<>
+    // NOLINTNEXTLINE
+    Manager::retryBatchedPath(const config::DataSyncConfig& dataSyncCfg,
+                              sync::SyncPriority priority, fs::path srcPath,
+                              fs::path movedFromPath)
+{
+    using std::experimental::scope_exit;
+    auto cleanup = scope_exit([this, &dataSyncCfg, srcPath]() noexcept {
+        releaseSyncPath(dataSyncCfg, srcPath);
+    });
+
+    // NOLINTNEXTLINE
+    co_await retrySync(dataSyncCfg, priority, srcPath, 0,
+                       std::move(movedFromPath));
+    co_return;
+}
+
+void Manager::releaseSyncPath(const config::DataSyncConfig& dataSyncCfg,
+                              const fs::path& srcPath)
+{
+    dataSyncCfg._syncInProgressPaths.erase(srcPath);
+
+    auto rerunIt = _rerunSyncOps.find(dataSyncCfg._path);
+    if (rerunIt == _rerunSyncOps.end())
+    {
+        return;
+    }
+    watch::DataOperations dataOperations;
+    std::erase_if(rerunIt->second, [&srcPath, &dataOperations](auto& dataOp) {
+        if (dataOp.path != srcPath)
+        {
+            return false;
+        }
+        dataOperations.emplace_back(std::move(dataOp));
+        return true;
+    });
+    if (rerunIt->second.empty())
+    {
+        _rerunSyncOps.erase(rerunIt);
+    }
+    if (dataOperations.empty() || _ctx.stop_requested() ||
+        _syncBMCDataIface.disable_sync())
+    {
+        return;
+    }
+
+    lg2::debug("Syncing [{SRC}] again as it changed while being synced",
+               "SRC", srcPath);
+    // Released on the completion of the syncs, which must not throw.
+    try
+    {
+        using enum config::SyncType;
+        if (dataSyncCfg._syncType == Immediate)
+        {
+            batchSync(dataSyncCfg, dataOperations);
+        }
+        else if (dataSyncCfg._syncType == Deferred)
+        {
+            deferSync(dataSyncCfg, dataOperations);
+        }
+        else if (_activeWatchers.contains(dataSyncCfg._path))
+        {
+            // Synced on the next period along with the later changes, else
+            // the whole path is.
+            collectChangedPaths(_collectedSyncOps[dataSyncCfg._path],
+                                dataSyncCfg, dataOperations);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to sync [{SRC}] again, Exception : {ERROR}", "SRC",
+                   srcPath, "ERROR", e);
+    }
+}
+
+sdbusplus::async::task<>
+    Manager::syncNotifyRequest(const config::DataSyncConfig& cfg,
+                               const fs::path& modifiedPath,
+                               const fs::path& notifyPath)
+{
+    std::string notifyCmd{};
+    getRsyncCmd(RsyncMode::Notify, cfg, notifyPath.string(), notifyCmd);
+    lg2::debug("Sync sibling notify request cmd : {CMD}", "CMD", notifyCmd);
+
+    std::pair<int, std::string> result{-1, ""};
+    // retryAttempts = 0 indicates initial attempt, if fails retry happens
+    uint8_t retryAttempts = 0;
+    while (cfg._retry.has_value() &&
+           retryAttempts++ <= cfg._retry->_maxRetryAttempts)
+    {
+        // The notify requests are as urgent as the changes they follow.
+        // NOLINTNEXTLINE
+        auto syncSlot = co_await _syncScheduler.acquire(
+            sync::SyncPriority::Immediate);
+
+        // The attempts are not spent while the sibling BMC is unreachable,
+        // the request waits for the breaker to let it through instead.
+        auto& breaker = getSiblingBreaker();
+        if (!breaker.allowRequest(std::chrono::steady_clock::now()))
+        {
+            syncSlot.release();
+            --retryAttempts;
+            // NOLINTNEXTLINE
+            co_await _timers.sleepUntil(
+                breaker.getRetryTime(std::chrono::steady_clock::now()),
+                std::chrono::steady_clock::duration(0));
+            continue;
+        }
+        data_sync::async::AsyncCommandExecutor executor(_ctx);
+        result = co_await executor.execCmd(notifyCmd);
+        syncSlot.release();
+        recordSiblingResult(result.first);
+
+        switch (result.first)
+        {
+            case 0: // Success
+            {
+                lg2::debug(
+                    "Successfully send notify request[{NOTIFYPATH}] to the sibling BMC "
+                    "for the path[{PATH}]",
+                    "NOTIFYPATH", notifyPath, "PATH", modifiedPath);
+                co_return;
+            }
+
+            case 24: // Vanished source
+            {
+                lg2::error(
+                    "Notify Request[{NOTIFYPATH}] to sibling BMC exited with vanished "
+                    "file error for the path [{PATH}], treating as permanent error.",
+                    "NOTIFYPATH", notifyPath, "PATH", modifiedPath);
+                co_return;
+            }
 
             default:
             {
@@ -739,8 +2162,8 @@ sdbusplus::async::task<>
             cfg._retry->_maxRetryAttempts, "INTERVAL",
             cfg._retry->_retryIntervalInSec.count());
 
-        co_await sleep_for(_ctx, std::chrono::seconds(
-                                     cfg._retry->_retryIntervalInSec.count()));
+        // NOLINTNEXTLINE
+        co_await _timers.sleepFor(cfg._retry->_retryIntervalInSec);
     }
 
     lg2::error("Failed to send notify request[{NOTIFYPATH}] to sibling BMC "
@@ -763,58 +2186,127 @@ sdbusplus::async::task<>
     co_return;
 }
 
-watch::inotify::DataWatcher*
-    Manager::addDataWatcher(const config::DataSyncConfig& dataSyncCfg)
+void Manager::addDataWatcher(const config::DataSyncConfig& dataSyncCfg,
+                             watch::DataChangeCallback callback)
 {
-    uint32_t eventMasksToWatch = IN_CLOSE_WRITE | IN_MOVE | IN_DELETE_SELF;
-    if (dataSyncCfg._isPathDir)
-    {
-        eventMasksToWatch |= IN_CREATE | IN_DELETE;
-    }
-
     auto excludeList = dataSyncCfg._excludeList.has_value()
                            ? std::make_optional<std::unordered_set<fs::path>>(
                                  dataSyncCfg._excludeList.value().first)
                            : std::nullopt;
 
-    auto [it, _] = _activeWatchers.emplace(
+    // The hash tree follows the same events, so a full sync compares it
+    // without rehashing the unchanged paths. It is not tracked if the
+    // watcher could not be created.
+    std::vector<fs::path> excludes;
+    if (excludeList.has_value())
+    {
+        excludes.assign(excludeList->begin(), excludeList->end());
+    }
+    auto& hashTree = _hashTrees
+                         .try_emplace(dataSyncCfg._path, dataSyncCfg._path,
+                                      excludes)
+                         .first->second;
+    hashTree.clear();
+    using std::experimental::scope_exit;
+    auto untrack = scope_exit([this, &dataSyncCfg]() noexcept {
+        if (!_activeWatchers.contains(dataSyncCfg._path))
+        {
+            _hashTrees.erase(dataSyncCfg._path);
+        }
+    });
+    callback = [&hashTree, callback = std::move(callback)](
+                   const watch::DataOperations& dataOperations) {
+        for (const auto& dataOp : dataOperations)
+        {
+            hashTree.invalidate(dataOp.path);
+            if (!dataOp.movedFrom.empty())
+            {
+                hashTree.invalidate(dataOp.movedFrom);
+            }
+        }
+        callback(dataOperations);
+    };
+
+    if (dataSyncCfg._watchBackend == config::WatchBackend::Poll)
+    {
+        _activeWatchers.emplace(
+            dataSyncCfg._path,
+            std::make_unique<watch::poll::PollWatcher>(
+                _pollMux, std::move(callback), dataSyncCfg._path, excludeList,
+                dataSyncCfg._includeList,
+                dataSyncCfg._pollIntervalInSec.value_or(
+                    watch::pollScanInterval)));
+        return;
+    }
+
+    // The fanotify marks cover the whole filesystem with the same events, so
+    // the periodic configs needing the modifications are watched by inotify.
+    if (_fanotifyMux && dataSyncCfg._syncType != config::SyncType::Periodic)
+    {
+        try
+        {
+            _activeWatchers.emplace(
+                dataSyncCfg._path,
+                std::make_unique<watch::fanotify::FanotifyWatcher>(
+                    *_fanotifyMux, callback, dataSyncCfg._path,
+                    dataSyncCfg._isPathDir, excludeList,
+                    dataSyncCfg._includeList));
+            return;
+        }
+        catch (const std::exception& e)
+        {
+            lg2::warning("Failed to monitor [{PATH}] using fanotify, falling "
+                         "back to inotify. Error : {ERROR}",
+                         "PATH", dataSyncCfg._path, "ERROR", e);
+        }
+    }
+
+    uint32_t eventMasksToWatch = IN_CLOSE_WRITE | IN_MOVE | IN_MOVE_SELF |
+                                 IN_DELETE_SELF;
+    if (dataSyncCfg._isPathDir)
+    {
+        eventMasksToWatch |= IN_CREATE | IN_DELETE;
+    }
+    if (dataSyncCfg._syncType == config::SyncType::Periodic)
+    {
+        // The periodically synced files are typically logs kept open and
+        // appended to, which are never closed after a write. The repeated
+        // modifications coalesce until the next period.
+        eventMasksToWatch |= IN_MODIFY;
+    }
+
+    _activeWatchers.emplace(
         dataSyncCfg._path,
         std::make_unique<watch::inotify::DataWatcher>(
-            _ctx, IN_NONBLOCK | IN_CLOEXEC, eventMasksToWatch,
-            dataSyncCfg._path, excludeList, dataSyncCfg._includeList));
-
-    return it->second.get();
+            _inotifyMux, std::move(callback), eventMasksToWatch,
+            dataSyncCfg._path, excludeList, dataSyncCfg._includeList,
+            dataSyncCfg._watchPriority));
 }
 
 sdbusplus::async::task<>
     // NOLINTNEXTLINE
     Manager::monitorDataToSync(const config::DataSyncConfig& dataSyncCfg)
 {
+    if (_activeWatchers.contains(dataSyncCfg._path))
+    {
+        // Still monitoring, the sync resumes along with the sync events.
+        co_return;
+    }
+
     bool exception{false};
     try
     {
-        auto* dataWatcher = addDataWatcher(dataSyncCfg);
-
-        // Ensure removal on scope exit
-        auto cleanup = std::experimental::scope_exit([this, &dataSyncCfg]() {
-            _activeWatchers.erase(dataSyncCfg._path);
-        });
-
-        while (!_ctx.stop_requested() && !_syncBMCDataIface.disable_sync())
-        {
-            // NOLINTNEXTLINE
-            if (auto dataOperations = co_await dataWatcher->onDataChange();
-                !dataOperations.empty())
+        // The events are dispatched from the inotify instance shared by all
+        // the configured paths.
+        addDataWatcher(dataSyncCfg,
+                       [this, &dataSyncCfg](
+                           const watch::DataOperations& dataOperations) {
+            if (_ctx.stop_requested() || _syncBMCDataIface.disable_sync())
             {
-                for (const auto& [path, dataOp] : dataOperations)
-                {
-                    // NOLINTNEXTLINE
-                    _ctx.spawn(
-                        syncData(dataSyncCfg, path) |
-                        stdexec::then([]([[maybe_unused]] bool result) {}));
-                }
+                return;
             }
-        }
+            batchSync(dataSyncCfg, dataOperations);
+        });
     }
     catch (std::exception& e)
     {
@@ -836,9 +2328,12 @@ sdbusplus::async::task<>
     co_return;
 }
 
-void Manager::deferSync(const config::DataSyncConfig& dataSyncCfg)
+void Manager::deferSync(const config::DataSyncConfig& dataSyncCfg,
+                        const watch::DataOperations& dataOperations)
 {
-    dataSyncCfg._lastDeferredSyncEventTime = std::chrono::steady_clock::now();
+    dataSyncCfg.recordDeferredSyncEvent(std::chrono::steady_clock::now());
+    collectChangedPaths(_collectedSyncOps[dataSyncCfg._path], dataSyncCfg,
+                        dataOperations);
 
     if (dataSyncCfg._deferredSyncScheduled)
     {
@@ -855,34 +2350,61 @@ sdbusplus::async::task<>
     while (!_ctx.stop_requested() && !_syncBMCDataIface.disable_sync() &&
            dataSyncCfg._deferredSyncIntervalInSec.has_value())
     {
-        const auto deferredSyncInterval =
-            dataSyncCfg._deferredSyncIntervalInSec.value();
-
-        // Time since the most recent event. If another event arrives before the
-        // interval completes, the timestamp is updated and this loop waits
-        // again from that new event time.
-        const auto timeSinceLastEvent = std::chrono::steady_clock::now() -
-                                        dataSyncCfg._lastDeferredSyncEventTime;
+        // Due once the events quiet down, or once the first pending event
+        // reaches the maximum latency. If another event arrives before then,
+        // the deadline moves and this loop waits again until the new one.
+        const auto now = std::chrono::steady_clock::now();
+        const auto deadline = dataSyncCfg.getDeferredSyncDeadline();
 
-        if (timeSinceLastEvent < deferredSyncInterval)
+        if (now < deadline)
         {
             // Wait only for the remaining interval. Example: for a 1s interval,
-            // if the last event was 300ms ago, wait 700ms more.
-            co_await sleep_for(_ctx, deferredSyncInterval - timeSinceLastEvent);
+            // if the last event was 300ms ago, wait 700ms more. The quiet
+            // window may be postponed to fire along with the other timers, but
+            // never past the maximum latency.
+            const auto latencyDeadline =
+                dataSyncCfg.getDeferredLatencyDeadline();
+            std::chrono::steady_clock::duration slack{0};
+            if (!latencyDeadline.has_value() || deadline < *latencyDeadline)
+            {
+                slack = (deadline - now) * _timers.getSlackPercent() / 100;
+                if (latencyDeadline.has_value())
+                {
+                    slack = std::min(slack, *latencyDeadline - deadline);
+                }
+            }
+            // NOLINTNEXTLINE
+            co_await _timers.sleepUntil(deadline, slack);
             continue;
         }
 
         // Remember the event timestamp covered by this sync. If another event
         // arrives while rsync is running, the timestamp changes and we run
-        // another sync.
+        // another sync, whose latency counts from that event.
         const auto syncedEventTime = dataSyncCfg._lastDeferredSyncEventTime;
+        dataSyncCfg._firstDeferredSyncEventTime.reset();
+        auto dataOperations = watch::coalesce(
+            std::exchange(_collectedSyncOps[dataSyncCfg._path], {}));
 
-        lg2::debug(
-            "Deferred sync quiet interval elapsed for [{PATH}], triggering root sync",
-            "PATH", dataSyncCfg._path);
+        if (now - syncedEventTime < dataSyncCfg.getDeferredQuietInterval())
+        {
+            lg2::debug("Deferred sync reached the maximum latency for [{PATH}] "
+                       "while still changing, triggering sync of [{COUNT}] "
+                       "paths",
+                       "PATH", dataSyncCfg._path, "COUNT",
+                       dataOperations.size());
+        }
+        else
+        {
+            lg2::debug("Deferred sync quiet interval elapsed for [{PATH}], "
+                       "triggering sync of [{COUNT}] paths",
+                       "PATH", dataSyncCfg._path, "COUNT",
+                       dataOperations.size());
+        }
 
         // NOLINTNEXTLINE
-        co_await syncData(dataSyncCfg);
+        co_await syncCollectedData(dataSyncCfg, std::move(dataOperations),
+                                   sync::SyncPriority::Deferred);
 
         if (dataSyncCfg._lastDeferredSyncEventTime == syncedEventTime)
         {
@@ -892,6 +2414,72 @@ sdbusplus::async::task<>
     }
 
     dataSyncCfg._deferredSyncScheduled = false;
+    dataSyncCfg._firstDeferredSyncEventTime.reset();
+    _collectedSyncOps.erase(dataSyncCfg._path);
+    co_return;
+}
+
+void Manager::collectChangedPaths(watch::DataOperations& collectedOps,
+                                  const config::DataSyncConfig& dataSyncCfg,
+                                  const watch::DataOperations& dataOperations)
+{
+    // Journaled before the sync starts, to resume it after a restart.
+    std::vector<fs::path> dirtyPaths;
+    for (const auto& dataOp : dataOperations)
+    {
+        dirtyPaths.emplace_back(dataOp.path);
+        if (!dataOp.movedFrom.empty())
+        {
+            dirtyPaths.emplace_back(dataOp.movedFrom);
+        }
+    }
+    _dirtyJournal.markDirty(dirtyPaths);
+
+    // Once too many paths changed, the configured path is synced instead and
+    // covers the later changes too.
+    if (collectedOps.size() == 1 &&
+        (collectedOps.front().path / "") == (dataSyncCfg._path / ""))
+    {
+        return;
+    }
+    collectedOps.insert(collectedOps.end(), dataOperations.begin(),
+                        dataOperations.end());
+    if (collectedOps.size() > MAX_COLLECTED_SYNC_PATHS)
+    {
+        collectedOps = watch::coalesce(collectedOps);
+    }
+    if (collectedOps.size() > MAX_COLLECTED_SYNC_PATHS)
+    {
+        lg2::debug("Collected more than [{COUNT}] changed paths of [{PATH}], "
+                   "syncing the whole path",
+                   "COUNT", MAX_COLLECTED_SYNC_PATHS, "PATH",
+                   dataSyncCfg._path);
+        collectedOps = {
+            watch::DataOperation{dataSyncCfg._path, watch::DataOps::COPY}};
+    }
+}
+
+sdbusplus::async::task<>
+    // NOLINTNEXTLINE
+    Manager::syncCollectedData(const config::DataSyncConfig& dataSyncCfg,
+                               watch::DataOperations dataOperations,
+                               sync::SyncPriority priority)
+{
+    // Only the changed paths are synced, unless the configured path itself
+    // got reported (Eg: on an event queue overflow or too many changes),
+    // which is synced like a full sync to honour the include list.
+    if (dataOperations.empty() ||
+        std::ranges::any_of(dataOperations, [&dataSyncCfg](const auto& dataOp) {
+        return (dataOp.path / "") == (dataSyncCfg._path / "");
+    }))
+    {
+        // NOLINTNEXTLINE
+        co_await syncData(dataSyncCfg, priority);
+        co_return;
+    }
+
+    // NOLINTNEXTLINE
+    co_await syncBatchedData(dataSyncCfg, std::move(dataOperations), priority);
     co_return;
 }
 
@@ -900,28 +2488,27 @@ sdbusplus::async::task<>
     Manager::monitorDeferredDataToSync(
         const config::DataSyncConfig& dataSyncCfg)
 {
+    if (_activeWatchers.contains(dataSyncCfg._path))
+    {
+        // Still monitoring, the sync resumes along with the sync events.
+        co_return;
+    }
+
     bool exception{false};
     try
     {
-        auto* dataWatcher = addDataWatcher(dataSyncCfg);
-
-        // Ensure removal on scope exit
-        auto cleanup = std::experimental::scope_exit([this, &dataSyncCfg]() {
-            _activeWatchers.erase(dataSyncCfg._path);
-        });
-
-        while (!_ctx.stop_requested() && !_syncBMCDataIface.disable_sync())
-        {
-            // NOLINTNEXTLINE
-            if (auto dataOperations = co_await dataWatcher->onDataChange();
-                !dataOperations.empty())
+        addDataWatcher(dataSyncCfg,
+                       [this, &dataSyncCfg](
+                           const watch::DataOperations& dataOperations) {
+            if (_ctx.stop_requested() || _syncBMCDataIface.disable_sync())
             {
-                lg2::debug(
-                    "Deferring sync for [{PATH}], received [{COUNT}] data operations",
-                    "PATH", dataSyncCfg._path, "COUNT", dataOperations.size());
-                deferSync(dataSyncCfg);
+                return;
             }
-        }
+            lg2::debug(
+                "Deferring sync for [{PATH}], received [{COUNT}] data operations",
+                "PATH", dataSyncCfg._path, "COUNT", dataOperations.size());
+            deferSync(dataSyncCfg, dataOperations);
+        });
     }
     catch (std::exception& e)
     {
@@ -947,13 +2534,76 @@ sdbusplus::async::task<>
     // NOLINTNEXTLINE
     Manager::monitorTimerToSync(const config::DataSyncConfig& dataSyncCfg)
 {
+    if (_activeWatchers.contains(dataSyncCfg._path))
+    {
+        // Still monitoring, the sync resumes along with the sync events.
+        co_return;
+    }
+
+    // The changes are collected by a watcher, so a period without changes
+    // costs no rsync run and a period with changes syncs only those.
+    try
+    {
+        addDataWatcher(dataSyncCfg,
+                       [this, &dataSyncCfg](
+                           const watch::DataOperations& dataOperations) {
+            if (_ctx.stop_requested() || _syncBMCDataIface.disable_sync())
+            {
+                return;
+            }
+            collectChangedPaths(_collectedSyncOps[dataSyncCfg._path],
+                                dataSyncCfg, dataOperations);
+        });
+    }
+    catch (const std::exception& e)
+    {
+        lg2::warning("Failed to watch [{PATH}] for the periodic sync, syncing "
+                     "the whole path on each period. Exception : {ERROR}",
+                     "PATH", dataSyncCfg._path, "ERROR", e);
+    }
+
+    // The whole path is still synced every few periods, to catch up on the
+    // changes the watcher missed.
+    size_t periods{0};
     while (!_ctx.stop_requested() && !_syncBMCDataIface.disable_sync() &&
            dataSyncCfg._periodicityInSec.has_value())
     {
-        co_await sdbusplus::async::sleep_for(
-            _ctx, dataSyncCfg._periodicityInSec.value());
         // NOLINTNEXTLINE
-        co_await syncData(dataSyncCfg);
+        co_await _timers.sleepFor(dataSyncCfg._periodicityInSec.value());
+        if (_ctx.stop_requested() || _syncBMCDataIface.disable_sync())
+        {
+            break;
+        }
+
+        ++periods;
+        // The watcher is dropped if it could not be created or failed later
+        // on, in which case the changes are no longer tracked.
+        if (!_activeWatchers.contains(dataSyncCfg._path) ||
+            (PERIODIC_FULL_SYNC_PERIODS != 0 &&
+             periods % PERIODIC_FULL_SYNC_PERIODS == 0))
+        {
+            lg2::debug("Periodic sync of the whole path [{PATH}]", "PATH",
+                       dataSyncCfg._path);
+            _collectedSyncOps.erase(dataSyncCfg._path);
+            // NOLINTNEXTLINE
+            co_await syncData(dataSyncCfg, sync::SyncPriority::Periodic);
+            continue;
+        }
+
+        auto dataOperations = watch::coalesce(
+            std::exchange(_collectedSyncOps[dataSyncCfg._path], {}));
+        if (dataOperations.empty())
+        {
+            lg2::debug("Skipping periodic sync for [{PATH}]: unchanged since "
+                       "its last sync",
+                       "PATH", dataSyncCfg._path);
+            continue;
+        }
+        lg2::debug("Periodic sync of [{COUNT}] changed paths of [{PATH}]",
+                   "COUNT", dataOperations.size(), "PATH", dataSyncCfg._path);
+        // NOLINTNEXTLINE
+        co_await syncCollectedData(dataSyncCfg, std::move(dataOperations),
+                                   sync::SyncPriority::Periodic);
     }
     co_return;
 }
@@ -963,6 +2613,12 @@ void Manager::disableSyncPropChanged(bool disableSync)
     if (disableSync)
     {
         lg2::info("Sync is Disabled, Stopping events");
+        if (_syncBMCDataIface.full_sync_status() ==
+            FullSyncStatus::FullSyncInProgress)
+        {
+            lg2::info("Stopping the full sync in progress");
+        }
+        _fullSyncStop.request_stop();
         stopSyncEvents();
     }
     else
@@ -972,6 +2628,15 @@ void Manager::disableSyncPropChanged(bool disableSync)
     }
 }
 
+std::stop_token Manager::getStopToken(sync::SyncPriority priority) const
+{
+    if (priority != sync::SyncPriority::FullSync)
+    {
+        return {};
+    }
+    return _fullSyncStop.get_token();
+}
+
 void Manager::setFullSyncStatus(const FullSyncStatus& fullSyncStatus)
 {
     if (_syncBMCDataIface.full_sync_status() == fullSyncStatus)
@@ -1024,27 +2689,26 @@ sdbusplus::async::task<void> Manager::startFullSync()
 {
     lg2::info("Full Sync started");
     setFullSyncStatus(FullSyncStatus::FullSyncInProgress);
+    _fullSyncParked = false;
 
-    auto fullSyncStartTime = std::chrono::steady_clock::now();
+    // Stopped once the sync gets disabled, the syncs of a previous full sync
+    // keep their own token.
+    _fullSyncStop = std::stop_source{};
+
+    // The sibling may have changed meanwhile, so nothing is known synced.
+    _contentCache.clear();
 
-    auto syncResults = std::vector<bool>();
-    size_t spawnedTasks = 0;
+    auto fullSyncStartTime = std::chrono::steady_clock::now();
 
+    std::vector<const config::DataSyncConfig*> eligibleCfgs;
+    bool spawnFailed{false};
     for (const auto& cfg : _dataSyncConfiguration)
     {
-        // TODO: add receiver logic to stop fullsync when disable sync is set to
-        // true.
         try
         {
             if (isSyncEligible(cfg))
             {
-                _ctx.spawn(
-                    syncData(cfg) |
-                    stdexec::then([&syncResults, &spawnedTasks](bool result) {
-                    syncResults.push_back(result);
-                    spawnedTasks--; // Decrement the number of spawned tasks
-                }));
-                spawnedTasks++;     // Increment the number of spawned tasks
+                eligibleCfgs.emplace_back(&cfg);
             }
         }
         catch (const std::exception& e)
@@ -1052,23 +2716,81 @@ sdbusplus::async::task<void> Manager::startFullSync()
             lg2::error(
                 "Full sync spawn failed for [{PATH}], Error : {EXCEPTION}",
                 "PATH", cfg._path, "EXCEPTION", e);
-            setFullSyncStatus(FullSyncStatus::FullSyncFailed);
+            spawnFailed = true;
         }
     }
 
-    while (spawnedTasks > 0)
+    // The spawned syncs share the latch and the results with this coroutine,
+    // so both stay valid if the full sync gets cancelled along with the
+    // context while the syncs are still running.
+    std::shared_ptr<async::Latch> syncsLatch;
+    try
     {
-        co_await sdbusplus::async::sleep_for(_ctx,
-                                             std::chrono::milliseconds(50));
+        syncsLatch = std::make_shared<async::Latch>(_ctx, eligibleCfgs.size());
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Full sync failed to start, Error : {EXCEPTION}",
+                   "EXCEPTION", e);
+        setFullSyncStatus(FullSyncStatus::FullSyncFailed);
+        co_return;
+    }
+    auto syncResults = std::make_shared<std::map<fs::path, SyncResult>>();
+
+    for (const auto* cfg : eligibleCfgs)
+    {
+        _ctx.spawn(fullSyncData(*cfg) |
+                   stdexec::then([syncsLatch, syncResults,
+                                  path = cfg->_path](SyncResult result) {
+            syncResults->insert_or_assign(path, result);
+            syncsLatch->countDown();
+        }));
     }
 
+    // Resumed as soon as the last sync completes.
+    // NOLINTNEXTLINE
+    co_await syncsLatch->wait();
+
     auto fullSyncEndTime = std::chrono::steady_clock::now();
     auto FullsyncElapsedTime = std::chrono::duration_cast<std::chrono::seconds>(
         fullSyncEndTime - fullSyncStartTime);
 
+    // The parked paths are not synced yet, hence the full sync is incomplete
+    // until they are.
+    _fullSyncResults.clear();
+    size_t parkedCount{0};
+    for (const auto& [path, result] : *syncResults)
+    {
+        if (result == SyncResult::Failed)
+        {
+            lg2::error("Full Sync failed for the path [{PATH}]", "PATH", path);
+        }
+        else if (result == SyncResult::Parked)
+        {
+            lg2::info("Full Sync of the path [{PATH}] is parked until the "
+                      "sibling BMC is reachable",
+                      "PATH", path);
+            ++parkedCount;
+        }
+        _fullSyncResults.emplace(path, result == SyncResult::Synced);
+    }
+
+    // The syncs started after the sync got disabled are skipped, hence the
+    // full sync is incomplete.
+    if (_syncBMCDataIface.disable_sync())
+    {
+        lg2::error(
+            "Full Sync cancelled as the sync is disabled. Elapsed time : "
+            "[{DURATION_SECONDS}] seconds",
+            "DURATION_SECONDS", FullsyncElapsedTime.count());
+        setFullSyncStatus(FullSyncStatus::FullSyncFailed);
+        co_return;
+    }
+
     // If any sync operation fails, the FullSync will be considered failed;
     // otherwise, it will be marked as completed.
-    if (std::ranges::all_of(syncResults,
+    if (!spawnFailed &&
+        std::ranges::all_of(_fullSyncResults | std::views::values,
                             [](const auto& result) { return result; }))
     {
         lg2::info(
@@ -1076,13 +2798,28 @@ sdbusplus::async::task<void> Manager::startFullSync()
             "DURATION_SECONDS", FullsyncElapsedTime.count());
         setFullSyncStatus(FullSyncStatus::FullSyncCompleted);
         setSyncEventsHealth(SyncEventsHealth::Ok);
+
+        // All the data is synced, so only the later changes need tracking.
+        if (!_dirtyJournal.isActive())
+        {
+            _dirtyJournal.create(_extDataIfaces->bmcRoleInStr(),
+                                 getConfigHash());
+        }
     }
     else
     {
         lg2::error(
-            "Full Sync failed. Elapsed time : [{DURATION_SECONDS}] seconds",
+            "Full Sync failed for [{FAILED}/{TOTAL}] paths, [{PARKED}] of them "
+            "parked. Elapsed time : [{DURATION_SECONDS}] seconds",
+            "FAILED",
+            std::ranges::count(_fullSyncResults | std::views::values, false),
+            "TOTAL", _fullSyncResults.size(), "PARKED", parkedCount,
             "DURATION_SECONDS", FullsyncElapsedTime.count());
         setFullSyncStatus(FullSyncStatus::FullSyncFailed);
+        if (parkedCount != 0)
+        {
+            resumeParkedFullSync();
+        }
     }
 
     co_return;
@@ -1092,25 +2829,164 @@ nlohmann::json Manager::collectAllWatchingPaths() const
 {
     nlohmann::json result;
     nlohmann::json watchingPaths;
+    nlohmann::json eventStats;
+    nlohmann::json watcherMemory;
+    nlohmann::json polledPaths;
+    size_t polledPathsCount = 0;
 
     lg2::debug("Collecting the {COUNT} active watchers", "COUNT",
                _activeWatchers.size());
 
     for (const auto& [configPath, dataWatcher] : _activeWatchers)
     {
-        const auto& wds = dataWatcher->getWatchDescriptors();
-
         std::vector<std::string> paths;
-        paths.reserve(wds.size());
-
-        std::ranges::transform(
-            wds, std::back_inserter(paths),
-            [](const auto& entry) { return entry.second.string(); });
+        std::ranges::transform(dataWatcher->getWatchingPaths(),
+                               std::back_inserter(paths),
+                               [](const auto& path) { return path.string(); });
 
         watchingPaths.emplace(configPath.string(), std::move(paths));
+
+        // The subtrees scanned periodically as the inotify watches ran short.
+        auto polled = dataWatcher->getPolledPaths();
+        if (!polled.empty())
+        {
+            polledPathsCount += polled.size();
+            polledPaths[configPath.string()] =
+                polled | std::views::transform([](const auto& path) {
+                return path.string();
+            }) | std::ranges::to<std::vector>();
+        }
+
+        const auto& stats = dataWatcher->getEventStats();
+        eventStats[configPath.string()] = {
+            {"wakeups", stats.wakeups},
+            {"events", stats.events},
+            {"last_wakeup_events", stats.lastWakeupEvents},
+            {"max_wakeup_events", stats.maxWakeupEvents},
+            {"overflows", stats.overflows}};
+
+        auto watchesCount = watchingPaths[configPath.string()].size();
+        auto memoryUsage = dataWatcher->getMemoryUsage();
+        watcherMemory[configPath.string()] = {
+            {"watches", watchesCount},
+            {"bytes", memoryUsage},
+            {"bytes_per_watch",
+             watchesCount != 0 ? memoryUsage / watchesCount : 0},
+            {"pending_renames", dataWatcher->getPendingRenamesCount()}};
     }
 
     result["watching_paths"] = watchingPaths;
+    result["event_stats"] = eventStats;
+    result["watcher_memory"] = watcherMemory;
+    result["polled_paths"] = polledPaths;
+
+    const auto& muxStats = _inotifyMux.getEventStats();
+    result["inotify"] = {{"watches", _inotifyMux.getWatchesCount()},
+                         {"watch_budget", _inotifyMux.getWatchBudget()},
+                         {"polled_paths", polledPathsCount},
+                         {"wakeups", muxStats.wakeups},
+                         {"events", muxStats.events},
+                         {"last_wakeup_events", muxStats.lastWakeupEvents},
+                         {"max_wakeup_events", muxStats.maxWakeupEvents},
+                         {"overflows", muxStats.overflows}};
+
+    if (_pollMux.getWatchersCount() > 0)
+    {
+        const auto& pollStats = _pollMux.getEventStats();
+        result["poll"] = {{"watchers", _pollMux.getWatchersCount()},
+                          {"scans_with_changes", pollStats.wakeups},
+                          {"changes", pollStats.events},
+                          {"last_scan_changes", pollStats.lastWakeupEvents},
+                          {"max_scan_changes", pollStats.maxWakeupEvents}};
+    }
+
+    if (_fanotifyMux)
+    {
+        const auto& fanotifyStats = _fanotifyMux->getEventStats();
+        result["fanotify"] = {
+            {"marked_filesystems", _fanotifyMux->getMarksCount()},
+            {"wakeups", fanotifyStats.wakeups},
+            {"events", fanotifyStats.events},
+            {"last_wakeup_events", fanotifyStats.lastWakeupEvents},
+            {"max_wakeup_events", fanotifyStats.maxWakeupEvents},
+            {"overflows", fanotifyStats.overflows}};
+    }
+
+    nlohmann::json scheduler = {
+        {"max_concurrent_syncs", _syncScheduler.getMaxConcurrentSyncs()},
+        {"running_syncs", _syncScheduler.getRunningSyncs()}};
+    for (auto priority :
+         {sync::SyncPriority::Immediate, sync::SyncPriority::Deferred,
+          sync::SyncPriority::FullSync, sync::SyncPriority::Periodic})
+    {
+        const auto& stats = _syncScheduler.getStats(priority);
+        scheduler[sync::toString(priority)] = {
+            {"queue_depth", _syncScheduler.getQueueDepth(priority)},
+            {"max_queue_depth", stats.maxQueueDepth},
+            {"syncs", stats.syncs},
+            {"waited_syncs", stats.waitedSyncs},
+            {"total_wait_ms", stats.totalWait.count()},
+            {"max_wait_ms", stats.maxWait.count()}};
+    }
+    result["scheduler"] = std::move(scheduler);
+
+    const auto& timerStats = _timers.getStats();
+    result["timers"] = {{"tick_ms", _timers.getTick().count()},
+                        {"slack_percent", _timers.getSlackPercent()},
+                        {"pending_timers", _timers.getPendingTimers()},
+                        {"timers", timerStats.timers},
+                        {"wakeups", timerStats.wakeups},
+                        {"fired_timers", timerStats.firedTimers},
+                        {"max_batch", timerStats.maxBatch}};
+
+    result["dirty_journal"] = {{"active", _dirtyJournal.isActive()},
+                               {"dirty_paths", _dirtyJournal.size()}};
+
+    nlohmann::json siblingBreakers;
+    const auto steadyNow = std::chrono::steady_clock::now();
+    for (const auto& [endpoint, breaker] : _siblingBreakers)
+    {
+        siblingBreakers[endpoint] = {
+            {"state", sync::toString(breaker.getState())},
+            {"consecutive_failures", breaker.getConsecutiveFailures()},
+            {"trips", breaker.getTrips()},
+            {"retry_in_ms",
+             std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::max(breaker.getRetryTime(steadyNow) - steadyNow,
+                          std::chrono::steady_clock::duration(0)))
+                 .count()}};
+    }
+    result["sibling_breakers"] = std::move(siblingBreakers);
+
+    size_t parkedPaths{0};
+    for (const auto& parked : _parkedSyncs | std::views::values)
+    {
+        parkedPaths += parked.dataOperations.size();
+    }
+    result["parked_syncs"] = {{"configs", _parkedSyncs.size()},
+                              {"paths", parkedPaths}};
+
+    result["content_cache"] = {{"entries", _contentCache.size()},
+                               {"hits", _contentCache.getHits()},
+                               {"misses", _contentCache.getMisses()}};
+
+    nlohmann::json hashTrees;
+    for (const auto& [path, hashTree] : _hashTrees)
+    {
+        hashTrees[path.string()] = hashTree.size();
+    }
+    result["hash_trees"] = std::move(hashTrees);
+
+    // The results of the last full sync per configured path.
+    if (!_fullSyncResults.empty())
+    {
+        nlohmann::json fullSyncResults;
+        for (const auto& [path, synced] : _fullSyncResults)
+        {
+            fullSyncResults[path.string()] = synced ? "Completed" : "Failed";
+        }
+        result["full_sync"] = std::move(fullSyncResults);
+    }
 
     // Add timestamp of collecting along with the list of watchers
     auto now = std::chrono::system_clock::now();
@@ -2,12 +2,21 @@
 
 #pragma once
 
+#include "circuit_breaker.hpp"
+#include "content_cache.hpp"
 #include "data_sync_config.hpp"
 #include "data_watcher.hpp"
+#include "dirty_journal.hpp"
 #include "external_data_ifaces.hpp"
+#include "fanotify_watcher.hpp"
+#include "hash_tree.hpp"
+#include "native_transfer.hpp"
 #include "notify_service.hpp"
 #include "persistent.hpp"
+#include "poll_watcher.hpp"
 #include "sync_bmc_data_ifaces.hpp"
+#include "sync_scheduler.hpp"
+#include "timer_wheel.hpp"
 
 #include <sdbusplus/async.hpp>
 
@@ -17,6 +26,8 @@
 #include <memory>
 #include <optional>
 #include <ranges>
+#include <stop_token>
+#include <string>
 #include <vector>
 
 namespace data_sync
@@ -35,6 +46,13 @@ enum class RsyncMode
     Notify // perform sibling notification
 };
 
+enum class SyncResult
+{
+    Synced, // synced, or nothing to sync
+    Failed, // failed, after the retries if any
+    Parked  // parked until the sibling BMC is reachable again
+};
+
 /**
  * @class Manager
  *
@@ -81,6 +99,8 @@ class Manager
      *        - This method is responsible for initiating the  Full
      *          synchronization process between two BMCs.
      *        - The sync process is handled asynchronously.
+     *        - The configs are synced concurrently, and the full sync
+     *          completes as soon as the last of them completes.
      *
      */
     sdbusplus::async::task<> startFullSync();
@@ -123,6 +143,19 @@ class Manager
      */
     void disableSyncPropChanged(bool disableSync);
 
+    /**
+     * @brief Get the token stopping the syncs of the given priority.
+     *
+     * Only the syncs of the full sync get stopped, once the sync is
+     * disabled.
+     *
+     * @param[in] priority - The priority class of the sync
+     *
+     * @returns std::stop_token - The token, which never stops for the other
+     *                            syncs
+     */
+    std::stop_token getStopToken(sync::SyncPriority priority) const;
+
     /**
      * @brief Helper API to set the Disable sync Dbus status-property.
      *        Specifically, for unit testing purposes.
@@ -170,6 +203,14 @@ class Manager
      */
     sdbusplus::async::task<> processPendingNotifications();
 
+    /**
+     * @brief API to start processing a notify request, unless it is already
+     *        being processed.
+     *
+     * @param[in] notifyFilePath - The path of the notify request
+     */
+    void processNotifyRequest(const fs::path& notifyFilePath);
+
     /**
      * @brief API which will monitor the notify directory for sibling
      * notification requests, and will trigger the callback upon receiving the
@@ -177,6 +218,16 @@ class Manager
      */
     sdbusplus::async::task<> monitorServiceNotifications();
 
+    /**
+     * @brief Drop the watcher which failed to handle its events and report
+     *        it, the other watchers keep running.
+     *
+     * @param[in] path - The path monitored by the watcher
+     * @param[in] error - The description of the failure
+     */
+    sdbusplus::async::task<> handleWatcherFailure(fs::path path,
+                                                  std::string error);
+
     /**
      * @brief A helper API to initiate sync events, covering the following
      *        scenarios. These event will be initiated based on the BMC role.
@@ -191,11 +242,28 @@ class Manager
     /**
      * @brief Stop all active data change watchers.
      *
-     * Stops each watcher in _activeWatchers, allowing their monitor
-     * coroutines to exit cleanly.
+     * Stops each watcher in _activeWatchers and drops them, so no more data
+     * operations are dispatched until the sync events are started again.
      */
     void stopSyncEvents();
 
+    /**
+     * @brief Sync the paths left dirty by the previous run and the paths
+     *        changed since it stopped, instead of a full sync.
+     *
+     * @param[in] dirtyState - The state replayed from the dirty path journal
+     */
+    void replayDirtyPaths(const persist::DirtyState& dirtyState);
+
+    /**
+     * @brief Get the hash of the configured paths, along with what decides
+     *        their synced data, to find out whether the dirty path journal
+     *        was written with the same configuration.
+     *
+     * @returns uint64_t - The hash, independent of the order of the configs
+     */
+    uint64_t getConfigHash() const;
+
     /**
      * @brief API responsible to trigger sibling notification if required.
      *
@@ -230,15 +298,21 @@ class Manager
      *        performing a local copy instead.
      *
      * @param[in] dataSyncCfg - The data sync config to sync
+     * @param[in] priority - The priority class of the sync
      * @param[in] srcPath - The modified path inside the cfg path, if available.
      * @param[in] retryCount - The current retry attempt count
+     * @param[in] movedFromPath - The path from which the srcPath is moved, if
+     *                            renamed. Synced along in the same rsync run
+     *                            to delete it on the sibling.
      *
-     * @return Returns true if sync succeeds; otherwise, returns false
+     * @return The result of the sync
      *
      */
-    sdbusplus::async::task<bool>
+    sdbusplus::async::task<SyncResult>
         syncData(const config::DataSyncConfig& dataSyncCfg,
-                 fs::path srcPath = fs::path{}, size_t retryCount = 0);
+                 sync::SyncPriority priority, fs::path srcPath = fs::path{},
+                 size_t retryCount = 0,
+                 fs::path movedFromPath = fs::path{});
 
     /**
      * @brief Wrapper API to frame and issue RSYNC command to sync the generated
@@ -260,17 +334,210 @@ class Manager
      * @brief Retry the data sync operation based on failure
      *
      * @param[in] cfg - Data sync configuration
+     * @param[in] priority - The priority class of the sync
      * @param[in] srcPath - Source path to be synced
      * @param[in] retryCount - Current retry attempt number
+     * @param[in] movedFromPath - The path from which the srcPath is moved, if
+     *                            renamed
+     *
+     * @return The result of the retry, SyncResult::Parked while the sibling
+     *         BMC is unreachable
+     */
+    sdbusplus::async::task<SyncResult>
+        retrySync(const config::DataSyncConfig& cfg,
+                  sync::SyncPriority priority, fs::path srcPath,
+                  size_t retryCount, fs::path movedFromPath = fs::path{});
+
+    /**
+     * @brief Queue the data operations of a config to be synced along with
+     *        the other pending operations of the config, in a single rsync
+     *        run.
+     *
+     * @param[in] dataSyncCfg - The data sync config to sync
+     * @param[in] dataOperations - The data operations to sync
+     */
+    void batchSync(const config::DataSyncConfig& dataSyncCfg,
+                   const watch::DataOperations& dataOperations);
+
+    /**
+     * @brief Keep syncing the pending data operations of a config, one
+     *        batch at a time, until no more operations are pending.
+     *
+     * The operations reported while a batch is being synced are collected
+     * into the next batch.
+     *
+     * @param[in] dataSyncCfg - The data sync config to sync
+     */
+    sdbusplus::async::task<>
+        syncPendingData(const config::DataSyncConfig& dataSyncCfg);
+
+    /**
+     * @brief Sync the paths of a batch of data operations in a single rsync
+     *        run, using a list of the paths.
+     *
+     * On a retryable failure, each path is retried on its own so the retry
+     * attempts are tracked per path. The sibling is notified for each path
+     * whose data got transferred.
+     *
+     * @param[in] dataSyncCfg - The data sync config to sync
+     * @param[in] dataOperations - The coalesced data operations to sync
+     * @param[in] priority - The priority class of the sync
+     */
+    sdbusplus::async::task<>
+        syncBatchedData(const config::DataSyncConfig& dataSyncCfg,
+                        watch::DataOperations dataOperations,
+                        sync::SyncPriority priority);
+
+    /**
+     * @brief Check whether a changed path is unchanged since its last sync,
+     *        to skip its sync.
+     *
+     * A renamed path is never skipped, as its source gets deleted on the
+     * sibling.
+     *
+     * @param[in] srcPath - The path to be synced
+     * @param[in] movedFromPath - The path from which the srcPath is moved, if
+     *                            renamed
+     *
+     * @returns sync::CacheCheck - The result, with the fingerprint to record
+     *                             once synced
+     */
+    sync::CacheCheck checkSyncedContent(const fs::path& srcPath,
+                                        const fs::path& movedFromPath);
+
+    /**
+     * @brief Send the small changed files of a batch to the sibling over the
+     *        native transfer instead of rsync.
+     *
+     * The directories, the bigger files and the files whose transfer failed
+     * are returned to be synced by rsync.
+     *
+     * @param[in] dataSyncCfg - The data sync config to sync
+     * @param[in] dataOperations - The data operations to sync
+     * @param[in] priority - The priority class of the sync
+     * @param[in] readRecords - The files already read to check their
+     *                          contents, by path, sent as read
+     *
+     * @returns The data operations left to rsync, std::nullopt if all of
+     *          them got parked while the sibling BMC is unreachable
+     */
+    sdbusplus::async::task<std::optional<watch::DataOperations>>
+        transferNatively(
+            const config::DataSyncConfig& dataSyncCfg,
+            watch::DataOperations dataOperations, sync::SyncPriority priority,
+            std::map<fs::path, transfer::FileRecord> readRecords = {});
+
+    /**
+     * @brief Start receiving the native transfers from the sibling and
+     *        connect to the sibling to send them, if enabled.
+     *
+     * Falls back to rsync for all the syncs if the transfer port could not
+     *        be listened.
+     */
+    void startNativeTransfer();
+
+    /**
+     * @brief Check whether a path received over the native transfer belongs
+     *        to the destination of a configured path.
+     *
+     * The path must be one the sibling would sync by rsync, hence not
+     * excluded, included if an include list is configured, and of a config
+     * synced towards the role of this BMC.
+     *
+     * @param[in] destPath - The received path
+     *
+     * @returns true if the path can be modified
+     */
+    bool isTransferAllowed(const fs::path& destPath) const;
+
+    /**
+     * @brief Fully sync a configured path, by syncing only the paths found
+     *        differing from the sibling through the hash trees.
+     *
+     * Falls back to syncing the whole path if the hash trees could not be
+     * compared.
+     *
+     * @param[in] dataSyncCfg - The data sync config to sync
+     *
+     * @return The result of the sync
+     */
+    sdbusplus::async::task<SyncResult>
+        fullSyncData(const config::DataSyncConfig& dataSyncCfg);
+
+    /**
+     * @brief Get the hash tree of a path of a configured path.
+     *
+     * The tree of a watched path is kept up to date by its events between
+     * the rebuilds, which also catch the changes the watchers miss.
+     *
+     * @param[in] dataSyncCfg - The data sync config of the path
+     * @param[in] root - The configured path, or its destination on this BMC
+     * @param[in] rebuild - Whether to rebuild the tree
+     *
+     * @returns sync::HashTree& - The hash tree
+     */
+    sync::HashTree& getHashTree(const config::DataSyncConfig& dataSyncCfg,
+                                const fs::path& root, bool rebuild);
+
+    /**
+     * @brief Hash a path of a hash tree in steps, yielding to the event loop
+     *        between them, so the comparisons read the cached hashes.
      *
-     * @return true if the retry succeeds or can be skipped, false if failed
+     * The tree is looked up again on each step, as a watched tree is
+     * dropped along with its watcher.
+     *
+     * @param[in] dataSyncCfg - The data sync config of the path
+     * @param[in] root - The configured path, or its destination on this BMC
+     * @param[in] path - The path to hash, along with the paths under it
+     * @param[in] rebuild - Whether to rebuild the tree first
+     */
+    sdbusplus::async::task<>
+        hashTreeInSteps(const config::DataSyncConfig& dataSyncCfg,
+                        fs::path root, fs::path path, bool rebuild);
+
+    /**
+     * @brief Answer the query of the sibling about a level of its
+     *        destination hash tree.
+     *
+     * @param[in] destPath - The queried path
+     *
+     * @returns The serialized level, std::nullopt if the path is not part of
+     *          the destination of a configured path
+     */
+    sdbusplus::async::task<std::optional<std::string>>
+        describeTreeLevel(fs::path destPath);
+
+    /**
+     * @brief Retry the sync of a path of a failed batch, and release the
+     *        path once the retries complete.
+     *
+     * @param[in] dataSyncCfg - The data sync config to sync
+     * @param[in] priority - The priority class of the sync
+     * @param[in] srcPath - The path to be synced
+     * @param[in] movedFromPath - The path from which the srcPath is moved, if
+     *                            renamed
+     */
+    sdbusplus::async::task<>
+        retryBatchedPath(const config::DataSyncConfig& dataSyncCfg,
+                         sync::SyncPriority priority, fs::path srcPath,
+                         fs::path movedFromPath);
+
+    /**
+     * @brief Release a path once its sync completes, and sync it again if it
+     *        changed while being synced.
+     *
+     * @param[in] dataSyncCfg - The data sync config of the path
+     * @param[in] srcPath - The synced path
      */
-    sdbusplus::async::task<bool> retrySync(const config::DataSyncConfig& cfg,
-                                           fs::path srcPath, size_t retryCount);
+    void releaseSyncPath(const config::DataSyncConfig& dataSyncCfg,
+                         const fs::path& srcPath);
 
     /**
      * @brief A helper to API to monitor data to sync if its changed
      *
+     * The watcher is registered with the shared inotify instance, and the
+     * data operations dispatched to it are batched into a single rsync run.
+     *
      * @param[in] dataSyncCfg - The data sync config to sync
      *
      */
@@ -278,14 +545,18 @@ class Manager
         monitorDataToSync(const config::DataSyncConfig& dataSyncCfg);
 
     /**
-     * @brief Create and register a DataWatcher for the given sync config.
+     * @brief Create and register a watcher for the given sync config.
      *
-     * @param[in] dataSyncCfg - The data sync config to watch
+     * The paths configured to be polled are scanned by the poller of the
+     * manager. Otherwise, the fanotify backend is used if enabled and
+     * available, else the watcher shares the inotify instance of the
+     * manager.
      *
-     * @return Pointer to the registered watcher
+     * @param[in] dataSyncCfg - The data sync config to watch
+     * @param[in] callback - The callback to invoke upon data operations
      */
-    watch::inotify::DataWatcher*
-        addDataWatcher(const config::DataSyncConfig& dataSyncCfg);
+    void addDataWatcher(const config::DataSyncConfig& dataSyncCfg,
+                        watch::DataChangeCallback callback);
 
     /**
      * @brief A helper API to monitor data changes and trigger deferred sync.
@@ -298,21 +569,57 @@ class Manager
     /**
      * @brief Schedule a deferred sync for the changed data.
      *
+     * The changed paths are collected until the sync runs.
+     *
      * @param[in] dataSyncCfg - The data sync config to sync
+     * @param[in] dataOperations - The data operations of the changed data
      */
-    void deferSync(const config::DataSyncConfig& dataSyncCfg);
+    void deferSync(const config::DataSyncConfig& dataSyncCfg,
+                   const watch::DataOperations& dataOperations);
 
     /**
-     * @brief Wait for the deferred interval and run sync.
+     * @brief Wait for the deferred interval and sync the changed paths.
      *
      * @param[in] dataSyncCfg - The data sync config to sync
      */
     sdbusplus::async::task<>
         syncDeferredData(const config::DataSyncConfig& dataSyncCfg);
 
+    /**
+     * @brief Collect the changed paths of a config until its next sync.
+     *
+     * The paths are journaled, and replaced by the configured path once too
+     * many paths changed.
+     *
+     * @param[in,out] collectedOps - The data operations collected so far
+     * @param[in] dataSyncCfg - The data sync config of the paths
+     * @param[in] dataOperations - The data operations of the changed data
+     */
+    void collectChangedPaths(watch::DataOperations& collectedOps,
+                             const config::DataSyncConfig& dataSyncCfg,
+                             const watch::DataOperations& dataOperations);
+
+    /**
+     * @brief Sync the collected changed paths of a config, or the whole
+     *        configured path if it got reported itself.
+     *
+     * @param[in] dataSyncCfg - The data sync config to sync
+     * @param[in] dataOperations - The coalesced data operations to sync
+     * @param[in] priority - The priority class of the sync
+     */
+    sdbusplus::async::task<>
+        syncCollectedData(const config::DataSyncConfig& dataSyncCfg,
+                          watch::DataOperations dataOperations,
+                          sync::SyncPriority priority);
+
     /**
      * @brief A helper to API to sync data periodically.
      *
+     * The configured path is watched, so only the paths changed since the
+     * previous period are synced and a period without changes is skipped.
+     * The whole path is synced every PERIODIC_FULL_SYNC_PERIODS periods, and
+     * on each period while the path is not watched.
+     *
      * @param[in] dataSyncCfg - The data sync config to sync
      */
     sdbusplus::async::task<>
@@ -341,6 +648,71 @@ class Manager
      */
     static bool isRetryEligible(uint8_t errCode) noexcept;
 
+    /**
+     * @brief Check whether the RSYNC error code tells the sibling BMC could
+     *        not be reached, as opposed to a failure of the synced data.
+     *
+     * @param errCode - Rsync error code
+     * @return true - If the sibling BMC could not be reached
+     */
+    static bool isSiblingUnreachable(int errCode) noexcept;
+
+    /**
+     * @brief Get the circuit breaker of the sibling BMC endpoint.
+     */
+    sync::CircuitBreaker& getSiblingBreaker();
+
+    /**
+     * @brief Account the result of a request sent to the sibling BMC, to
+     *        open or close its circuit breaker.
+     *
+     * The parked syncs are drained once the breaker closes.
+     *
+     * @param errCode - Rsync error code
+     */
+    void recordSiblingResult(int errCode);
+
+    /**
+     * @brief Account whether a request reached the sibling BMC, to open or
+     *        close its circuit breaker.
+     *
+     * @param reachable - Whether the sibling BMC got reached
+     * @param errCode - The rsync error code or the errno of the failure
+     */
+    void recordSiblingReachability(bool reachable, int errCode);
+
+    /**
+     * @brief Park the data operations of a config while the sibling BMC is
+     *        unreachable, to be synced once it is reachable again.
+     *
+     * @param[in] dataSyncCfg - The data sync config of the operations
+     * @param[in] dataOperations - The data operations to sync
+     * @param[in] priority - The priority class of the sync
+     */
+    void parkSync(const config::DataSyncConfig& dataSyncCfg,
+                  const watch::DataOperations& dataOperations,
+                  sync::SyncPriority priority);
+
+    /**
+     * @brief Probe the sibling BMC with a parked sync each time the backoff
+     *        of its circuit breaker elapses, until the breaker closes.
+     */
+    sdbusplus::async::task<> probeSibling();
+
+    /**
+     * @brief Sync all the parked data operations at once.
+     *
+     * @param[in] skipFullSync - Whether to drop the operations parked by a
+     *                           full sync, as the full sync gets resumed
+     */
+    void drainParkedSyncs(bool skipFullSync = false);
+
+    /**
+     * @brief Run again a full sync which parked some paths, at once if the
+     *        sibling BMC is reachable or else once it is reachable again.
+     */
+    void resumeParkedFullSync();
+
     /**
      * @brief Register SIGUSR1 signal handler using signalfd
      *
@@ -358,13 +730,15 @@ class Manager
     void dumpWatchingPathsToFile() const;
 
     /**
-     * @brief Collect all currently watched paths from all DataWatcher instances
+     * @brief Collect all currently watched paths from all watcher instances
      *
-     * Iterates through all registered DataWatcher instances and collects their
-     * watched paths into a JSON structure.
+     * Iterates through all registered watcher instances and collects their
+     * watched paths and event counters into a JSON structure.
      *
      * @returns nlohmann::json - JSON object with config_path → watched_paths
-     *          mapping and timestamp
+     *          mapping, config_path → event_stats mapping, the shared
+     *          inotify/fanotify instance counters, the sync scheduler
+     *          queue counters, the last full sync results and timestamp
      */
     nlohmann::json collectAllWatchingPaths() const;
 
@@ -401,14 +775,160 @@ class Manager
      */
     std::vector<std::unique_ptr<notify::NotifyService>> _notifyReqs;
 
+    /**
+     * @brief The inotify instance shared by all the watchers of the manager.
+     *
+     * @note Must outlive the watchers, hence declared before them.
+     */
+    watch::inotify::InotifyMux _inotifyMux;
+
+    /**
+     * @brief The fanotify instance shared by all the watchers of the manager,
+     *        if the fanotify backend is enabled and available.
+     */
+    std::unique_ptr<watch::fanotify::FanotifyMux> _fanotifyMux;
+
+    /**
+     * @brief The poller shared by all the watchers of the paths configured
+     *        to be polled.
+     *
+     * @note Must outlive the watchers, hence declared before them.
+     */
+    watch::poll::PollMux _pollMux;
+
+    /**
+     * @brief The scheduler bounding the rsync runs in flight, shared by all
+     *        the syncs.
+     */
+    sync::SyncScheduler _syncScheduler;
+
+    /**
+     * @brief The timers of the periodic syncs, the deferred syncs and the
+     *        retries, batched on a single timer wheel.
+     */
+    timer::TimerService _timers;
+
+    /**
+     * @brief The fingerprints of the files as last synced, to skip the
+     *        rewrites with the same contents.
+     */
+    sync::ContentCache _contentCache;
+
+    /**
+     * @brief The journal of the changed paths not synced yet, to resume the
+     *        syncs after a restart.
+     */
+    persist::DirtyJournal _dirtyJournal;
+
+    /**
+     * @brief The receiver of the files sent by the sibling over the native
+     *        transfer, if enabled.
+     */
+    std::unique_ptr<transfer::TransferServer> _transferServer;
+
+    /**
+     * @brief The sender of the small changed files to the sibling, if the
+     *        native transfer is enabled.
+     */
+    std::unique_ptr<transfer::TransferClient> _transferClient;
+
+    /**
+     * @brief Map of the watched config paths to their hash trees, updated
+     *        by the events of their watchers.
+     *
+     * @note Must outlive the watchers, hence declared before them.
+     */
+    std::map<fs::path, sync::HashTree> _hashTrees;
+
+    /**
+     * @brief Map of the paths not watched to their hash trees, rebuilt on
+     *        each comparison.
+     */
+    std::map<fs::path, sync::HashTree> _untrackedHashTrees;
+
+    /**
+     * @brief The watcher of the sibling notification requests directory.
+     */
+    std::unique_ptr<watch::inotify::DataWatcher> _notifyWatcher;
+
     /**
      * @brief Map of config paths to their active DataWatcher instances
      *
      * Key: Configured path from JSON (e.g., "/var/lib/network/hypervisor/")
-     * Value: Pointer to the DataWatcher monitoring that path
+     * Value: Pointer to the watcher monitoring that path
+     */
+    std::map<fs::path, std::unique_ptr<watch::Watcher>> _activeWatchers;
+
+    /**
+     * @brief Map of config paths to their data operations waiting to be
+     *        synced in the next rsync run.
+     *
+     * A config has an entry as long as its batches are being synced.
+     */
+    std::map<fs::path, watch::DataOperations> _pendingSyncOps;
+
+    /**
+     * @brief Map of config paths to their data operations collected until
+     *        the next deferred or periodic sync.
+     */
+    std::map<fs::path, watch::DataOperations> _collectedSyncOps;
+
+    /**
+     * @brief Map of config paths to their data operations which changed
+     *        while already being synced, synced again once released.
+     */
+    std::map<fs::path, watch::DataOperations> _rerunSyncOps;
+
+    /**
+     * @brief The results of the last full sync per configured path.
+     */
+    std::map<fs::path, bool> _fullSyncResults;
+
+    /**
+     * @brief The source stopping the running full sync, renewed by each full
+     *        sync.
+     */
+    std::stop_source _fullSyncStop;
+
+    /**
+     * @brief The circuit breakers of the sibling BMC, by endpoint.
+     */
+    std::map<std::string, sync::CircuitBreaker> _siblingBreakers;
+
+    /**
+     * @brief The data operations of a config parked while the sibling BMC
+     *        is unreachable.
+     */
+    struct ParkedSync
+    {
+        watch::DataOperations dataOperations;
+
+        /**
+         * @brief The highest priority class of the parked syncs.
+         */
+        sync::SyncPriority priority = sync::SyncPriority::Periodic;
+    };
+
+    /**
+     * @brief Map of config paths to their parked data operations.
+     */
+    std::map<fs::path, ParkedSync> _parkedSyncs;
+
+    /**
+     * @brief Whether the last full sync parked some paths, to be resumed
+     *        once the sibling BMC is reachable again.
+     */
+    bool _fullSyncParked = false;
+
+    /**
+     * @brief Whether the sibling BMC is being probed.
+     */
+    bool _siblingProbeScheduled = false;
+
+    /**
+     * @brief Whether the current outage of the sibling BMC got an error log.
      */
-    std::map<fs::path, std::unique_ptr<watch::inotify::DataWatcher>>
-        _activeWatchers;
+    bool _siblingOutageLogged = false;
 };
 
 } // namespace data_sync
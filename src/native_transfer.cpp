@@ -0,0 +1,901 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "native_transfer.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace data_sync::transfer
+{
+
+namespace
+{
+
+/**
+ * @brief The magic numbers leading the frames, bumped along with the layout.
+ */
+constexpr uint32_t recordMagic = 0x44535231; // "DSR1"
+constexpr uint32_t resultMagic = 0x44534132; // "DSA2"
+
+/**
+ * @brief magic, op, flags, mode, uid, gid, atime, mtime, path size and data
+ *        size.
+ */
+constexpr size_t recordHeaderSize = 4 + 1 + 1 + 4 + 4 + 4 + 8 + 8 + 4 + 8;
+
+/**
+ * @brief magic, errno and payload size.
+ */
+constexpr size_t resultHeaderSize = 4 + 4 + 4;
+
+/**
+ * @brief The maximum accepted payload of a result.
+ */
+constexpr size_t maxPayloadSize = 16 * 1024 * 1024;
+
+constexpr uint8_t updateOnlyFlag = 0x01;
+
+/**
+ * @brief The table of the TCP sockets, along with their owners.
+ */
+constexpr auto tcpSocketTable = "/proc/net/tcp";
+
+template <typename T>
+void put(std::string& frame, T value)
+{
+    // In the network byte order, as the BMCs can differ.
+    auto bits = static_cast<std::make_unsigned_t<T>>(value);
+    for (size_t byte = sizeof(T); byte > 0; --byte)
+    {
+        frame.push_back(static_cast<char>((bits >> ((byte - 1) * 8)) & 0xFF));
+    }
+}
+
+template <typename T>
+T get(std::string_view frame, size_t& offset)
+{
+    std::make_unsigned_t<T> bits = 0;
+    for (size_t byte = 0; byte < sizeof(T); ++byte)
+    {
+        bits = (bits << 8) | static_cast<uint8_t>(frame[offset + byte]);
+    }
+    offset += sizeof(T);
+    return static_cast<T>(bits);
+}
+
+int64_t toNs(const struct timespec& time)
+{
+    return (static_cast<int64_t>(time.tv_sec) * 1'000'000'000) + time.tv_nsec;
+}
+
+struct timespec toTimespec(int64_t timeNs)
+{
+    auto sec = timeNs / 1'000'000'000;
+    auto nsec = timeNs % 1'000'000'000;
+    if (nsec < 0)
+    {
+        --sec;
+        nsec += 1'000'000'000;
+    }
+    return {static_cast<time_t>(sec), static_cast<long>(nsec)};
+}
+
+/**
+ * @class SocketWaiter
+ *
+ * @brief Waits for a socket to get readable or writable, until a deadline.
+ *
+ * fdio waits for the readability only and without a timeout, so the socket
+ * and a timerfd expiring at the deadline are polled through an epoll
+ * instance, which gets readable once either of them is ready.
+ */
+class SocketWaiter
+{
+  public:
+    SocketWaiter(const SocketWaiter&) = delete;
+    SocketWaiter& operator=(const SocketWaiter&) = delete;
+    SocketWaiter(SocketWaiter&&) = delete;
+    SocketWaiter& operator=(SocketWaiter&&) = delete;
+    ~SocketWaiter() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] ctx - The async context object
+     * @param[in] fd - The socket to wait for
+     * @param[in] deadline - The time after which the waits fail
+     *
+     * @throw std::system_error - If the wait could not be set up
+     */
+    SocketWaiter(sdbusplus::async::context& ctx, int fd,
+                 std::chrono::steady_clock::time_point deadline) :
+        _ctx(ctx), _fd(fd), _epollFd(epoll_create1(EPOLL_CLOEXEC)),
+        _timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+    {
+        // A zero expiry disarms the timerfd, so a past deadline is armed a
+        // nanosecond in.
+        const int64_t at = std::max<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline.time_since_epoch())
+                .count(),
+            1);
+        struct itimerspec spec{};
+        spec.it_value.tv_sec = at / 1'000'000'000;
+        spec.it_value.tv_nsec = at % 1'000'000'000;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = _timerFd();
+        if (_epollFd() < 0 || _timerFd() < 0 ||
+            timerfd_settime(_timerFd(), TFD_TIMER_ABSTIME, &spec, nullptr) !=
+                0 ||
+            epoll_ctl(_epollFd(), EPOLL_CTL_ADD, _timerFd(), &event) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Failed to wait for the transfer socket");
+        }
+    }
+
+    /**
+     * @brief Wait for the socket to get ready.
+     *
+     * @param[in] events - EPOLLIN or EPOLLOUT
+     *
+     * @throw std::system_error - With ETIMEDOUT once the deadline passed
+     */
+    // NOLINTNEXTLINE
+    sdbusplus::async::task<> wait(uint32_t events)
+    {
+        if (events != _events)
+        {
+            epoll_event event{};
+            event.events = events;
+            event.data.fd = _fd;
+            if (epoll_ctl(_epollFd(),
+                          _events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, _fd,
+                          &event) != 0)
+            {
+                throw std::system_error(
+                    errno, std::generic_category(),
+                    "Failed to wait for the transfer socket");
+            }
+            _events = events;
+        }
+        if (!_fdio)
+        {
+            _fdio = std::make_unique<sdbusplus::async::fdio>(_ctx,
+                                                             _epollFd());
+        }
+
+        // NOLINTNEXTLINE
+        co_await _fdio->next();
+        uint64_t expirations{};
+        if (read(_timerFd(), &expirations, sizeof(expirations)) > 0)
+        {
+            throw std::system_error(ETIMEDOUT, std::generic_category(),
+                                    "The transfer timed out");
+        }
+        co_return;
+    }
+
+  private:
+    sdbusplus::async::context& _ctx;
+    int _fd;
+    utility::FD _epollFd;
+    utility::FD _timerFd;
+
+    /**
+     * @brief The events the socket is polled for, zero until the first wait
+     */
+    uint32_t _events = 0;
+    std::unique_ptr<sdbusplus::async::fdio> _fdio;
+};
+
+/**
+ * @brief Send the whole data over a non-blocking socket.
+ *
+ * While the socket buffer is full, the send waits for the socket to get
+ * writable, until the deadline.
+ */
+// NOLINTNEXTLINE
+sdbusplus::async::task<> sendAll(sdbusplus::async::context& ctx, int fd,
+                                 std::string_view data,
+                                 std::chrono::steady_clock::time_point deadline)
+{
+    std::unique_ptr<SocketWaiter> writable;
+    while (!data.empty())
+    {
+        auto sent = ::send(fd, data.data(), data.size(),
+                           MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                if (!writable)
+                {
+                    writable = std::make_unique<SocketWaiter>(ctx, fd,
+                                                              deadline);
+                }
+                // NOLINTNEXTLINE
+                co_await writable->wait(EPOLLOUT);
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(),
+                                    "Failed to send the transfer frames");
+        }
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    co_return;
+}
+
+/**
+ * @brief Read all the available bytes of a non-blocking socket.
+ *
+ * @returns false if the connection is closed.
+ */
+bool readAvailable(int fd, FrameReader& reader)
+{
+    std::array<char, 4096> buffer{};
+    while (true)
+    {
+        auto bytes = read(fd, buffer.data(), buffer.size());
+        if (bytes > 0)
+        {
+            reader.append({buffer.data(), static_cast<size_t>(bytes)});
+            continue;
+        }
+        if (bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        return bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+}
+
+/**
+ * @brief Get the owner of the peer of a loopback TCP connection.
+ *
+ * SO_PEERCRED is available on the Unix sockets only, so the owner is looked
+ * up in the socket table, where the peer is the socket bound to the peer
+ * address and connected to the local one.
+ *
+ * @param[in] connFd - The accepted connection
+ *
+ * @returns The user ID, std::nullopt if the peer is not found.
+ */
+std::optional<uid_t> getPeerUid(int connFd)
+{
+    sockaddr_in local{};
+    sockaddr_in peer{};
+    socklen_t localLen = sizeof(local);
+    socklen_t peerLen = sizeof(peer);
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (getsockname(connFd, reinterpret_cast<sockaddr*>(&local), &localLen) !=
+            0 ||
+        getpeername(connFd, reinterpret_cast<sockaddr*>(&peer), &peerLen) != 0)
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+    {
+        return std::nullopt;
+    }
+
+    // The addresses are listed as the hex of their raw value, and the ports
+    // in the host byte order.
+    std::ifstream table(tcpSocketTable);
+    std::string line;
+    std::getline(table, line);
+    while (std::getline(table, line))
+    {
+        unsigned localAddr{};
+        unsigned localPort{};
+        unsigned remoteAddr{};
+        unsigned remotePort{};
+        unsigned uid{};
+        // NOLINTNEXTLINE
+        if (std::sscanf(line.c_str(),
+                        "%*u: %X:%X %X:%X %*X %*X:%*X %*X:%*X %*X %u",
+                        &localAddr, &localPort, &remoteAddr, &remotePort,
+                        &uid) != 5)
+        {
+            continue;
+        }
+        if (localAddr == peer.sin_addr.s_addr &&
+            localPort == ntohs(peer.sin_port) &&
+            remoteAddr == local.sin_addr.s_addr &&
+            remotePort == ntohs(local.sin_port))
+        {
+            return static_cast<uid_t>(uid);
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+std::string encode(const FileRecord& record)
+{
+    const auto& path = record.destPath.native();
+    std::string frame;
+    frame.reserve(recordHeaderSize + path.size() + record.data.size());
+    put(frame, recordMagic);
+    put(frame, static_cast<uint8_t>(record.op));
+    put(frame, static_cast<uint8_t>(record.updateOnly ? updateOnlyFlag : 0));
+    put(frame, record.mode);
+    put(frame, record.uid);
+    put(frame, record.gid);
+    put(frame, record.atimeNs);
+    put(frame, record.mtimeNs);
+    put(frame, static_cast<uint32_t>(path.size()));
+    put(frame, static_cast<uint64_t>(record.data.size()));
+    frame.append(path);
+    frame.append(record.data);
+    return frame;
+}
+
+std::string encodeResult(int error, std::string_view payload)
+{
+    std::string frame;
+    frame.reserve(resultHeaderSize + payload.size());
+    put(frame, resultMagic);
+    put(frame, static_cast<int32_t>(error));
+    put(frame, static_cast<uint32_t>(payload.size()));
+    frame.append(payload);
+    return frame;
+}
+
+std::optional<FileRecord> FrameReader::nextRecord()
+{
+    if (_buffer.size() < recordHeaderSize)
+    {
+        return std::nullopt;
+    }
+
+    size_t offset = 0;
+    if (get<uint32_t>(_buffer, offset) != recordMagic)
+    {
+        throw std::runtime_error("Invalid transfer record frame");
+    }
+    FileRecord record;
+    auto op = get<uint8_t>(_buffer, offset);
+    if (op != static_cast<uint8_t>(TransferOp::Put) &&
+        op != static_cast<uint8_t>(TransferOp::Delete) &&
+        op != static_cast<uint8_t>(TransferOp::Query))
+    {
+        throw std::runtime_error("Invalid transfer operation " +
+                                 std::to_string(op));
+    }
+    record.op = static_cast<TransferOp>(op);
+    record.updateOnly = (get<uint8_t>(_buffer, offset) & updateOnlyFlag) != 0;
+    record.mode = get<uint32_t>(_buffer, offset);
+    record.uid = get<uint32_t>(_buffer, offset);
+    record.gid = get<uint32_t>(_buffer, offset);
+    record.atimeNs = get<int64_t>(_buffer, offset);
+    record.mtimeNs = get<int64_t>(_buffer, offset);
+    auto pathSize = get<uint32_t>(_buffer, offset);
+    auto dataSize = get<uint64_t>(_buffer, offset);
+    if (pathSize > PATH_MAX || dataSize > _maxDataSize)
+    {
+        throw std::runtime_error("Transfer record exceeds the limits, path "
+                                 "size: " +
+                                 std::to_string(pathSize) +
+                                 " data size: " + std::to_string(dataSize));
+    }
+    if (_buffer.size() < recordHeaderSize + pathSize + dataSize)
+    {
+        return std::nullopt;
+    }
+
+    record.destPath = _buffer.substr(offset, pathSize);
+    offset += pathSize;
+    record.data = _buffer.substr(offset, dataSize);
+    offset += dataSize;
+    _buffer.erase(0, offset);
+    return record;
+}
+
+std::optional<TransferResult> FrameReader::nextResult()
+{
+    if (_buffer.size() < resultHeaderSize)
+    {
+        return std::nullopt;
+    }
+    size_t offset = 0;
+    if (get<uint32_t>(_buffer, offset) != resultMagic)
+    {
+        throw std::runtime_error("Invalid transfer result frame");
+    }
+    TransferResult result;
+    result.error = get<int32_t>(_buffer, offset);
+    auto payloadSize = get<uint32_t>(_buffer, offset);
+    if (payloadSize > maxPayloadSize)
+    {
+        throw std::runtime_error("Transfer result exceeds the limits, payload "
+                                 "size: " +
+                                 std::to_string(payloadSize));
+    }
+    if (_buffer.size() < resultHeaderSize + payloadSize)
+    {
+        return std::nullopt;
+    }
+    result.payload = _buffer.substr(offset, payloadSize);
+    offset += payloadSize;
+    _buffer.erase(0, offset);
+    return result;
+}
+
+std::optional<FileRecord> readFileRecord(const fs::path& srcPath,
+                                         const fs::path& destPath,
+                                         size_t maxDataSize)
+{
+    utility::FD file(open(srcPath.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+    if (file() < 0)
+    {
+        if (errno == ENOENT)
+        {
+            FileRecord record;
+            record.op = TransferOp::Delete;
+            record.destPath = destPath;
+            return record;
+        }
+        return std::nullopt;
+    }
+
+    struct stat before{};
+    if (fstat(file(), &before) != 0 || !S_ISREG(before.st_mode) ||
+        static_cast<size_t>(before.st_size) > maxDataSize)
+    {
+        return std::nullopt;
+    }
+
+    FileRecord record;
+    record.destPath = destPath;
+    record.mode = before.st_mode & 07777;
+    record.uid = before.st_uid;
+    record.gid = before.st_gid;
+    record.atimeNs = toNs(before.st_atim);
+    record.mtimeNs = toNs(before.st_mtim);
+    // One more byte to find out if the file grew meanwhile.
+    record.data.resize(static_cast<size_t>(before.st_size) + 1);
+    size_t total = 0;
+    while (total < record.data.size())
+    {
+        auto bytes = read(file(), record.data.data() + total,
+                          record.data.size() - total);
+        if (bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes < 0)
+        {
+            return std::nullopt;
+        }
+        if (bytes == 0)
+        {
+            break;
+        }
+        total += static_cast<size_t>(bytes);
+    }
+
+    struct stat after{};
+    if (total != static_cast<size_t>(before.st_size) ||
+        fstat(file(), &after) != 0 ||
+        toNs(after.st_mtim) != record.mtimeNs || after.st_size != before.st_size)
+    {
+        // Still being written, rsync handles it once the writer is done.
+        return std::nullopt;
+    }
+    record.data.resize(total);
+    return record;
+}
+
+int applyFileRecord(const FileRecord& record)
+{
+    const auto& destPath = record.destPath;
+    std::error_code ec;
+    if (record.op == TransferOp::Delete)
+    {
+        fs::remove(destPath, ec);
+        return ec.value();
+    }
+
+    if (record.updateOnly)
+    {
+        struct stat existing{};
+        if (stat(destPath.c_str(), &existing) == 0 &&
+            toNs(existing.st_mtim) > record.mtimeNs)
+        {
+            return 0;
+        }
+    }
+
+    fs::create_directories(destPath.parent_path(), ec);
+    if (ec)
+    {
+        return ec.value();
+    }
+
+    // Hidden, so the watchers of the path skip it.
+    std::string tmpPath{
+        (destPath.parent_path() / ("." + destPath.filename().string() +
+                                   ".XXXXXX"))
+            .string()};
+    utility::FD file(mkostemp(tmpPath.data(), O_CLOEXEC));
+    if (file() < 0)
+    {
+        return errno;
+    }
+    auto fail = [&tmpPath](int error) {
+        unlink(tmpPath.c_str());
+        return error;
+    };
+
+    std::string_view pending{record.data};
+    while (!pending.empty())
+    {
+        auto written = write(file(), pending.data(), pending.size());
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written < 0)
+        {
+            return fail(errno);
+        }
+        pending.remove_prefix(static_cast<size_t>(written));
+    }
+
+    // The owner is kept only while privileged, the same as rsync, and
+    // before the mode as the ownership change clears the set-id bits. The
+    // set-id bits are never applied, so a received file cannot grant the
+    // privileges of its owner.
+    if (geteuid() == 0 && fchown(file(), record.uid, record.gid) != 0)
+    {
+        return fail(errno);
+    }
+    if (fchmod(file(), record.mode & 01777) != 0)
+    {
+        return fail(errno);
+    }
+    std::array<struct timespec, 2> times{toTimespec(record.atimeNs),
+                                         toTimespec(record.mtimeNs)};
+    if (futimens(file(), times.data()) != 0)
+    {
+        return fail(errno);
+    }
+    if (rename(tmpPath.c_str(), destPath.c_str()) != 0)
+    {
+        return fail(errno);
+    }
+    return 0;
+}
+
+TransferServer::TransferServer(sdbusplus::async::context& ctx, uint16_t port,
+                               PathFilter pathFilter, size_t maxDataSize,
+                               QueryHandler queryHandler) :
+    _ctx(ctx), _pathFilter(std::move(pathFilter)),
+    _queryHandler(std::move(queryHandler)), _maxDataSize(maxDataSize),
+    _listenFd(socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0))
+{
+    if (_listenFd() < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Failed to create the transfer socket");
+    }
+
+    int reuse = 1;
+    setsockopt(_listenFd(), SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto* sockAddr = reinterpret_cast<sockaddr*>(&addr);
+    if (bind(_listenFd(), sockAddr, addrLen) != 0 ||
+        listen(_listenFd(), SOMAXCONN) != 0 ||
+        getsockname(_listenFd(), sockAddr, &addrLen) != 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Failed to listen the transfer port " +
+                                    std::to_string(port));
+    }
+    _port = ntohs(addr.sin_port);
+
+    lg2::info("Listening for the native transfers on the port {PORT}", "PORT",
+              _port);
+    _ctx.spawn(acceptConnections());
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> TransferServer::acceptConnections()
+{
+    sdbusplus::async::fdio fdioInstance(_ctx, _listenFd());
+    while (!_ctx.stop_requested())
+    {
+        // NOLINTNEXTLINE
+        co_await fdioInstance.next();
+        while (true)
+        {
+            int connFd = accept4(_listenFd(), nullptr, nullptr,
+                                 SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (connFd < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    lg2::error("Failed to accept a transfer connection, "
+                               "errno : {ERRNO}",
+                               "ERRNO", errno);
+                }
+                break;
+            }
+            utility::FD conn(connFd);
+
+            // Only the local stunnel forwarding the sibling BMC, run by root
+            // or by the same user, may apply the records.
+            auto peerUid = getPeerUid(conn());
+            if (!peerUid || (*peerUid != 0 && *peerUid != geteuid()))
+            {
+                lg2::warning("Rejecting the transfer connection of an "
+                             "untrusted peer, UID : {UID}",
+                             "UID", peerUid.value_or(-1));
+                continue;
+            }
+            _ctx.spawn(serveConnection(std::move(conn)));
+        }
+    }
+    co_return;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> TransferServer::serveConnection(utility::FD connFd)
+{
+    FrameReader reader(_maxDataSize);
+    sdbusplus::async::fdio fdioInstance(_ctx, connFd());
+    bool open{true};
+    while (open && !_ctx.stop_requested())
+    {
+        // NOLINTNEXTLINE
+        co_await fdioInstance.next();
+        open = readAvailable(connFd(), reader);
+
+        std::string results;
+        try
+        {
+            while (auto record = reader.nextRecord())
+            {
+                const bool validPath =
+                    record->destPath.is_absolute() &&
+                    record->destPath == record->destPath.lexically_normal();
+                if (record->op == TransferOp::Query)
+                {
+                    std::optional<std::string> payload;
+                    if (validPath && _queryHandler)
+                    {
+                        // NOLINTNEXTLINE
+                        payload = co_await _queryHandler(record->destPath);
+                    }
+                    results.append(payload ? encodeResult(0, *payload)
+                                           : encodeResult(ENOENT));
+                    continue;
+                }
+
+                int error = EACCES;
+                if (validPath && _pathFilter(record->destPath))
+                {
+                    error = applyFileRecord(*record);
+                }
+                if (error != 0)
+                {
+                    lg2::error("Failed to apply the transferred path "
+                               "[{PATH}], errno : {ERRNO}",
+                               "PATH", record->destPath, "ERRNO", error);
+                }
+                results.append(encodeResult(error));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Closing the transfer connection, Error : {ERROR}",
+                       "ERROR", e);
+            open = false;
+        }
+
+        try
+        {
+            // NOLINTNEXTLINE
+            co_await sendAll(_ctx, connFd(), results,
+                             std::chrono::steady_clock::now() +
+                                 transferTimeout);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Failed to send the transfer results, Error : {ERROR}",
+                       "ERROR", e);
+            open = false;
+        }
+    }
+    co_return;
+}
+
+TransferClient::TransferClient(sdbusplus::async::context& ctx, uint16_t port,
+                               std::chrono::milliseconds timeout) :
+    _ctx(ctx), _port(port), _timeout(timeout)
+{}
+
+utility::FD TransferClient::connect() const
+{
+    utility::FD connFd(socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if (connFd() < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Failed to create the transfer socket");
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    // The loopback connect completes right away, the local stunnel connects
+    // to the sibling BMC on its own.
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (::connect(connFd(), reinterpret_cast<sockaddr*>(&addr),
+                  sizeof(addr)) != 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Failed to connect the transfer port " +
+                                    std::to_string(_port));
+    }
+
+    int noDelay = 1;
+    setsockopt(connFd(), IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    int flags = fcntl(connFd(), F_GETFL, 0);
+    if (flags == -1 || fcntl(connFd(), F_SETFL, flags | O_NONBLOCK) == -1)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Failed to set the transfer socket "
+                                "non-blocking");
+    }
+    return connFd;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<std::vector<int>>
+    TransferClient::send(const std::vector<FileRecord>& records)
+{
+    std::vector<int> errors;
+    // NOLINTNEXTLINE
+    for (auto& result : co_await exchange(records))
+    {
+        errors.emplace_back(result.error);
+    }
+    co_return errors;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<std::vector<std::optional<std::string>>>
+    TransferClient::query(const std::vector<fs::path>& paths)
+{
+    std::vector<FileRecord> records(paths.size());
+    for (size_t index = 0; index < paths.size(); ++index)
+    {
+        records[index].op = TransferOp::Query;
+        records[index].destPath = paths[index];
+    }
+
+    std::vector<std::optional<std::string>> payloads;
+    // NOLINTNEXTLINE
+    for (auto& result : co_await exchange(records))
+    {
+        payloads.emplace_back(result.error == 0
+                                  ? std::optional(std::move(result.payload))
+                                  : std::nullopt);
+    }
+    co_return payloads;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<std::vector<TransferResult>>
+    TransferClient::exchange(const std::vector<FileRecord>& records)
+{
+    if (records.empty())
+    {
+        co_return std::vector<TransferResult>{};
+    }
+
+    std::string frames;
+    for (const auto& record : records)
+    {
+        frames.append(encode(record));
+    }
+
+    // An idle connection may have been closed by the peer meanwhile, then
+    // the records are sent again over a new connection, within the same
+    // deadline.
+    const auto deadline = std::chrono::steady_clock::now() + _timeout;
+    bool retry{!_idleConnections.empty()};
+    utility::FD connFd = retry ? std::move(_idleConnections.back())
+                               : connect();
+    if (retry)
+    {
+        _idleConnections.pop_back();
+    }
+
+    while (true)
+    {
+        std::vector<TransferResult> results;
+        try
+        {
+            // NOLINTNEXTLINE
+            co_await sendAll(_ctx, connFd(), frames, deadline);
+
+            // The connection of a stalled peer is dropped once the deadline
+            // passes, leaving the records to rsync.
+            FrameReader reader(0);
+            SocketWaiter readable(_ctx, connFd(), deadline);
+            while (results.size() < records.size())
+            {
+                // NOLINTNEXTLINE
+                co_await readable.wait(EPOLLIN);
+                bool open = readAvailable(connFd(), reader);
+                while (auto result = reader.nextResult())
+                {
+                    results.emplace_back(std::move(*result));
+                }
+                if (!open && results.size() < records.size())
+                {
+                    throw std::system_error(
+                        ECONNRESET, std::generic_category(),
+                        "The transfer connection got closed");
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            if (!retry)
+            {
+                throw;
+            }
+            lg2::debug("Reconnecting the transfer port, Error : {ERROR}",
+                       "ERROR", e);
+            results.clear();
+        }
+
+        if (results.size() == records.size())
+        {
+            _idleConnections.emplace_back(std::move(connFd));
+            co_return results;
+        }
+        retry = false;
+        connFd = connect();
+    }
+}
+
+} // namespace data_sync::transfer
@@ -0,0 +1,415 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "utility.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace data_sync::transfer
+{
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief The time a transfer may take before its connection is dropped, so
+ *        a stalled peer does not hold the sync forever.
+ */
+constexpr std::chrono::seconds transferTimeout{30};
+
+/**
+ * @brief The operations to apply on the sibling BMC.
+ *
+ * Query only asks for the description of a path, answered by the result.
+ */
+enum class TransferOp : uint8_t
+{
+    Put = 1,
+    Delete = 2,
+    Query = 3
+};
+
+/**
+ * @brief A file to replace or delete on the sibling BMC, along with its
+ *        metadata.
+ */
+struct FileRecord
+{
+    /**
+     * @brief The operation to apply
+     */
+    TransferOp op = TransferOp::Put;
+
+    /**
+     * @brief The absolute path to apply the operation on the sibling BMC
+     */
+    fs::path destPath;
+
+    /**
+     * @brief The permission bits of the file
+     */
+    uint32_t mode = 0;
+
+    /**
+     * @brief The owner and the group of the file
+     */
+    uint32_t uid = 0;
+    uint32_t gid = 0;
+
+    /**
+     * @brief The access and the modification times in nanoseconds
+     */
+    int64_t atimeNs = 0;
+    int64_t mtimeNs = 0;
+
+    /**
+     * @brief Whether to skip replacing a newer file on the sibling, the same
+     *        as the rsync --update option.
+     */
+    bool updateOnly = false;
+
+    /**
+     * @brief The whole contents of the file
+     */
+    std::string data;
+
+    bool operator==(const FileRecord&) const = default;
+};
+
+/**
+ * @brief Frame a record to send over the connection.
+ *
+ * @param[in] record - The record to frame
+ *
+ * @returns std::string - The frame
+ */
+std::string encode(const FileRecord& record);
+
+/**
+ * @brief The result of a record applied by the sibling BMC.
+ */
+struct TransferResult
+{
+    /**
+     * @brief The errno of the operation, zero on success
+     */
+    int error = 0;
+
+    /**
+     * @brief The answer of a query
+     */
+    std::string payload;
+};
+
+/**
+ * @class FrameReader
+ *
+ * @brief Parses the frames of the records or the results received over a
+ *        connection, which may be split or merged across the reads.
+ */
+class FrameReader
+{
+  public:
+    /**
+     * @brief Constructor
+     *
+     * @param[in] maxDataSize - The maximum accepted file size
+     */
+    explicit FrameReader(size_t maxDataSize) : _maxDataSize(maxDataSize) {}
+
+    /**
+     * @brief Append the received bytes.
+     */
+    void append(std::string_view bytes)
+    {
+        _buffer.append(bytes);
+    }
+
+    /**
+     * @brief Take the next complete record.
+     *
+     * @returns The record, std::nullopt if not yet received completely.
+     *
+     * @throw std::runtime_error - If the frame is malformed
+     */
+    std::optional<FileRecord> nextRecord();
+
+    /**
+     * @brief Take the next complete result.
+     *
+     * @returns The result, std::nullopt if not yet received completely.
+     *
+     * @throw std::runtime_error - If the frame is malformed
+     */
+    std::optional<TransferResult> nextResult();
+
+  private:
+    /**
+     * @brief The maximum accepted file size
+     */
+    size_t _maxDataSize;
+
+    /**
+     * @brief The received bytes not yet parsed
+     */
+    std::string _buffer;
+};
+
+/**
+ * @brief Frame the result of a received record.
+ *
+ * @param[in] error - The errno of the operation, zero on success
+ * @param[in] payload - The answer of a query
+ *
+ * @returns std::string - The frame
+ */
+std::string encodeResult(int error, std::string_view payload = {});
+
+/**
+ * @brief Read a file into a record to transfer.
+ *
+ * A missing file is read as a delete, the same as the rsync
+ * --delete-missing-args option.
+ *
+ * @param[in] srcPath - The absolute path of the file
+ * @param[in] destPath - The absolute path of the file on the sibling BMC
+ * @param[in] maxDataSize - The maximum size of the file
+ *
+ * @returns The record, std::nullopt if the path is not a regular file, is
+ *          bigger than the maximum size or changed while reading, which
+ *          are left to rsync.
+ */
+std::optional<FileRecord> readFileRecord(const fs::path& srcPath,
+                                         const fs::path& destPath,
+                                         size_t maxDataSize);
+
+/**
+ * @brief Apply a received record.
+ *
+ * The file is written into a hidden temporary file in the same directory,
+ * which replaces the file once its metadata are set, so a partially
+ * received file is never seen.
+ *
+ * @param[in] record - The record to apply
+ *
+ * @returns int - The errno of the operation, zero on success
+ */
+int applyFileRecord(const FileRecord& record);
+
+/**
+ * @brief The callback to check whether a received path can be modified.
+ */
+using PathFilter = std::function<bool(const fs::path&)>;
+
+/**
+ * @brief The callback to answer a query of a path, std::nullopt if the path
+ *        is unknown. It may suspend, the records after the query wait for
+ *        the answer.
+ */
+using QueryHandler =
+    std::function<sdbusplus::async::task<std::optional<std::string>>(
+        const fs::path&)>;
+
+/** @class TransferServer
+ *
+ *  @brief Receives the records sent by the sibling BMC and applies them.
+ *
+ *  Listens on the loopback interface only, the connections from the sibling
+ *  BMC are forwarded by stunnel, the same as for rsync. The connections of
+ *  the local processes not run by root or by the user of the service are
+ *  rejected, and the set-id bits of the received files are dropped.
+ */
+class TransferServer
+{
+  public:
+    TransferServer(const TransferServer&) = delete;
+    TransferServer& operator=(const TransferServer&) = delete;
+    TransferServer(TransferServer&&) = delete;
+    TransferServer& operator=(TransferServer&&) = delete;
+    ~TransferServer() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] ctx - The async context object
+     * @param[in] port - The loopback port to listen, zero for any free port
+     * @param[in] pathFilter - The check whether a received path can be
+     *                         modified
+     * @param[in] maxDataSize - The maximum accepted file size
+     * @param[in] queryHandler - The callback to answer the queries, none
+     *                           are answered if empty
+     *
+     * @throw std::system_error - If the port could not be listened
+     */
+    TransferServer(sdbusplus::async::context& ctx, uint16_t port,
+                   PathFilter pathFilter, size_t maxDataSize,
+                   QueryHandler queryHandler = {});
+
+    /**
+     * @brief Get the listened port.
+     */
+    uint16_t getPort() const
+    {
+        return _port;
+    }
+
+  private:
+    /**
+     * @brief The coroutine accepting the connections.
+     */
+    sdbusplus::async::task<> acceptConnections();
+
+    /**
+     * @brief The coroutine applying the records received over a connection
+     *        until it is closed.
+     *
+     * @param[in] connFd - The accepted connection
+     */
+    sdbusplus::async::task<> serveConnection(utility::FD connFd);
+
+    /**
+     * @brief The async context object
+     */
+    sdbusplus::async::context& _ctx;
+
+    /**
+     * @brief The check whether a received path can be modified
+     */
+    PathFilter _pathFilter;
+
+    /**
+     * @brief The callback to answer the queries
+     */
+    QueryHandler _queryHandler;
+
+    /**
+     * @brief The maximum accepted file size
+     */
+    size_t _maxDataSize;
+
+    /**
+     * @brief The listening socket
+     */
+    utility::FD _listenFd;
+
+    /**
+     * @brief The listened port
+     */
+    uint16_t _port = 0;
+};
+
+/** @class TransferClient
+ *
+ *  @brief Sends the records to the sibling BMC over the persistent
+ *         connections to the loopback port forwarded by stunnel.
+ *
+ *  The connections are kept open across the transfers, and a new one is
+ *  opened only if all the open ones are in use. A transfer not completed
+ *  within its timeout fails and its connection is dropped.
+ */
+class TransferClient
+{
+  public:
+    TransferClient(const TransferClient&) = delete;
+    TransferClient& operator=(const TransferClient&) = delete;
+    TransferClient(TransferClient&&) = delete;
+    TransferClient& operator=(TransferClient&&) = delete;
+    ~TransferClient() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] ctx - The async context object
+     * @param[in] port - The loopback port forwarded to the sibling BMC
+     * @param[in] timeout - The time a transfer may take
+     */
+    TransferClient(sdbusplus::async::context& ctx, uint16_t port,
+                   std::chrono::milliseconds timeout = transferTimeout);
+
+    /**
+     * @brief Send the records and wait for their results.
+     *
+     * @param[in] records - The records to send
+     *
+     * @returns std::vector<int> - The errno per record, zero on success
+     *
+     * @throw std::system_error - If the records could not be sent or the
+     *                            connection got closed or timed out
+     */
+    sdbusplus::async::task<std::vector<int>>
+        send(const std::vector<FileRecord>& records);
+
+    /**
+     * @brief Query the sibling BMC about the paths.
+     *
+     * @param[in] paths - The paths to query
+     *
+     * @returns The answer per path, std::nullopt if the path is unknown
+     *
+     * @throw std::system_error - If the queries could not be sent or the
+     *                            connection got closed or timed out
+     */
+    sdbusplus::async::task<std::vector<std::optional<std::string>>>
+        query(const std::vector<fs::path>& paths);
+
+    /**
+     * @brief Get the number of the open idle connections.
+     */
+    size_t getIdleConnections() const
+    {
+        return _idleConnections.size();
+    }
+
+  private:
+    /**
+     * @brief Send the records and wait for their results, over an idle
+     *        connection if any.
+     *
+     * @param[in] records - The records to send
+     *
+     * @returns std::vector<TransferResult> - The result per record
+     *
+     * @throw std::system_error - If the records could not be sent or the
+     *                            connection got closed or timed out
+     */
+    sdbusplus::async::task<std::vector<TransferResult>>
+        exchange(const std::vector<FileRecord>& records);
+
+    /**
+     * @brief Open a connection to the port.
+     *
+     * @throw std::system_error - If the connection failed
+     */
+    utility::FD connect() const;
+
+    /**
+     * @brief The async context object
+     */
+    sdbusplus::async::context& _ctx;
+
+    /**
+     * @brief The loopback port forwarded to the sibling BMC
+     */
+    uint16_t _port;
+
+    /**
+     * @brief The time a transfer may take
+     */
+    std::chrono::milliseconds _timeout;
+
+    /**
+     * @brief The open connections not in use
+     */
+    std::vector<utility::FD> _idleConnections;
+};
+
+} // namespace data_sync::transfer
@@ -31,7 +31,8 @@ NotifyService::NotifyService(
     sdbusplus::async::context& ctx,
     data_sync::ext_data::ExternalDataIFaces& extDataIfaces,
     const fs::path& notifyFilePath, CleanupCallback cleanup) :
-    _ctx(ctx), _extDataIfaces(extDataIfaces), _cleanup(std::move(cleanup))
+    _ctx(ctx), _extDataIfaces(extDataIfaces), _notifyFilePath(notifyFilePath),
+    _cleanup(std::move(cleanup))
 {
     _ctx.spawn(init(notifyFilePath));
 }
@@ -39,6 +39,14 @@ class NotifyService
                   data_sync::ext_data::ExternalDataIFaces& extDataIfaces,
                   const fs::path& notifyFilePath, CleanupCallback cleanup);
 
+    /**
+     * @brief Get the path of the notify request being processed.
+     */
+    const fs::path& getNotifyFilePath() const
+    {
+        return _notifyFilePath;
+    }
+
   private:
     /**
      * @brief API to trigger systemd reload/restart for the service and
@@ -87,6 +95,11 @@ class NotifyService
      */
     data_sync::ext_data::ExternalDataIFaces& _extDataIfaces;
 
+    /**
+     * @brief The path of the notify request being processed.
+     */
+    fs::path _notifyFilePath;
+
     /**
      * @brief  Callback function invoked when notification processing
      *         completes to remove the NotifyService object from the
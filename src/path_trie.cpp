@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "path_trie.hpp"
+
+#include <algorithm>
+
+namespace data_sync::watch
+{
+
+namespace
+{
+
+/**
+ * @brief Invoke the given callable for each non empty component of the
+ *        path, until it returns false.
+ */
+template <typename Callable>
+void forEachComponent(std::string_view path, Callable&& callable)
+{
+    while (!path.empty())
+    {
+        auto separator = path.find('/');
+        auto component = path.substr(0, separator);
+        if (!component.empty() && !callable(component))
+        {
+            return;
+        }
+        if (separator == std::string_view::npos)
+        {
+            return;
+        }
+        path.remove_prefix(separator + 1);
+    }
+}
+
+} // namespace
+
+PathTrie::PathTrie() : _nodes(1) {}
+
+PathTrie::PathTrie(
+    const std::optional<std::unordered_set<fs::path>>& excludeList,
+    const std::optional<std::unordered_set<fs::path>>& includeList) :
+    PathTrie()
+{
+    if (excludeList.has_value())
+    {
+        std::ranges::for_each(excludeList.value(),
+                              [this](const auto& path) { addExclude(path); });
+    }
+    if (includeList.has_value())
+    {
+        std::ranges::for_each(includeList.value(),
+                              [this](const auto& path) { addInclude(path); });
+    }
+}
+
+void PathTrie::addExclude(const fs::path& path)
+{
+    insert(path, NodeFlags::exclude);
+    _hasExcludes = true;
+}
+
+void PathTrie::addInclude(const fs::path& path)
+{
+    insert(path, NodeFlags::include);
+    _hasIncludes = true;
+}
+
+void PathTrie::insert(const fs::path& path, NodeFlags flag)
+{
+    size_t nodeIdx = 0;
+    forEachComponent(path.native(), [this, flag, &nodeIdx](auto component) {
+        if (flag == NodeFlags::include)
+        {
+            // The nodes above an include path are its parents.
+            _nodes[nodeIdx].flags |= NodeFlags::parentOfInclude;
+        }
+
+        auto child = _nodes[nodeIdx].children.find(component);
+        if (child == _nodes[nodeIdx].children.end())
+        {
+            // Note: emplace_back may invalidate the node references, hence
+            // use the index only.
+            _nodes.emplace_back();
+            child = _nodes[nodeIdx]
+                        .children.emplace(component, _nodes.size() - 1)
+                        .first;
+        }
+        nodeIdx = child->second;
+        return true;
+    });
+    _nodes[nodeIdx].flags |= flag;
+}
+
+PathTrie::Match PathTrie::match(std::string_view path) const
+{
+    Match result{};
+    const Node* node = _nodes.data();
+    bool consumed = true;
+
+    auto accumulate = [&result](const Node& node) {
+        result.excluded |= (node.flags & NodeFlags::exclude) != 0;
+        result.included |= (node.flags & NodeFlags::include) != 0;
+    };
+
+    forEachComponent(path, [this, &node, &consumed,
+                            &accumulate](std::string_view component) {
+        accumulate(*node);
+        auto child = node->children.find(component);
+        if (child == node->children.end())
+        {
+            consumed = false;
+            return false;
+        }
+        node = &_nodes[child->second];
+        return true;
+    });
+
+    if (consumed)
+    {
+        // The whole path is on the trie, check the node of the path itself.
+        accumulate(*node);
+        result.parentOfInclude = (node->flags & NodeFlags::parentOfInclude) !=
+                                 0;
+    }
+    return result;
+}
+
+} // namespace data_sync::watch
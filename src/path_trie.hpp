@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace data_sync::watch
+{
+
+namespace fs = std::filesystem;
+
+/** @class PathTrie
+ *
+ *  @brief Component-wise prefix trie of the configured Include/Exclude
+ *         lists.
+ *
+ *  The lists are compiled once, then whether a path is excluded, included
+ *  or a parent of an include path is answered by a single walk over the
+ *  path components, without allocation and without accessing the
+ *  filesystem. A trailing slash (i.e. directory) is not significant while
+ *  matching, an entry matches itself and everything under it.
+ */
+class PathTrie
+{
+  public:
+    /**
+     * @brief The result of matching a path against the lists.
+     */
+    struct Match
+    {
+        /**
+         * @brief The path is an exclude path or a child of it.
+         */
+        bool excluded = false;
+
+        /**
+         * @brief The path is an include path or a child of it.
+         */
+        bool included = false;
+
+        /**
+         * @brief The path is a parent of an include path.
+         */
+        bool parentOfInclude = false;
+    };
+
+    PathTrie();
+
+    /**
+     * @brief Constructor
+     *
+     * Compile the given lists.
+     *
+     * @param[in] excludeList - The list of paths to be excluded
+     * @param[in] includeList - The list of paths to be included
+     */
+    PathTrie(const std::optional<std::unordered_set<fs::path>>& excludeList,
+             const std::optional<std::unordered_set<fs::path>>& includeList);
+
+    /**
+     * @brief Add a path to exclude.
+     *
+     * @param[in] path - The absolute path
+     */
+    void addExclude(const fs::path& path);
+
+    /**
+     * @brief Add a path to include.
+     *
+     * @param[in] path - The absolute path
+     */
+    void addInclude(const fs::path& path);
+
+    /**
+     * @brief Match the given absolute path against the lists.
+     *
+     * @param[in] path - The absolute path, with or without trailing slash
+     *
+     * @returns Match - The result of the match
+     */
+    Match match(std::string_view path) const;
+
+    /**
+     * @brief Whether any exclude path is added.
+     */
+    bool hasExcludes() const
+    {
+        return _hasExcludes;
+    }
+
+    /**
+     * @brief Whether any include path is added.
+     */
+    bool hasIncludes() const
+    {
+        return _hasIncludes;
+    }
+
+  private:
+    /**
+     * @brief The flags of a trie node
+     */
+    enum NodeFlags : uint8_t
+    {
+        exclude = 0x1,
+        include = 0x2,
+        parentOfInclude = 0x4
+    };
+
+    /**
+     * @brief A trie node per path component.
+     *
+     * The children are looked up by std::string_view without creating a
+     * string, and are referred by their index in _nodes.
+     */
+    struct Node
+    {
+        std::map<std::string, size_t, std::less<>> children;
+        uint8_t flags = 0;
+    };
+
+    /**
+     * @brief Add the path components to the trie and set the flag on the
+     *        final node.
+     *
+     * @param[in] path - The absolute path
+     * @param[in] flag - The flag to set
+     */
+    void insert(const fs::path& path, NodeFlags flag);
+
+    /**
+     * @brief The trie nodes, the root ("/") is the first node.
+     */
+    std::vector<Node> _nodes;
+
+    /**
+     * @brief Whether any exclude path is added
+     */
+    bool _hasExcludes = false;
+
+    /**
+     * @brief Whether any include path is added
+     */
+    bool _hasIncludes = false;
+};
+
+} // namespace data_sync::watch
@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "poll_scanner.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <ranges>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace data_sync::watch
+{
+
+namespace
+{
+
+/**
+ * @brief Check whether the path is the given root or inside it.
+ */
+bool isUnder(std::string_view path, std::string_view root)
+{
+    return path.starts_with(root) &&
+           (path.size() == root.size() || path[root.size()] == '/' ||
+            root.ends_with('/'));
+}
+
+std::string_view withoutTrailingSlash(std::string_view path)
+{
+    while (path.size() > 1 && path.ends_with('/'))
+    {
+        path.remove_suffix(1);
+    }
+    return path;
+}
+
+} // namespace
+
+PollScanner::PollScanner(PathFilter pathFilter) :
+    _pathFilter(std::move(pathFilter))
+{}
+
+void PollScanner::addRoot(const fs::path& root)
+{
+    fs::path rootPath{withoutTrailingSlash(root.native())};
+    if (covers(rootPath.native()))
+    {
+        return;
+    }
+
+    // The new root subsumes the polled paths inside it.
+    std::erase_if(_roots, [&rootPath](const fs::path& polled) {
+        return isUnder(polled.native(), rootPath.native());
+    });
+    std::erase_if(_snapshot, [&rootPath](const Entry& entry) {
+        return isUnder(entry.path, rootPath.native());
+    });
+
+    walk(rootPath, _snapshot);
+    std::ranges::sort(_snapshot, {}, &Entry::path);
+    _roots.emplace_back(std::move(rootPath));
+}
+
+bool PollScanner::covers(std::string_view path) const
+{
+    path = withoutTrailingSlash(path);
+    return std::ranges::any_of(_roots, [path](const fs::path& root) {
+        return isUnder(path, root.native());
+    });
+}
+
+size_t PollScanner::getMemoryUsage() const
+{
+    return std::ranges::fold_left(
+        _snapshot, _snapshot.capacity() * sizeof(Entry),
+        [](size_t total, const Entry& entry) {
+        // The short paths are stored inside the string object itself.
+        return total + (entry.path.capacity() > std::string().capacity()
+                            ? entry.path.capacity() + 1
+                            : 0);
+    });
+}
+
+void PollScanner::walk(const fs::path& root, Snapshot& snapshot) const
+{
+    auto filter = [this](std::string_view path) {
+        return _pathFilter ? _pathFilter(path) : ScanFilter::Report;
+    };
+
+    auto addEntry = [&snapshot](std::string path, const struct statx& stx) {
+        snapshot.emplace_back(
+            std::move(path), stx.stx_ino, static_cast<int64_t>(stx.stx_size),
+            (static_cast<int64_t>(stx.stx_mtime.tv_sec) * 1'000'000'000) +
+                stx.stx_mtime.tv_nsec,
+            S_ISDIR(stx.stx_mode));
+    };
+
+    // Only the fields compared across the scans are requested, and the
+    // cached attributes are used as is on the network filesystems instead
+    // of revalidating each entry with the server.
+    auto statEntry = [](int dirFd, const char* path, struct statx& stx) {
+        return statx(dirFd, path, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+                     STATX_TYPE | STATX_INO | STATX_SIZE | STATX_MTIME,
+                     &stx) == 0;
+    };
+
+    struct statx stx{};
+    auto rootFilter = filter(root.native());
+    if (rootFilter == ScanFilter::Skip ||
+        !statEntry(AT_FDCWD, root.c_str(), stx))
+    {
+        return;
+    }
+    if (rootFilter == ScanFilter::Report)
+    {
+        addEntry(root.native(), stx);
+    }
+    if (!S_ISDIR(stx.stx_mode))
+    {
+        return;
+    }
+
+    // Walk iteratively to keep the stack bounded on deep trees.
+    std::vector<std::string> pendingDirs{root.native()};
+    while (!pendingDirs.empty())
+    {
+        std::string dirPath = std::move(pendingDirs.back());
+        pendingDirs.pop_back();
+
+        DIR* dir = opendir(dirPath.c_str());
+        if (dir == nullptr)
+        {
+            // Removed meanwhile or not readable, its entries are reported
+            // as deleted if they were seen before.
+            continue;
+        }
+        while (const dirent* dirEntry = readdir(dir))
+        {
+            std::string_view name{dirEntry->d_name};
+            if (name == "." || name == "..")
+            {
+                continue;
+            }
+            std::string path = dirPath;
+            if (!path.ends_with('/'))
+            {
+                path.push_back('/');
+            }
+            path.append(name);
+
+            auto entryFilter = filter(path);
+            if (entryFilter == ScanFilter::Skip ||
+                !statEntry(dirfd(dir), dirEntry->d_name, stx))
+            {
+                continue;
+            }
+            if (S_ISDIR(stx.stx_mode))
+            {
+                pendingDirs.push_back(path);
+            }
+            if (entryFilter == ScanFilter::Report)
+            {
+                addEntry(std::move(path), stx);
+            }
+        }
+        closedir(dir);
+    }
+}
+
+PollScanner::Snapshot PollScanner::takeSnapshot() const
+{
+    Snapshot snapshot;
+    snapshot.reserve(_snapshot.size());
+    std::ranges::for_each(_roots, [this, &snapshot](const fs::path& root) {
+        walk(root, snapshot);
+    });
+    std::ranges::sort(snapshot, {}, &Entry::path);
+    return snapshot;
+}
+
+DataOperations PollScanner::scan()
+{
+    Snapshot current = takeSnapshot();
+    DataOperations dataOps;
+    std::vector<const Entry*> deleted;
+    std::vector<const Entry*> created;
+
+    auto reportedPath = [](const Entry& entry) {
+        return entry.isDir ? fs::path(entry.path) / "" : fs::path(entry.path);
+    };
+
+    // Both the snapshots are sorted by path, so a single merge pass finds the
+    // created, deleted and modified entries.
+    auto prevIt = _snapshot.cbegin();
+    auto currIt = current.cbegin();
+    while (prevIt != _snapshot.cend() || currIt != current.cend())
+    {
+        if (currIt == current.cend() ||
+            (prevIt != _snapshot.cend() && prevIt->path < currIt->path))
+        {
+            deleted.emplace_back(&*prevIt++);
+        }
+        else if (prevIt == _snapshot.cend() || currIt->path < prevIt->path)
+        {
+            created.emplace_back(&*currIt++);
+        }
+        else
+        {
+            // The modification time of a directory changes along with its
+            // entries, which are reported by themselves.
+            if (prevIt->isDir != currIt->isDir ||
+                prevIt->inode != currIt->inode ||
+                (!currIt->isDir && (prevIt->size != currIt->size ||
+                                    prevIt->mtimeNs != currIt->mtimeNs)))
+            {
+                dataOps.emplace_back(reportedPath(*currIt), DataOps::COPY);
+            }
+            ++prevIt;
+            ++currIt;
+        }
+    }
+
+    // A rename keeps the inode, and the size and the modification time of a
+    // file, so the deleted and the created entries matching those are
+    // reported as moved, the same as the IN_MOVED_FROM/TO pairs.
+    std::unordered_map<uint64_t, const Entry*> deletedByInode;
+    std::ranges::for_each(deleted, [&deletedByInode](const Entry* entry) {
+        deletedByInode.emplace(entry->inode, entry);
+    });
+    auto isRenamed = [](const Entry& from, const Entry& to) {
+        return from.isDir == to.isDir &&
+               (from.isDir ||
+                (from.size == to.size && from.mtimeNs == to.mtimeNs));
+    };
+
+    std::unordered_set<const Entry*> movedFrom;
+    for (const Entry* entry : created)
+    {
+        auto fromIt = deletedByInode.find(entry->inode);
+        if (fromIt != deletedByInode.end() && isRenamed(*fromIt->second, *entry))
+        {
+            dataOps.emplace_back(reportedPath(*entry), DataOps::MOVE,
+                                 reportedPath(*fromIt->second));
+            movedFrom.emplace(fromIt->second);
+            deletedByInode.erase(fromIt);
+            continue;
+        }
+        dataOps.emplace_back(reportedPath(*entry), DataOps::COPY);
+    }
+    for (const Entry* entry : deleted)
+    {
+        if (!movedFrom.contains(entry))
+        {
+            dataOps.emplace_back(reportedPath(*entry), DataOps::DELETE);
+        }
+    }
+
+    _snapshot = std::move(current);
+    return dataOps;
+}
+
+} // namespace data_sync::watch
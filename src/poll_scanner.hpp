@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "watcher.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace data_sync::watch
+{
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief The interval to scan the polled paths for modifications.
+ */
+constexpr auto pollScanInterval = std::chrono::seconds(15);
+
+/**
+ * @brief How an entry found while scanning should be handled.
+ */
+enum class ScanFilter
+{
+    /**
+     * @brief Report the modifications of the entry
+     */
+    Report,
+
+    /**
+     * @brief Only look into the directory for the entries to report
+     */
+    Traverse,
+
+    /**
+     * @brief Ignore the entry and its children
+     */
+    Skip
+};
+
+/**
+ * @brief The callback to filter the entries found while scanning.
+ */
+using PathFilter = std::function<ScanFilter(std::string_view path)>;
+
+/** @class PollScanner
+ *
+ *  @brief Detects the modifications of the paths which aren't monitored
+ *         through the filesystem notifications, by comparing the size and
+ *         the modification time of the entries with the snapshot taken on
+ *         the previous scan.
+ *
+ *  The snapshot is a vector sorted by path, so two snapshots are compared
+ *  with a single merge pass. The directories are reported with a trailing
+ *  slash, as the watchers do, and only their creation and deletion are
+ *  reported as the modifications of their entries are reported anyway. A
+ *  deleted and a created entry having the same inode are reported as a
+ *  DataOps::MOVE.
+ */
+class PollScanner
+{
+  public:
+    /**
+     * @brief Constructor
+     *
+     * @param[in] pathFilter - The callback to filter the found entries,
+     *                         all the entries are reported if not given.
+     */
+    explicit PollScanner(PathFilter pathFilter = {});
+
+    /**
+     * @brief Start polling the given path along with its subtree.
+     *
+     * The snapshot of the path is taken right away, so only the
+     * modifications made afterwards are reported.
+     *
+     * @param[in] root - The absolute path of a file or a directory, it is
+     *                   reported once created if not exists.
+     */
+    void addRoot(const fs::path& root);
+
+    /**
+     * @brief Check whether the given path is in a polled subtree.
+     *
+     * @param[in] path - The absolute path, the trailing slash is ignored
+     */
+    bool covers(std::string_view path) const;
+
+    /**
+     * @brief Scan the polled paths and compare with the previous snapshot.
+     *
+     * @returns DataOperations - The operations to sync the modifications
+     *                           since the previous scan
+     */
+    DataOperations scan();
+
+    /**
+     * @brief Get the polled paths.
+     */
+    const std::vector<fs::path>& getRoots() const
+    {
+        return _roots;
+    }
+
+    /**
+     * @brief Get the number of the entries in the snapshot.
+     */
+    size_t size() const
+    {
+        return _snapshot.size();
+    }
+
+    /**
+     * @brief Get the approximate memory used by the snapshot.
+     */
+    size_t getMemoryUsage() const;
+
+  private:
+    /**
+     * @brief The state of an entry at the time of the scan
+     */
+    struct Entry
+    {
+        /**
+         * @brief The absolute path, without the trailing slash
+         */
+        std::string path;
+        uint64_t inode;
+        int64_t size;
+        int64_t mtimeNs;
+        bool isDir;
+    };
+
+    using Snapshot = std::vector<Entry>;
+
+    /**
+     * @brief Walk the given path and append its entries to the snapshot.
+     *
+     * @param[in] root - The absolute path to walk
+     * @param[in,out] snapshot - The snapshot to append the entries
+     */
+    void walk(const fs::path& root, Snapshot& snapshot) const;
+
+    /**
+     * @brief Take the snapshot of all the polled paths, sorted by path.
+     */
+    Snapshot takeSnapshot() const;
+
+    /**
+     * @brief The callback to filter the found entries
+     */
+    PathFilter _pathFilter;
+
+    /**
+     * @brief The polled paths
+     */
+    std::vector<fs::path> _roots;
+
+    /**
+     * @brief The snapshot taken on the previous scan
+     */
+    Snapshot _snapshot;
+};
+
+} // namespace data_sync::watch
@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "poll_watcher.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <ranges>
+
+namespace data_sync::watch::poll
+{
+
+PollMux::PollMux(sdbusplus::async::context& ctx) : _ctx(ctx) {}
+
+void PollMux::attach(PollWatcher& watcher)
+{
+    if (!std::ranges::contains(_watchers, &watcher))
+    {
+        _watchers.emplace_back(&watcher);
+    }
+}
+
+void PollMux::detach(PollWatcher& watcher)
+{
+    std::erase(_watchers, &watcher);
+}
+
+void PollMux::startPoller()
+{
+    if (_pollerRunning)
+    {
+        return;
+    }
+    _pollerRunning = true;
+    _ctx.spawn(pollWatchers());
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> PollMux::pollWatchers()
+{
+    while (!_ctx.stop_requested() && !_watchers.empty())
+    {
+        // Sleep until the earliest due scan. The watchers attached meanwhile
+        // are scanned on the next wakeup at the latest.
+        auto now = std::chrono::steady_clock::now();
+        auto nextScanTime = std::ranges::min(
+            _watchers | std::views::transform(&PollWatcher::getNextScanTime));
+        auto sleepTime = std::clamp(
+            std::chrono::duration_cast<std::chrono::milliseconds>(nextScanTime -
+                                                                  now),
+            std::chrono::milliseconds(0),
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                pollScanInterval));
+
+        // NOLINTNEXTLINE
+        co_await sdbusplus::async::sleep_for(_ctx, sleepTime);
+
+        // Copy as a watcher could get detached while reporting.
+        auto watchers = _watchers;
+        now = std::chrono::steady_clock::now();
+        size_t modifications = 0;
+        for (auto* watcher : watchers)
+        {
+            if (std::ranges::contains(_watchers, watcher) &&
+                watcher->getNextScanTime() <= now)
+            {
+                modifications += watcher->scan();
+            }
+        }
+        if (modifications > 0)
+        {
+            _eventStats.update(modifications);
+        }
+    }
+    _pollerRunning = false;
+    co_return;
+}
+
+PollWatcher::PollWatcher(
+    PollMux& pollMux, DataChangeCallback callback,
+    const fs::path& dataPathToWatch,
+    std::optional<std::unordered_set<fs::path>> excludeList,
+    std::optional<std::unordered_set<fs::path>> includeList,
+    std::chrono::seconds pollInterval) :
+    _pollMux(pollMux), _dataChangeCallback(std::move(callback)),
+    _dataPathToWatch(dataPathToWatch), _pathTrie(excludeList, includeList),
+    _pollInterval(pollInterval),
+    _nextScanTime(std::chrono::steady_clock::now() + pollInterval),
+    _pollScanner(
+        [this](std::string_view path) { return filterPath(path); })
+{
+    // The configured path is reported once created if it doesn't exist yet.
+    _pollScanner.addRoot(_dataPathToWatch);
+    lg2::debug("Polling [{COUNT}] entries of {PATH} every [{INTERVAL}]s",
+               "COUNT", _pollScanner.size(), "PATH", _dataPathToWatch,
+               "INTERVAL", _pollInterval.count());
+
+    _pollMux.attach(*this);
+    _pollMux.startPoller();
+}
+
+PollWatcher::~PollWatcher()
+{
+    _pollMux.detach(*this);
+}
+
+void PollWatcher::stop()
+{
+    lg2::debug("Stopping PollWatcher for [{PATH}]", "PATH", _dataPathToWatch);
+    _stopped = true;
+    _pollMux.detach(*this);
+}
+
+std::vector<fs::path> PollWatcher::getPolledPaths() const
+{
+    if (_stopped)
+    {
+        return {};
+    }
+    return {_dataPathToWatch};
+}
+
+ScanFilter PollWatcher::filterPath(std::string_view path) const
+{
+    // No current use case for data-sync to support hidden files, which also
+    // skips the temporary files of rsync.
+    if (path.substr(path.rfind('/') + 1).starts_with('.'))
+    {
+        return ScanFilter::Skip;
+    }
+    auto match = _pathTrie.match(path);
+    if (match.excluded)
+    {
+        return ScanFilter::Skip;
+    }
+    if (_pathTrie.hasIncludes() && !match.included)
+    {
+        return match.parentOfInclude ? ScanFilter::Traverse : ScanFilter::Skip;
+    }
+    return ScanFilter::Report;
+}
+
+size_t PollWatcher::scan()
+{
+    _nextScanTime = std::chrono::steady_clock::now() + _pollInterval;
+
+    auto dataOps = _pollScanner.scan();
+    if (dataOps.empty())
+    {
+        return 0;
+    }
+
+    _eventStats.update(dataOps.size());
+    lg2::debug("The scan of {PATH} found [{COUNT}] modifications", "PATH",
+               _dataPathToWatch, "COUNT", dataOps.size());
+    _dataChangeCallback(dataOps);
+    return dataOps.size();
+}
+
+} // namespace data_sync::watch::poll
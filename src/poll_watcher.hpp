@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "path_trie.hpp"
+#include "poll_scanner.hpp"
+#include "watcher.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace data_sync::watch::poll
+{
+
+namespace fs = std::filesystem;
+
+class PollWatcher;
+
+/** @class PollMux
+ *
+ *  @brief Scans the configured paths of the attached PollWatchers on their
+ *         intervals, using a single coroutine.
+ *
+ *  Used for the filesystems on which the notifications are missing or
+ *  unreliable (Eg: overlay or remote-backed mounts), where the changes can
+ *  only be found by comparing the snapshots of the paths.
+ */
+class PollMux
+{
+  public:
+    PollMux(const PollMux&) = delete;
+    PollMux& operator=(const PollMux&) = delete;
+    PollMux(PollMux&&) = delete;
+    PollMux& operator=(PollMux&&) = delete;
+    ~PollMux() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] ctx - The async context object
+     */
+    explicit PollMux(sdbusplus::async::context& ctx);
+
+    /**
+     * @brief Register a watcher to be scanned.
+     *
+     * @param[in] watcher - The watcher to register
+     */
+    void attach(PollWatcher& watcher);
+
+    /**
+     * @brief Unregister a watcher.
+     *
+     * @param[in] watcher - The watcher to unregister
+     */
+    void detach(PollWatcher& watcher);
+
+    /**
+     * @brief Spawn the coroutine which scans the attached watchers, if it is
+     *        not already running.
+     *
+     * The coroutine exits once no watcher is attached anymore.
+     */
+    void startPoller();
+
+    /**
+     * @brief Get the modifications per scan counters of all the watchers.
+     */
+    const EventStats& getEventStats() const
+    {
+        return _eventStats;
+    }
+
+    /**
+     * @brief Get the number of the attached watchers.
+     */
+    size_t getWatchersCount() const
+    {
+        return _watchers.size();
+    }
+
+  private:
+    /**
+     * @brief The coroutine which keeps scanning the watchers which are due,
+     *        as long as any watcher is attached.
+     */
+    sdbusplus::async::task<> pollWatchers();
+
+    /**
+     * @brief The async context object
+     */
+    sdbusplus::async::context& _ctx;
+
+    /**
+     * @brief The attached watchers
+     */
+    std::vector<PollWatcher*> _watchers;
+
+    /**
+     * @brief Whether the poller coroutine is running
+     */
+    bool _pollerRunning = false;
+
+    /**
+     * @brief The modifications per scan counters
+     */
+    EventStats _eventStats;
+};
+
+/** @class PollWatcher
+ *
+ *  @brief Reports the data operations of a configured path by comparing the
+ *         snapshots of its subtree taken on an interval.
+ *
+ *  The snapshot keeps only the inode, the size and the modification time of
+ *  each entry, and the same data operations as the notification based
+ *  watchers are reported, including the renames found by the inode.
+ */
+class PollWatcher : public Watcher
+{
+  public:
+    /**
+     * @brief Constructor
+     *
+     * The initial snapshot is taken right away, so only the modifications
+     * made afterwards are reported.
+     *
+     *  @param[in] pollMux - The shared poller
+     *  @param[in] callback - The callback to invoke upon data operations
+     *  @param[in] dataPathToWatch - The absolute path to be monitored
+     *  @param[in] excludeList - The list of paths to be excluded from
+     *                           monitoring
+     *  @param[in] includeList - The list of paths should be included while
+     *                           monitoring
+     *  @param[in] pollInterval - The interval to scan the path
+     */
+    PollWatcher(
+        PollMux& pollMux, DataChangeCallback callback,
+        const fs::path& dataPathToWatch,
+        std::optional<std::unordered_set<fs::path>> excludeList = std::nullopt,
+        std::optional<std::unordered_set<fs::path>> includeList = std::nullopt,
+        std::chrono::seconds pollInterval = pollScanInterval);
+
+    /**
+     * @brief Destructor
+     * Unregister from the poller.
+     */
+    ~PollWatcher() override;
+
+    /**
+     * @brief Stop scanning the configured path.
+     */
+    void stop() override;
+
+    /**
+     * @brief Get the paths monitored through the notifications, none as the
+     *        configured path is polled.
+     *
+     * @returns std::vector<fs::path> - Always empty
+     */
+    std::vector<fs::path> getWatchingPaths() const override
+    {
+        return {};
+    }
+
+    /**
+     * @brief Get the polled path.
+     *
+     * @returns std::vector<fs::path> - The configured path, empty once
+     *                                  stopped
+     */
+    std::vector<fs::path> getPolledPaths() const override;
+
+    /**
+     * @brief Get the modifications per scan counters of this watcher.
+     *
+     * Only the scans which found modifications are accounted.
+     *
+     * @returns const EventStats& - The accumulated counters
+     */
+    const EventStats& getEventStats() const override
+    {
+        return _eventStats;
+    }
+
+    /**
+     * @brief Get the approximate memory used by the snapshot.
+     *
+     * @returns size_t - The memory in bytes
+     */
+    size_t getMemoryUsage() const override
+    {
+        return sizeof(*this) + _pollScanner.getMemoryUsage();
+    }
+
+    /**
+     * @brief Get the number of the pending renames, none as both the paths
+     *        of a rename are found by the same scan.
+     *
+     * @returns size_t - Always zero
+     */
+    size_t getPendingRenamesCount() const override
+    {
+        return 0;
+    }
+
+    /**
+     * @brief Get the time at which the next scan is due.
+     */
+    std::chrono::steady_clock::time_point getNextScanTime() const
+    {
+        return _nextScanTime;
+    }
+
+    /**
+     * @brief Scan the configured path and hand over the data operations of
+     *        the modifications through the callback.
+     *
+     * @returns size_t - The number of the reported data operations
+     */
+    size_t scan();
+
+  private:
+    /**
+     * @brief API to filter the entries found by the scan using the exclude
+     *        and include lists.
+     *
+     * @param[in] path - The absolute path of the entry
+     *
+     * @returns ScanFilter - How the entry should be scanned
+     */
+    ScanFilter filterPath(std::string_view path) const;
+
+    /**
+     * @brief The shared poller
+     */
+    PollMux& _pollMux;
+
+    /**
+     * @brief The callback to hand over the data operations
+     */
+    DataChangeCallback _dataChangeCallback;
+
+    /**
+     * @brief The file or directory path to be monitored.
+     */
+    const fs::path _dataPathToWatch;
+
+    /**
+     * @brief The exclude and include lists compiled for the matching.
+     */
+    PathTrie _pathTrie;
+
+    /**
+     * @brief The interval to scan the path
+     */
+    std::chrono::seconds _pollInterval;
+
+    /**
+     * @brief The time at which the next scan is due
+     */
+    std::chrono::steady_clock::time_point _nextScanTime;
+
+    /**
+     * @brief The scanner holding the snapshot of the path
+     */
+    PollScanner _pollScanner;
+
+    /**
+     * @brief Whether the watcher is stopped
+     */
+    bool _stopped = false;
+
+    /**
+     * @brief The modifications per scan counters
+     */
+    EventStats _eventStats;
+};
+
+} // namespace data_sync::watch::poll
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "rename_cookie_table.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+
+namespace data_sync::watch::inotify
+{
+
+RenameCookieTable::RenameCookieTable(size_t capacity) :
+    _capacity(std::max<size_t>(capacity, 1))
+{}
+
+void RenameCookieTable::emplace(uint32_t cookie, fs::path movedFromPath,
+                                Clock::time_point now)
+{
+    if (auto entry = _entries.find(cookie); entry != _entries.end())
+    {
+        _order.erase(entry->second.order);
+        _entries.erase(entry);
+    }
+    else if (_entries.size() >= _capacity)
+    {
+        popOldest();
+    }
+    _order.push_back(cookie);
+    _entries.emplace(cookie, Entry{std::move(movedFromPath), _batch, now,
+                                   std::prev(_order.end())});
+}
+
+std::optional<fs::path> RenameCookieTable::take(uint32_t cookie)
+{
+    auto node = _entries.extract(cookie);
+    if (node.empty())
+    {
+        return std::nullopt;
+    }
+    _order.erase(node.mapped().order);
+    return std::move(node.mapped().path);
+}
+
+bool RenameCookieTable::isPending(const fs::path& path) const
+{
+    auto trimmed = [](std::string_view pathStr) {
+        while (pathStr.size() > 1 && pathStr.ends_with('/'))
+        {
+            pathStr.remove_suffix(1);
+        }
+        return pathStr;
+    };
+    // Only a few renames are awaited at a time, hence no index by path.
+    return std::ranges::any_of(_entries | std::views::values,
+                               [&path, &trimmed](const Entry& entry) {
+        return trimmed(entry.path.native()) == trimmed(path.native());
+    });
+}
+
+void RenameCookieTable::expire()
+{
+    // The entries are ordered by the batch too.
+    while (!_order.empty() &&
+           _entries.at(_order.front()).batch + renameCookieMaxAge <= _batch)
+    {
+        popOldest();
+    }
+    _batch++;
+}
+
+void RenameCookieTable::expireBefore(Clock::time_point time)
+{
+    while (!_order.empty() && _entries.at(_order.front()).received < time)
+    {
+        popOldest();
+    }
+}
+
+void RenameCookieTable::popOldest()
+{
+    _entries.erase(_order.front());
+    _order.pop_front();
+}
+
+} // namespace data_sync::watch::inotify
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace data_sync::watch::inotify
+{
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief The maximum number of the unmatched IN_MOVED_FROM to hold.
+ */
+constexpr size_t renameCookieTableCapacity = 1024;
+
+/**
+ * @brief The number of the following batches in which an IN_MOVED_FROM can
+ *        still be matched.
+ *
+ * Both the events of a rename are queued by the same syscall, but they can
+ * be split across the reads of the inotify queue, hence the IN_MOVED_TO is
+ * awaited for one more batch.
+ */
+constexpr uint64_t renameCookieMaxAge = 1;
+
+/**
+ * @brief The time after which an IN_MOVED_FROM is dropped even if no other
+ *        batch of events is received.
+ */
+constexpr std::chrono::milliseconds renameCookieTimeout{500};
+
+/** @class RenameCookieTable
+ *
+ *  @brief Pairs the IN_MOVED_FROM and IN_MOVED_TO events of a rename by
+ *         their cookie.
+ *
+ *  The paths moved out of the watched tree and the renames which never pair
+ *  don't receive an IN_MOVED_TO, hence the entries expire after
+ *  renameCookieMaxAge batches or renameCookieTimeout, whichever comes
+ *  first, and the table is capped, evicting the oldest entries once full.
+ *  The DELETE of a moved path is reported while receiving its
+ *  IN_MOVED_FROM, so the expired entries are only dropped.
+ */
+class RenameCookieTable
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] capacity - The maximum number of the entries
+     */
+    explicit RenameCookieTable(size_t capacity = renameCookieTableCapacity);
+
+    /**
+     * @brief Add the path of a received IN_MOVED_FROM.
+     *
+     * @param[in] cookie - The cookie of the event
+     * @param[in] movedFromPath - The absolute path moved from
+     * @param[in] now - The time the event is received
+     */
+    void emplace(uint32_t cookie, fs::path movedFromPath,
+                 Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Remove the entry matching the cookie of a received IN_MOVED_TO.
+     *
+     * @param[in] cookie - The cookie of the event
+     *
+     * @returns The path moved from, std::nullopt if the cookie is unknown.
+     */
+    std::optional<fs::path> take(uint32_t cookie);
+
+    /**
+     * @brief Check whether the given path is moved from and not yet matched.
+     *
+     * @param[in] path - The absolute path, the trailing slash is ignored
+     *
+     * @returns True if an unmatched IN_MOVED_FROM is held for the path.
+     */
+    bool isPending(const fs::path& path) const;
+
+    /**
+     * @brief Expire the entries which weren't matched in time, to be called
+     *        once a batch of events is processed.
+     */
+    void expire();
+
+    /**
+     * @brief Expire the entries received before the given time.
+     *
+     * @param[in] time - The time the remaining entries are received from
+     */
+    void expireBefore(Clock::time_point time);
+
+    /**
+     * @brief Get the number of the unmatched entries.
+     */
+    size_t size() const
+    {
+        return _entries.size();
+    }
+
+  private:
+    /**
+     * @brief An unmatched IN_MOVED_FROM
+     */
+    struct Entry
+    {
+        fs::path path;
+
+        /**
+         * @brief The batch in which the event was received
+         */
+        uint64_t batch;
+
+        /**
+         * @brief The time the event was received
+         */
+        Clock::time_point received;
+
+        /**
+         * @brief The position of the cookie in the insertion order
+         */
+        std::list<uint32_t>::iterator order;
+    };
+
+    /**
+     * @brief Remove the oldest entry.
+     */
+    void popOldest();
+
+    /**
+     * @brief The maximum number of the entries
+     */
+    size_t _capacity;
+
+    /**
+     * @brief The number of the batches processed so far
+     */
+    uint64_t _batch = 0;
+
+    /**
+     * @brief The entries by cookie.
+     */
+    std::unordered_map<uint32_t, Entry> _entries;
+
+    /**
+     * @brief The cookies from the oldest to the newest entry.
+     *
+     * The kernel increments a global counter for the cookies, which wraps
+     * around, hence the order of the cookies doesn't tell the oldest entry.
+     */
+    std::list<uint32_t> _order;
+};
+
+} // namespace data_sync::watch::inotify
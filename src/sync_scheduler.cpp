@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sync_scheduler.hpp"
+
+#include "utility.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <experimental/scope>
+#include <utility>
+
+namespace data_sync::sync
+{
+
+std::string_view toString(SyncPriority priority)
+{
+    switch (priority)
+    {
+        case SyncPriority::Immediate:
+            return "immediate";
+        case SyncPriority::Deferred:
+            return "deferred";
+        case SyncPriority::FullSync:
+            return "full_sync";
+        case SyncPriority::Periodic:
+            return "periodic";
+    }
+    return "unknown";
+}
+
+SyncSlot::SyncSlot(SyncScheduler& scheduler) : _scheduler(&scheduler) {}
+
+SyncSlot::SyncSlot(SyncSlot&& other) noexcept :
+    _scheduler(std::exchange(other._scheduler, nullptr))
+{}
+
+SyncSlot::~SyncSlot()
+{
+    release();
+}
+
+void SyncSlot::release() noexcept
+{
+    if (_scheduler != nullptr)
+    {
+        std::exchange(_scheduler, nullptr)->releaseSlot();
+    }
+}
+
+SyncScheduler::SyncScheduler(sdbusplus::async::context& ctx,
+                             size_t maxConcurrentSyncs) :
+    _ctx(ctx), _maxConcurrentSyncs(std::max<size_t>(maxConcurrentSyncs, 1))
+{}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<SyncSlot> SyncScheduler::acquire(SyncPriority priority)
+{
+    // A sync waits only while all the slots are in use, the queued syncs
+    // are handed the released slots directly.
+    if (_runningSyncs < _maxConcurrentSyncs)
+    {
+        ++_runningSyncs;
+        updateStats(priority, std::chrono::milliseconds(0));
+        co_return SyncSlot(*this);
+    }
+
+    utility::FD eventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    if (eventFd() < 0)
+    {
+        // Better to run the sync beyond the bound than to drop it.
+        lg2::error("Failed to create the eventfd to queue a {PRIORITY} sync, "
+                   "running it right away. errno : {ERRNO}",
+                   "PRIORITY", toString(priority), "ERRNO", errno);
+        ++_runningSyncs;
+        updateStats(priority, std::chrono::milliseconds(0));
+        co_return SyncSlot(*this);
+    }
+
+    auto& waitQueue = _waitQueues[static_cast<size_t>(priority)];
+    auto& stats = _stats[static_cast<size_t>(priority)];
+    Waiter waiter{eventFd()};
+    waitQueue.push_back(&waiter);
+    stats.maxQueueDepth = std::max(stats.maxQueueDepth, waitQueue.size());
+    const auto enqueueTime = std::chrono::steady_clock::now();
+
+    // The coroutine is destroyed without resuming if the context stops, the
+    // slot it got meanwhile is handed over to the next queued sync.
+    bool handedOver{false};
+    using std::experimental::scope_exit;
+    auto cleanup = scope_exit([this, &waitQueue, &waiter,
+                               &handedOver]() noexcept {
+        if (!waiter.granted)
+        {
+            std::erase(waitQueue, &waiter);
+        }
+        else if (!handedOver)
+        {
+            releaseSlot();
+        }
+    });
+
+    sdbusplus::async::fdio fdioInstance(_ctx, eventFd());
+    while (!waiter.granted)
+    {
+        // NOLINTNEXTLINE
+        co_await fdioInstance.next();
+        uint64_t count{};
+        [[maybe_unused]] auto bytes = read(eventFd(), &count, sizeof(count));
+    }
+
+    ++stats.waitedSyncs;
+    updateStats(priority,
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - enqueueTime));
+    handedOver = true;
+    co_return SyncSlot(*this);
+}
+
+void SyncScheduler::releaseSlot() noexcept
+{
+    auto waitQueue = std::ranges::find_if(
+        _waitQueues, [](const auto& queue) { return !queue.empty(); });
+    if (waitQueue == _waitQueues.end())
+    {
+        --_runningSyncs;
+        return;
+    }
+
+    // The slot stays in use, owned by the woken up sync.
+    Waiter* waiter = waitQueue->front();
+    waitQueue->pop_front();
+    waiter->granted = true;
+    uint64_t count{1};
+    [[maybe_unused]] auto bytes = write(waiter->eventFd, &count, sizeof(count));
+}
+
+void SyncScheduler::updateStats(SyncPriority priority,
+                                std::chrono::milliseconds wait)
+{
+    auto& stats = _stats[static_cast<size_t>(priority)];
+    ++stats.syncs;
+    stats.totalWait += wait;
+    stats.maxWait = std::max(stats.maxWait, wait);
+}
+
+} // namespace data_sync::sync
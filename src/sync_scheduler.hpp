@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <sdbusplus/async.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+
+namespace data_sync::sync
+{
+
+/**
+ * @brief The priority classes of the syncs, from the highest to the lowest.
+ */
+enum class SyncPriority
+{
+    Immediate,
+    Deferred,
+    FullSync,
+    Periodic
+};
+
+/**
+ * @brief The number of the priority classes.
+ */
+constexpr size_t syncPriorityCount = 4;
+
+/**
+ * @brief Get the name of the priority class, as exported in the metrics.
+ *
+ * @param[in] priority - The priority class
+ *
+ * @returns std::string_view - The name of the class
+ */
+std::string_view toString(SyncPriority priority);
+
+/**
+ * @brief Counters describing how long the syncs of a priority class waited
+ *        for a free slot.
+ */
+struct SyncClassStats
+{
+    /**
+     * @brief Number of the syncs which got a slot.
+     */
+    uint64_t syncs = 0;
+
+    /**
+     * @brief Number of the syncs which had to wait for a slot.
+     */
+    uint64_t waitedSyncs = 0;
+
+    /**
+     * @brief The maximum number of the syncs queued at once.
+     */
+    size_t maxQueueDepth = 0;
+
+    /**
+     * @brief The accumulated wait of the syncs.
+     */
+    std::chrono::milliseconds totalWait{0};
+
+    /**
+     * @brief The longest wait of a sync.
+     */
+    std::chrono::milliseconds maxWait{0};
+};
+
+class SyncScheduler;
+
+/** @class SyncSlot
+ *
+ *  @brief A running sync slot handed out by the SyncScheduler, released on
+ *         destruction unless released earlier.
+ */
+class SyncSlot
+{
+  public:
+    SyncSlot(const SyncSlot&) = delete;
+    SyncSlot& operator=(const SyncSlot&) = delete;
+    SyncSlot& operator=(SyncSlot&&) = delete;
+
+    SyncSlot(SyncSlot&& other) noexcept;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] scheduler - The scheduler which granted the slot
+     */
+    explicit SyncSlot(SyncScheduler& scheduler);
+
+    /**
+     * @brief Destructor
+     * Release the slot if not released yet.
+     */
+    ~SyncSlot();
+
+    /**
+     * @brief Release the slot to the next queued sync, if any.
+     */
+    void release() noexcept;
+
+  private:
+    /**
+     * @brief The scheduler which granted the slot, null once released.
+     */
+    SyncScheduler* _scheduler;
+};
+
+/** @class SyncScheduler
+ *
+ *  @brief Bounds the number of the rsync runs in flight across all the
+ *         configs.
+ *
+ *  A sync acquires a slot before spawning rsync and releases it once rsync
+ *  exits. Once all the slots are in use, the syncs are queued per priority
+ *  class and a released slot is handed over to the oldest sync of the
+ *  highest non-empty class.
+ */
+class SyncScheduler
+{
+  public:
+    SyncScheduler(const SyncScheduler&) = delete;
+    SyncScheduler& operator=(const SyncScheduler&) = delete;
+    SyncScheduler(SyncScheduler&&) = delete;
+    SyncScheduler& operator=(SyncScheduler&&) = delete;
+    ~SyncScheduler() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] ctx - The async context object
+     * @param[in] maxConcurrentSyncs - The maximum number of the syncs running
+     *                                 at once, at least one
+     */
+    SyncScheduler(sdbusplus::async::context& ctx, size_t maxConcurrentSyncs);
+
+    /**
+     * @brief Wait for a free slot to run a sync.
+     *
+     * @param[in] priority - The priority class of the sync
+     *
+     * @returns SyncSlot - The slot to be released once the sync completes
+     */
+    sdbusplus::async::task<SyncSlot> acquire(SyncPriority priority);
+
+    /**
+     * @brief Get the maximum number of the syncs running at once.
+     */
+    size_t getMaxConcurrentSyncs() const
+    {
+        return _maxConcurrentSyncs;
+    }
+
+    /**
+     * @brief Get the number of the running syncs.
+     */
+    size_t getRunningSyncs() const
+    {
+        return _runningSyncs;
+    }
+
+    /**
+     * @brief Get the number of the syncs of a class waiting for a slot.
+     *
+     * @param[in] priority - The priority class
+     */
+    size_t getQueueDepth(SyncPriority priority) const
+    {
+        return _waitQueues[static_cast<size_t>(priority)].size();
+    }
+
+    /**
+     * @brief Get the wait counters of a class.
+     *
+     * @param[in] priority - The priority class
+     */
+    const SyncClassStats& getStats(SyncPriority priority) const
+    {
+        return _stats[static_cast<size_t>(priority)];
+    }
+
+  private:
+    friend class SyncSlot;
+
+    /**
+     * @brief A sync waiting for a slot, woken up through its eventfd once
+     *        the slot is handed over.
+     */
+    struct Waiter
+    {
+        int eventFd;
+        bool granted = false;
+    };
+
+    /**
+     * @brief Hand over the released slot to the next queued sync, or free it
+     *        if none is queued.
+     */
+    void releaseSlot() noexcept;
+
+    /**
+     * @brief Account the wait of a sync which got a slot.
+     *
+     * @param[in] priority - The priority class of the sync
+     * @param[in] wait - The time the sync waited
+     */
+    void updateStats(SyncPriority priority, std::chrono::milliseconds wait);
+
+    /**
+     * @brief The async context object
+     */
+    sdbusplus::async::context& _ctx;
+
+    /**
+     * @brief The maximum number of the syncs running at once.
+     */
+    size_t _maxConcurrentSyncs;
+
+    /**
+     * @brief The number of the slots in use.
+     */
+    size_t _runningSyncs = 0;
+
+    /**
+     * @brief The syncs waiting for a slot per class, in the arrival order.
+     */
+    std::array<std::deque<Waiter*>, syncPriorityCount> _waitQueues;
+
+    /**
+     * @brief The wait counters per class.
+     */
+    std::array<SyncClassStats, syncPriorityCount> _stats;
+};
+
+} // namespace data_sync::sync
@@ -0,0 +1,333 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "timer_wheel.hpp"
+
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <experimental/scope>
+#include <utility>
+
+namespace data_sync::timer
+{
+
+namespace
+{
+
+constexpr uint64_t slotMask = TimerWheel::levelSlots - 1;
+
+/**
+ * @brief The number of the ticks covered by the slots of a level.
+ */
+constexpr uint64_t levelSpan(size_t level)
+{
+    return uint64_t{1} << (TimerWheel::levelBits * level);
+}
+
+} // namespace
+
+void TimerWheel::add(Timer& timer, uint64_t expiry)
+{
+    remove(timer);
+    timer.expiry = expiry;
+    insert(timer);
+    timer.pending = true;
+    ++_size;
+}
+
+void TimerWheel::remove(Timer& timer)
+{
+    if (!timer.pending)
+    {
+        return;
+    }
+    auto& timers = _slots[timer.level][timer.slot];
+    std::erase(timers, &timer);
+    if (timers.empty())
+    {
+        _occupied[timer.level] &= ~(uint64_t{1} << timer.slot);
+    }
+    timer.pending = false;
+    --_size;
+}
+
+void TimerWheel::insert(Timer& timer)
+{
+    const uint64_t expiry = std::max(timer.expiry, _now);
+    const uint64_t delta = expiry - _now;
+
+    size_t level = 0;
+    while (level + 1 < levels && delta >= levelSpan(level + 1))
+    {
+        ++level;
+    }
+
+    // A timer due beyond the span of the wheel waits in the farthest slot,
+    // and gets inserted again once reached.
+    const uint64_t slotTick = delta < levelSpan(levels)
+                                  ? expiry
+                                  : _now + levelSpan(levels) - 1;
+    timer.level = level;
+    timer.slot = (slotTick >> (levelBits * level)) & slotMask;
+    _slots[level][timer.slot].push_back(&timer);
+    _occupied[level] |= uint64_t{1} << timer.slot;
+}
+
+void TimerWheel::cascade(size_t level, size_t slot)
+{
+    auto timers = std::exchange(_slots[level][slot], {});
+    _occupied[level] &= ~(uint64_t{1} << slot);
+    for (auto* timer : timers)
+    {
+        insert(*timer);
+    }
+}
+
+std::vector<Timer*> TimerWheel::advance(uint64_t tick)
+{
+    std::vector<Timer*> fired;
+    while (_now <= tick)
+    {
+        const size_t index = _now & slotMask;
+        if (index == 0)
+        {
+            // A coarser slot is spread only once the finer ones wrapped.
+            for (size_t level = 1; level < levels; ++level)
+            {
+                const size_t slot = (_now >> (levelBits * level)) & slotMask;
+                cascade(level, slot);
+                if (slot != 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        auto due = std::exchange(_slots[0][index], {});
+        _occupied[0] &= ~(uint64_t{1} << index);
+        for (auto* timer : due)
+        {
+            if (timer->expiry > _now)
+            {
+                insert(*timer);
+                continue;
+            }
+            timer->pending = false;
+            --_size;
+            fired.push_back(timer);
+        }
+
+        // The ticks with nothing to fire or to spread are skipped.
+        ++_now;
+        _now = std::min(nextExpiry().value_or(tick + 1), tick + 1);
+    }
+    return fired;
+}
+
+std::optional<uint64_t> TimerWheel::nextExpiry() const
+{
+    std::optional<uint64_t> next;
+    for (size_t level = 0; level < levels; ++level)
+    {
+        if (_occupied[level] == 0)
+        {
+            continue;
+        }
+
+        // The first tick this level gets processed or spread at, and the
+        // number of its slots to go from there.
+        const uint64_t span = levelSpan(level);
+        const uint64_t first = (_now + span - 1) & ~(span - 1);
+        const auto current = static_cast<int>((first >> (levelBits * level)) &
+                                              slotMask);
+        const auto distance =
+            std::countr_zero(std::rotr(_occupied[level], current));
+        const uint64_t tick = first + (distance * span);
+        next = std::min(next.value_or(tick), tick);
+    }
+    return next;
+}
+
+uint64_t TimerWheel::alignTick(uint64_t earliest, uint64_t latest)
+{
+    if (latest <= earliest)
+    {
+        return earliest;
+    }
+    for (int bit = 63; bit > 0; --bit)
+    {
+        const uint64_t tick = latest & ~((uint64_t{1} << bit) - 1);
+        if (tick >= earliest)
+        {
+            return tick;
+        }
+    }
+    return latest;
+}
+
+TimerService::TimerService(sdbusplus::async::context& ctx,
+                           std::chrono::milliseconds tick,
+                           unsigned slackPercent) :
+    _ctx(ctx), _tick(std::max(tick, std::chrono::milliseconds(1))),
+    _slackPercent(std::min(slackPercent, 100U)),
+    _epoch(std::chrono::steady_clock::now()),
+    _timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+{
+    if (_timerFd() < 0)
+    {
+        // Better to wait on a timer per sync than to drop the waits.
+        lg2::error("Failed to create the timerfd of the timer wheel, the "
+                   "timers are not batched. errno : {ERRNO}",
+                   "ERRNO", errno);
+    }
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<>
+    TimerService::sleepFor(std::chrono::steady_clock::duration duration)
+{
+    // NOLINTNEXTLINE
+    co_await sleepUntil(std::chrono::steady_clock::now() + duration,
+                        duration * _slackPercent / 100);
+    co_return;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<>
+    TimerService::sleepUntil(std::chrono::steady_clock::time_point deadline,
+                             std::chrono::steady_clock::duration slack)
+{
+    utility::FD eventFd(_timerFd() < 0
+                            ? -1
+                            : eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    if (eventFd() < 0)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (deadline > now)
+        {
+            co_await sdbusplus::async::sleep_for(_ctx, deadline - now);
+        }
+        co_return;
+    }
+
+    // Due at the first tick not before the deadline, or at the most aligned
+    // tick within the slack.
+    uint64_t earliest = toTick(deadline);
+    if (_epoch + (static_cast<int64_t>(earliest) * _tick) < deadline)
+    {
+        ++earliest;
+    }
+    const uint64_t expiry = TimerWheel::alignTick(
+        earliest,
+        toTick(deadline + std::max(slack, std::chrono::steady_clock::duration(
+                                              0))));
+
+    Waiter waiter;
+    waiter.eventFd = eventFd();
+    _wheel.add(waiter, expiry);
+    ++_stats.timers;
+
+    // The coroutine is destroyed without resuming if the context stops.
+    using std::experimental::scope_exit;
+    auto cleanup = scope_exit([this, &waiter]() noexcept {
+        if (!waiter.fired)
+        {
+            _wheel.remove(waiter);
+        }
+    });
+
+    if (!_armedTick.has_value() || expiry < *_armedTick)
+    {
+        arm();
+    }
+    if (!_running)
+    {
+        _running = true;
+        _ctx.spawn(run());
+    }
+
+    sdbusplus::async::fdio fdioInstance(_ctx, eventFd());
+    while (!waiter.fired)
+    {
+        // NOLINTNEXTLINE
+        co_await fdioInstance.next();
+        uint64_t count{};
+        [[maybe_unused]] auto bytes = read(eventFd(), &count, sizeof(count));
+    }
+    co_return;
+}
+
+// NOLINTNEXTLINE
+sdbusplus::async::task<> TimerService::run()
+{
+    sdbusplus::async::fdio fdioInstance(_ctx, _timerFd());
+    while (!_ctx.stop_requested())
+    {
+        // NOLINTNEXTLINE
+        co_await fdioInstance.next();
+        uint64_t expirations{};
+        [[maybe_unused]] auto bytes = read(_timerFd(), &expirations,
+                                           sizeof(expirations));
+
+        auto fired = _wheel.advance(toTick(std::chrono::steady_clock::now()));
+        if (!fired.empty())
+        {
+            ++_stats.wakeups;
+            _stats.firedTimers += fired.size();
+            _stats.maxBatch = std::max(_stats.maxBatch, fired.size());
+        }
+        for (auto* timer : fired)
+        {
+            auto* waiter = static_cast<Waiter*>(timer);
+            waiter->fired = true;
+            uint64_t count{1};
+            [[maybe_unused]] auto written = write(waiter->eventFd, &count,
+                                                  sizeof(count));
+        }
+        arm();
+    }
+    co_return;
+}
+
+void TimerService::arm()
+{
+    _armedTick = _wheel.nextExpiry();
+
+    // A zero expiry disarms the timerfd, so a due tick is armed a
+    // nanosecond in.
+    struct itimerspec spec{};
+    if (_armedTick.has_value())
+    {
+        const auto at = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            (_epoch + (static_cast<int64_t>(*_armedTick) * _tick))
+                .time_since_epoch());
+        spec.it_value.tv_sec = at.count() / 1'000'000'000;
+        spec.it_value.tv_nsec = at.count() % 1'000'000'000;
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+        {
+            spec.it_value.tv_nsec = 1;
+        }
+    }
+    if (timerfd_settime(_timerFd(), TFD_TIMER_ABSTIME, &spec, nullptr) != 0)
+    {
+        lg2::error("Failed to arm the timerfd of the timer wheel, errno : "
+                   "{ERRNO}",
+                   "ERRNO", errno);
+    }
+}
+
+uint64_t TimerService::toTick(std::chrono::steady_clock::time_point time) const
+{
+    if (time <= _epoch)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>((time - _epoch) / _tick);
+}
+
+} // namespace data_sync::timer
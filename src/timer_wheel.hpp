@@ -0,0 +1,361 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "utility.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace data_sync::timer
+{
+
+/**
+ * @brief A timer of the TimerWheel, owned by its user.
+ */
+struct Timer
+{
+    /**
+     * @brief The tick the timer is due at.
+     */
+    uint64_t expiry = 0;
+
+    /**
+     * @brief The level and the slot of the wheel holding the timer.
+     */
+    size_t level = 0;
+    size_t slot = 0;
+
+    /**
+     * @brief Whether the timer is in the wheel.
+     */
+    bool pending = false;
+};
+
+/** @class TimerWheel
+ *
+ *  @brief A hierarchical timer wheel counting in ticks.
+ *
+ *  The timers due within the next 64 ticks are kept in the slot of their
+ *  tick, and the later ones in the coarser levels, each covering 64 times
+ *  the span of the previous one. A coarser slot gets spread over the finer
+ *  levels once the wheel reaches it, so adding, removing and firing a timer
+ *  costs the same regardless of the number of the timers.
+ */
+class TimerWheel
+{
+  public:
+    /**
+     * @brief The number of the bits of the tick indexing a level.
+     */
+    static constexpr size_t levelBits = 6;
+
+    /**
+     * @brief The number of the slots per level.
+     */
+    static constexpr size_t levelSlots = size_t{1} << levelBits;
+
+    /**
+     * @brief The number of the levels. The timers due beyond their span are
+     *        kept in the last level until they come in range.
+     */
+    static constexpr size_t levels = 4;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] now - The first tick to be processed
+     */
+    explicit TimerWheel(uint64_t now = 0) : _now(now) {}
+
+    /**
+     * @brief Add a timer, or move it if already pending.
+     *
+     * @param[in] timer - The timer, to be kept alive until fired or removed
+     * @param[in] expiry - The tick the timer is due at, a past tick fires it
+     *                     on the next advance
+     */
+    void add(Timer& timer, uint64_t expiry);
+
+    /**
+     * @brief Remove a timer, if pending.
+     *
+     * @param[in] timer - The timer
+     */
+    void remove(Timer& timer);
+
+    /**
+     * @brief Process the ticks up to and including a tick.
+     *
+     * @param[in] tick - The current tick
+     *
+     * @returns std::vector<Timer*> - The timers due by then, all fired in the
+     *                               same batch
+     */
+    std::vector<Timer*> advance(uint64_t tick);
+
+    /**
+     * @brief Get the tick the wheel next needs to be advanced at.
+     *
+     * It is the tick of the next due timer, or earlier if a coarser slot
+     * needs to be spread first.
+     *
+     * @returns The tick, std::nullopt if no timer is pending.
+     */
+    std::optional<uint64_t> nextExpiry() const;
+
+    /**
+     * @brief Get the next tick to be processed.
+     */
+    uint64_t now() const
+    {
+        return _now;
+    }
+
+    /**
+     * @brief Get the number of the pending timers.
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Pick the tick a timer fires at within its allowed window.
+     *
+     * The tick which is a multiple of the highest power of two is picked, so
+     * the timers with overlapping windows fire at the same tick.
+     *
+     * @param[in] earliest - The earliest allowed tick
+     * @param[in] latest - The latest allowed tick
+     *
+     * @returns uint64_t - The tick to fire at
+     */
+    static uint64_t alignTick(uint64_t earliest, uint64_t latest);
+
+  private:
+    /**
+     * @brief Insert a timer into the slot matching its expiry.
+     */
+    void insert(Timer& timer);
+
+    /**
+     * @brief Spread the timers of a coarser slot over the finer levels.
+     */
+    void cascade(size_t level, size_t slot);
+
+    /**
+     * @brief The next tick to be processed.
+     */
+    uint64_t _now;
+
+    /**
+     * @brief The number of the pending timers.
+     */
+    size_t _size = 0;
+
+    /**
+     * @brief The timers of each slot of each level.
+     */
+    std::array<std::array<std::vector<Timer*>, levelSlots>, levels> _slots;
+
+    /**
+     * @brief The non-empty slots of each level, a bit per slot.
+     */
+    std::array<uint64_t, levels> _occupied{};
+};
+
+/**
+ * @brief Counters describing how well the timers got batched.
+ */
+struct TimerStats
+{
+    /**
+     * @brief Number of the timers started.
+     */
+    uint64_t timers = 0;
+
+    /**
+     * @brief Number of the wakeups of the wheel which fired some timers.
+     */
+    uint64_t wakeups = 0;
+
+    /**
+     * @brief Number of the timers fired.
+     */
+    uint64_t firedTimers = 0;
+
+    /**
+     * @brief The maximum number of the timers fired in one wakeup.
+     */
+    size_t maxBatch = 0;
+};
+
+/** @class TimerService
+ *
+ *  @brief The timers of all the syncs, driven by a single timerfd.
+ *
+ *  The deadlines are aligned to the configured tick and may be postponed by
+ *  the configured percentage of their duration, to fire along with the
+ *  other timers due around the same time. The timers due at a tick are all
+ *  woken up at once, so their syncs reach the SyncScheduler together and
+ *  get ordered by priority there instead of spawning rsync one by one.
+ *
+ *  The wheel costs a single timerfd wakeup per due tick, but each sleeping
+ *  coroutine is still resumed through its own eventfd, as sdbusplus resumes
+ *  the coroutines only on the file descriptors it polls.
+ */
+class TimerService
+{
+  public:
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+    TimerService(TimerService&&) = delete;
+    TimerService& operator=(TimerService&&) = delete;
+    ~TimerService() = default;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] ctx - The async context object
+     * @param[in] tick - The resolution the deadlines are aligned to
+     * @param[in] slackPercent - The percentage of the duration a timer may
+     *                           be postponed by
+     */
+    TimerService(sdbusplus::async::context& ctx,
+                 std::chrono::milliseconds tick, unsigned slackPercent);
+
+    /**
+     * @brief Wait for a duration, with the configured slack.
+     *
+     * The wait is cancelled along with the context.
+     *
+     * @param[in] duration - The duration to wait for
+     */
+    sdbusplus::async::task<>
+        sleepFor(std::chrono::steady_clock::duration duration);
+
+    /**
+     * @brief Wait until a deadline.
+     *
+     * The wait is cancelled along with the context.
+     *
+     * @param[in] deadline - The earliest time to resume at
+     * @param[in] slack - The time the wait may be postponed by past the
+     *                    deadline
+     */
+    sdbusplus::async::task<>
+        sleepUntil(std::chrono::steady_clock::time_point deadline,
+                   std::chrono::steady_clock::duration slack);
+
+    /**
+     * @brief Get the resolution the deadlines are aligned to.
+     */
+    std::chrono::milliseconds getTick() const
+    {
+        return _tick;
+    }
+
+    /**
+     * @brief Get the percentage of the duration a timer may be postponed by.
+     */
+    unsigned getSlackPercent() const
+    {
+        return _slackPercent;
+    }
+
+    /**
+     * @brief Get the number of the pending timers.
+     */
+    size_t getPendingTimers() const
+    {
+        return _wheel.size();
+    }
+
+    /**
+     * @brief Get the batching counters.
+     */
+    const TimerStats& getStats() const
+    {
+        return _stats;
+    }
+
+  private:
+    /**
+     * @brief A timer waiting to fire, woken up through its eventfd.
+     */
+    struct Waiter : Timer
+    {
+        int eventFd = -1;
+        bool fired = false;
+    };
+
+    /**
+     * @brief Fire the due timers on each expiry of the timerfd.
+     */
+    sdbusplus::async::task<> run();
+
+    /**
+     * @brief Arm the timerfd for the next expiry of the wheel, or disarm it
+     *        if no timer is pending.
+     */
+    void arm();
+
+    /**
+     * @brief Get the tick of a time, rounded down.
+     */
+    uint64_t toTick(std::chrono::steady_clock::time_point time) const;
+
+    /**
+     * @brief The async context object
+     */
+    sdbusplus::async::context& _ctx;
+
+    /**
+     * @brief The resolution the deadlines are aligned to.
+     */
+    std::chrono::milliseconds _tick;
+
+    /**
+     * @brief The percentage of the duration a timer may be postponed by.
+     */
+    unsigned _slackPercent;
+
+    /**
+     * @brief The time of the tick zero.
+     */
+    std::chrono::steady_clock::time_point _epoch;
+
+    /**
+     * @brief The wheel of the pending timers.
+     */
+    TimerWheel _wheel;
+
+    /**
+     * @brief The timerfd expiring at the next expiry of the wheel, invalid
+     *        if it could not be created.
+     */
+    data_sync::utility::FD _timerFd;
+
+    /**
+     * @brief The tick the timerfd is armed for, if armed.
+     */
+    std::optional<uint64_t> _armedTick;
+
+    /**
+     * @brief Whether the coroutine firing the timers got spawned.
+     */
+    bool _running = false;
+
+    /**
+     * @brief The batching counters.
+     */
+    TimerStats _stats;
+};
+
+} // namespace data_sync::timer
@@ -8,8 +8,13 @@
 
 #include <phosphor-logging/lg2.hpp>
 
+#include <cerrno>
+#include <cstdlib>
 #include <filesystem>
 #include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
 #include <utility>
 
 namespace data_sync::utility
@@ -110,5 +115,79 @@ size_t getTransferredDataBytes(const std::string& rsyncOpStr)
     }
     return 0;
 }
+
+std::vector<fs::path> getTransferredPaths(const std::string& rsyncOpStr)
+{
+    constexpr std::string_view prefix{"Transferred:"};
+    std::vector<fs::path> paths;
+    std::istringstream output(rsyncOpStr);
+    std::string line;
+    while (std::getline(output, line))
+    {
+        if (line.starts_with(prefix))
+        {
+            paths.emplace_back(line.substr(prefix.size()));
+        }
+    }
+    return paths;
+}
+
+fs::path writeFilesFromList(const std::vector<fs::path>& paths)
+{
+    std::string listPath{
+        (fs::temp_directory_path() / "rbmc-data-sync-XXXXXX").string()};
+    FD listFd(mkstemp(listPath.data()));
+    if (listFd() < 0)
+    {
+        throw std::runtime_error("Failed to create the rsync list file, "
+                                 "errno: " +
+                                 std::to_string(errno));
+    }
+
+    // The paths are separated by NUL, as a name may contain a newline.
+    std::string list;
+    for (const auto& path : paths)
+    {
+        list.append(path.string());
+        list.push_back('\0');
+    }
+
+    std::string_view pending{list};
+    while (!pending.empty())
+    {
+        auto written = write(listFd(), pending.data(), pending.size());
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written < 0)
+        {
+            auto error = errno;
+            std::error_code ec;
+            fs::remove(listPath, ec);
+            throw std::runtime_error("Failed to write the rsync list file, "
+                                     "errno: " +
+                                     std::to_string(error));
+        }
+        pending.remove_prefix(static_cast<size_t>(written));
+    }
+    return listPath;
+}
+
+std::string quotePath(const fs::path& path)
+{
+    std::string quoted{"'"};
+    for (char c : path.native())
+    {
+        if (c == '\'')
+        {
+            quoted.append("'\\''");
+            continue;
+        }
+        quoted.push_back(c);
+    }
+    quoted.push_back('\'');
+    return quoted;
+}
 } // namespace rsync
 } // namespace data_sync::utility
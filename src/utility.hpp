@@ -3,7 +3,9 @@
 #pragma once
 
 #include <cstddef>
+#include <filesystem>
 #include <string>
+#include <vector>
 namespace data_sync::utility
 {
 
@@ -83,5 +85,51 @@ namespace rsync
  */
 size_t getTransferredDataBytes(const std::string& rsyncOpStr);
 
+/**
+ * @brief The rsync option to print the absolute path of each transferred
+ *        entry, when the transfer is rooted at "/".
+ */
+constexpr auto transferredPathsOpt = " --out-format=Transferred:/%n";
+
+/**
+ * @brief Extract the paths of the entries transferred by an rsync run
+ *        which is framed with the transferredPathsOpt option.
+ *
+ * @param[in] rsyncOpStr - rsync output string
+ *
+ * @return std::vector<std::filesystem::path> - The transferred paths, the
+ *                                              directories with a trailing
+ *                                              slash
+ */
+std::vector<std::filesystem::path>
+    getTransferredPaths(const std::string& rsyncOpStr);
+
+/**
+ * @brief Write the list of paths to transfer in a single rsync run, to pass
+ *        using the "--from0 --files-from" options.
+ *
+ * The caller owns the created file and has to remove it once the rsync run
+ * completes.
+ *
+ * @param[in] paths - The absolute paths to transfer
+ *
+ * @return std::filesystem::path - The path of the created list file
+ *
+ * @throw std::runtime_error - If the list file could not be written
+ */
+std::filesystem::path
+    writeFilesFromList(const std::vector<std::filesystem::path>& paths);
+
+/**
+ * @brief Quote a path to pass it as a single argument of the rsync command,
+ *        which is run through the shell.
+ *
+ * @param[in] path - The path to quote
+ *
+ * @return std::string - The path in single quotes, the single quotes of
+ *                       the path escaped
+ */
+std::string quotePath(const std::filesystem::path& path);
+
 } // namespace rsync
 } // namespace data_sync::utility
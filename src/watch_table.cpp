@@ -0,0 +1,360 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "watch_table.hpp"
+
+#include <algorithm>
+#include <ranges>
+#include <stdexcept>
+
+namespace data_sync::watch::inotify
+{
+
+namespace
+{
+
+/**
+ * @brief Invoke the given callable for each non empty component of the
+ *        path, until it returns false.
+ *
+ * @returns False if the callable stopped the iteration.
+ */
+template <typename Callable>
+bool forEachComponent(std::string_view path, Callable&& callable)
+{
+    while (!path.empty())
+    {
+        auto separator = path.find('/');
+        auto component = path.substr(0, separator);
+        if (!component.empty() && !callable(component))
+        {
+            return false;
+        }
+        if (separator == std::string_view::npos)
+        {
+            break;
+        }
+        path.remove_prefix(separator + 1);
+    }
+    return true;
+}
+
+/**
+ * @brief The approximate memory of the buckets and the nodes of a hash map.
+ */
+template <typename Map>
+size_t hashMapMemoryUsage(const Map& map)
+{
+    // Each node holds the value, the next pointer and the cached hash.
+    constexpr auto nodeSize = sizeof(typename Map::value_type) +
+                              sizeof(void*) + sizeof(size_t);
+    return (map.bucket_count() * sizeof(void*)) + (map.size() * nodeSize);
+}
+
+} // namespace
+
+PathPool::PathPool() : _nodes(1, Node{rootId, 0, 1}) {}
+
+PathPool::NodeId PathPool::acquire(std::string_view path)
+{
+    NodeId id = rootId;
+    forEachComponent(path, [this, &id](std::string_view component) {
+        id = addChild(id, component);
+        return true;
+    });
+    _nodes[id].refs++;
+    return id;
+}
+
+void PathPool::release(NodeId id)
+{
+    while (id != rootId)
+    {
+        auto& node = _nodes[id];
+        if (--node.refs != 0)
+        {
+            return;
+        }
+
+        // The node is unused, free it and drop its reference of the parent.
+        _children.erase(childKey(node.parent, node.nameId));
+        releaseName(node.nameId);
+        _freeNodes.push_back(id);
+        id = node.parent;
+    }
+}
+
+std::optional<PathPool::NodeId> PathPool::find(std::string_view path) const
+{
+    NodeId id = rootId;
+    auto found = forEachComponent(path, [this, &id](
+                                            std::string_view component) {
+        auto childId = findChild(id, component);
+        if (!childId.has_value())
+        {
+            return false;
+        }
+        id = childId.value();
+        return true;
+    });
+    return found ? std::make_optional(id) : std::nullopt;
+}
+
+std::optional<PathPool::NodeId>
+    PathPool::findChild(NodeId parent, std::string_view name) const
+{
+    auto nameIt = _nameIds.find(name);
+    if (nameIt == _nameIds.end())
+    {
+        return std::nullopt;
+    }
+    auto childIt = _children.find(childKey(parent, nameIt->second));
+    if (childIt == _children.end())
+    {
+        return std::nullopt;
+    }
+    return childIt->second;
+}
+
+PathPool::NodeId PathPool::addChild(NodeId parent, std::string_view name)
+{
+    if (auto childId = findChild(parent, name); childId.has_value())
+    {
+        return childId.value();
+    }
+
+    auto nameId = internName(name);
+
+    NodeId id = 0;
+    if (!_freeNodes.empty())
+    {
+        id = _freeNodes.back();
+        _freeNodes.pop_back();
+        _nodes[id] = Node{parent, nameId, 0};
+    }
+    else
+    {
+        id = static_cast<NodeId>(_nodes.size());
+        _nodes.push_back(Node{parent, nameId, 0});
+    }
+    _nameRefs[nameId]++;
+    _nodes[parent].refs++;
+    _children.emplace(childKey(parent, nameId), id);
+    return id;
+}
+
+bool PathPool::move(std::string_view from, std::string_view to)
+{
+    auto fromId = find(from);
+    if (!fromId.has_value() || fromId.value() == rootId ||
+        find(to).has_value())
+    {
+        return false;
+    }
+
+    // Split the destination into its parent and its basename.
+    while (to.ends_with('/'))
+    {
+        to.remove_suffix(1);
+    }
+    auto separator = to.rfind('/');
+    if (separator == std::string_view::npos)
+    {
+        return false;
+    }
+    auto toName = to.substr(separator + 1);
+
+    // Attach the node to the new parent before releasing the old one, as the
+    // old parent could be an ancestor of the new one.
+    NodeId toParent = rootId;
+    forEachComponent(to.substr(0, separator),
+                     [this, &toParent](std::string_view component) {
+        toParent = addChild(toParent, component);
+        return true;
+    });
+    auto toNameId = internName(toName);
+    _nameRefs[toNameId]++;
+    _nodes[toParent].refs++;
+
+    auto& node = _nodes[fromId.value()];
+    auto fromParent = node.parent;
+    auto fromNameId = node.nameId;
+    _children.erase(childKey(fromParent, fromNameId));
+    node.parent = toParent;
+    node.nameId = toNameId;
+    _children.emplace(childKey(toParent, toNameId), fromId.value());
+
+    releaseName(fromNameId);
+    release(fromParent);
+    return true;
+}
+
+uint32_t PathPool::internName(std::string_view name)
+{
+    if (auto nameIt = _nameIds.find(name); nameIt != _nameIds.end())
+    {
+        return nameIt->second;
+    }
+
+    uint32_t nameId = 0;
+    if (!_freeNames.empty())
+    {
+        nameId = _freeNames.back();
+        _freeNames.pop_back();
+        _names[nameId] = name;
+    }
+    else
+    {
+        nameId = static_cast<uint32_t>(_names.size());
+        _names.emplace_back(name);
+        _nameRefs.push_back(0);
+    }
+    _nameIds.emplace(_names[nameId], nameId);
+    return nameId;
+}
+
+void PathPool::releaseName(uint32_t nameId)
+{
+    if (--_nameRefs[nameId] == 0)
+    {
+        _nameIds.erase(_names[nameId]);
+        _names[nameId].clear();
+        _freeNames.push_back(nameId);
+    }
+}
+
+void PathPool::appendPath(NodeId id, std::string& buffer) const
+{
+    if (id == rootId)
+    {
+        return;
+    }
+    appendPath(_nodes[id].parent, buffer);
+    buffer.push_back('/');
+    buffer.append(_names[_nodes[id].nameId]);
+}
+
+size_t PathPool::getMemoryUsage() const
+{
+    auto namesMemory = std::ranges::fold_left(
+        _names, _names.size() * sizeof(std::string),
+        [](size_t total, const std::string& name) {
+        // The short names are stored inside the string object itself.
+        return total + (name.capacity() > std::string().capacity()
+                            ? name.capacity() + 1
+                            : 0);
+    });
+
+    return sizeof(*this) + (_nodes.capacity() * sizeof(Node)) +
+           (_freeNodes.capacity() * sizeof(NodeId)) + namesMemory +
+           (_nameRefs.capacity() * sizeof(uint32_t)) +
+           (_freeNames.capacity() * sizeof(uint32_t)) +
+           hashMapMemoryUsage(_nameIds) + hashMapMemoryUsage(_children);
+}
+
+bool WatchTable::emplace(int wd, const fs::path& path, bool isDir)
+{
+    auto slotIt = std::ranges::lower_bound(_slots, wd, {}, &Slot::wd);
+    if (slotIt != _slots.end() && slotIt->wd == wd)
+    {
+        return false;
+    }
+    _slots.insert(slotIt, Slot{wd, _pathPool.acquire(path.native()), isDir});
+    return true;
+}
+
+void WatchTable::erase(int wd)
+{
+    auto slotIt = findSlot(wd);
+    if (slotIt == _slots.end())
+    {
+        return;
+    }
+    _pathPool.release(slotIt->pathId);
+    _slots.erase(slotIt);
+}
+
+std::vector<WatchTable::Slot>::const_iterator WatchTable::findSlot(int wd) const
+{
+    auto slotIt = std::ranges::lower_bound(_slots, wd, {}, &Slot::wd);
+    if (slotIt != _slots.end() && slotIt->wd == wd)
+    {
+        return slotIt;
+    }
+    return _slots.end();
+}
+
+const WatchTable::Slot& WatchTable::slot(int wd) const
+{
+    auto slotIt = findSlot(wd);
+    if (slotIt == _slots.end())
+    {
+        throw std::out_of_range("Unknown watch descriptor " +
+                                std::to_string(wd));
+    }
+    return *slotIt;
+}
+
+bool WatchTable::isDir(int wd) const
+{
+    return slot(wd).isDir;
+}
+
+fs::path WatchTable::at(int wd) const
+{
+    std::string path;
+    appendPath(wd, path);
+    return path;
+}
+
+void WatchTable::appendPath(int wd, std::string& buffer) const
+{
+    const auto& watchSlot = slot(wd);
+    auto start = buffer.size();
+    _pathPool.appendPath(watchSlot.pathId, buffer);
+
+    // The root has no component, and it is a directory too.
+    if (watchSlot.isDir || buffer.size() == start)
+    {
+        buffer.push_back('/');
+    }
+}
+
+bool WatchTable::move(const fs::path& from, const fs::path& to)
+{
+    return _pathPool.move(from.native(), to.native());
+}
+
+std::optional<int> WatchTable::find(const fs::path& path) const
+{
+    auto pathId = _pathPool.find(path.native());
+    if (!pathId.has_value())
+    {
+        return std::nullopt;
+    }
+    auto slotIt = std::ranges::find(_slots, pathId.value(), &Slot::pathId);
+    if (slotIt == _slots.end())
+    {
+        return std::nullopt;
+    }
+    return slotIt->wd;
+}
+
+std::vector<int> WatchTable::getWDs() const
+{
+    return _slots | std::views::transform(&Slot::wd) |
+           std::ranges::to<std::vector>();
+}
+
+std::vector<std::pair<int, fs::path>> WatchTable::getEntries() const
+{
+    return _slots | std::views::transform([this](const Slot& watchSlot) {
+        return std::make_pair(watchSlot.wd, at(watchSlot.wd));
+    }) | std::ranges::to<std::vector>();
+}
+
+size_t WatchTable::getMemoryUsage() const
+{
+    return (_slots.capacity() * sizeof(Slot)) + _pathPool.getMemoryUsage();
+}
+
+} // namespace data_sync::watch::inotify
@@ -0,0 +1,350 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace data_sync::watch::inotify
+{
+
+namespace fs = std::filesystem;
+
+/** @class PathPool
+ *
+ *  @brief Interns the absolute paths as a tree of nodes, where each node
+ *         refers to its parent node and to its interned basename.
+ *
+ *  The common parents and the repeated basenames of a directory tree are
+ *  stored only once, and two paths are the same if their node ids are the
+ *  same. The nodes and the names are reference counted and reused once
+ *  released.
+ */
+class PathPool
+{
+  public:
+    /**
+     * @brief The id of an interned path
+     */
+    using NodeId = uint32_t;
+
+    /**
+     * @brief The id of the root ("/") node
+     */
+    static constexpr NodeId rootId = 0;
+
+    PathPool();
+
+    /**
+     * @brief Intern the given path and take a reference of it.
+     *
+     * @param[in] path - The absolute path, the trailing slash is ignored
+     *
+     * @returns NodeId - The id of the path
+     */
+    NodeId acquire(std::string_view path);
+
+    /**
+     * @brief Release a reference of the path taken by acquire().
+     *
+     * @param[in] id - The id of the path
+     */
+    void release(NodeId id);
+
+    /**
+     * @brief Get the id of the given path if it is interned, without
+     *        interning it.
+     *
+     * @param[in] path - The absolute path, the trailing slash is ignored
+     *
+     * @returns The id of the path, std::nullopt if not interned.
+     */
+    std::optional<NodeId> find(std::string_view path) const;
+
+    /**
+     * @brief Move an interned path along with its subtree to a new path, by
+     *        re-parenting its node. The ids of the moved paths are retained.
+     *
+     * @param[in] from - The absolute path to move, the trailing slash is
+     *                   ignored
+     * @param[in] to - The absolute path to move to, the trailing slash is
+     *                 ignored
+     *
+     * @returns True if moved, false if the source isn't interned or the
+     *          destination is interned already.
+     */
+    bool move(std::string_view from, std::string_view to);
+
+    /**
+     * @brief Append the absolute path of the given id to the buffer.
+     *
+     * @param[in] id - The id of the path
+     * @param[in,out] buffer - The buffer to append the path, without the
+     *                         trailing slash
+     */
+    void appendPath(NodeId id, std::string& buffer) const;
+
+    /**
+     * @brief Get the approximate heap and object memory used by the pool.
+     */
+    size_t getMemoryUsage() const;
+
+  private:
+    /**
+     * @brief A path component
+     */
+    struct Node
+    {
+        NodeId parent;
+        uint32_t nameId;
+
+        /**
+         * @brief The references by the children and by acquire(), 0 if the
+         *        node is free.
+         */
+        uint32_t refs;
+    };
+
+    /**
+     * @brief Get the id of the child node.
+     *
+     * @param[in] parent - The id of the parent node
+     * @param[in] name - The basename of the child
+     *
+     * @returns The id of the child, std::nullopt if doesn't exist.
+     */
+    std::optional<NodeId> findChild(NodeId parent,
+                                    std::string_view name) const;
+
+    /**
+     * @brief Get the id of the child node, create it if doesn't exist.
+     *
+     * @param[in] parent - The id of the parent node
+     * @param[in] name - The basename of the child
+     *
+     * @returns NodeId - The id of the child
+     */
+    NodeId addChild(NodeId parent, std::string_view name);
+
+    /**
+     * @brief Get the id of the interned name, intern it if doesn't exist.
+     *
+     * @note The reference of the name is taken by the node referring it.
+     */
+    uint32_t internName(std::string_view name);
+
+    /**
+     * @brief Release a reference of the name taken by a node.
+     */
+    void releaseName(uint32_t nameId);
+
+    /**
+     * @brief The key of a child node in _children
+     */
+    static uint64_t childKey(NodeId parent, uint32_t nameId)
+    {
+        return (static_cast<uint64_t>(parent) << 32) | nameId;
+    }
+
+    /**
+     * @brief The nodes indexed by NodeId
+     */
+    std::vector<Node> _nodes;
+
+    /**
+     * @brief The released nodes to reuse
+     */
+    std::vector<NodeId> _freeNodes;
+
+    /**
+     * @brief The interned names indexed by the name id, the deque keeps the
+     *        names in place so they can be referred by std::string_view.
+     */
+    std::deque<std::string> _names;
+
+    /**
+     * @brief The number of nodes referring each name
+     */
+    std::vector<uint32_t> _nameRefs;
+
+    /**
+     * @brief The released name ids to reuse
+     */
+    std::vector<uint32_t> _freeNames;
+
+    /**
+     * @brief The name → name id lookup
+     */
+    std::unordered_map<std::string_view, uint32_t> _nameIds;
+
+    /**
+     * @brief The (parent, name id) → child node lookup
+     */
+    std::unordered_map<uint64_t, NodeId> _children;
+};
+
+/** @class WatchTable
+ *
+ *  @brief A flat table of the inotify watch descriptors of a watcher and the
+ *         paths they monitor.
+ *
+ *  The entries are kept sorted by the watch descriptor in a contiguous
+ *  vector. As the kernel allocates increasing watch descriptors, a new entry
+ *  is usually appended. The paths are interned in a PathPool and
+ *  materialized only when they are needed, Eg: to report a data operation.
+ *  The directories are materialized with a trailing slash, so rsync syncs
+ *  the directory contents rather than the directory itself.
+ */
+class WatchTable
+{
+  public:
+    /**
+     * @brief Add a watch descriptor, if it is not present already.
+     *
+     * @param[in] wd - The watch descriptor
+     * @param[in] path - The absolute path monitored by the watch
+     * @param[in] isDir - Whether the path is a directory
+     *
+     * @returns True if added, false if the watch descriptor is present
+     */
+    bool emplace(int wd, const fs::path& path, bool isDir);
+
+    /**
+     * @brief Remove a watch descriptor.
+     *
+     * @param[in] wd - The watch descriptor
+     */
+    void erase(int wd);
+
+    /**
+     * @brief Check whether the watch descriptor is present.
+     */
+    bool contains(int wd) const
+    {
+        return findSlot(wd) != _slots.end();
+    }
+
+    /**
+     * @brief Get the number of the watch descriptors.
+     */
+    size_t size() const
+    {
+        return _slots.size();
+    }
+
+    /**
+     * @brief Check whether the watch descriptor monitors a directory.
+     *
+     * @throws std::out_of_range if the watch descriptor is not present
+     */
+    bool isDir(int wd) const;
+
+    /**
+     * @brief Get the path monitored by the watch descriptor.
+     *
+     * @param[in] wd - The watch descriptor
+     *
+     * @returns fs::path - The path, directories end with a trailing slash
+     *
+     * @throws std::out_of_range if the watch descriptor is not present
+     */
+    fs::path at(int wd) const;
+
+    /**
+     * @brief Append the path monitored by the watch descriptor to the buffer,
+     *        to build the path of an event without an allocation once the
+     *        buffer has grown.
+     *
+     * @param[in] wd - The watch descriptor
+     * @param[in,out] buffer - The buffer to append the path, directories end
+     *                         with a trailing slash
+     *
+     * @throws std::out_of_range if the watch descriptor is not present
+     */
+    void appendPath(int wd, std::string& buffer) const;
+
+    /**
+     * @brief Re-key the watch descriptors of a moved path and its subtree.
+     *
+     * The kernel keeps the watches of a renamed directory, so only their
+     * paths are moved, at once for the whole subtree.
+     *
+     * @param[in] from - The absolute path moved from
+     * @param[in] to - The absolute path moved to
+     *
+     * @returns True if moved, false if no watch is under the source or the
+     *          destination is used by a watch already.
+     */
+    bool move(const fs::path& from, const fs::path& to);
+
+    /**
+     * @brief Find the watch descriptor which monitors the given path.
+     *
+     * The paths are compared by their interned ids, the trailing slash is
+     * ignored.
+     *
+     * @param[in] path - The absolute path
+     *
+     * @returns The watch descriptor, std::nullopt if the path is not
+     *          monitored.
+     */
+    std::optional<int> find(const fs::path& path) const;
+
+    /**
+     * @brief Get all the watch descriptors.
+     */
+    std::vector<int> getWDs() const;
+
+    /**
+     * @brief Get all the watch descriptors along with the materialized paths.
+     */
+    std::vector<std::pair<int, fs::path>> getEntries() const;
+
+    /**
+     * @brief Get the approximate memory used by the table and the interned
+     *        paths.
+     */
+    size_t getMemoryUsage() const;
+
+  private:
+    /**
+     * @brief An entry of the table
+     */
+    struct Slot
+    {
+        int wd;
+        PathPool::NodeId pathId;
+        bool isDir;
+    };
+
+    /**
+     * @brief Find the slot of the watch descriptor.
+     */
+    std::vector<Slot>::const_iterator findSlot(int wd) const;
+
+    /**
+     * @brief Get the slot of the watch descriptor.
+     *
+     * @throws std::out_of_range if the watch descriptor is not present
+     */
+    const Slot& slot(int wd) const;
+
+    /**
+     * @brief The entries sorted by the watch descriptor
+     */
+    std::vector<Slot> _slots;
+
+    /**
+     * @brief The interned paths of the entries
+     */
+    PathPool _pathPool;
+};
+
+} // namespace data_sync::watch::inotify
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace data_sync::watch
+{
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief enum which indicates the type of operations that can take against an
+ * intersted inotify event on a configured data path
+ */
+enum class DataOps
+{
+    COPY,
+    DELETE,
+    MOVE
+};
+
+/**
+ * @brief A data path and the type of operation, that needs to be performed
+ *        on it.
+ */
+struct DataOperation
+{
+    /**
+     * @brief Absolute path of the file or directory
+     */
+    fs::path path;
+
+    /**
+     * @brief Operation to perform on the given path
+     */
+    DataOps op;
+
+    /**
+     * @brief The absolute path from which the data is moved to the given
+     *        path, only for DataOps::MOVE.
+     */
+    fs::path movedFrom{};
+
+    bool operator==(const DataOperation&) const = default;
+};
+
+/**
+ * @brief Container holding data paths and their corresponding operations.
+ */
+using DataOperations = std::vector<DataOperation>;
+
+/**
+ * @brief The callback to hand over the data operations of the received events
+ *        to the owner of a watcher sharing the notification instance.
+ */
+using DataChangeCallback = std::function<void(const DataOperations&)>;
+
+/**
+ * @brief Counters describing how the filesystem events are amortized over the
+ *        wakeups.
+ */
+struct EventStats
+{
+    /**
+     * @brief Number of wakeups which delivered events.
+     */
+    uint64_t wakeups = 0;
+
+    /**
+     * @brief Total number of events delivered.
+     */
+    uint64_t events = 0;
+
+    /**
+     * @brief Number of events delivered on the most recent wakeup.
+     */
+    size_t lastWakeupEvents = 0;
+
+    /**
+     * @brief Highest number of events delivered on a single wakeup.
+     */
+    size_t maxWakeupEvents = 0;
+
+    /**
+     * @brief Number of event queue overflows, each of them lost an unknown
+     *        number of events.
+     */
+    uint64_t overflows = 0;
+
+    /**
+     * @brief Account the events delivered on a wakeup.
+     *
+     * @param[in] eventsCount - The number of events of the wakeup
+     */
+    void update(size_t eventsCount)
+    {
+        wakeups++;
+        events += eventsCount;
+        lastWakeupEvents = eventsCount;
+        maxWakeupEvents = std::max(maxWakeupEvents, eventsCount);
+    }
+};
+
+/** @class Watcher
+ *
+ *  @brief The interface of the backends which monitor a configured data path
+ *         and report the data operations to perform upon modifications.
+ *
+ *  The data operations are handed over through the DataChangeCallback given
+ *  while creating the watcher, so the users don't need to care which backend
+ *  is in use.
+ */
+class Watcher
+{
+  public:
+    Watcher() = default;
+    Watcher(const Watcher&) = delete;
+    Watcher& operator=(const Watcher&) = delete;
+    Watcher(Watcher&&) = delete;
+    Watcher& operator=(Watcher&&) = delete;
+    virtual ~Watcher() = default;
+
+    /**
+     * @brief Stop monitoring the configured data path.
+     */
+    virtual void stop() = 0;
+
+    /**
+     * @brief Get the paths which are currently monitored.
+     *
+     * Used to collect all the watched paths for debugging purposes.
+     *
+     * @returns std::vector<fs::path> - The monitored paths
+     */
+    virtual std::vector<fs::path> getWatchingPaths() const = 0;
+
+    /**
+     * @brief Get the events per wakeup counters of this watcher.
+     *
+     * @returns const EventStats& - The accumulated event counters
+     */
+    virtual const EventStats& getEventStats() const = 0;
+
+    /**
+     * @brief Get the approximate memory used to track the monitored paths.
+     *
+     * Used along with the number of the watching paths to report the memory
+     * per monitored directory.
+     *
+     * @returns size_t - The memory in bytes
+     */
+    virtual size_t getMemoryUsage() const = 0;
+
+    /**
+     * @brief Get the number of the renames whose source is received but not
+     *        yet the destination.
+     *
+     * Used to confirm the pairing of the renames doesn't accumulate.
+     *
+     * @returns size_t - The number of the pending renames
+     */
+    virtual size_t getPendingRenamesCount() const = 0;
+
+    /**
+     * @brief Get the paths which are scanned periodically instead of being
+     *        monitored through the filesystem notifications.
+     *
+     * @returns std::vector<fs::path> - The polled paths
+     */
+    virtual std::vector<fs::path> getPolledPaths() const = 0;
+};
+
+} // namespace data_sync::watch
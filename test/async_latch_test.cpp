@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "async_latch.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <chrono>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+using data_sync::async::Latch;
+
+TEST(LatchTest, ResumesOnceAllCountedDown)
+{
+    using namespace std::literals;
+    sdbusplus::async::context ctx;
+    auto latch = std::make_shared<Latch>(ctx, 3);
+    size_t completed = 0;
+    bool waited = false;
+
+    auto countDownAfter =
+        [&](std::chrono::milliseconds delay) -> sdbusplus::async::task<> {
+        co_await sdbusplus::async::sleep_for(ctx, delay);
+        ++completed;
+        latch->countDown();
+    };
+
+    auto test = [&]() -> sdbusplus::async::task<> {
+        ctx.spawn(countDownAfter(30ms));
+        ctx.spawn(countDownAfter(10ms));
+        ctx.spawn(countDownAfter(20ms));
+        co_await latch->wait();
+        EXPECT_EQ(completed, 3);
+        EXPECT_EQ(latch->getCount(), 0);
+
+        // An extra countdown is ignored, and a completed latch is not
+        // awaited.
+        latch->countDown();
+        co_await latch->wait();
+        waited = true;
+        ctx.request_stop();
+    };
+
+    ctx.spawn(test());
+    ctx.run();
+    EXPECT_TRUE(waited);
+}
+
+TEST(LatchTest, ZeroCountDoesNotWait)
+{
+    sdbusplus::async::context ctx;
+    Latch latch(ctx, 0);
+    bool waited = false;
+
+    auto test = [&]() -> sdbusplus::async::task<> {
+        co_await latch.wait();
+        waited = true;
+        ctx.request_stop();
+    };
+
+    ctx.spawn(test());
+    ctx.run();
+    EXPECT_TRUE(waited);
+}
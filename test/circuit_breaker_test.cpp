@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "circuit_breaker.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+using data_sync::sync::BreakerState;
+using data_sync::sync::CircuitBreaker;
+
+TEST(CircuitBreakerTest, OpensAfterConsecutiveFailures)
+{
+    CircuitBreaker breaker(3, 1s, 4s, 1);
+    const auto now = CircuitBreaker::Clock::now();
+
+    EXPECT_FALSE(breaker.recordFailure(now));
+    EXPECT_FALSE(breaker.recordFailure(now));
+    EXPECT_FALSE(breaker.recordSuccess());
+    EXPECT_FALSE(breaker.recordFailure(now));
+    EXPECT_FALSE(breaker.recordFailure(now));
+    EXPECT_TRUE(breaker.allowRequest(now));
+
+    EXPECT_TRUE(breaker.recordFailure(now));
+    EXPECT_EQ(breaker.getState(), BreakerState::Open);
+    EXPECT_EQ(breaker.getTrips(), 1);
+    EXPECT_FALSE(breaker.allowRequest(now));
+
+    // The jitter keeps the backoff between its half and its whole, and the
+    // requests sent before opening do not extend it.
+    const auto retryTime = breaker.getRetryTime(now);
+    EXPECT_GE(retryTime, now + 500ms);
+    EXPECT_LE(retryTime, now + 1s);
+    EXPECT_FALSE(breaker.recordFailure(now));
+    EXPECT_EQ(breaker.getRetryTime(now), retryTime);
+    EXPECT_EQ(breaker.getTrips(), 1);
+}
+
+TEST(CircuitBreakerTest, ProbesWithExponentialBackoff)
+{
+    CircuitBreaker breaker(1, 1s, 4s, 2);
+    auto now = CircuitBreaker::Clock::now();
+    ASSERT_TRUE(breaker.recordFailure(now));
+
+    // A single probe once the backoff elapses, doubling it on each failure
+    // up to the maximum.
+    for (auto backoff : {2s, 4s, 4s})
+    {
+        now = breaker.getRetryTime(now);
+        EXPECT_TRUE(breaker.allowRequest(now));
+        EXPECT_EQ(breaker.getState(), BreakerState::HalfOpen);
+        EXPECT_FALSE(breaker.allowRequest(now));
+        EXPECT_EQ(breaker.getRetryTime(now), now + 1s);
+
+        EXPECT_TRUE(breaker.recordFailure(now));
+        EXPECT_GE(breaker.getRetryTime(now), now + (backoff / 2));
+        EXPECT_LE(breaker.getRetryTime(now), now + backoff);
+    }
+
+    now = breaker.getRetryTime(now);
+    EXPECT_TRUE(breaker.allowRequest(now));
+    EXPECT_TRUE(breaker.recordSuccess());
+    EXPECT_EQ(breaker.getState(), BreakerState::Closed);
+    EXPECT_TRUE(breaker.allowRequest(now));
+
+    // Closing resets the backoff.
+    EXPECT_TRUE(breaker.recordFailure(now));
+    EXPECT_LE(breaker.getRetryTime(now), now + 1s);
+}
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "content_cache.hpp"
+
+#include <sys/stat.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using data_sync::sync::ContentCache;
+
+class ContentCacheTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpdir[] = "/tmp/pdsContentCacheDirXXXXXX";
+        cacheDir = fs::path(mkdtemp(tmpdir));
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(cacheDir);
+    }
+
+    static void writeData(const fs::path& fileName, const std::string& data)
+    {
+        std::ofstream out(fileName);
+        ASSERT_TRUE(out.is_open()) << "Failed to open " << fileName;
+        out << data;
+        out.close();
+    }
+
+    fs::path cacheDir;
+};
+
+TEST(ContentHashTest, MatchesXXH64)
+{
+    EXPECT_EQ(data_sync::sync::hashContent(""), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(data_sync::sync::hashContent("abc"), 0x44BC2CF5AD770999ULL);
+
+    std::string longData(100, 'x');
+    EXPECT_EQ(data_sync::sync::hashContent(longData),
+              data_sync::sync::hashContent(std::string(100, 'x')));
+    longData.back() = 'y';
+    EXPECT_NE(data_sync::sync::hashContent(longData),
+              data_sync::sync::hashContent(std::string(100, 'x')));
+}
+
+TEST_F(ContentCacheTest, SkipsRewriteWithSameContent)
+{
+    ContentCache cache;
+    const auto file = cacheDir / "file";
+    writeData(file, "Data\n");
+
+    // Not synced yet
+    auto check = cache.check(file);
+    EXPECT_FALSE(check.unchanged);
+    ASSERT_TRUE(check.fingerprint);
+    cache.record(file, *check.fingerprint);
+
+    writeData(file, "Data\n");
+    EXPECT_TRUE(cache.check(file).unchanged);
+
+    // The permissions are part of the fingerprint.
+    chmod(file.c_str(), 0600);
+    check = cache.check(file);
+    EXPECT_FALSE(check.unchanged);
+    ASSERT_TRUE(check.fingerprint);
+    cache.record(file, *check.fingerprint);
+
+    writeData(file, "Modified Data\n");
+    EXPECT_FALSE(cache.check(file).unchanged);
+    // Dropped on the change, so still a miss if the sync failed.
+    EXPECT_FALSE(cache.check(file).unchanged);
+
+    // The missing files and the directories are not cacheable.
+    fs::remove(file);
+    check = cache.check(file);
+    EXPECT_FALSE(check.unchanged);
+    EXPECT_FALSE(check.fingerprint);
+    EXPECT_FALSE(cache.check(cacheDir).fingerprint);
+
+    EXPECT_EQ(cache.getHits(), 1);
+    EXPECT_EQ(cache.getMisses(), 4);
+}
+
+TEST_F(ContentCacheTest, DropsFilesChangedUntilRecorded)
+{
+    ContentCache cache;
+    const auto file = cacheDir / "file";
+    writeData(file, "Data\n");
+
+    // Rewritten while being synced, the synced contents are unknown.
+    auto check = cache.check(file);
+    ASSERT_TRUE(check.fingerprint);
+    ASSERT_TRUE(check.record);
+    EXPECT_EQ(check.record->data, "Data\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writeData(file, "Data\n");
+    cache.record(file, *check.fingerprint);
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_FALSE(cache.check(file).unchanged);
+
+    check = cache.check(file);
+    ASSERT_TRUE(check.fingerprint);
+    cache.record(file, *check.fingerprint);
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_TRUE(cache.check(file).unchanged);
+}
+
+TEST_F(ContentCacheTest, DropsPathsUnderSyncedDirectory)
+{
+    ContentCache cache;
+    fs::create_directory(cacheDir / "dir");
+    const auto fileInDir = cacheDir / "dir" / "file";
+    const auto fileBesideDir = cacheDir / "dir-file";
+    writeData(fileInDir, "Data\n");
+    writeData(fileBesideDir, "Data\n");
+
+    for (const auto& file : {fileInDir, fileBesideDir})
+    {
+        auto check = cache.check(file);
+        ASSERT_TRUE(check.fingerprint);
+        cache.record(file, *check.fingerprint);
+    }
+    EXPECT_EQ(cache.size(), 2);
+
+    cache.erase(cacheDir / "dir" / "");
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_FALSE(cache.check(fileInDir).unchanged);
+    EXPECT_TRUE(cache.check(fileBesideDir).unchanged);
+}
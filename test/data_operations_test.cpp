@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "data_operations.hpp"
+
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using data_sync::watch::coalesce;
+using data_sync::watch::DataOperations;
+using data_sync::watch::DataOps;
+
+TEST(DataOperationsTest, DeduplicateSamePath)
+{
+    // An editor save: write to the file, rename over it, write again.
+    DataOperations ops{{"/a/file", DataOps::COPY},
+                       {"/a/other", DataOps::COPY},
+                       {"/a/file", DataOps::DELETE},
+                       {"/a/file", DataOps::COPY}};
+
+    DataOperations expected{{"/a/file", DataOps::COPY},
+                            {"/a/other", DataOps::COPY}};
+    EXPECT_EQ(coalesce(ops), expected);
+
+    // The latest operation wins.
+    ops.emplace_back("/a/other", DataOps::DELETE);
+    expected[1].op = DataOps::DELETE;
+    EXPECT_EQ(coalesce(ops), expected);
+}
+
+TEST(DataOperationsTest, DirectoryAbsorbsChildren)
+{
+    // mkdir -p /a/dir/sub followed by file writes.
+    DataOperations ops{{"/a/dir/", DataOps::COPY},
+                       {"/a/dir/sub/", DataOps::COPY},
+                       {"/a/dir/sub/file1", DataOps::COPY},
+                       {"/a/dir-file", DataOps::COPY},
+                       {"/a/dir/file2", DataOps::COPY},
+                       {"/a/dirfile", DataOps::COPY}};
+
+    // The paths which only share the prefix of the directory name are not
+    // children of the directory.
+    DataOperations expected{{"/a/dir/", DataOps::COPY},
+                            {"/a/dir-file", DataOps::COPY},
+                            {"/a/dirfile", DataOps::COPY}};
+    EXPECT_EQ(coalesce(ops), expected);
+
+    // The order doesn't matter, a child reported before its directory is
+    // absorbed too.
+    DataOperations reversed{ops.rbegin(), ops.rend()};
+    DataOperations expectedReversed{{"/a/dirfile", DataOps::COPY},
+                                    {"/a/dir-file", DataOps::COPY},
+                                    {"/a/dir/", DataOps::COPY}};
+    EXPECT_EQ(coalesce(reversed), expectedReversed);
+}
+
+TEST(DataOperationsTest, CollapseDeletedSubtree)
+{
+    // rm -rf /a/dir reports IN_DELETE_SELF bottom up.
+    DataOperations ops{{"/a/dir/sub/file", DataOps::DELETE},
+                       {"/a/dir/sub/", DataOps::DELETE},
+                       {"/a/dir/file", DataOps::DELETE},
+                       {"/a/dir/", DataOps::DELETE},
+                       {"/b/file", DataOps::DELETE}};
+
+    DataOperations expected{{"/a/dir/", DataOps::DELETE},
+                            {"/b/file", DataOps::DELETE}};
+    EXPECT_EQ(coalesce(ops), expected);
+}
+
+TEST(DataOperationsTest, MoveKeepsItsSource)
+{
+    // mv /a/file /b/file, followed by a write and a second move onto it.
+    DataOperations ops{{"/b/file", DataOps::MOVE, "/a/file"},
+                       {"/b/file", DataOps::COPY},
+                       {"/b/file", DataOps::MOVE, "/c/file"}};
+
+    // The source of the earlier move is still synced to be deleted.
+    DataOperations expected{{"/b/file", DataOps::MOVE, "/c/file"},
+                            {"/a/file", DataOps::DELETE}};
+    EXPECT_EQ(coalesce(ops), expected);
+
+    // A directory absorbs a move only if the source is inside it.
+    DataOperations dirOps{{"/a/", DataOps::COPY},
+                          {"/a/new", DataOps::MOVE, "/a/old"},
+                          {"/a/moved", DataOps::MOVE, "/b/moved"}};
+    DataOperations expectedDirOps{{"/a/", DataOps::COPY},
+                                  {"/a/moved", DataOps::MOVE, "/b/moved"}};
+    EXPECT_EQ(coalesce(dirOps), expectedDirOps);
+}
+
+TEST(DataOperationsTest, FilePathDoesNotAbsorb)
+{
+    DataOperations ops{{"/a/file", DataOps::COPY},
+                       {"/a/file.bak", DataOps::COPY}};
+    EXPECT_EQ(coalesce(ops), ops);
+
+    EXPECT_TRUE(coalesce({}).empty());
+}
@@ -122,6 +122,9 @@ TEST(DataSyncConfigParserTest, TestDeferredDirectorySyncWithNoRetry)
     EXPECT_EQ(dataSyncConfig._periodicityInSec, std::nullopt);
     EXPECT_EQ(dataSyncConfig._deferredSyncIntervalInSec,
               std::chrono::seconds(1));
+    EXPECT_EQ(dataSyncConfig._maxDeferredLatencyInSec,
+              std::chrono::seconds(10));
+    EXPECT_FALSE(dataSyncConfig._adaptiveDeferredInterval);
     EXPECT_EQ(dataSyncConfig._notifySibling, std::nullopt);
     if (!dataSyncConfig._retry.has_value())
     {
@@ -135,6 +138,68 @@ TEST(DataSyncConfigParserTest, TestDeferredDirectorySyncWithNoRetry)
     EXPECT_EQ(dataSyncConfig._includeList, std::nullopt);
 }
 
+/*
+ * Test the deferred sync gets due once the events quiet down for the adaptive
+ * interval, or once the first event reaches the maximum latency while the
+ * events keep arriving.
+ */
+TEST(DataSyncConfigParserTest, TestDeferredSyncDeadline)
+{
+    using namespace std::chrono_literals;
+    auto configJSON = R"(
+        {
+            "Path": "/directory/path/to/sync/",
+            "Description": "Add details about the data and purpose of the synchronization",
+            "SyncDirection": "Active2Passive",
+            "SyncType": "Deferred",
+            "DeferredSyncInterval": "PT2S",
+            "MaxDeferredLatency": "PT3S",
+            "AdaptiveDeferredInterval": true
+        }
+    )"_json;
+
+    data_sync::config::DataSyncConfig dataSyncConfig(configJSON, true);
+    EXPECT_EQ(dataSyncConfig._maxDeferredLatencyInSec, std::chrono::seconds(3));
+    EXPECT_TRUE(dataSyncConfig._adaptiveDeferredInterval);
+
+    // The whole interval until the gaps are known.
+    const auto firstEventTime = std::chrono::steady_clock::now();
+    dataSyncConfig.recordDeferredSyncEvent(firstEventTime);
+    EXPECT_EQ(dataSyncConfig.getDeferredQuietInterval(), 2s);
+    EXPECT_EQ(dataSyncConfig.getDeferredSyncDeadline(), firstEventTime + 2s);
+
+    // Written every 500ms, a few gaps are waited for.
+    for (auto eventTime = firstEventTime + 500ms;
+         eventTime <= firstEventTime + 2500ms; eventTime += 500ms)
+    {
+        dataSyncConfig.recordDeferredSyncEvent(eventTime);
+    }
+    EXPECT_EQ(dataSyncConfig.getDeferredQuietInterval(), 1500ms);
+    EXPECT_EQ(dataSyncConfig.getDeferredSyncDeadline(), firstEventTime + 3s);
+    EXPECT_EQ(dataSyncConfig.getDeferredLatencyDeadline(),
+              firstEventTime + 3s);
+
+    // The latency of the next events counts from the first of them.
+    dataSyncConfig._firstDeferredSyncEventTime.reset();
+    dataSyncConfig.recordDeferredSyncEvent(firstEventTime + 3s);
+    EXPECT_EQ(dataSyncConfig.getDeferredSyncDeadline(),
+              firstEventTime + 4500ms);
+
+    configJSON.erase("AdaptiveDeferredInterval");
+    configJSON["MaxDeferredLatency"] = "PT1S";
+    data_sync::config::DataSyncConfig fixedConfig(configJSON, true);
+    EXPECT_EQ(fixedConfig._maxDeferredLatencyInSec, std::chrono::seconds(2));
+    fixedConfig.recordDeferredSyncEvent(firstEventTime);
+    fixedConfig.recordDeferredSyncEvent(firstEventTime + 500ms);
+    EXPECT_EQ(fixedConfig.getDeferredQuietInterval(), 2s);
+
+    // No latency bound without it configured.
+    configJSON.erase("MaxDeferredLatency");
+    data_sync::config::DataSyncConfig unboundConfig(configJSON, true);
+    unboundConfig.recordDeferredSyncEvent(firstEventTime);
+    EXPECT_FALSE(unboundConfig.getDeferredLatencyDeadline().has_value());
+}
+
 /*
  * Test when the input JSON contains the details of the directory to be synced
  * immediately with no overriding retry attempt and retry interval.
@@ -529,3 +594,78 @@ TEST(DataSyncConfigParserTest, TestSyncConfigWithSelectivePathSiblingNotify)
     EXPECT_EQ(dataSyncConfig._excludeList, std::nullopt);
     EXPECT_EQ(dataSyncConfig._includeList, std::nullopt);
 }
+
+/*
+ * Test when the input JSON contains the watch priority of the directory to be
+ * synced, and when the priority is invalid or not given.
+ * Hence WatchPriority will set to the default value of 'Normal'.
+ */
+TEST(DataSyncConfigParserTest, TestDirectorySyncWithWatchPriority)
+{
+    // JSON object with details of directory to be synced.
+    auto configJSON = R"(
+        {
+            "Path": "/directory/path/to/sync/",
+            "Description": "Add details about the data and purpose of the synchronization",
+            "SyncDirection": "Active2Passive",
+            "SyncType": "Immediate",
+            "WatchPriority": "Low"
+        }
+
+    )"_json;
+
+    EXPECT_EQ(
+        data_sync::config::DataSyncConfig(configJSON, true)._watchPriority,
+        data_sync::config::WatchPriority::Low);
+
+    configJSON["WatchPriority"] = "High";
+    EXPECT_EQ(
+        data_sync::config::DataSyncConfig(configJSON, true)._watchPriority,
+        data_sync::config::WatchPriority::High);
+
+    configJSON["WatchPriority"] = "Urgent";
+    EXPECT_EQ(
+        data_sync::config::DataSyncConfig(configJSON, true)._watchPriority,
+        data_sync::config::WatchPriority::Normal);
+
+    configJSON.erase("WatchPriority");
+    EXPECT_EQ(
+        data_sync::config::DataSyncConfig(configJSON, true)._watchPriority,
+        data_sync::config::WatchPriority::Normal);
+}
+
+/*
+ * Test when the input JSON contains the details of the directory to be polled
+ * for the changes, with and without the poll interval.
+ */
+TEST(DataSyncConfigParserTest, TestDirectorySyncWithPollBackend)
+{
+    // JSON object with details of directory to be synced.
+    auto configJSON = R"(
+        {
+            "Path": "/directory/path/to/sync/",
+            "Description": "Add details about the data and purpose of the synchronization",
+            "SyncDirection": "Active2Passive",
+            "SyncType": "Immediate",
+            "WatchBackend": "Poll",
+            "PollInterval": "PT1M"
+        }
+
+    )"_json;
+
+    data_sync::config::DataSyncConfig dataSyncConfig(configJSON, true);
+    EXPECT_EQ(dataSyncConfig._watchBackend,
+              data_sync::config::WatchBackend::Poll);
+    EXPECT_EQ(dataSyncConfig._pollIntervalInSec, std::chrono::seconds(60));
+
+    configJSON.erase("PollInterval");
+    EXPECT_EQ(
+        data_sync::config::DataSyncConfig(configJSON, true)._pollIntervalInSec,
+        std::chrono::seconds(15));
+
+    configJSON.erase("WatchBackend");
+    data_sync::config::DataSyncConfig notifyConfig(configJSON, true);
+    EXPECT_EQ(notifyConfig._watchBackend,
+              data_sync::config::WatchBackend::Notify);
+    EXPECT_EQ(notifyConfig._pollIntervalInSec, std::nullopt);
+}
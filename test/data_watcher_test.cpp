@@ -0,0 +1,436 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "data_watcher.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+namespace watch = data_sync::watch::inotify;
+
+class DataWatcherTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpdir[] = "/tmp/pdsWatcherDirXXXXXX";
+        watchDir = fs::path(mkdtemp(tmpdir)) / "";
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(watchDir);
+    }
+
+    static void writeData(const fs::path& fileName, const std::string& data)
+    {
+        std::ofstream out(fileName);
+        ASSERT_TRUE(out.is_open()) << "Failed to open " << fileName;
+        out << data;
+        out.close();
+    }
+
+    fs::path watchDir;
+};
+
+TEST_F(DataWatcherTest, BulkDrainOnSingleWakeup)
+{
+    sdbusplus::async::context ctx;
+
+    watch::DataWatcher dataWatcher(ctx, IN_NONBLOCK | IN_CLOEXEC,
+                                   IN_CLOSE_WRITE, watchDir);
+
+    // Queue a burst of events before the watcher gets a chance to wake up.
+    constexpr size_t filesCount = 12;
+    for (size_t i = 0; i < filesCount; ++i)
+    {
+        DataWatcherTest::writeData(watchDir / ("file" + std::to_string(i)),
+                                   "Data\n");
+    }
+
+    ctx.spawn(dataWatcher.onDataChange() |
+              sdbusplus::async::execution::then(
+                  [&ctx, &dataWatcher](const auto& dataOps) {
+        // All the queued events must be returned as one batch.
+        EXPECT_EQ(dataOps.size(), filesCount);
+
+        const auto& stats = dataWatcher.getEventStats();
+        EXPECT_EQ(stats.wakeups, 1U);
+        EXPECT_EQ(stats.events, filesCount);
+        EXPECT_EQ(stats.lastWakeupEvents, filesCount);
+        EXPECT_EQ(stats.maxWakeupEvents, filesCount);
+        ctx.request_stop();
+    }));
+
+    ctx.run();
+}
+
+TEST_F(DataWatcherTest, EventNamesValidAcrossReads)
+{
+    sdbusplus::async::context ctx;
+
+    watch::DataWatcher dataWatcher(ctx, IN_NONBLOCK | IN_CLOEXEC,
+                                   IN_CLOSE_WRITE, watchDir);
+
+    // The events with long names need several reads of the buffer, still
+    // the names of the earlier reads must stay valid as they are referred in
+    // place.
+    constexpr size_t filesCount = 200;
+    std::vector<fs::path> expectedPaths;
+    for (size_t i = 0; i < filesCount; ++i)
+    {
+        auto fileName = std::string(200, 'f') + std::to_string(i);
+        expectedPaths.emplace_back(watchDir / fileName);
+        DataWatcherTest::writeData(expectedPaths.back(), "Data\n");
+    }
+    ASSERT_GT(filesCount * (sizeof(inotify_event) + 200),
+              watch::inotifyReadBufferSize);
+
+    ctx.spawn(dataWatcher.onDataChange() |
+              sdbusplus::async::execution::then(
+                  [&ctx, &expectedPaths](const auto& dataOps) {
+        ASSERT_EQ(dataOps.size(), filesCount);
+        for (size_t i = 0; i < filesCount; ++i)
+        {
+            EXPECT_EQ(dataOps[i],
+                      watch::DataOperation(expectedPaths[i],
+                                           watch::DataOps::COPY));
+        }
+        ctx.request_stop();
+    }));
+
+    ctx.run();
+}
+
+TEST_F(DataWatcherTest, SharedInotifyInstance)
+{
+    using namespace std::literals;
+    sdbusplus::async::context ctx;
+    watch::InotifyMux inotifyMux(ctx);
+
+    fs::path srcFile = watchDir / "srcFile";
+    size_t dirWatcherOps = 0;
+    size_t fileWatcherOps = 0;
+
+    auto stopIfAllReceived = [&ctx, &dirWatcherOps, &fileWatcherOps]() {
+        if (dirWatcherOps > 0 && fileWatcherOps > 0)
+        {
+            ctx.request_stop();
+        }
+    };
+
+    auto dirWatcher = std::make_unique<watch::DataWatcher>(
+        inotifyMux, [&](const watch::DataOperations& dataOps) {
+        dirWatcherOps += dataOps.size();
+        stopIfAllReceived();
+    }, IN_CLOSE_WRITE, watchDir);
+
+    // The parent of the file is already watched by the other watcher, hence
+    // the kernel watch is shared.
+    auto fileWatcher = std::make_unique<watch::DataWatcher>(
+        inotifyMux, [&](const watch::DataOperations& dataOps) {
+        fileWatcherOps += dataOps.size();
+        stopIfAllReceived();
+    }, IN_CLOSE_WRITE, srcFile);
+    EXPECT_EQ(inotifyMux.getWatchesCount(), 1U);
+
+    ctx.spawn(sdbusplus::async::sleep_for(ctx, 0.1s) |
+              sdbusplus::async::execution::then([&srcFile]() {
+        DataWatcherTest::writeData(srcFile, "Data\n");
+    }));
+
+    ctx.run();
+
+    EXPECT_EQ(dirWatcherOps, 1U);
+    EXPECT_EQ(fileWatcherOps, 1U);
+
+    // Both the watchers got the event through a single read of the shared
+    // inotify instance.
+    EXPECT_EQ(inotifyMux.getEventStats().wakeups, 1U);
+
+    fileWatcher.reset();
+    EXPECT_EQ(inotifyMux.getWatchesCount(), 1U)
+        << "The watch is still used by the directory watcher";
+
+    dirWatcher.reset();
+    EXPECT_EQ(inotifyMux.getWatchesCount(), 0U);
+}
+
+TEST_F(DataWatcherTest, DeletedDirectoryKeepsDirFlag)
+{
+    using namespace std::literals;
+    sdbusplus::async::context ctx;
+    watch::InotifyMux inotifyMux(ctx);
+
+    fs::path cfgDir = watchDir / "cfgDir" / "";
+    fs::create_directories(cfgDir / "subDir");
+    watch::DataOperations receivedOps;
+
+    watch::DataOperation cfgDirDelete{cfgDir, watch::DataOps::DELETE};
+    watch::DataWatcher dataWatcher(
+        inotifyMux, [&](const watch::DataOperations& dataOps) {
+        std::ranges::copy(dataOps, std::back_inserter(receivedOps));
+        if (std::ranges::contains(receivedOps, cfgDirDelete))
+        {
+            ctx.request_stop();
+        }
+    }, IN_CLOSE_WRITE | IN_CREATE | IN_DELETE_SELF, cfgDir);
+
+    // The directory type is taken from the listing, hence stored with the
+    // trailing slash.
+    EXPECT_TRUE(std::ranges::contains(dataWatcher.getWatchingPaths(),
+                                      cfgDir / "subDir" / ""));
+
+    ctx.spawn(sdbusplus::async::sleep_for(ctx, 0.1s) |
+              sdbusplus::async::execution::then(
+                  [&cfgDir]() { fs::remove_all(cfgDir); }));
+
+    ctx.run();
+
+    // The deleted directory can't be stat'ed anymore, still it is reported as
+    // a directory and the parent is monitored for its re-creation.
+    EXPECT_TRUE(std::ranges::contains(receivedOps, cfgDirDelete));
+    EXPECT_TRUE(
+        std::ranges::contains(dataWatcher.getWatchingPaths(), watchDir));
+}
+
+TEST_F(DataWatcherTest, QueueOverflowRescansWatches)
+{
+    sdbusplus::async::context ctx;
+    watch::InotifyMux inotifyMux(ctx);
+    watch::DataOperations receivedOps;
+
+    watch::DataWatcher dataWatcher(
+        inotifyMux, [&receivedOps](const watch::DataOperations& dataOps) {
+        std::ranges::copy(dataOps, std::back_inserter(receivedOps));
+    }, IN_CLOSE_WRITE | IN_CREATE | IN_DELETE_SELF, watchDir);
+
+    // Create a directory while the events are not processed, as its
+    // IN_CREATE would be lost on an overflow.
+    fs::path newDir = watchDir / "newDir" / "";
+    fs::create_directories(newDir);
+    EXPECT_FALSE(
+        std::ranges::contains(dataWatcher.getWatchingPaths(), newDir));
+
+    // The overflow is reported with wd -1.
+    dataWatcher.handleEvents({{-1, "", IN_Q_OVERFLOW, 0}});
+
+    // The whole configured path is reported to sync and the missed
+    // directory is monitored.
+    ASSERT_EQ(receivedOps.size(), 1U);
+    EXPECT_EQ(receivedOps.front(),
+              watch::DataOperation(watchDir, watch::DataOps::COPY));
+    EXPECT_TRUE(std::ranges::contains(dataWatcher.getWatchingPaths(), newDir));
+    EXPECT_EQ(dataWatcher.getEventStats().overflows, 1U);
+}
+
+TEST_F(DataWatcherTest, UnmatchedRenamesExpire)
+{
+    sdbusplus::async::context ctx;
+    watch::InotifyMux inotifyMux(ctx);
+    watch::DataOperations receivedOps;
+
+    watch::DataWatcher dataWatcher(
+        inotifyMux, [&receivedOps](const watch::DataOperations& dataOps) {
+        std::ranges::copy(dataOps, std::back_inserter(receivedOps));
+    }, IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO, watchDir);
+
+    auto wd = dataWatcher.getWatchDescriptors().find(watchDir);
+    ASSERT_TRUE(wd.has_value());
+
+    // The rename of the rsync temporary file is paired and skipped.
+    dataWatcher.handleEvents({{wd.value(), ".file1.XXXX", IN_MOVED_FROM, 1},
+                              {wd.value(), "file1", IN_MOVED_TO, 1}});
+    EXPECT_TRUE(receivedOps.empty());
+    EXPECT_EQ(dataWatcher.getPendingRenamesCount(), 0U);
+
+    // A hidden file moved out of the tree never pairs, it is not reported
+    // as the hidden files are not synced.
+    dataWatcher.handleEvents({{wd.value(), ".file2", IN_MOVED_FROM, 2}});
+    EXPECT_TRUE(receivedOps.empty());
+    EXPECT_EQ(dataWatcher.getPendingRenamesCount(), 1U);
+
+    dataWatcher.handleEvents({{wd.value(), "file3", IN_CLOSE_WRITE, 0}});
+    EXPECT_EQ(receivedOps, watch::DataOperations({{watchDir / "file3",
+                                                   watch::DataOps::COPY}}));
+    EXPECT_EQ(dataWatcher.getPendingRenamesCount(), 0U);
+
+    // Without any other event, the rename expires after the timeout.
+    dataWatcher.handleEvents({{wd.value(), "file4", IN_MOVED_FROM, 4}});
+    EXPECT_EQ(dataWatcher.getPendingRenamesCount(), 1U);
+    ctx.spawn(sdbusplus::async::sleep_for(
+                  ctx, 3 * watch::renameCookieTimeout) |
+              sdbusplus::async::execution::then([&ctx]() {
+        ctx.request_stop();
+    }));
+    ctx.run();
+    EXPECT_EQ(dataWatcher.getPendingRenamesCount(), 0U);
+}
+
+TEST_F(DataWatcherTest, ModifiedFilesReportedIfWatched)
+{
+    sdbusplus::async::context ctx;
+    watch::InotifyMux inotifyMux(ctx);
+    watch::DataOperations receivedOps;
+
+    watch::DataWatcher dataWatcher(
+        inotifyMux, [&receivedOps](const watch::DataOperations& dataOps) {
+        std::ranges::copy(dataOps, std::back_inserter(receivedOps));
+    }, IN_CLOSE_WRITE | IN_MODIFY, watchDir);
+
+    auto wd = dataWatcher.getWatchDescriptors().find(watchDir);
+    ASSERT_TRUE(wd.has_value());
+
+    // A file appended to without being closed is reported on each write.
+    dataWatcher.handleEvents({{wd.value(), "log", IN_MODIFY, 0},
+                              {wd.value(), "log", IN_MODIFY, 0}});
+    EXPECT_EQ(receivedOps,
+              watch::DataOperations(
+                  2, watch::DataOperation(watchDir / "log",
+                                          watch::DataOps::COPY)));
+}
+
+TEST_F(DataWatcherTest, RenamedDirectoryMovesWatches)
+{
+    sdbusplus::async::context ctx;
+    watch::InotifyMux inotifyMux(ctx);
+    watch::DataOperations receivedOps;
+
+    fs::create_directories(watchDir / "dir" / "sub");
+    watch::DataWatcher dataWatcher(
+        inotifyMux, [&receivedOps](const watch::DataOperations& dataOps) {
+        std::ranges::copy(dataOps, std::back_inserter(receivedOps));
+    }, IN_CLOSE_WRITE | IN_CREATE | IN_MOVE | IN_MOVE_SELF | IN_DELETE_SELF,
+        watchDir);
+
+    const auto& watchTable = dataWatcher.getWatchDescriptors();
+    auto rootWd = watchTable.find(watchDir);
+    auto dirWd = watchTable.find(watchDir / "dir");
+    auto subWd = watchTable.find(watchDir / "dir" / "sub");
+    ASSERT_TRUE(rootWd && dirWd && subWd);
+    auto watchesCount = inotifyMux.getWatchesCount();
+
+    // mv dir renamed, the watches are kept by the kernel and only their paths
+    // are moved. The rename is reported as a single operation.
+    dataWatcher.handleEvents(
+        {{rootWd.value(), "dir", IN_MOVED_FROM | IN_ISDIR, 1},
+         {rootWd.value(), "renamed", IN_MOVED_TO | IN_ISDIR, 1},
+         {dirWd.value(), "", IN_MOVE_SELF, 0}});
+
+    EXPECT_EQ(receivedOps,
+              watch::DataOperations({{watchDir / "renamed",
+                                      watch::DataOps::MOVE, watchDir / "dir"}}));
+    EXPECT_EQ(watchTable.at(subWd.value()), watchDir / "renamed" / "sub" / "");
+    EXPECT_EQ(watchTable.find(watchDir / "renamed"), dirWd);
+    EXPECT_EQ(watchTable.find(watchDir / "dir"), std::nullopt);
+    EXPECT_EQ(inotifyMux.getWatchesCount(), watchesCount);
+    EXPECT_EQ(dataWatcher.getPendingRenamesCount(), 0U);
+
+    // mv renamed /elsewhere, the subtree is no longer monitored.
+    receivedOps.clear();
+    dataWatcher.handleEvents(
+        {{rootWd.value(), "renamed", IN_MOVED_FROM | IN_ISDIR, 2},
+         {dirWd.value(), "", IN_MOVE_SELF, 0}});
+
+    EXPECT_EQ(receivedOps,
+              watch::DataOperations(
+                  {{watchDir / "renamed", watch::DataOps::DELETE}}));
+    EXPECT_EQ(dataWatcher.getWatchingPaths(), std::vector<fs::path>{watchDir});
+}
+
+TEST_F(DataWatcherTest, ExhaustedWatchBudgetFallsBackToPolling)
+{
+    using namespace std::literals;
+    sdbusplus::async::context ctx;
+    constexpr size_t watchBudget = 4;
+    watch::InotifyMux inotifyMux(ctx, IN_NONBLOCK | IN_CLOEXEC, watchBudget);
+
+    fs::path lowDir = watchDir / "lowDir";
+    fs::create_directories(lowDir / "a" / "x");
+    fs::create_directories(lowDir / "a" / "y");
+    fs::create_directories(lowDir / "b");
+    fs::path highDir = watchDir / "highDir";
+    fs::create_directories(highDir / "c");
+
+    watch::DataOperations lowWatcherOps;
+    watch::DataWatcher lowWatcher(
+        inotifyMux, [&lowWatcherOps](const watch::DataOperations& dataOps) {
+        std::ranges::copy(dataOps, std::back_inserter(lowWatcherOps));
+    }, IN_CLOSE_WRITE | IN_CREATE | IN_DELETE_SELF, lowDir, std::nullopt,
+        std::nullopt, data_sync::config::WatchPriority::Low);
+
+    // Nothing to reclaim from, hence the watcher polls the rest by itself.
+    EXPECT_EQ(inotifyMux.getWatchesCount(), watchBudget);
+    EXPECT_EQ(lowWatcher.getPolledPaths().size(), 1U);
+
+    // The lower priority subtree holding the most watches makes room.
+    watch::DataWatcher highWatcher(
+        inotifyMux, [](const watch::DataOperations&) {},
+        IN_CLOSE_WRITE | IN_CREATE | IN_DELETE_SELF, highDir, std::nullopt,
+        std::nullopt, data_sync::config::WatchPriority::High);
+
+    EXPECT_EQ(highWatcher.getWatchDescriptors().size(), 2U);
+    EXPECT_TRUE(highWatcher.getPolledPaths().empty());
+    EXPECT_TRUE(std::ranges::contains(lowWatcher.getPolledPaths(),
+                                      lowDir / "a"));
+    EXPECT_LE(inotifyMux.getWatchesCount(), watchBudget);
+
+    // The modifications of the polled subtrees are reported by the scan.
+    DataWatcherTest::writeData(lowDir / "a" / "x" / "file", "Data\n");
+    lowWatcher.pollSubtrees();
+    EXPECT_TRUE(std::ranges::contains(
+        lowWatcherOps,
+        watch::DataOperation{lowDir / "a" / "x" / "file", watch::DataOps::COPY}));
+
+    ctx.spawn(
+        sdbusplus::async::sleep_for(ctx, 0.1s) |
+        sdbusplus::async::execution::then([&ctx]() { ctx.request_stop(); }));
+    ctx.run();
+}
+
+TEST_F(DataWatcherTest, FailedReclaimRestoresDemotedWatches)
+{
+    using namespace std::literals;
+    sdbusplus::async::context ctx;
+    constexpr size_t watchBudget = 2;
+    watch::InotifyMux inotifyMux(ctx, IN_NONBLOCK | IN_CLOEXEC, watchBudget);
+
+    fs::path sharedDir = watchDir / "sharedDir";
+    fs::create_directories(sharedDir);
+    fs::path highDir = watchDir / "highDir";
+    fs::create_directories(highDir / "a");
+    fs::create_directories(highDir / "b");
+
+    constexpr auto masks = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE_SELF;
+    watch::DataWatcher sharingWatcher(
+        inotifyMux, [](const watch::DataOperations&) {}, masks, sharedDir,
+        std::nullopt, std::nullopt, data_sync::config::WatchPriority::High);
+    watch::DataWatcher lowWatcher(
+        inotifyMux, [](const watch::DataOperations&) {}, masks, sharedDir,
+        std::nullopt, std::nullopt, data_sync::config::WatchPriority::Low);
+    EXPECT_EQ(inotifyMux.getWatchesCount(), 1U);
+
+    // The watch of the lower priority watcher is shared, so demoting it
+    // doesn't release any watch and it gets watched again.
+    watch::DataWatcher highWatcher(
+        inotifyMux, [](const watch::DataOperations&) {}, masks, highDir,
+        std::nullopt, std::nullopt, data_sync::config::WatchPriority::High);
+
+    EXPECT_TRUE(lowWatcher.getPolledPaths().empty());
+    EXPECT_EQ(lowWatcher.getWatchDescriptors().size(), 1U);
+    EXPECT_FALSE(highWatcher.getPolledPaths().empty());
+    EXPECT_LE(inotifyMux.getWatchesCount(), watchBudget);
+
+    ctx.spawn(
+        sdbusplus::async::sleep_for(ctx, 0.1s) |
+        sdbusplus::async::execution::then([&ctx]() { ctx.request_stop(); }));
+    ctx.run();
+}
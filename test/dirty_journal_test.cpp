@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dirty_journal.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using data_sync::persist::DirtyJournal;
+
+class DirtyJournalTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpdir[] = "/tmp/pdsJournalDirXXXXXX";
+        journalDir = fs::path(mkdtemp(tmpdir));
+        journalFile = journalDir / "persistence" / "dirtyPaths.journal";
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(journalDir);
+    }
+
+    fs::path journalDir;
+    fs::path journalFile;
+};
+
+TEST_F(DirtyJournalTest, ReplaysOutstandingPaths)
+{
+    {
+        DirtyJournal journal(journalFile);
+        // Nothing is known to be synced without a journal.
+        EXPECT_FALSE(journal.open("Active", 1));
+        EXPECT_FALSE(journal.isActive());
+
+        journal.create("Active", 1);
+        ASSERT_TRUE(journal.isActive());
+
+        journal.markDirty({"/dir/file1", "/dir/sub/file2", "/file3"});
+        journal.flush();
+        const auto syncedSequence = journal.sequence();
+        journal.markDirty({"/dir/sub/file2"});
+
+        // The change made while syncing stays dirty.
+        journal.markClean("/dir/", syncedSequence);
+        journal.markClean("/file3", journal.sequence());
+        EXPECT_EQ(journal.size(), 1);
+    }
+
+    DirtyJournal journal(journalFile);
+    auto dirtyState = journal.open("Active", 1);
+    ASSERT_TRUE(dirtyState);
+    EXPECT_EQ(dirtyState->paths, std::vector<fs::path>{"/dir/sub/file2"});
+    EXPECT_GT(dirtyState->lastUpdateNs, 0);
+    EXPECT_TRUE(journal.isActive());
+
+    journal.markClean("/dir/sub/file2", journal.sequence());
+    EXPECT_EQ(journal.size(), 0);
+}
+
+TEST_F(DirtyJournalTest, DiscardsCorruptOrOtherRoleJournal)
+{
+    {
+        DirtyJournal journal(journalFile);
+        journal.create("Active", 1);
+        journal.markDirty({"/file1"});
+    }
+    {
+        DirtyJournal journal(journalFile);
+        EXPECT_FALSE(journal.open("Passive", 1));
+        EXPECT_FALSE(fs::exists(journalFile));
+    }
+
+    {
+        DirtyJournal journal(journalFile);
+        journal.create("Active", 1);
+        journal.markDirty({"/file1"});
+    }
+    {
+        // A record cut while appending.
+        std::ofstream out(journalFile, std::ios::app | std::ios::binary);
+        out << "D/fil";
+    }
+    DirtyJournal journal(journalFile);
+    EXPECT_FALSE(journal.open("Active", 1));
+    EXPECT_FALSE(fs::exists(journalFile));
+    EXPECT_FALSE(journal.isActive());
+}
+
+TEST_F(DirtyJournalTest, DiscardsJournalOfOtherConfiguration)
+{
+    {
+        DirtyJournal journal(journalFile);
+        journal.create("Active", 1);
+        journal.markDirty({"/file1"});
+        journal.flush();
+    }
+    DirtyJournal journal(journalFile);
+    EXPECT_FALSE(journal.open("Active", 2));
+    EXPECT_FALSE(fs::exists(journalFile));
+}
+
+TEST_F(DirtyJournalTest, KeepsTimeOfLastFlush)
+{
+    using namespace std::chrono_literals;
+    auto now = []() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    };
+
+    int64_t flushedAfterNs{0};
+    int64_t flushedBeforeNs{0};
+    {
+        DirtyJournal journal(journalFile);
+        journal.create("Active", 1);
+        journal.markDirty({"/file1", "/file2"});
+        std::this_thread::sleep_for(10ms);
+        flushedAfterNs = now();
+        journal.flush();
+        flushedBeforeNs = now();
+
+        // Neither the clean records nor the unflushed dirty ones move it.
+        std::this_thread::sleep_for(10ms);
+        journal.markClean("/file1", journal.sequence());
+        journal.markDirty({"/file3"});
+    }
+
+    DirtyJournal journal(journalFile);
+    auto dirtyState = journal.open("Active", 1);
+    ASSERT_TRUE(dirtyState);
+    EXPECT_GE(dirtyState->lastUpdateNs, flushedAfterNs);
+    EXPECT_LE(dirtyState->lastUpdateNs, flushedBeforeNs);
+    EXPECT_EQ(dirtyState->paths,
+              (std::vector<fs::path>{"/file2", "/file3"}));
+
+    // Kept by the rewrite when reopened.
+    journal.flush();
+    DirtyJournal reopened(journalFile);
+    dirtyState = reopened.open("Active", 1);
+    ASSERT_TRUE(dirtyState);
+    EXPECT_LE(dirtyState->lastUpdateNs, flushedBeforeNs);
+}
+
+TEST_F(DirtyJournalTest, FindsPathsChangedSinceLastUpdate)
+{
+    using namespace std::chrono_literals;
+    const auto srcDir = journalDir / "src";
+    fs::create_directories(srcDir / "unchanged");
+    fs::create_directories(srcDir / "changed");
+    std::ofstream(srcDir / "unchanged" / "file") << "Data\n";
+    std::ofstream(srcDir / "changed" / "deleted") << "Data\n";
+    std::ofstream(srcDir / "file") << "Data\n";
+
+    std::this_thread::sleep_for(10ms);
+    const auto sinceNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+    std::this_thread::sleep_for(10ms);
+
+    fs::remove(srcDir / "changed" / "deleted");
+    std::ofstream(srcDir / "unchanged" / "file") << "Modified Data\n";
+
+    auto changedPaths = data_sync::persist::findChangedPaths(srcDir, sinceNs);
+    std::ranges::sort(changedPaths);
+    EXPECT_EQ(changedPaths,
+              (std::vector<fs::path>{srcDir / "changed" / "",
+                                     srcDir / "unchanged" / "file"}));
+}
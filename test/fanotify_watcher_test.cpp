@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "fanotify_watcher.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+namespace watch = data_sync::watch;
+
+class FanotifyWatcherTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpdir[] = "/tmp/pdsFanotifyDirXXXXXX";
+        watchDir = fs::path(mkdtemp(tmpdir)) / "";
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(watchDir);
+    }
+
+    static void writeData(const fs::path& fileName, const std::string& data)
+    {
+        std::ofstream out(fileName);
+        ASSERT_TRUE(out.is_open()) << "Failed to open " << fileName;
+        out << data;
+        out.close();
+    }
+
+    fs::path watchDir;
+};
+
+TEST_F(FanotifyWatcherTest, ReportsChangesInWholeTree)
+{
+    using namespace std::literals;
+    sdbusplus::async::context ctx;
+
+    std::unique_ptr<watch::fanotify::FanotifyMux> fanotifyMux;
+    try
+    {
+        fanotifyMux = std::make_unique<watch::fanotify::FanotifyMux>(ctx);
+    }
+    catch (const std::exception& e)
+    {
+        GTEST_SKIP() << "fanotify is not available: " << e.what();
+    }
+
+    // The nested directory doesn't exist while the watcher gets created, but
+    // no watch is needed per directory as the whole filesystem is marked.
+    fs::path subDir = watchDir / "a" / "b" / "c";
+    fs::path srcFile = subDir / "srcFile";
+    fs::path excludedFile = watchDir / "excluded";
+
+    watch::DataOperations receivedOps;
+    std::unique_ptr<watch::fanotify::FanotifyWatcher> watcher;
+    try
+    {
+        watcher = std::make_unique<watch::fanotify::FanotifyWatcher>(
+            *fanotifyMux, [&](const watch::DataOperations& dataOps) {
+            receivedOps.insert(receivedOps.end(), dataOps.begin(),
+                               dataOps.end());
+            if (std::ranges::contains(
+                    receivedOps,
+                    watch::DataOperation{srcFile, watch::DataOps::COPY}))
+            {
+                ctx.request_stop();
+            }
+        }, watchDir, true, std::unordered_set<fs::path>{excludedFile});
+    }
+    catch (const std::exception& e)
+    {
+        GTEST_SKIP() << "The filesystem cannot be marked: " << e.what();
+    }
+    EXPECT_EQ(fanotifyMux->getMarksCount(), 1U);
+
+    ctx.spawn(sdbusplus::async::sleep_for(ctx, 0.1s) |
+              sdbusplus::async::execution::then([&]() {
+        fs::create_directories(subDir);
+        FanotifyWatcherTest::writeData(excludedFile, "Data\n");
+        FanotifyWatcherTest::writeData(srcFile, "Data\n");
+    }));
+
+    ctx.run();
+
+    EXPECT_TRUE(std::ranges::contains(
+        receivedOps,
+        watch::DataOperation{watchDir / "a" / "", watch::DataOps::COPY}));
+    EXPECT_FALSE(std::ranges::contains(
+        receivedOps,
+        watch::DataOperation{excludedFile, watch::DataOps::COPY}));
+    EXPECT_EQ(watcher->getWatchingPaths().size(), 1U);
+}
+
+TEST_F(FanotifyWatcherTest, ReportsMergedRemovalsAsDeletes)
+{
+    sdbusplus::async::context ctx;
+
+    std::unique_ptr<watch::fanotify::FanotifyMux> fanotifyMux;
+    try
+    {
+        fanotifyMux = std::make_unique<watch::fanotify::FanotifyMux>(ctx);
+    }
+    catch (const std::exception& e)
+    {
+        GTEST_SKIP() << "fanotify is not available: " << e.what();
+    }
+
+    fs::path removedFile = watchDir / "removedFile";
+    fs::path recreatedFile = watchDir / "recreatedFile";
+    FanotifyWatcherTest::writeData(recreatedFile, "Data\n");
+
+    watch::DataOperations receivedOps;
+    std::unique_ptr<watch::fanotify::FanotifyWatcher> watcher;
+    try
+    {
+        watcher = std::make_unique<watch::fanotify::FanotifyWatcher>(
+            *fanotifyMux, [&](const watch::DataOperations& dataOps) {
+            receivedOps.insert(receivedOps.end(), dataOps.begin(),
+                               dataOps.end());
+        }, watchDir, true);
+    }
+    catch (const std::exception& e)
+    {
+        GTEST_SKIP() << "The filesystem cannot be marked: " << e.what();
+    }
+
+    // The events of an entry written and then removed, or removed and then
+    // written again, get merged in the queue.
+    ctx.spawn(sdbusplus::async::execution::just() |
+              sdbusplus::async::execution::then([&]() {
+        watcher->handleEvents(
+            {{FAN_CLOSE_WRITE | FAN_DELETE, removedFile},
+             {FAN_CREATE | FAN_DELETE | FAN_CLOSE_WRITE, recreatedFile}});
+        ctx.request_stop();
+    }));
+
+    ctx.run();
+
+    EXPECT_EQ(receivedOps,
+              (watch::DataOperations{
+                  {removedFile, watch::DataOps::DELETE},
+                  {recreatedFile, watch::DataOps::COPY}}));
+}
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hash_tree.hpp"
+
+#include <sys/stat.h>
+
+#include <sdbusplus/async.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using data_sync::sync::HashTree;
+
+class HashTreeTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpdir[] = "/tmp/pdsHashTreeDirXXXXXX";
+        treeDir = fs::path(mkdtemp(tmpdir));
+        dirA = treeDir / "dirA";
+        dirB = treeDir / "dirB";
+        for (const auto& dir : {dirA, dirB})
+        {
+            fs::create_directories(dir / "sub");
+            fs::create_directories(dir / "other");
+            writeData(dir / "file", "Data\n");
+            writeData(dir / "sub" / "file", "Data\n");
+            writeData(dir / "other" / "file", "Data\n");
+        }
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(treeDir);
+    }
+
+    // The same modification time on both the trees, as rsync preserves it.
+    static void writeData(const fs::path& fileName, const std::string& data)
+    {
+        std::ofstream out(fileName);
+        ASSERT_TRUE(out.is_open()) << "Failed to open " << fileName;
+        out << data;
+        out.close();
+        fs::last_write_time(fileName, fs::file_time_type{std::chrono::hours(1)});
+    }
+
+    fs::path treeDir;
+    fs::path dirA;
+    fs::path dirB;
+};
+
+TEST_F(HashTreeTest, ComparesAndInvalidatesLevels)
+{
+    HashTree treeA(dirA);
+    HashTree treeB(dirB / "");
+
+    auto levelA = treeA.level(dirA);
+    auto levelB = treeB.level(dirB);
+    ASSERT_TRUE(levelA && levelB);
+    EXPECT_TRUE(levelA->isDir);
+    EXPECT_EQ(*levelA, *levelB);
+    EXPECT_EQ(levelA->children.size(), 3);
+    EXPECT_EQ(levelA->children.front().name, "file");
+    EXPECT_EQ(data_sync::sync::decodeLevel(
+                  data_sync::sync::encodeLevel(*levelA)),
+              *levelA);
+    EXPECT_THROW(data_sync::sync::decodeLevel("\x01\x02"), std::runtime_error);
+
+    // Cached until invalidated.
+    writeData(dirB / "sub" / "file", "Modified Data\n");
+    EXPECT_EQ(treeB.level(dirB)->hash, levelA->hash);
+    treeB.invalidate(dirB / "sub" / "file");
+    EXPECT_NE(treeB.level(dirB)->hash, levelA->hash);
+    EXPECT_NE(treeB.level(dirB / "sub")->hash, treeA.level(dirA / "sub")->hash);
+    EXPECT_EQ(treeB.level(dirB / "other")->hash,
+              treeA.level(dirA / "other")->hash);
+
+    // The permissions are compared, the excluded and outside paths are not.
+    chmod((dirA / "file").c_str(), 0600);
+    chmod((dirB / "file").c_str(), 0644);
+    HashTree excludingTree(dirA, {dirA / "sub" / ""});
+    EXPECT_NE(excludingTree.level(dirA / "file")->hash,
+              treeB.level(dirB / "file")->hash);
+    EXPECT_FALSE(excludingTree.level(dirA / "sub"));
+    EXPECT_FALSE(excludingTree.level(dirB));
+    EXPECT_EQ(excludingTree.level(dirA)->children.size(), 2);
+}
+
+TEST_F(HashTreeTest, HashesInSteps)
+{
+    HashTree treeA(dirA);
+    auto walk = treeA.startWalk(dirA);
+    size_t steps{0};
+    while (!treeA.hashStep(walk, 1))
+    {
+        ++steps;
+    }
+    EXPECT_GT(steps, 1);
+    const auto hashed = treeA.size();
+    EXPECT_GT(hashed, 0);
+
+    // Cached by the steps, the same as hashed at once.
+    HashTree treeB(dirB);
+    EXPECT_EQ(treeA.level(dirA), treeB.level(dirB));
+    EXPECT_EQ(treeA.size(), hashed);
+
+    HashTree outsideTree(dirA / "sub");
+    auto outsideWalk = outsideTree.startWalk(dirB);
+    EXPECT_TRUE(outsideTree.hashStep(outsideWalk));
+    EXPECT_EQ(outsideTree.size(), 0);
+}
+
+TEST_F(HashTreeTest, FindsDifferingPathsFromLocalSibling)
+{
+    writeData(dirA / "sub" / "file", "Modified Data\n");
+    writeData(dirA / "new", "Data\n");
+    writeData(dirB / "other" / "deleted", "Data\n");
+
+    // The sibling is another instance serving the tree of dirB as the
+    // destination of dirA.
+    sdbusplus::async::context ctx;
+    HashTree remoteTree(dirB);
+    data_sync::transfer::TransferServer server(
+        ctx, 0, []([[maybe_unused]] const fs::path& destPath) {
+        return false;
+    }, 100, [&remoteTree](const fs::path& destPath)
+                    -> sdbusplus::async::task<std::optional<std::string>> {
+        auto level = remoteTree.level(destPath);
+        co_return level ? std::optional(data_sync::sync::encodeLevel(*level))
+                        : std::nullopt;
+    });
+    data_sync::transfer::TransferClient client(ctx, server.getPort());
+
+    HashTree localTree(dirA);
+    std::vector<fs::path> differingPaths;
+    std::vector<fs::path> samePaths{fs::path{"/"}};
+    auto test = [&]() -> sdbusplus::async::task<> {
+        differingPaths = co_await data_sync::sync::findDifferingPaths(
+            localTree, client, dirB);
+
+        HashTree sameTree(dirB);
+        samePaths = co_await data_sync::sync::findDifferingPaths(sameTree,
+                                                                 client, dirB);
+        ctx.request_stop();
+    };
+
+    ctx.spawn(test());
+    ctx.run();
+
+    std::ranges::sort(differingPaths);
+    EXPECT_EQ(differingPaths,
+              (std::vector<fs::path>{dirA / "new", dirA / "other" / "",
+                                     dirA / "sub" / "file"}));
+    EXPECT_TRUE(samePaths.empty());
+}
@@ -914,3 +914,99 @@ TEST_F(ManagerTest, ImmediateSyncVanishedPathRetrySucceeds)
     ctx->spawn(triggerAndWatchSyncOp());
     ctx->run();
 }
+
+TEST_F(ManagerTest, testBatchedDataChangesInDir)
+{
+    using namespace std::literals;
+    namespace extData = data_sync::ext_data;
+
+    auto extDataIface = std::make_unique<extData::MockExternalDataIFaces>();
+    extData::MockExternalDataIFaces* mockExtDataIfaces =
+        dynamic_cast<extData::MockExternalDataIFaces*>(extDataIface.get());
+
+    ON_CALL(*mockExtDataIfaces, fetchBMCRedundancyMgrProps())
+        .WillByDefault([mockExtDataIfaces]() -> sdbusplus::async::task<> {
+        mockExtDataIfaces->setBMCRole(extData::BMCRole::Active);
+        mockExtDataIfaces->setBMCRedundancy(true);
+        co_return;
+    });
+
+    EXPECT_CALL(*mockExtDataIfaces, fetchBMCPosition())
+        .WillRepeatedly([]() -> sdbusplus::async::task<> { co_return; });
+
+    EXPECT_CALL(*mockExtDataIfaces,
+                createErrorLog(testing::_, testing::_, testing::_, testing::_))
+        .WillRepeatedly([]() -> sdbusplus::async::task<> { co_return; });
+
+    nlohmann::json jsonData = {
+        {"Directories",
+         {{{"Path", ManagerTest::tmpDataSyncDataDir.string() + "/srcDir/"},
+           {"DestinationPath", ManagerTest::destDir.string()},
+           {"Description", "Directory to test the batched immediate sync"},
+           {"SyncDirection", "Active2Passive"},
+           {"SyncType", "Immediate"}}}}};
+
+    fs::path srcDir{jsonData["Directories"][0]["Path"]};
+    fs::path destDir{jsonData["Directories"][0]["DestinationPath"]};
+    fs::path destSrcDir = destDir / fs::relative(srcDir, "/");
+
+    writeConfig(jsonData);
+    auto ctx = std::make_shared<sdbusplus::async::context>();
+
+    fs::create_directories(srcDir / "subDir");
+    ManagerTest::writeData(srcDir / "toRename", "Data to rename\n");
+
+    auto manager = std::make_shared<data_sync::Manager>(
+        *ctx, std::move(extDataIface), ManagerTest::dataSyncCfgDir);
+
+    auto triggerAndWatchSyncOp = [manager, srcDir, destSrcDir,
+                                  ctx]() -> sdbusplus::async::task<void> {
+        // Wait for full sync to complete
+        auto status = manager->getFullSyncStatus();
+        while (status != FullSyncStatus::FullSyncCompleted &&
+               status != FullSyncStatus::FullSyncFailed)
+        {
+            status = manager->getFullSyncStatus();
+            co_await sdbusplus::async::sleep_for(*ctx,
+                                                 std::chrono::milliseconds(50));
+        }
+        EXPECT_TRUE(fs::exists(destSrcDir / "toRename"));
+
+        // Modify several paths at once, their events are synced in batches
+        // of a single rsync run each.
+        ManagerTest::writeData(srcDir / "file1", "Data 1\n");
+        ManagerTest::writeData(srcDir / "file2", "Data 2\n");
+        ManagerTest::writeData(srcDir / "subDir" / "file3", "Data 3\n");
+        fs::rename(srcDir / "toRename", srcDir / "renamed");
+
+        auto synced = [&destSrcDir]() {
+            return fs::exists(destSrcDir / "file1") &&
+                   fs::exists(destSrcDir / "file2") &&
+                   fs::exists(destSrcDir / "subDir" / "file3") &&
+                   fs::exists(destSrcDir / "renamed") &&
+                   !fs::exists(destSrcDir / "toRename");
+        };
+        for (size_t attempt = 0; attempt < 100 && !synced(); ++attempt)
+        {
+            co_await sdbusplus::async::sleep_for(*ctx,
+                                                 std::chrono::milliseconds(50));
+        }
+
+        EXPECT_EQ(ManagerTest::readData(destSrcDir / "file1"), "Data 1\n");
+        EXPECT_EQ(ManagerTest::readData(destSrcDir / "file2"), "Data 2\n");
+        EXPECT_EQ(ManagerTest::readData(destSrcDir / "subDir" / "file3"),
+                  "Data 3\n");
+        EXPECT_EQ(ManagerTest::readData(destSrcDir / "renamed"),
+                  "Data to rename\n");
+        EXPECT_FALSE(fs::exists(destSrcDir / "toRename"));
+
+        // Force an inotify event so running immediate sync tasks wake up
+        // and exit once the context stop is requested
+        ManagerTest::writeData(srcDir / "file1", "Dummy data to stop ctx");
+        ctx->request_stop();
+        co_return;
+    };
+
+    ctx->spawn(triggerAndWatchSyncOp());
+    ctx->run();
+}
@@ -19,6 +19,8 @@ class ManagerTest : public ::testing::Test
         tmpDataSyncDataDir = mkdtemp(tmpDataDir);
         data_sync::persist::DBusPropDataFile = tmpDataSyncDataDir /
                                                "persistentData.json";
+        data_sync::persist::DirtyJournalFile = tmpDataSyncDataDir /
+                                               "dirtyPaths.journal";
     }
 
     // Set up each individual test
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "native_transfer.hpp"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <sdbusplus/async.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using data_sync::transfer::FileRecord;
+using data_sync::transfer::FrameReader;
+using data_sync::transfer::TransferClient;
+using data_sync::transfer::TransferOp;
+using data_sync::transfer::TransferServer;
+
+class NativeTransferTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpdir[] = "/tmp/pdsTransferDirXXXXXX";
+        transferDir = fs::path(mkdtemp(tmpdir));
+        srcDir = transferDir / "src";
+        destDir = transferDir / "dest";
+        fs::create_directory(srcDir);
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(transferDir);
+    }
+
+    static void writeData(const fs::path& fileName, const std::string& data)
+    {
+        std::ofstream out(fileName);
+        ASSERT_TRUE(out.is_open()) << "Failed to open " << fileName;
+        out << data;
+        out.close();
+    }
+
+    static std::string readData(const fs::path& fileName)
+    {
+        std::ifstream in(fileName);
+        return {std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>()};
+    }
+
+    fs::path transferDir;
+    fs::path srcDir;
+    fs::path destDir;
+};
+
+TEST_F(NativeTransferTest, ReadsAndAppliesRecordsAcrossSplitFrames)
+{
+    writeData(srcDir / "file", "Data\n");
+    chmod((srcDir / "file").c_str(), 0640);
+
+    auto putRecord = data_sync::transfer::readFileRecord(
+        srcDir / "file", destDir / "dir" / "file", 100);
+    ASSERT_TRUE(putRecord);
+    EXPECT_EQ(putRecord->op, TransferOp::Put);
+    EXPECT_EQ(putRecord->data, "Data\n");
+    EXPECT_EQ(putRecord->mode & 07777, 0640);
+
+    // A missing file is read as a delete.
+    auto deleteRecord = data_sync::transfer::readFileRecord(
+        srcDir / "missing", destDir / "deleted", 100);
+    ASSERT_TRUE(deleteRecord);
+    EXPECT_EQ(deleteRecord->op, TransferOp::Delete);
+
+    // The directories and the bigger files are left to rsync.
+    EXPECT_FALSE(
+        data_sync::transfer::readFileRecord(srcDir, destDir / "dir", 100));
+    EXPECT_FALSE(data_sync::transfer::readFileRecord(srcDir / "file",
+                                                     destDir / "file", 2));
+
+    std::string frames = data_sync::transfer::encode(*putRecord) +
+                         data_sync::transfer::encode(*deleteRecord);
+    FrameReader reader(100);
+    reader.append(std::string_view(frames).substr(0, 10));
+    EXPECT_FALSE(reader.nextRecord());
+    reader.append(std::string_view(frames).substr(10));
+    auto receivedPut = reader.nextRecord();
+    auto receivedDelete = reader.nextRecord();
+    ASSERT_TRUE(receivedPut && receivedDelete);
+    EXPECT_EQ(*receivedPut, *putRecord);
+    EXPECT_EQ(*receivedDelete, *deleteRecord);
+    EXPECT_FALSE(reader.nextRecord());
+
+    EXPECT_EQ(data_sync::transfer::applyFileRecord(*receivedPut), 0);
+    EXPECT_EQ(readData(destDir / "dir" / "file"), "Data\n");
+    struct stat srcStat{};
+    struct stat destStat{};
+    ASSERT_EQ(stat((srcDir / "file").c_str(), &srcStat), 0);
+    ASSERT_EQ(stat((destDir / "dir" / "file").c_str(), &destStat), 0);
+    EXPECT_EQ(destStat.st_mode & 07777, 0640);
+    EXPECT_EQ(destStat.st_mtim.tv_sec, srcStat.st_mtim.tv_sec);
+    EXPECT_EQ(destStat.st_mtim.tv_nsec, srcStat.st_mtim.tv_nsec);
+
+    // The set-id bits are never applied.
+    auto setIdRecord = *receivedPut;
+    setIdRecord.destPath = destDir / "setid";
+    setIdRecord.mode = 06755;
+    EXPECT_EQ(data_sync::transfer::applyFileRecord(setIdRecord), 0);
+    ASSERT_EQ(stat((destDir / "setid").c_str(), &destStat), 0);
+    EXPECT_EQ(destStat.st_mode & 07777, 0755);
+
+    writeData(destDir / "deleted", "Data\n");
+    EXPECT_EQ(data_sync::transfer::applyFileRecord(*receivedDelete), 0);
+    EXPECT_FALSE(fs::exists(destDir / "deleted"));
+
+    // A frame bigger than the accepted size is rejected.
+    FrameReader smallReader(2);
+    smallReader.append(data_sync::transfer::encode(*putRecord));
+    EXPECT_THROW(smallReader.nextRecord(), std::runtime_error);
+}
+
+TEST_F(NativeTransferTest, TransfersOverPersistentLoopbackConnection)
+{
+    sdbusplus::async::context ctx;
+    TransferServer server(
+        ctx, 0,
+        [this](const fs::path& destPath) {
+        return destPath.native().starts_with(destDir.native() + "/");
+    }, 100);
+    TransferClient client(ctx, server.getPort());
+
+    writeData(srcDir / "file1", "Data1\n");
+    writeData(srcDir / "file2", "Data2\n");
+    writeData(transferDir / "outside", "Data\n");
+    fs::create_directory(destDir);
+    writeData(destDir / "deleted", "Data\n");
+
+    std::vector<int> firstResults;
+    std::vector<int> secondResults;
+    size_t idleConnections{0};
+    auto test = [&]() -> sdbusplus::async::task<> {
+        std::vector<FileRecord> records{
+            *data_sync::transfer::readFileRecord(srcDir / "file1",
+                                                 destDir / "file1", 100),
+            *data_sync::transfer::readFileRecord(srcDir / "missing",
+                                                 destDir / "deleted", 100),
+            // Not allowed by the path filter of the server.
+            *data_sync::transfer::readFileRecord(srcDir / "missing",
+                                                 transferDir / "outside", 100)};
+        firstResults = co_await client.send(records);
+        idleConnections = client.getIdleConnections();
+
+        // The second transfer reuses the connection of the first one.
+        records = {*data_sync::transfer::readFileRecord(
+            srcDir / "file2", destDir / "sub" / "file2", 100)};
+        secondResults = co_await client.send(records);
+        ctx.request_stop();
+    };
+
+    ctx.spawn(test());
+    ctx.run();
+
+    EXPECT_EQ(firstResults, (std::vector<int>{0, 0, EACCES}));
+    EXPECT_EQ(secondResults, std::vector<int>{0});
+    EXPECT_EQ(idleConnections, 1);
+    EXPECT_EQ(client.getIdleConnections(), 1);
+
+    EXPECT_EQ(readData(destDir / "file1"), "Data1\n");
+    EXPECT_EQ(readData(destDir / "sub" / "file2"), "Data2\n");
+    EXPECT_FALSE(fs::exists(destDir / "deleted"));
+    EXPECT_TRUE(fs::exists(transferDir / "outside"));
+}
+
+TEST_F(NativeTransferTest, DropsConnectionOfStalledPeer)
+{
+    using namespace std::chrono_literals;
+
+    // A peer accepting the connections but never answering, the connections
+    // complete through the backlog without being accepted.
+    int listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_GE(listenFd, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto* sockAddr = reinterpret_cast<sockaddr*>(&addr);
+    ASSERT_EQ(bind(listenFd, sockAddr, addrLen), 0);
+    ASSERT_EQ(listen(listenFd, 1), 0);
+    ASSERT_EQ(getsockname(listenFd, sockAddr, &addrLen), 0);
+
+    sdbusplus::async::context ctx;
+    TransferClient client(ctx, ntohs(addr.sin_port), 200ms);
+    writeData(srcDir / "file1", "Data1\n");
+
+    int error{0};
+    auto test = [&]() -> sdbusplus::async::task<> {
+        std::vector<FileRecord> records{*data_sync::transfer::readFileRecord(
+            srcDir / "file1", destDir / "file1", 100)};
+        try
+        {
+            co_await client.send(records);
+        }
+        catch (const std::system_error& e)
+        {
+            error = e.code().value();
+        }
+        ctx.request_stop();
+    };
+
+    ctx.spawn(test());
+    ctx.run();
+    close(listenFd);
+
+    EXPECT_EQ(error, ETIMEDOUT);
+    EXPECT_EQ(client.getIdleConnections(), 0);
+}
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * Microbenchmark of the Include/Exclude list matching per event, comparing
+ * the linear scan over the lists with the compiled PathTrie.
+ *
+ * Run using "meson test --benchmark".
+ */
+
+#include "path_trie.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace fs = std::filesystem;
+using data_sync::watch::PathTrie;
+
+namespace
+{
+
+constexpr auto cfgDir = "/var/lib/phosphor-inventory-manager/";
+constexpr size_t iterations = 200000;
+
+/**
+ * The linear matching as done on each event before compiling the lists.
+ */
+bool linearMatch(const fs::path& path,
+                 const std::unordered_set<fs::path>& excludeList,
+                 const std::unordered_set<fs::path>& includeList)
+{
+    auto matchesOrParentOfPath = [&path](const auto& excludePath) {
+        if (fs::is_directory(path))
+        {
+            return (path / "").string().starts_with(excludePath.string());
+        }
+        return (path.string() == excludePath.string());
+    };
+    if (std::ranges::any_of(excludeList, matchesOrParentOfPath))
+    {
+        return false;
+    }
+
+    fs::path normalizedPath{};
+    fs::is_directory(path) ? normalizedPath = path / "" : normalizedPath = path;
+    if (includeList.contains(normalizedPath))
+    {
+        return true;
+    }
+
+    auto isParentOfNormPath = [&normalizedPath](const auto& includePath) {
+        auto [parentItr, childItr] = std::ranges::mismatch(includePath,
+                                                           normalizedPath);
+        return (parentItr == includePath.end()) || (*parentItr == "");
+    };
+    if (std::ranges::any_of(includeList, isParentOfNormPath))
+    {
+        return true;
+    }
+
+    auto childOfPath = [&normalizedPath](const auto& includePath) {
+        auto [parentItr, childItr] = std::ranges::mismatch(normalizedPath,
+                                                           includePath);
+        return ((parentItr == normalizedPath.end()) || (*parentItr == ""));
+    };
+    return std::ranges::any_of(includeList, childOfPath);
+}
+
+bool trieMatch(const fs::path& path, const PathTrie& pathTrie)
+{
+    auto match = pathTrie.match(path.native());
+    return !match.excluded && (match.included || match.parentOfInclude);
+}
+
+template <typename Callable>
+std::chrono::nanoseconds measure(const std::vector<fs::path>& paths,
+                                 Callable&& callable)
+{
+    size_t matched = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        matched += callable(paths[i % paths.size()]) ? 1 : 0;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    // Keep the result used
+    if (matched == iterations + 1)
+    {
+        std::cout << matched;
+    }
+    return (end - start) / iterations;
+}
+
+} // namespace
+
+int main()
+{
+    for (size_t listSize : {4, 16, 64, 256})
+    {
+        std::unordered_set<fs::path> excludeList;
+        std::unordered_set<fs::path> includeList;
+        for (size_t i = 0; i < listSize; ++i)
+        {
+            excludeList.emplace(std::string(cfgDir) + "xyz/openbmc_project/" +
+                                "excluded" + std::to_string(i) + "/");
+            includeList.emplace(std::string(cfgDir) + "xyz/openbmc_project/" +
+                                "inventory/system/chassis" + std::to_string(i) +
+                                "/");
+        }
+
+        std::vector<fs::path> paths;
+        for (size_t i = 0; i < 64; ++i)
+        {
+            paths.emplace_back(
+                std::string(cfgDir) +
+                "xyz/openbmc_project/inventory/system/chassis" +
+                std::to_string(i % (listSize * 2)) + "/motherboard/cpu" +
+                std::to_string(i) + "/persist");
+        }
+
+        PathTrie pathTrie(excludeList, includeList);
+
+        auto linear = measure(paths, [&](const fs::path& path) {
+            return linearMatch(path, excludeList, includeList);
+        });
+        auto trie = measure(paths, [&](const fs::path& path) {
+            return trieMatch(path, pathTrie);
+        });
+
+        std::cout << "List size: " << listSize
+                  << " linear: " << linear.count() << " ns/event"
+                  << " trie: " << trie.count() << " ns/event" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "path_trie.hpp"
+
+#include <filesystem>
+#include <unordered_set>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using data_sync::watch::PathTrie;
+
+TEST(PathTrieTest, EmptyLists)
+{
+    PathTrie pathTrie;
+
+    EXPECT_FALSE(pathTrie.hasExcludes());
+    EXPECT_FALSE(pathTrie.hasIncludes());
+
+    auto match = pathTrie.match("/var/lib/data");
+    EXPECT_FALSE(match.excluded);
+    EXPECT_FALSE(match.included);
+    EXPECT_FALSE(match.parentOfInclude);
+}
+
+TEST(PathTrieTest, ExcludeList)
+{
+    PathTrie pathTrie(std::unordered_set<fs::path>{"/var/lib/data/dirX/",
+                                                   "/var/lib/data/fileX"},
+                      std::nullopt);
+
+    EXPECT_TRUE(pathTrie.hasExcludes());
+    EXPECT_FALSE(pathTrie.hasIncludes());
+
+    // The excluded paths and their children, with or without trailing slash
+    EXPECT_TRUE(pathTrie.match("/var/lib/data/dirX").excluded);
+    EXPECT_TRUE(pathTrie.match("/var/lib/data/dirX/").excluded);
+    EXPECT_TRUE(pathTrie.match("/var/lib/data/dirX/subDir/file").excluded);
+    EXPECT_TRUE(pathTrie.match("/var/lib/data/fileX").excluded);
+
+    // Only the whole components are matched
+    EXPECT_FALSE(pathTrie.match("/var/lib/data/fileX1").excluded);
+    EXPECT_FALSE(pathTrie.match("/var/lib/data/dirX1/").excluded);
+    EXPECT_FALSE(pathTrie.match("/var/lib/data/").excluded);
+    EXPECT_FALSE(pathTrie.match("/var/lib/data/dirY/file").excluded);
+}
+
+TEST(PathTrieTest, IncludeList)
+{
+    PathTrie pathTrie(std::nullopt,
+                      std::unordered_set<fs::path>{"/var/lib/data/dir1/",
+                                                   "/var/lib/data/a/b/file1"});
+
+    EXPECT_FALSE(pathTrie.hasExcludes());
+    EXPECT_TRUE(pathTrie.hasIncludes());
+
+    auto match = pathTrie.match("/var/lib/data/dir1/subDir/file");
+    EXPECT_TRUE(match.included);
+    EXPECT_FALSE(match.parentOfInclude);
+
+    match = pathTrie.match("/var/lib/data/a/b/file1");
+    EXPECT_TRUE(match.included);
+    EXPECT_FALSE(match.parentOfInclude);
+
+    // The parents of the include paths
+    match = pathTrie.match("/var/lib/data/");
+    EXPECT_FALSE(match.included);
+    EXPECT_TRUE(match.parentOfInclude);
+
+    match = pathTrie.match("/var/lib/data/a");
+    EXPECT_FALSE(match.included);
+    EXPECT_TRUE(match.parentOfInclude);
+
+    // Neither included nor parent of the include paths
+    match = pathTrie.match("/var/lib/data/a/c");
+    EXPECT_FALSE(match.included);
+    EXPECT_FALSE(match.parentOfInclude);
+
+    match = pathTrie.match("/var/lib/data/dir10");
+    EXPECT_FALSE(match.included);
+    EXPECT_FALSE(match.parentOfInclude);
+}
+
+TEST(PathTrieTest, ExcludeInsideIncludeList)
+{
+    PathTrie pathTrie(
+        std::unordered_set<fs::path>{"/var/lib/data/dir1/tmp/"},
+        std::unordered_set<fs::path>{"/var/lib/data/dir1/"});
+
+    auto match = pathTrie.match("/var/lib/data/dir1/tmp/file");
+    EXPECT_TRUE(match.included);
+    EXPECT_TRUE(match.excluded);
+
+    match = pathTrie.match("/var/lib/data/dir1/file");
+    EXPECT_TRUE(match.included);
+    EXPECT_FALSE(match.excluded);
+}
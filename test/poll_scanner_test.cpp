@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "poll_scanner.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using data_sync::watch::DataOperation;
+using data_sync::watch::DataOps;
+using data_sync::watch::PollScanner;
+using data_sync::watch::ScanFilter;
+
+class PollScannerTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpdir[] = "/tmp/pdsPollDirXXXXXX";
+        pollDir = fs::path(mkdtemp(tmpdir));
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(pollDir);
+    }
+
+    static void writeData(const fs::path& fileName, const std::string& data)
+    {
+        std::ofstream out(fileName);
+        ASSERT_TRUE(out.is_open()) << "Failed to open " << fileName;
+        out << data;
+        out.close();
+    }
+
+    fs::path pollDir;
+};
+
+TEST_F(PollScannerTest, ReportsModificationsSinceLastScan)
+{
+    fs::create_directory(pollDir / "dir");
+    writeData(pollDir / "dir" / "modified", "Data\n");
+    writeData(pollDir / "unmodified", "Data\n");
+    writeData(pollDir / "deleted", "Data\n");
+
+    PollScanner pollScanner;
+    pollScanner.addRoot(pollDir);
+    EXPECT_TRUE(pollScanner.covers((pollDir / "dir" / "").native()));
+    EXPECT_FALSE(pollScanner.covers(pollDir.native() + "_sibling"));
+
+    // The existing entries are part of the initial snapshot.
+    EXPECT_TRUE(pollScanner.scan().empty());
+
+    writeData(pollDir / "dir" / "modified", "Modified Data\n");
+    fs::remove(pollDir / "deleted");
+    fs::create_directory(pollDir / "newDir");
+    writeData(pollDir / "newDir" / "created", "Data\n");
+
+    auto dataOps = pollScanner.scan();
+    std::ranges::sort(dataOps, {}, &DataOperation::path);
+    EXPECT_EQ(dataOps, (std::vector<DataOperation>{
+                           {pollDir / "deleted", DataOps::DELETE},
+                           {pollDir / "dir" / "modified", DataOps::COPY},
+                           {pollDir / "newDir" / "", DataOps::COPY},
+                           {pollDir / "newDir" / "created", DataOps::COPY}}));
+
+    EXPECT_TRUE(pollScanner.scan().empty());
+}
+
+TEST_F(PollScannerTest, FilteredEntriesAndSubsumedRoots)
+{
+    fs::create_directory(pollDir / "included");
+    fs::create_directory(pollDir / "excluded");
+
+    PollScanner pollScanner([this](std::string_view path) {
+        if (path == pollDir.native())
+        {
+            return ScanFilter::Traverse;
+        }
+        return path.starts_with((pollDir / "excluded").native())
+                   ? ScanFilter::Skip
+                   : ScanFilter::Report;
+    });
+
+    pollScanner.addRoot(pollDir / "included");
+    pollScanner.addRoot(pollDir / "included" / "child");
+    pollScanner.addRoot(pollDir);
+    EXPECT_EQ(pollScanner.getRoots(), std::vector<fs::path>{pollDir});
+    EXPECT_EQ(pollScanner.size(), 1);
+
+    writeData(pollDir / "excluded" / "file", "Data\n");
+    writeData(pollDir / "included" / "file", "Data\n");
+
+    EXPECT_EQ(pollScanner.scan(),
+              (std::vector<DataOperation>{
+                  {pollDir / "included" / "file", DataOps::COPY}}));
+}
+
+TEST_F(PollScannerTest, RenameReportedAsMove)
+{
+    fs::create_directory(pollDir / "dir");
+    writeData(pollDir / "dir" / "file", "Data\n");
+    writeData(pollDir / "replaced", "Data\n");
+
+    PollScanner pollScanner;
+    pollScanner.addRoot(pollDir);
+
+    fs::rename(pollDir / "dir", pollDir / "renamedDir");
+    fs::remove(pollDir / "replaced");
+    writeData(pollDir / "created", "Other Data\n");
+
+    auto dataOps = pollScanner.scan();
+    std::ranges::sort(dataOps, {}, &DataOperation::path);
+    EXPECT_EQ(dataOps, (std::vector<DataOperation>{
+                           {pollDir / "created", DataOps::COPY},
+                           {pollDir / "renamedDir" / "", DataOps::MOVE,
+                            pollDir / "dir" / ""},
+                           {pollDir / "renamedDir" / "file", DataOps::MOVE,
+                            pollDir / "dir" / "file"},
+                           {pollDir / "replaced", DataOps::DELETE}}));
+}
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "poll_watcher.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+namespace watch = data_sync::watch;
+
+class PollWatcherTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpdir[] = "/tmp/pdsPollWatcherDirXXXXXX";
+        watchDir = fs::path(mkdtemp(tmpdir)) / "";
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(watchDir);
+    }
+
+    static void writeData(const fs::path& fileName, const std::string& data)
+    {
+        std::ofstream out(fileName);
+        ASSERT_TRUE(out.is_open()) << "Failed to open " << fileName;
+        out << data;
+        out.close();
+    }
+
+    fs::path watchDir;
+};
+
+TEST_F(PollWatcherTest, ReportsChangesOnInterval)
+{
+    using namespace std::literals;
+    sdbusplus::async::context ctx;
+    watch::poll::PollMux pollMux(ctx);
+
+    fs::create_directory(watchDir / "dir");
+    writeData(watchDir / "dir" / "renamed", "Data\n");
+    fs::path srcFile = watchDir / "dir" / "srcFile";
+    fs::path excludedFile = watchDir / "excluded";
+
+    watch::DataOperations receivedOps;
+    watch::poll::PollWatcher watcher(
+        pollMux, [&](const watch::DataOperations& dataOps) {
+        std::ranges::copy(dataOps, std::back_inserter(receivedOps));
+        ctx.request_stop();
+    }, watchDir, std::unordered_set<fs::path>{excludedFile}, std::nullopt, 1s);
+
+    EXPECT_TRUE(watcher.getWatchingPaths().empty());
+    EXPECT_EQ(watcher.getPolledPaths(), std::vector<fs::path>{watchDir});
+
+    // All the changes made between the scans are reported at once.
+    ctx.spawn(sdbusplus::async::sleep_for(ctx, 0.1s) |
+              sdbusplus::async::execution::then([&]() {
+        writeData(srcFile, "Data\n");
+        writeData(excludedFile, "Data\n");
+        writeData(watchDir / ".hidden", "Data\n");
+        fs::rename(watchDir / "dir" / "renamed", watchDir / "moved");
+    }));
+    ctx.spawn(
+        sdbusplus::async::sleep_for(ctx, 5s) |
+        sdbusplus::async::execution::then([&ctx]() { ctx.request_stop(); }));
+
+    ctx.run();
+
+    std::ranges::sort(receivedOps, {}, &watch::DataOperation::path);
+    EXPECT_EQ(receivedOps,
+              (watch::DataOperations{
+                  {srcFile, watch::DataOps::COPY},
+                  {watchDir / "moved", watch::DataOps::MOVE,
+                   watchDir / "dir" / "renamed"}}));
+    EXPECT_EQ(watcher.getEventStats().wakeups, 1U);
+}
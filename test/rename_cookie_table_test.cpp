@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "rename_cookie_table.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using data_sync::watch::inotify::renameCookieTimeout;
+using data_sync::watch::inotify::RenameCookieTable;
+
+TEST(RenameCookieTableTest, MatchedRename)
+{
+    RenameCookieTable renameCookies;
+
+    renameCookies.emplace(1, "/var/lib/data/.file.XXXX");
+    EXPECT_EQ(renameCookies.size(), 1);
+    EXPECT_TRUE(renameCookies.isPending("/var/lib/data/.file.XXXX/"));
+
+    EXPECT_FALSE(renameCookies.take(2).has_value());
+    EXPECT_EQ(renameCookies.take(1), fs::path("/var/lib/data/.file.XXXX"));
+    EXPECT_EQ(renameCookies.size(), 0);
+    EXPECT_FALSE(renameCookies.isPending("/var/lib/data/.file.XXXX"));
+}
+
+TEST(RenameCookieTableTest, ExpiryAfterNextBatchOrTimeout)
+{
+    RenameCookieTable renameCookies;
+    const auto now = RenameCookieTable::Clock::now();
+
+    renameCookies.emplace(1, "/var/lib/data/.hidden", now);
+    renameCookies.emplace(2, "/var/lib/data/file", now);
+
+    // The IN_MOVED_TO can still arrive in the next batch.
+    renameCookies.expire();
+    EXPECT_EQ(renameCookies.size(), 2);
+    renameCookies.emplace(3, "/var/lib/data/later", now + renameCookieTimeout);
+    renameCookies.expire();
+    EXPECT_EQ(renameCookies.size(), 1);
+
+    // Without any other batch, the entries expire after the timeout.
+    renameCookies.expireBefore(now + renameCookieTimeout);
+    EXPECT_EQ(renameCookies.size(), 1);
+    renameCookies.expireBefore(now + (2 * renameCookieTimeout));
+    EXPECT_EQ(renameCookies.size(), 0);
+}
+
+TEST(RenameCookieTableTest, BoundedByCapacityInInsertionOrder)
+{
+    constexpr size_t capacity = 4;
+    RenameCookieTable renameCookies(capacity);
+
+    // The moves out of the tree never pair, still the table doesn't grow.
+    // The cookies wrap around, yet the oldest entries are evicted.
+    for (uint32_t index = 0; index < 100; ++index)
+    {
+        renameCookies.emplace(UINT32_MAX - 50 + index,
+                              "/var/lib/data/file" + std::to_string(index));
+        EXPECT_LE(renameCookies.size(), capacity);
+    }
+
+    for (uint32_t index = 0; index < 100; ++index)
+    {
+        EXPECT_EQ(renameCookies.isPending("/var/lib/data/file" +
+                                          std::to_string(index)),
+                  index >= 100 - capacity);
+    }
+}
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sync_scheduler.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using data_sync::sync::SyncPriority;
+using data_sync::sync::SyncScheduler;
+
+TEST(SyncSchedulerTest, RunsUpToTheBoundAtOnce)
+{
+    using namespace std::literals;
+    sdbusplus::async::context ctx;
+    SyncScheduler scheduler(ctx, 2);
+
+    size_t maxRunning = 0;
+    size_t completed = 0;
+    auto runSync = [&]() -> sdbusplus::async::task<> {
+        auto slot = co_await scheduler.acquire(SyncPriority::Immediate);
+        maxRunning = std::max(maxRunning, scheduler.getRunningSyncs());
+        co_await sdbusplus::async::sleep_for(ctx, 50ms);
+        ++completed;
+    };
+
+    auto test = [&]() -> sdbusplus::async::task<> {
+        for (size_t sync = 0; sync < 5; ++sync)
+        {
+            ctx.spawn(runSync());
+        }
+        while (completed < 5)
+        {
+            co_await sdbusplus::async::sleep_for(ctx, 10ms);
+        }
+        ctx.request_stop();
+    };
+
+    ctx.spawn(test());
+    ctx.run();
+
+    EXPECT_EQ(maxRunning, 2);
+    EXPECT_EQ(scheduler.getRunningSyncs(), 0);
+    const auto& stats = scheduler.getStats(SyncPriority::Immediate);
+    EXPECT_EQ(stats.syncs, 5);
+    EXPECT_EQ(stats.waitedSyncs, 3);
+    EXPECT_EQ(stats.maxQueueDepth, 3);
+}
+
+TEST(SyncSchedulerTest, GrantsByPriorityThenArrival)
+{
+    using namespace std::literals;
+    sdbusplus::async::context ctx;
+    SyncScheduler scheduler(ctx, 1);
+
+    std::vector<std::string> order;
+    auto runSync = [&](SyncPriority priority,
+                       std::string name) -> sdbusplus::async::task<> {
+        auto slot = co_await scheduler.acquire(priority);
+        order.emplace_back(std::move(name));
+        co_await sdbusplus::async::sleep_for(ctx, 10ms);
+    };
+
+    auto test = [&]() -> sdbusplus::async::task<> {
+        auto slot = co_await scheduler.acquire(SyncPriority::Periodic);
+
+        // Queue each sync before the next one, while the only slot is held.
+        for (auto [priority, name] :
+             {std::pair{SyncPriority::Periodic, "periodic"},
+              std::pair{SyncPriority::FullSync, "fullSync"},
+              std::pair{SyncPriority::Immediate, "immediate1"},
+              std::pair{SyncPriority::Deferred, "deferred"},
+              std::pair{SyncPriority::Immediate, "immediate2"}})
+        {
+            ctx.spawn(runSync(priority, name));
+            co_await sdbusplus::async::sleep_for(ctx, 10ms);
+        }
+        EXPECT_EQ(scheduler.getQueueDepth(SyncPriority::Immediate), 2);
+        EXPECT_EQ(scheduler.getQueueDepth(SyncPriority::Periodic), 1);
+        EXPECT_TRUE(order.empty());
+
+        slot.release();
+        while (order.size() < 5)
+        {
+            co_await sdbusplus::async::sleep_for(ctx, 10ms);
+        }
+        ctx.request_stop();
+    };
+
+    ctx.spawn(test());
+    ctx.run();
+
+    EXPECT_EQ(order, (std::vector<std::string>{"immediate1", "immediate2",
+                                               "deferred", "fullSync",
+                                               "periodic"}));
+    EXPECT_EQ(scheduler.getQueueDepth(SyncPriority::Immediate), 0);
+    EXPECT_EQ(scheduler.getStats(SyncPriority::Immediate).waitedSyncs, 2);
+    EXPECT_EQ(scheduler.getStats(SyncPriority::Periodic).syncs, 2);
+    EXPECT_GE(scheduler.getStats(SyncPriority::Periodic).maxWait, 50ms);
+}
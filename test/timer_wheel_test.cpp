@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using data_sync::timer::Timer;
+using data_sync::timer::TimerWheel;
+
+TEST(TimerWheelTest, FiresTimersOfAllLevelsInBatches)
+{
+    TimerWheel wheel(10);
+    std::array<Timer, 6> timers;
+    const std::array<uint64_t, 6> expiries{12, 12, 100, 5000, 300000,
+                                           uint64_t{1} << 30};
+    for (size_t index = 0; index < timers.size(); ++index)
+    {
+        wheel.add(timers[index], expiries[index]);
+    }
+    EXPECT_EQ(wheel.size(), timers.size());
+    EXPECT_EQ(wheel.nextExpiry(), 12);
+
+    // The timers due at the same tick fire at once, nothing before it.
+    EXPECT_TRUE(wheel.advance(11).empty());
+    auto fired = wheel.advance(12);
+    EXPECT_EQ(fired, (std::vector<Timer*>{&timers[0], &timers[1]}));
+    EXPECT_EQ(wheel.now(), 13);
+
+    // The coarser timers never fire before their expiry, whatever the ticks
+    // the wheel gets advanced at.
+    std::vector<uint64_t> firedAt;
+    for (auto next = wheel.nextExpiry(); next; next = wheel.nextExpiry())
+    {
+        ASSERT_GE(*next, wheel.now());
+        for (auto* timer : wheel.advance(*next))
+        {
+            EXPECT_EQ(timer->expiry, *next);
+            EXPECT_FALSE(timer->pending);
+            firedAt.push_back(*next);
+        }
+    }
+    EXPECT_EQ(firedAt, (std::vector<uint64_t>{expiries.begin() + 2,
+                                              expiries.end()}));
+    EXPECT_EQ(wheel.size(), 0);
+    EXPECT_FALSE(wheel.nextExpiry());
+}
+
+TEST(TimerWheelTest, RemovesAndMovesTimers)
+{
+    TimerWheel wheel;
+    Timer removed;
+    Timer moved;
+    Timer past;
+    wheel.add(removed, 70);
+    wheel.add(moved, 4000);
+    wheel.remove(removed);
+    wheel.remove(removed);
+    wheel.add(moved, 20);
+    EXPECT_EQ(wheel.size(), 1);
+
+    // A jump past the expiry fires the timer on the first advance.
+    EXPECT_EQ(wheel.advance(5000), std::vector<Timer*>{&moved});
+    wheel.add(past, 3);
+    EXPECT_EQ(wheel.nextExpiry(), 5001);
+    EXPECT_EQ(wheel.advance(5001), std::vector<Timer*>{&past});
+    EXPECT_EQ(wheel.size(), 0);
+}
+
+TEST(TimerWheelTest, AlignsTicksWithinSlack)
+{
+    EXPECT_EQ(TimerWheel::alignTick(5, 5), 5);
+    EXPECT_EQ(TimerWheel::alignTick(9, 3), 9);
+    EXPECT_EQ(TimerWheel::alignTick(5, 7), 6);
+    EXPECT_EQ(TimerWheel::alignTick(100, 130), 128);
+
+    // The overlapping windows pick the same tick.
+    EXPECT_EQ(TimerWheel::alignTick(120, 135), TimerWheel::alignTick(97, 128));
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * Microbenchmark of the memory per watched directory, comparing the map of
+ * the full paths with the WatchTable of the interned paths.
+ *
+ * Run using "meson test --benchmark".
+ */
+
+#include "watch_table.hpp"
+
+#include <malloc.h>
+
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+using data_sync::watch::inotify::WatchTable;
+
+namespace
+{
+
+constexpr auto cfgDir = "/var/lib/phosphor-inventory-manager/";
+
+/**
+ * The bytes currently allocated on the heap, including the allocator
+ * overhead.
+ */
+size_t allocatedBytes()
+{
+    return mallinfo2().uordblks;
+}
+
+/**
+ * A directory tree of the given depth and fan-out under the config dir.
+ */
+std::vector<fs::path> makeTree(size_t depth, size_t fanOut)
+{
+    std::vector<fs::path> dirs{fs::path(cfgDir)};
+    size_t levelStart = 0;
+    for (size_t level = 0; level < depth; ++level)
+    {
+        size_t levelEnd = dirs.size();
+        for (size_t parent = levelStart; parent < levelEnd; ++parent)
+        {
+            for (size_t child = 0; child < fanOut; ++child)
+            {
+                dirs.emplace_back(dirs[parent] / ("chassis" +
+                                                  std::to_string(child)) /
+                                  "");
+            }
+        }
+        levelStart = levelEnd;
+    }
+    return dirs;
+}
+
+} // namespace
+
+int main()
+{
+    for (auto [depth, fanOut] : {std::pair<size_t, size_t>{2, 8},
+                                 {3, 8},
+                                 {4, 8},
+                                 {6, 4}})
+    {
+        auto dirs = makeTree(depth, fanOut);
+
+        size_t before = allocatedBytes();
+        auto pathsMap = std::make_unique<std::map<int, fs::path>>();
+        for (int wd = 0; const auto& dir : dirs)
+        {
+            pathsMap->emplace(++wd, dir);
+        }
+        size_t mapBytes = allocatedBytes() - before;
+        pathsMap.reset();
+
+        before = allocatedBytes();
+        auto watchTable = std::make_unique<WatchTable>();
+        for (int wd = 0; const auto& dir : dirs)
+        {
+            watchTable->emplace(++wd, dir, true);
+        }
+        size_t tableBytes = allocatedBytes() - before;
+
+        std::cout << "Directories: " << dirs.size()
+                  << " map: " << mapBytes / dirs.size() << " bytes/dir"
+                  << " table: " << tableBytes / dirs.size() << " bytes/dir"
+                  << " (reported: "
+                  << watchTable->getMemoryUsage() / dirs.size() << ")"
+                  << std::endl;
+    }
+    return 0;
+}
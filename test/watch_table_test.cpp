@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "watch_table.hpp"
+
+#include <filesystem>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using data_sync::watch::inotify::PathPool;
+using data_sync::watch::inotify::WatchTable;
+
+TEST(WatchTableTest, MaterializePaths)
+{
+    WatchTable table;
+    EXPECT_TRUE(table.emplace(2, "/a/b/", true));
+    EXPECT_TRUE(table.emplace(1, "/a", true));
+    EXPECT_TRUE(table.emplace(5, "/a/b/file", false));
+    EXPECT_FALSE(table.emplace(5, "/a/b/other", false));
+
+    EXPECT_EQ(table.size(), 3U);
+    EXPECT_EQ(table.at(1), "/a/");
+    EXPECT_EQ(table.at(2), "/a/b/");
+    EXPECT_EQ(table.at(5), "/a/b/file");
+    EXPECT_TRUE(table.isDir(2));
+    EXPECT_FALSE(table.isDir(5));
+    EXPECT_THROW(table.at(3), std::out_of_range);
+
+    // The event path is built into a reusable buffer.
+    std::string buffer;
+    table.appendPath(2, buffer);
+    buffer.append("name");
+    EXPECT_EQ(buffer, "/a/b/name");
+
+    EXPECT_EQ(table.getWDs(), (std::vector<int>{1, 2, 5}));
+}
+
+TEST(WatchTableTest, FindByInternedPath)
+{
+    WatchTable table;
+    table.emplace(1, "/a/b/", true);
+    table.emplace(2, "/a/b/c", true);
+
+    // The trailing slash is not significant.
+    EXPECT_EQ(table.find("/a/b"), 1);
+    EXPECT_EQ(table.find("/a/b/c/"), 2);
+
+    // Interned as the parent of a watched path, but not watched itself.
+    EXPECT_EQ(table.find("/a"), std::nullopt);
+    EXPECT_EQ(table.find("/a/x"), std::nullopt);
+}
+
+TEST(WatchTableTest, ReleaseInternedPaths)
+{
+    WatchTable table;
+    table.emplace(1, "/a/b/c/", true);
+    table.emplace(2, "/a/b/d/", true);
+
+    table.erase(1);
+    EXPECT_FALSE(table.contains(1));
+    EXPECT_EQ(table.find("/a/b/c"), std::nullopt);
+    EXPECT_EQ(table.at(2), "/a/b/d/");
+
+    // The released nodes are reused, hence the memory doesn't grow while
+    // the directories are created and deleted.
+    table.emplace(3, "/a/b/c/", true);
+    table.erase(3);
+    auto memoryUsage = table.getMemoryUsage();
+    for (int wd = 4; wd < 100; ++wd)
+    {
+        table.emplace(wd, "/a/b/dir" + std::to_string(wd % 2) + "/", true);
+        table.erase(wd);
+    }
+    EXPECT_EQ(table.getMemoryUsage(), memoryUsage);
+
+    table.erase(2);
+    EXPECT_EQ(table.size(), 0U);
+}
+
+TEST(WatchTableTest, RootPath)
+{
+    WatchTable table;
+    table.emplace(1, "/", true);
+    EXPECT_EQ(table.at(1), "/");
+    EXPECT_EQ(table.find("/"), 1);
+}
+
+TEST(WatchTableTest, MoveSubtree)
+{
+    WatchTable table;
+    table.emplace(1, "/cfg/", true);
+    table.emplace(2, "/cfg/dir/", true);
+    table.emplace(3, "/cfg/dir/sub/", true);
+    table.emplace(4, "/cfg/dir/sub/file", false);
+    table.emplace(5, "/cfg/other/", true);
+
+    // mv /cfg/dir /cfg/other/renamed
+    EXPECT_TRUE(table.move("/cfg/dir", "/cfg/other/renamed"));
+    EXPECT_EQ(table.at(2), "/cfg/other/renamed/");
+    EXPECT_EQ(table.at(3), "/cfg/other/renamed/sub/");
+    EXPECT_EQ(table.at(4), "/cfg/other/renamed/sub/file");
+    EXPECT_TRUE(table.isDir(3));
+    EXPECT_EQ(table.find("/cfg/dir/sub"), std::nullopt);
+    EXPECT_EQ(table.find("/cfg/other/renamed/sub/"), 3);
+
+    // Moved up into an ancestor of the source.
+    EXPECT_TRUE(table.move("/cfg/other/renamed/sub/", "/sub"));
+    EXPECT_EQ(table.at(4), "/sub/file");
+    EXPECT_EQ(table.at(2), "/cfg/other/renamed/");
+
+    // Nothing to move, or the destination is watched already.
+    EXPECT_FALSE(table.move("/cfg/missing", "/cfg/new"));
+    EXPECT_FALSE(table.move("/cfg/other/renamed", "/cfg"));
+    EXPECT_EQ(table.at(2), "/cfg/other/renamed/");
+
+    // The released nodes of the moved paths are reused.
+    table.erase(4);
+    table.erase(3);
+    auto memoryUsage = table.getMemoryUsage();
+    table.emplace(6, "/cfg/other/renamed/sub/", true);
+    table.erase(6);
+    EXPECT_EQ(table.getMemoryUsage(), memoryUsage);
+}